@@ -9,6 +9,10 @@ include(CMakeDependentOption)
 
 option(BUILD_LIBXSMM_VIA_CMAKE "Build LIBXSMM via CMake" ON)
 option(USE_LIBXSMM "Enable LIBXSMM" ON)
+# The loop schemes in csrc/cpu/tpp/common_loops.cpp are always built in, the
+# others are JIT compiled at runtime unless they are listed here.
+set(BUILD_TPP_AOT_LOOP_SCHEMES "" CACHE STRING
+  "Semicolon separated TPP loop schemes to generate at build time")
 if(WIN32)
   set(USE_LIBXSMM ON)
 endif()
@@ -53,6 +57,7 @@ function (print_cpu_config_summary)
     message(STATUS "  IPEX_DISP_OP          : ${IPEX_DISP_OP}")
     message(STATUS "  BUILD_XSMM_VIA_CMAKE  : ${BUILD_LIBXSMM_VIA_CMAKE}")
     message(STATUS "  USE_LIBXSMM           : ${USE_LIBXSMM}")
+    message(STATUS "  TPP AOT loop schemes  : ${BUILD_TPP_AOT_LOOP_SCHEMES}")
     message(STATUS "  BUILD_CPU_WITH_ONECCL : ${BUILD_CPU_WITH_ONECCL}")
     message(STATUS "  USE_SHM               : ${USE_SHM}")
     message(STATUS "")
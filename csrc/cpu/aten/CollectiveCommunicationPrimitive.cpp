@@ -8,6 +8,8 @@ namespace torch_ipex {
 namespace cpu {
 
 IPEX_DEFINE_DISPATCH(all_reduce_add_kernel_stub);
+IPEX_DEFINE_DISPATCH(all_reduce_add_async_kernel_stub);
+IPEX_DEFINE_DISPATCH(all_reduce_wait_kernel_stub);
 IPEX_DEFINE_DISPATCH(allgather_kernel_stub);
 
 at::Tensor all_reduce_add(at::Tensor t_in) {
@@ -15,6 +17,20 @@ at::Tensor all_reduce_add(at::Tensor t_in) {
   return all_reduce_add_kernel_stub(kCPU, t_in);
 }
 
+// Starts the all-reduce of t_in on the communication thread and returns the
+// handle to pass to all_reduce_wait. t_in must not be accessed before the
+// wait.
+int64_t all_reduce_add_async(at::Tensor t_in) {
+  RECORD_FUNCTION(
+      "ipex::all_reduce_add_async", c10::ArrayRef<c10::IValue>({}));
+  return all_reduce_add_async_kernel_stub(kCPU, t_in);
+}
+
+at::Tensor all_reduce_wait(at::Tensor t_in, int64_t handle) {
+  RECORD_FUNCTION("ipex::all_reduce_wait", c10::ArrayRef<c10::IValue>({}));
+  return all_reduce_wait_kernel_stub(kCPU, t_in, handle);
+}
+
 at::Tensor allgather(
     at::Tensor t_in,
     std::vector<int64_t> cols_per_rank,
@@ -32,6 +48,16 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def("all_reduce_add(Tensor(a!) t_in)-> (Tensor)");
   m.impl(
       "all_reduce_add", c10::DispatchKey::CPU, torch_ipex::cpu::all_reduce_add);
+  m.def("all_reduce_add_async(Tensor(a!) t_in) -> int");
+  m.impl(
+      "all_reduce_add_async",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::all_reduce_add_async);
+  m.def("all_reduce_wait(Tensor(a!) t_in, int handle) -> Tensor(a!)");
+  m.impl(
+      "all_reduce_wait",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::all_reduce_wait);
   m.def("allgather(Tensor input, int[] output, int world_size) -> (Tensor)");
   m.impl("allgather", c10::DispatchKey::CPU, torch_ipex::cpu::allgather);
 }
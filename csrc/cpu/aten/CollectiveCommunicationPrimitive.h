@@ -9,6 +9,8 @@ namespace cpu {
 namespace {
 
 at::Tensor all_reduce_add(at::Tensor& t_in);
+int64_t all_reduce_add_async(at::Tensor& t_in);
+at::Tensor all_reduce_wait(at::Tensor& t_in, int64_t handle);
 at::Tensor allgather(
     at::Tensor t_in,
     std::vector<int64_t> cols_per_rank,
@@ -18,12 +20,18 @@ int64_t get_rank(const at::Tensor dummy_input);
 } // namespace
 
 using all_reduce_add_fn = at::Tensor (*)(at::Tensor& t_in);
+using all_reduce_add_async_fn = int64_t (*)(at::Tensor& t_in);
+using all_reduce_wait_fn = at::Tensor (*)(at::Tensor& t_in, int64_t handle);
 using allgather_fn = at::Tensor (*)(
     at::Tensor t_in,
     std::vector<int64_t> cols_per_rank,
     int64_t world_size);
 
 IPEX_DECLARE_DISPATCH(all_reduce_add_fn, all_reduce_add_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    all_reduce_add_async_fn,
+    all_reduce_add_async_kernel_stub);
+IPEX_DECLARE_DISPATCH(all_reduce_wait_fn, all_reduce_wait_kernel_stub);
 IPEX_DECLARE_DISPATCH(allgather_fn, allgather_kernel_stub);
 
 } // namespace cpu
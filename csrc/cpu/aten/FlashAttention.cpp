@@ -32,12 +32,64 @@ std::tuple<at::Tensor, at::Tensor> flash_attention_forward_cpu(
     c10::optional<double> scale) {
   if (use_ipex_flash_attention(query, key, value)) {
     return flash_attention_kernel_stub(
-        kCPU, query, key, value, dropout_p, is_causal, attention_mask, scale);
+        kCPU,
+        query,
+        key,
+        value,
+        dropout_p,
+        is_causal,
+        attention_mask,
+        scale,
+        /* window_size */ -1);
   }
   return at::native::_scaled_dot_product_flash_attention_cpu(
       query, key, value, dropout_p, is_causal, attention_mask, scale);
 }
 
+/*
+ *Caculate the flash attention SDPA with a sliding window, query i only
+ *attends keys in (i - window_size, i]. The kv blocks out of the window are
+ *skipped instead of being masked by a dense attention mask.
+ */
+std::tuple<at::Tensor, at::Tensor> flash_attention_window_forward_cpu(
+    const at::Tensor& query,
+    const at::Tensor& key,
+    const at::Tensor& value,
+    double dropout_p,
+    bool is_causal,
+    const c10::optional<at::Tensor>& attention_mask,
+    c10::optional<double> scale,
+    int64_t window_size) {
+  if (window_size <= 0) {
+    return flash_attention_forward_cpu(
+        query, key, value, dropout_p, is_causal, attention_mask, scale);
+  }
+  // The fallback in PT has no sliding window, make the inputs usable by the
+  // IPEX kernel instead.
+  if (use_ipex_flash_attention(query, key, value)) {
+    return flash_attention_kernel_stub(
+        kCPU,
+        query,
+        key,
+        value,
+        dropout_p,
+        is_causal,
+        attention_mask,
+        scale,
+        window_size);
+  }
+  return flash_attention_kernel_stub(
+      kCPU,
+      query.contiguous(),
+      key.contiguous(),
+      value.contiguous(),
+      dropout_p,
+      is_causal,
+      attention_mask,
+      scale,
+      window_size);
+}
+
 /*
  *Substitude the flash attention SDPA in PT.
  *In order to add optimizations which are hard to upstream, like TPP layout
@@ -53,12 +105,12 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       "flash_attention(Tensor query, Tensor key, Tensor value, \
        float dropout_p=0.0, bool is_causal=False, \
-       *, Tensor? attention_mask=None, float? scale=None) -> \
-       (Tensor, Tensor)");
+       *, Tensor? attention_mask=None, float? scale=None, \
+       int window_size=-1) -> (Tensor, Tensor)");
   m.impl(
       "flash_attention",
       c10::DispatchKey::CPU,
-      torch_ipex::cpu::flash_attention_forward_cpu);
+      torch_ipex::cpu::flash_attention_window_forward_cpu);
 }
 
 } // namespace cpu
@@ -15,7 +15,8 @@ std::tuple<at::Tensor, at::Tensor> flash_attention(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale);
+    c10::optional<double> scale,
+    int64_t window_size);
 } // namespace
 
 using flash_attention_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
@@ -25,7 +26,8 @@ using flash_attention_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale);
+    c10::optional<double> scale,
+    int64_t window_size);
 
 IPEX_DECLARE_DISPATCH(flash_attention_kernel_fn, flash_attention_kernel_stub);
 
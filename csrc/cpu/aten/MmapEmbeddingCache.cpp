@@ -0,0 +1,361 @@
+#include "MmapEmbeddingCache.h"
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/record_function.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+// A row used by more recent batches survives more CLOCK sweeps
+constexpr uint8_t kMaxFrequency = 15;
+} // namespace
+
+MmapEmbeddingCache::MmapEmbeddingCache(
+    const std::string& path,
+    int64_t num_rows,
+    int64_t emb_dim,
+    int64_t num_states,
+    int64_t cache_rows)
+    : num_rows_(num_rows),
+      emb_dim_(emb_dim),
+      num_tables_(1 + num_states),
+      cache_rows_(cache_rows) {
+  TORCH_CHECK(
+      num_rows > 0 && emb_dim > 0 && num_states >= 0 && cache_rows > 0,
+      "MmapEmbeddingCache: invalid table shape or cache size");
+  map_bytes_ = num_tables_ * num_rows_ * emb_dim_ * sizeof(float);
+  fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  TORCH_CHECK(fd_ >= 0, "MmapEmbeddingCache: fail to open ", path);
+  struct stat st;
+  TORCH_CHECK(fstat(fd_, &st) == 0, "MmapEmbeddingCache: fail to stat ", path);
+  if (st.st_size == 0) {
+    // sparse file, the rows read as zeros until written
+    TORCH_CHECK(
+        ftruncate(fd_, map_bytes_) == 0,
+        "MmapEmbeddingCache: fail to resize ",
+        path);
+  } else {
+    TORCH_CHECK(
+        (size_t)st.st_size == map_bytes_,
+        "MmapEmbeddingCache: expect ",
+        path,
+        " of ",
+        map_bytes_,
+        " bytes, got ",
+        st.st_size);
+  }
+  void* map =
+      mmap(NULL, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  TORCH_CHECK(map != MAP_FAILED, "MmapEmbeddingCache: fail to map ", path);
+  map_ = (float*)map;
+  // the rows are read at random, the read-ahead of the neighbours is wasted
+  madvise(map_, map_bytes_, MADV_RANDOM);
+
+  cache_rows_ = std::min(cache_rows_, num_rows_);
+  for (int64_t t = 0; t < num_tables_; t++) {
+    cache_.push_back(at::zeros({cache_rows_, emb_dim_}, at::kFloat));
+  }
+  row_of_.resize(cache_rows_, -1);
+  frequency_.resize(cache_rows_, 0);
+  dirty_.resize(cache_rows_, 0);
+  step_of_.resize(cache_rows_, -1);
+}
+
+MmapEmbeddingCache::~MmapEmbeddingCache() {
+  try {
+    wait_prefetch();
+    flush();
+  } catch (...) {
+  }
+  munmap(map_, map_bytes_);
+  close(fd_);
+}
+
+float* MmapEmbeddingCache::file_row(int64_t table, int64_t row) const {
+  return map_ + (table * num_rows_ + row) * emb_dim_;
+}
+
+float* MmapEmbeddingCache::cache_row(int64_t table, int64_t slot) const {
+  return cache_[table].data_ptr<float>() + slot * emb_dim_;
+}
+
+MmapEmbeddingCache::Staged MmapEmbeddingCache::stage(
+    const at::Tensor& indices) const {
+  Staged staged;
+  auto indices_ptr = indices.data_ptr<int64_t>();
+  for (int64_t i = 0; i < indices.numel(); i++) {
+    int64_t row = indices_ptr[i];
+    // out of range rows are reported by lookup
+    if (row < 0 || row >= num_rows_ || slot_of_.count(row) ||
+        staged.rows.count(row)) {
+      continue;
+    }
+    staged.rows.emplace(row, staged.rows.size());
+    for (int64_t t = 0; t < num_tables_; t++) {
+      auto src = file_row(t, row);
+      staged.data.insert(staged.data.end(), src, src + emb_dim_);
+    }
+  }
+  return staged;
+}
+
+void MmapEmbeddingCache::prefetch(const at::Tensor& indices) {
+  wait_prefetch();
+  auto rows = indices.to(at::kLong).contiguous();
+  // The rows not in the cache are only written by the next lookup, which
+  // waits for the staging to finish
+  prefetching_ =
+      std::async(std::launch::async, [this, rows]() { return stage(rows); });
+}
+
+MmapEmbeddingCache::Staged MmapEmbeddingCache::wait_prefetch() {
+  if (!prefetching_.valid()) {
+    return Staged();
+  }
+  return prefetching_.get();
+}
+
+int64_t MmapEmbeddingCache::evict() {
+  TORCH_CHECK(
+      num_used_ < cache_rows_,
+      "MmapEmbeddingCache: a batch uses more than the ",
+      cache_rows_,
+      " cached rows");
+  while (true) {
+    int64_t slot = hand_;
+    hand_ = hand_ + 1 == cache_rows_ ? 0 : hand_ + 1;
+    if (row_of_[slot] < 0) {
+      return slot;
+    }
+    if (step_of_[slot] == step_) {
+      continue;
+    }
+    if (frequency_[slot] > 0) {
+      frequency_[slot]--;
+      continue;
+    }
+    return slot;
+  }
+}
+
+template <typename index_t>
+void MmapEmbeddingCache::lookup_(
+    const index_t* indices,
+    index_t* slots,
+    int64_t size,
+    bool update) {
+  auto staged = wait_prefetch();
+  step_++;
+  num_used_ = 0;
+  at::parallel_for(0, size, 4096, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t row = indices[i];
+      TORCH_CHECK(
+          row >= 0 && row < num_rows_,
+          "MmapEmbeddingCache: index ",
+          row,
+          " out of range [0, ",
+          num_rows_,
+          ")");
+      auto it = slot_of_.find(row);
+      slots[i] = it == slot_of_.end() ? -1 : it->second;
+    }
+  });
+
+  // pin the hits first, a row hit later in the batch must not be evicted for
+  // an earlier miss
+  for (int64_t i = 0; i < size; i++) {
+    int64_t slot = slots[i];
+    if (slot < 0) {
+      continue;
+    }
+    stats_.hits++;
+    if (step_of_[slot] != step_) {
+      step_of_[slot] = step_;
+      num_used_++;
+      if (frequency_[slot] < kMaxFrequency) {
+        frequency_[slot]++;
+      }
+    }
+    dirty_[slot] |= update;
+  }
+
+  // {row, slot, evicted row, evicted row is dirty} of the misses
+  struct Load {
+    int64_t row;
+    int64_t slot;
+    int64_t evicted;
+    bool write_back;
+  };
+  std::vector<Load> loads;
+  robin_hood::unordered_map<int64_t, int64_t> loading;
+  // the rows already mapped to their slots are still loaded if the batch
+  // doesn't fit in the cache, to keep the cache consistent
+  std::exception_ptr error;
+  try {
+    for (int64_t i = 0; i < size; i++) {
+      if (slots[i] >= 0) {
+        continue;
+      }
+      int64_t row = indices[i];
+      int64_t slot;
+      auto it = loading.find(row);
+      if (it != loading.end()) {
+        slot = it->second;
+      } else {
+        slot = evict();
+        int64_t evicted = row_of_[slot];
+        if (evicted >= 0) {
+          slot_of_.erase(evicted);
+          stats_.evictions++;
+        }
+        loads.push_back({row, slot, evicted, evicted >= 0 && dirty_[slot]});
+        loading.emplace(row, slot);
+        slot_of_.emplace(row, slot);
+        row_of_[slot] = row;
+        frequency_[slot] = 0;
+        dirty_[slot] = 0;
+      }
+      slots[i] = slot;
+      if (step_of_[slot] != step_) {
+        step_of_[slot] = step_;
+        num_used_++;
+        if (frequency_[slot] < kMaxFrequency) {
+          frequency_[slot]++;
+        }
+      }
+      dirty_[slot] |= update;
+    }
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  at::parallel_for(0, loads.size(), 16, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      auto& load = loads[i];
+      auto it = staged.rows.find(load.row);
+      for (int64_t t = 0; t < num_tables_; t++) {
+        auto cached = cache_row(t, load.slot);
+        if (load.write_back) {
+          std::memcpy(
+              file_row(t, load.evicted), cached, emb_dim_ * sizeof(float));
+        }
+        auto src = it != staged.rows.end()
+            ? &staged.data[(it->second * num_tables_ + t) * emb_dim_]
+            : file_row(t, load.row);
+        std::memcpy(cached, src, emb_dim_ * sizeof(float));
+      }
+    }
+  });
+  for (auto& load : loads) {
+    stats_.write_backs += load.write_back;
+    stats_.prefetched += staged.rows.count(load.row);
+  }
+  stats_.misses += loads.size();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+at::Tensor MmapEmbeddingCache::lookup(const at::Tensor& indices, bool update) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  auto indices_ = indices.contiguous();
+  auto slots = at::empty_like(indices_);
+  AT_DISPATCH_INDEX_TYPES(
+      indices_.scalar_type(), "MmapEmbeddingCache::lookup", [&] {
+        lookup_<index_t>(
+            indices_.data_ptr<index_t>(),
+            slots.data_ptr<index_t>(),
+            indices_.numel(),
+            update);
+      });
+  return slots;
+}
+
+at::Tensor MmapEmbeddingCache::cached_rows(const at::Tensor& slots) const {
+  auto slots_ = slots.to(at::kLong).contiguous();
+  auto rows = at::empty_like(slots_);
+  auto slots_ptr = slots_.data_ptr<int64_t>();
+  auto rows_ptr = rows.data_ptr<int64_t>();
+  for (int64_t i = 0; i < slots_.numel(); i++) {
+    int64_t slot = slots_ptr[i];
+    TORCH_CHECK(
+        slot >= 0 && slot < cache_rows_,
+        "MmapEmbeddingCache: slot ",
+        slot,
+        " out of range");
+    rows_ptr[i] = row_of_[slot];
+  }
+  return rows;
+}
+
+at::Tensor MmapEmbeddingCache::weight() const {
+  return cache_[0];
+}
+
+at::Tensor MmapEmbeddingCache::state(int64_t i) const {
+  TORCH_CHECK(
+      i >= 0 && i + 1 < num_tables_,
+      "MmapEmbeddingCache: state ",
+      i,
+      " out of range");
+  return cache_[1 + i];
+}
+
+at::Tensor MmapEmbeddingCache::table(int64_t i) const {
+  TORCH_CHECK(
+      i >= 0 && i < num_tables_,
+      "MmapEmbeddingCache: table ",
+      i,
+      " out of range");
+  return at::from_blob(file_row(i, 0), {num_rows_, emb_dim_}, at::kFloat);
+}
+
+void MmapEmbeddingCache::flush() {
+  std::vector<int64_t> write_backs;
+  for (int64_t slot = 0; slot < cache_rows_; slot++) {
+    if (dirty_[slot]) {
+      write_backs.push_back(slot);
+      dirty_[slot] = 0;
+    }
+  }
+  at::parallel_for(0, write_backs.size(), 16, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      int64_t slot = write_backs[i];
+      for (int64_t t = 0; t < num_tables_; t++) {
+        std::memcpy(
+            file_row(t, row_of_[slot]),
+            cache_row(t, slot),
+            emb_dim_ * sizeof(float));
+      }
+    }
+  });
+  stats_.write_backs += write_backs.size();
+  msync(map_, map_bytes_, MS_SYNC);
+}
+
+void MmapEmbeddingCache::clear() {
+  wait_prefetch();
+  flush();
+  slot_of_.clear();
+  std::fill(row_of_.begin(), row_of_.end(), -1);
+  std::fill(frequency_.begin(), frequency_.end(), 0);
+  std::fill(step_of_.begin(), step_of_.end(), -1);
+  hand_ = 0;
+}
+
+EmbeddingCacheStats MmapEmbeddingCache::stats() const {
+  return stats_;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+#include "utils/robin_hood.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+struct EmbeddingCacheStats {
+  // indices served by the rows already cached
+  int64_t hits;
+  // rows loaded into the cache
+  int64_t misses;
+  // misses loaded from the rows staged by prefetch
+  int64_t prefetched;
+  int64_t evictions;
+  // dirty rows written to the file on eviction or flush
+  int64_t write_backs;
+};
+
+// Out-of-core storage of an fp32 embedding table, e.g. on a local NVMe, with a
+// DRAM cache of its hot rows.
+// - The file holds the table followed by num_states tables of the optimizer
+//   states (the AdaGrad hessian), and is memory mapped. It is created zero
+//   filled, an existing file of the same shape is reused.
+// - The cache keeps cache_rows rows of the table and the states in the weight()
+//   and state() tensors. A row is evicted by a CLOCK sweep over the
+//   frequencies of the cached rows, so the rows used by many recent batches
+//   stay in the cache.
+// - lookup() loads the rows of a batch into the cache and returns the cache
+//   slots of the indices, which replace the indices of the merged embedding
+//   bag kernels, so the forward and the fused SGD/AdaGrad updates run on the
+//   cache. With update, the rows are marked dirty and written back to the file
+//   when evicted. The slots are valid until the next lookup.
+// - prefetch() reads the rows of the next batch not in the cache into a
+//   staging buffer in the background, for the next lookup.
+class MmapEmbeddingCache {
+ public:
+  MmapEmbeddingCache(
+      const std::string& path,
+      int64_t num_rows,
+      int64_t emb_dim,
+      int64_t num_states,
+      int64_t cache_rows);
+  ~MmapEmbeddingCache();
+
+  at::Tensor lookup(const at::Tensor& indices, bool update);
+  void prefetch(const at::Tensor& indices);
+  // the rows cached in the slots, -1 for the free slots
+  at::Tensor cached_rows(const at::Tensor& slots) const;
+  // [cache_rows, emb_dim] rows of the table and of the states in the cache
+  at::Tensor weight() const;
+  at::Tensor state(int64_t i) const;
+  // [num_rows, emb_dim] view of the file, table(0) is the table and
+  // table(1 + i) state i. The dirty rows are only in the file after flush().
+  at::Tensor table(int64_t i) const;
+  // Writes the dirty rows back and syncs the file
+  void flush();
+  // Flushes and drops all the cached rows, e.g. after writing to table()
+  void clear();
+  EmbeddingCacheStats stats() const;
+
+ private:
+  // Rows of a prefetched batch, each one followed by its states
+  struct Staged {
+    robin_hood::unordered_map<int64_t, int64_t> rows;
+    std::vector<float> data;
+  };
+
+  template <typename index_t>
+  void lookup_(
+      const index_t* indices,
+      index_t* slots,
+      int64_t size,
+      bool update);
+  Staged stage(const at::Tensor& indices) const;
+  Staged wait_prefetch();
+  int64_t evict();
+  float* file_row(int64_t table, int64_t row) const;
+  float* cache_row(int64_t table, int64_t slot) const;
+
+  int64_t num_rows_;
+  int64_t emb_dim_;
+  // the table and its states
+  int64_t num_tables_;
+  int64_t cache_rows_;
+  int fd_ = -1;
+  float* map_ = nullptr;
+  size_t map_bytes_ = 0;
+
+  std::vector<at::Tensor> cache_;
+  robin_hood::unordered_map<int64_t, int64_t> slot_of_;
+  // -1 for the free slots
+  std::vector<int64_t> row_of_;
+  std::vector<uint8_t> frequency_;
+  std::vector<uint8_t> dirty_;
+  // the slots used by the current lookup can't be evicted
+  std::vector<int64_t> step_of_;
+  int64_t step_ = 0;
+  int64_t num_used_ = 0;
+  int64_t hand_ = 0;
+  std::future<Staged> prefetching_;
+  EmbeddingCacheStats stats_{0, 0, 0, 0, 0};
+};
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -8,6 +8,9 @@ namespace cpu {
 IPEX_DEFINE_DISPATCH(mixtral_moe_tpp_kernel_stub);
 IPEX_DEFINE_DISPATCH(mixtral_moe_woq_kernel_stub);
 IPEX_DEFINE_DISPATCH(mixtral_moe_kernel_stub);
+IPEX_DEFINE_DISPATCH(mixtral_moe_tpp_grouped_kernel_stub);
+IPEX_DEFINE_DISPATCH(mixtral_moe_woq_grouped_kernel_stub);
+IPEX_DEFINE_DISPATCH(mixtral_moe_grouped_kernel_stub);
 
 at::Tensor mixtral_moe_tpp(
     const at::Tensor& hidden_states,
@@ -98,6 +101,84 @@ at::Tensor mixtral_moe_woq(
       output,
       is_distributed);
 }
+
+// Grouped variants take the router top-k output of all the experts at once.
+// Tokens are bucketed by expert inside the kernel and, for tensor parallel,
+// the layer output is all-reduced once instead of once per expert.
+at::Tensor mixtral_moe_tpp_grouped(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool tpp_fallback,
+    bool is_distributed) {
+  RECORD_FUNCTION(
+      "ipex::mixtral_moe_tpp_grouped", c10::ArrayRef<c10::IValue>({}));
+
+  return mixtral_moe_tpp_grouped_kernel_stub(
+      kCPU,
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      gate_wei,
+      up_wei,
+      down_wei,
+      tpp_fallback,
+      is_distributed);
+}
+
+at::Tensor mixtral_moe_woq_grouped(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool is_distributed) {
+  RECORD_FUNCTION(
+      "ipex::mixtral_moe_woq_grouped", c10::ArrayRef<c10::IValue>({}));
+
+  return mixtral_moe_woq_grouped_kernel_stub(
+      kCPU,
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      gate_wei,
+      up_wei,
+      down_wei,
+      is_distributed);
+}
+
+at::Tensor mixtral_moe_grouped(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList gate_op_ctx,
+    at::TensorList up_wei,
+    at::TensorList up_op_ctx,
+    at::TensorList down_wei,
+    at::TensorList down_op_ctx,
+    bool use_dnnl,
+    bool is_distributed) {
+  RECORD_FUNCTION("ipex::mixtral_moe_grouped", c10::ArrayRef<c10::IValue>({}));
+
+  return mixtral_moe_grouped_kernel_stub(
+      kCPU,
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      gate_wei,
+      gate_op_ctx,
+      up_wei,
+      up_op_ctx,
+      down_wei,
+      down_op_ctx,
+      use_dnnl,
+      is_distributed);
+}
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -124,5 +205,30 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "mixtral_moe_woq",
       c10::DispatchKey::CPU,
       torch_ipex::cpu::mixtral_moe_woq);
+  m.def(
+      "mixtral_moe_tpp_grouped(Tensor hidden_states, Tensor selected_experts, \
+      Tensor routing_weights, Tensor[] gate_wei, Tensor[] up_wei, Tensor[] down_wei, \
+      bool tpp_fallback, bool is_distributed) -> Tensor");
+  m.impl(
+      "mixtral_moe_tpp_grouped",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::mixtral_moe_tpp_grouped);
+  m.def(
+      "mixtral_moe_woq_grouped(Tensor hidden_states, Tensor selected_experts, \
+      Tensor routing_weights, Tensor[] gate_wei, Tensor[] up_wei, Tensor[] down_wei, \
+      bool is_distributed) -> Tensor");
+  m.impl(
+      "mixtral_moe_woq_grouped",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::mixtral_moe_woq_grouped);
+  m.def(
+      "mixtral_moe_grouped(Tensor hidden_states, Tensor selected_experts, \
+      Tensor routing_weights, Tensor[] gate_wei, Tensor[] gate_op_ctx, Tensor[] up_wei, \
+      Tensor[] up_op_ctx, Tensor[] down_wei, Tensor[] down_op_ctx, bool use_dnnl, \
+      bool is_distributed) -> Tensor");
+  m.impl(
+      "mixtral_moe_grouped",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::mixtral_moe_grouped);
 }
 } // namespace
\ No newline at end of file
@@ -40,6 +40,35 @@ at::Tensor mixtral_moe(
     const at::Tensor&,
     at::Tensor&,
     bool);
+at::Tensor mixtral_moe_tpp_grouped(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    bool,
+    bool);
+at::Tensor mixtral_moe_woq_grouped(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    bool);
+at::Tensor mixtral_moe_grouped(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    bool,
+    bool);
 using mixtral_moe_tpp_kernel_fn = at::Tensor (*)(
     const at::Tensor& hidden_states,
     const at::Tensor& top_x,
@@ -75,8 +104,46 @@ using mixtral_moe_kernel_fn = at::Tensor (*)(
     const at::Tensor& routing_weights,
     at::Tensor& output,
     bool is_distributed);
+using mixtral_moe_tpp_grouped_kernel_fn = at::Tensor (*)(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool tpp_fallback,
+    bool is_distributed);
+using mixtral_moe_woq_grouped_kernel_fn = at::Tensor (*)(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool is_distributed);
+using mixtral_moe_grouped_kernel_fn = at::Tensor (*)(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList gate_op_ctx,
+    at::TensorList up_wei,
+    at::TensorList up_op_ctx,
+    at::TensorList down_wei,
+    at::TensorList down_op_ctx,
+    bool use_dnnl,
+    bool is_distributed);
 IPEX_DECLARE_DISPATCH(mixtral_moe_tpp_kernel_fn, mixtral_moe_tpp_kernel_stub);
 IPEX_DECLARE_DISPATCH(mixtral_moe_woq_kernel_fn, mixtral_moe_woq_kernel_stub);
 IPEX_DECLARE_DISPATCH(mixtral_moe_kernel_fn, mixtral_moe_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    mixtral_moe_tpp_grouped_kernel_fn,
+    mixtral_moe_tpp_grouped_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    mixtral_moe_woq_grouped_kernel_fn,
+    mixtral_moe_woq_grouped_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    mixtral_moe_grouped_kernel_fn,
+    mixtral_moe_grouped_kernel_stub);
 } // namespace cpu
 } // namespace torch_ipex
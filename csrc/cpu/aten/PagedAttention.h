@@ -19,7 +19,27 @@ void single_query_cached_kv_attention(
     at::Tensor& context_lens, // [num_seqs]
     int64_t block_size,
     int64_t max_context_len,
-    const c10::optional<at::Tensor>& alibi_slopes);
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size);
+
+void multi_query_cached_kv_attention(
+    at::Tensor& out, // [num_tokens, num_heads, head_size]
+    at::Tensor& query, // [num_tokens, num_heads, head_size]
+    at::Tensor& key_cache, // [num_blocks, num_kv_heads, block_size, head_size]
+    at::Tensor& value_cache, // [num_blocks, num_kv_heads, block_size,
+                             // head_size]
+    const double scale,
+    at::Tensor& block_tables, // [num_seqs, max_num_blocks_per_seq]
+    at::Tensor& context_lens, // [num_seqs]
+    at::Tensor& query_start_loc, // [num_seqs + 1]
+    int64_t block_size,
+    int64_t max_query_len,
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size);
 }
 
 void reshape_and_cache(
@@ -27,7 +47,19 @@ void reshape_and_cache(
     at::Tensor& value,
     at::Tensor& key_cache,
     at::Tensor& value_cache,
-    at::Tensor& slot_mapping);
+    at::Tensor& slot_mapping,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale);
+
+void copy_blocks(
+    at::TensorList key_caches,
+    at::TensorList value_caches,
+    const at::Tensor& block_mapping);
+
+void swap_blocks(
+    at::Tensor& src,
+    at::Tensor& dst,
+    const at::Tensor& block_mapping);
 
 using single_query_cached_kv_attention_fn = void (*)(
     at::Tensor& out, // [num_seqs, num_heads, head_size]
@@ -40,19 +72,56 @@ using single_query_cached_kv_attention_fn = void (*)(
     at::Tensor& context_lens, // [num_seqs]
     int64_t block_size,
     int64_t max_context_len,
-    const c10::optional<at::Tensor>& alibi_slopes);
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size);
+
+using multi_query_cached_kv_attention_fn = void (*)(
+    at::Tensor& out, // [num_tokens, num_heads, head_size]
+    at::Tensor& query, // [num_tokens, num_heads, head_size]
+    at::Tensor& key_cache, // [num_blocks, num_kv_heads, block_size, head_size]
+    at::Tensor& value_cache, // [num_blocks, num_kv_heads, block_size,
+                             // head_size]
+    const double scale,
+    at::Tensor& block_tables, // [num_seqs, max_num_blocks_per_seq]
+    at::Tensor& context_lens, // [num_seqs]
+    at::Tensor& query_start_loc, // [num_seqs + 1]
+    int64_t block_size,
+    int64_t max_query_len,
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size);
 
 using reshape_and_cache_fn = void (*)(
     at::Tensor& key,
     at::Tensor& value,
     at::Tensor& key_cache,
     at::Tensor& value_cache,
-    at::Tensor& slot_mapping);
+    at::Tensor& slot_mapping,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale);
+
+using copy_blocks_fn = void (*)(
+    at::TensorList key_caches,
+    at::TensorList value_caches,
+    const at::Tensor& block_mapping);
+
+using swap_blocks_fn = void (*)(
+    at::Tensor& src,
+    at::Tensor& dst,
+    const at::Tensor& block_mapping);
 
 IPEX_DECLARE_DISPATCH(
     single_query_cached_kv_attention_fn,
     single_query_cached_kv_attention_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    multi_query_cached_kv_attention_fn,
+    multi_query_cached_kv_attention_kernel_stub);
 IPEX_DECLARE_DISPATCH(reshape_and_cache_fn, reshape_and_cache_kernel_stub);
+IPEX_DECLARE_DISPATCH(copy_blocks_fn, copy_blocks_kernel_stub);
+IPEX_DECLARE_DISPATCH(swap_blocks_fn, swap_blocks_kernel_stub);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,96 @@
+#include "RowwiseQuantizedMergedEmb.h"
+#include <ATen/Tensor.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+IPEX_DEFINE_DISPATCH(rowwise_quantize_embedding_kernel_stub);
+IPEX_DEFINE_DISPATCH(rowwise_merged_embeddingbag_forward_kernel_stub);
+IPEX_DEFINE_DISPATCH(rowwise_merged_embeddingbag_cat_forward_kernel_stub);
+
+int64_t rowwise_quantized_row_bytes(at::ScalarType dtype, int64_t emb_dim) {
+  TORCH_CHECK(
+      dtype == at::kByte || dtype == at::kQUInt4x2 ||
+          dtype == at::kFloat8_e4m3fn,
+      "row-wise quantized embedding only supports uint8, quint4x2 and "
+      "float8_e4m3fn, got ",
+      dtype);
+  int64_t data_bytes = dtype == at::kQUInt4x2 ? (emb_dim + 1) / 2 : emb_dim;
+  return data_bytes + 2 * sizeof(float);
+}
+
+Tensor merged_embeddingbag_rowwise_quantize(
+    const Tensor& weight,
+    at::ScalarType dtype) {
+  /*
+  pointer to rowwise_quantize_embedding_kernel_impl(weight, dtype);
+  */
+  return rowwise_quantize_embedding_kernel_stub(kCPU, weight, dtype);
+}
+
+std::vector<Tensor> merged_embeddingbag_rowwise_forward(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const int64_t pooling_mode,
+    const bool include_last_offsets,
+    at::ScalarType dtype,
+    const int64_t emb_dim) {
+  /*
+  pointer to rowwise_merged_embeddingbag_forward_kernel_impl(
+      qweights, indices, offsets, pooling_mode, include_last_offsets, dtype,
+      emb_dim);
+  */
+  return rowwise_merged_embeddingbag_forward_kernel_stub(
+      kCPU,
+      qweights,
+      indices,
+      offsets,
+      pooling_mode,
+      include_last_offsets,
+      dtype,
+      emb_dim);
+}
+
+Tensor merged_embeddingbag_rowwise_cat_forward(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const Tensor& dense,
+    at::ScalarType dtype) {
+  /*
+  pointer to rowwise_merged_embeddingbag_cat_forward_kernel_impl(
+      qweights, indices, offsets, dense, dtype);
+  */
+  return rowwise_merged_embeddingbag_cat_forward_kernel_stub(
+      kCPU, qweights, indices, offsets, dense, dtype);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "merged_embeddingbag_rowwise_quantize(Tensor weight, ScalarType dtype) -> Tensor");
+  m.impl(
+      "merged_embeddingbag_rowwise_quantize",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_rowwise_quantize);
+  m.def(
+      "merged_embeddingbag_rowwise_forward(Tensor[] qweights, Tensor[] indices, Tensor[] offsets, int pooling_mode, bool include_last_offsets, ScalarType dtype, int emb_dim) -> Tensor[]");
+  m.impl(
+      "merged_embeddingbag_rowwise_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_rowwise_forward);
+  m.def(
+      "merged_embeddingbag_rowwise_cat_forward(Tensor[] qweights, Tensor[] indices, Tensor[] offsets, Tensor dense, ScalarType dtype) -> Tensor");
+  m.impl(
+      "merged_embeddingbag_rowwise_cat_forward",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::merged_embeddingbag_rowwise_cat_forward);
+}
+
+} // namespace
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+using namespace at;
+
+// Row-wise quantized embedding tables, for the inference of the merged
+// embedding bag. A table is a [num_rows, row_bytes] uint8 tensor, each row
+// holds its packed data followed by its fp32 scale and bias:
+//   |  data  | scale | bias |
+// with the value of element d is data[d] * scale + bias. The row-wise
+// quantized dtypes are
+// - kByte: asymmetric uint8, 1 byte per element.
+// - kQUInt4x2: asymmetric uint4, 2 elements per byte, element 2k in the low
+//   nibble of byte k and element 2k+1 in the high nibble.
+// - kFloat8_e4m3fn: fp8 e4m3 scaled by the absolute max of the row to 448,
+//   the bias is 0.
+
+int64_t rowwise_quantized_row_bytes(at::ScalarType dtype, int64_t emb_dim);
+
+namespace {
+
+Tensor rowwise_quantize_embedding_kernel_impl(
+    const Tensor& weight,
+    at::ScalarType dtype);
+
+std::vector<Tensor> rowwise_merged_embeddingbag_forward_kernel_impl(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const int64_t pooling_mode,
+    const bool include_last_offsets,
+    at::ScalarType dtype,
+    const int64_t emb_dim);
+
+Tensor rowwise_merged_embeddingbag_cat_forward_kernel_impl(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const Tensor& dense,
+    at::ScalarType dtype);
+
+} // namespace
+
+using rowwise_quantize_embedding_kernel_fn =
+    Tensor (*)(const Tensor&, at::ScalarType);
+
+IPEX_DECLARE_DISPATCH(
+    rowwise_quantize_embedding_kernel_fn,
+    rowwise_quantize_embedding_kernel_stub);
+
+using rowwise_merged_embeddingbag_forward_kernel_fn = std::vector<Tensor> (*)(
+    const TensorList&,
+    const TensorList&,
+    const TensorList&,
+    const int64_t,
+    const bool,
+    at::ScalarType,
+    const int64_t);
+
+IPEX_DECLARE_DISPATCH(
+    rowwise_merged_embeddingbag_forward_kernel_fn,
+    rowwise_merged_embeddingbag_forward_kernel_stub);
+
+using rowwise_merged_embeddingbag_cat_forward_kernel_fn = Tensor (*)(
+    const TensorList&,
+    const TensorList&,
+    const TensorList&,
+    const Tensor&,
+    at::ScalarType);
+
+IPEX_DECLARE_DISPATCH(
+    rowwise_merged_embeddingbag_cat_forward_kernel_fn,
+    rowwise_merged_embeddingbag_cat_forward_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,51 @@
+#include "Sampling.h"
+#include <torch/all.h>
+#include <torch/csrc/autograd/function.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+IPEX_DEFINE_DISPATCH(fused_sampling_kernel_stub);
+
+/*
+ *Pick the next token of every sequence from the logits of the last position.
+ *It fuses the repetition penalty, temperature, top-k, top-p and the sampling
+ *of the generation into one pass over the vocabulary. temperature <= 0 means
+ *greedy search.
+ */
+at::Tensor fused_sampling_forward_cpu(
+    const at::Tensor& logits,
+    const c10::optional<at::Tensor>& input_ids,
+    double repetition_penalty,
+    double temperature,
+    int64_t top_k,
+    double top_p,
+    c10::optional<int64_t> seed) {
+  RECORD_FUNCTION("ipex::fused_sampling", c10::ArrayRef<c10::IValue>({}));
+
+  return fused_sampling_kernel_stub(
+      kCPU,
+      logits,
+      input_ids,
+      repetition_penalty,
+      temperature,
+      top_k,
+      top_p,
+      seed);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "fused_sampling(Tensor logits, Tensor? input_ids=None, float repetition_penalty=1.0, \
+       float temperature=1.0, int top_k=0, float top_p=1.0, int? seed=None) -> Tensor");
+  m.impl(
+      "fused_sampling",
+      c10::DispatchKey::CPU,
+      torch_ipex::cpu::fused_sampling_forward_cpu);
+}
+} // namespace
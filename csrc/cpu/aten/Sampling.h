@@ -0,0 +1,33 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <dyndisp/DispatchStub.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+at::Tensor fused_sampling(
+    const at::Tensor& logits,
+    const c10::optional<at::Tensor>& input_ids,
+    double repetition_penalty,
+    double temperature,
+    int64_t top_k,
+    double top_p,
+    c10::optional<int64_t> seed);
+}
+
+using fused_sampling_kernel_fn = at::Tensor (*)(
+    const at::Tensor& logits, // [batch, vocab_size]
+    const c10::optional<at::Tensor>& input_ids, // [batch, seq_len]
+    double repetition_penalty,
+    double temperature,
+    int64_t top_k,
+    double top_p,
+    c10::optional<int64_t> seed);
+
+IPEX_DECLARE_DISPATCH(fused_sampling_kernel_fn, fused_sampling_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
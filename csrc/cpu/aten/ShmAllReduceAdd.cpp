@@ -16,7 +16,8 @@ at::Tensor shm_all_reduce_add_forward_cpu(
     at::Tensor& t_blockState,
     int64_t shm_block_size,
     int64_t rank,
-    int64_t world_size) {
+    int64_t world_size,
+    int64_t precision) {
   return shm_all_reduce_add_kernel_stub(
       kCPU,
       t_in,
@@ -25,7 +26,8 @@ at::Tensor shm_all_reduce_add_forward_cpu(
       t_blockState,
       shm_block_size,
       rank,
-      world_size);
+      world_size,
+      precision);
 }
 
 } // namespace cpu
@@ -7,6 +7,18 @@
 namespace torch_ipex {
 namespace cpu {
 
+// Format of the data staged in the shared memory buffer by the all-reduce,
+// set by IPEX_SHM_ALLREDUCE_PRECISION (fp32, native or int8)
+enum ShmReducePrecision : int64_t {
+  // always staged as fp32
+  SHM_REDUCE_FP32 = 0,
+  // bf16/fp16 staged in their own dtype and accumulated in fp32, which gives
+  // the same result as fp32 with half of the memory traffic
+  SHM_REDUCE_NATIVE = 1,
+  // floating point staged as int8 with a fp32 scale per block, lossy
+  SHM_REDUCE_INT8 = 2,
+};
+
 namespace {
 
 at::Tensor shm_all_reduce_add(
@@ -16,7 +28,8 @@ at::Tensor shm_all_reduce_add(
     at::Tensor& t_blockState,
     int64_t shm_block_size,
     int64_t rank,
-    int64_t world_size);
+    int64_t world_size,
+    int64_t precision);
 }
 
 using shm_all_reduce_add_kernel_fn = at::Tensor (*)(
@@ -26,7 +39,8 @@ using shm_all_reduce_add_kernel_fn = at::Tensor (*)(
     at::Tensor& t_blockState,
     int64_t shm_block_size,
     int64_t rank,
-    int64_t world_size);
+    int64_t world_size,
+    int64_t precision);
 
 IPEX_DECLARE_DISPATCH(
     shm_all_reduce_add_kernel_fn,
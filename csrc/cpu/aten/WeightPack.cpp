@@ -1,7 +1,15 @@
 #include <torch/all.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "WeightPack.h"
-#include "utils/rw_lock.h"
 #include "utils/utils.h"
 
 namespace torch_ipex {
@@ -11,29 +19,263 @@ namespace {
 
 using weakref_type =
     c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
-using val_blocked = std::tuple<weakref_type, ideep::tensor>;
-std::unordered_map<c10::TensorImpl*, val_blocked> cached_weights;
 
-using map_iter =
-    std::unordered_map<c10::TensorImpl*, val_blocked>::const_iterator;
+struct CachedWeight {
+  weakref_type weakref;
+  // the packed copy is stale once the weight is modified in place
+  int64_t version;
+  ideep::tensor packed;
+  int64_t bytes;
+  std::atomic<uint64_t> last_use;
+};
+
+// Inference tensors have no version counter, _version() throws for them
+inline int64_t weight_version(const at::Tensor& weight) {
+  return weight.is_inference() ? 0 : weight._version();
+}
 
-torch_ipex::ReadWriteMutex rwmutex;
+// Owns the entries, guarded by the mutex of the cache
+using cache_map =
+    std::unordered_map<c10::TensorImpl*, std::shared_ptr<CachedWeight>>;
+// What the threads look up, the entries are freed as soon as they leave the
+// cache_map
+using snapshot_map =
+    std::unordered_map<c10::TensorImpl*, std::weak_ptr<CachedWeight>>;
+
+// Cache of the packed weights of LSTM, looked up on every call.
+// - Every thread looks up its own snapshot of the map, without locking. The
+//   rare inserts update the map under a mutex, publish a new snapshot and bump
+//   the generation, and a thread takes the new snapshot on its next lookup.
+// - Only the map owns the packed weights, the snapshots hold weak references.
+//   The evicted or cleared weights are thus freed right away, the snapshot of
+//   an idle thread doesn't keep them alive.
+// - The entries of the freed weights are purged on insert.
+// - Once the packed weights exceed the capacity (IPEX_WEIGHT_PACK_CACHE_BYTES,
+//   0 means unlimited), the least recently used ones are evicted. The recency
+//   is tracked at the granularity of the inserts: a lookup only writes the
+//   entry when it is the first one since the last insert.
+// There is a single cache per process, see packed_weight_cache(), the
+// snapshot and the counters of a thread are thread locals.
+class PackedWeightCache {
+ public:
+  PackedWeightCache() : snapshot_(std::make_shared<const snapshot_map>()) {
+    auto env = getenv("IPEX_WEIGHT_PACK_CACHE_BYTES");
+    capacity_ = env ? atoll(env) : 0;
+  }
 
-ideep::tensor read_cached_weights(const at::Tensor& weight) {
-  torch_ipex::UniqueReadLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  ideep::tensor cached_weight;
-  auto it = cached_weights.find(weight.unsafeGetTensorImpl());
-  if (it != cached_weights.end()) {
-    cached_weight = std::get<1>(it->second);
+  ideep::tensor lookup(const at::Tensor& weight) {
+    auto& local = local_state();
+    if (local.generation != generation_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      local.snapshot = snapshot_;
+      local.generation = generation_.load(std::memory_order_relaxed);
+    }
+    auto it = local.snapshot->find(weight.unsafeGetTensorImpl());
+    std::shared_ptr<CachedWeight> entry;
+    if (it != local.snapshot->end()) {
+      entry = it->second.lock();
+    }
+    // The address of a freed weight may be reused by another tensor
+    if (entry == nullptr || entry->weakref.expired() ||
+        entry->version != weight_version(weight)) {
+      local.stats.add_miss();
+      return ideep::tensor();
+    }
+    auto now = clock_.load(std::memory_order_relaxed);
+    if (entry->last_use.load(std::memory_order_relaxed) != now) {
+      entry->last_use.store(now, std::memory_order_relaxed);
+    }
+    local.stats.add_hit();
+    return entry->packed;
+  }
+
+  void insert(const at::Tensor& weight, const ideep::tensor& packed) {
+    auto entry = std::make_shared<CachedWeight>();
+    entry->weakref = weakref_type(weight.getIntrusivePtr());
+    entry->version = weight_version(weight);
+    entry->packed = packed;
+    entry->bytes = packed.get_desc().get_size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry->last_use = clock_.fetch_add(1, std::memory_order_relaxed) + 1;
+    for (auto it = map_.begin(); it != map_.end();) {
+      if (it->second->weakref.expired()) {
+        it = map_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    map_[weight.unsafeGetTensorImpl()] = entry;
+    evict(weight.unsafeGetTensorImpl());
+    publish();
+  }
+
+  void set_capacity(int64_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    evict(nullptr);
+    publish();
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    map_.clear();
+    bytes_ = 0;
+    publish();
+  }
+
+  WeightPackCacheStats stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    WeightPackCacheStats stats;
+    stats.entries = map_.size();
+    stats.bytes = bytes_;
+    stats.capacity = capacity_;
+    std::tie(stats.hits, stats.misses) = sum_thread_stats();
+    stats.hits -= hits_base_;
+    stats.misses -= misses_base_;
+    stats.evictions = evictions_;
+    return stats;
+  }
+
+  void reset_stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::tie(hits_base_, misses_base_) = sum_thread_stats();
+    evictions_ = 0;
+  }
+
+ private:
+  // Written by its thread only, read by stats()
+  struct alignas(64) ThreadStats {
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+
+    void add_hit() {
+      hits.store(
+          hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void add_miss() {
+      misses.store(
+          misses.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+    }
+  };
+
+  struct LocalState {
+    std::shared_ptr<const snapshot_map> snapshot;
+    // the generations start from 1
+    uint64_t generation = 0;
+    ThreadStats stats;
+    // set once the stats are registered
+    PackedWeightCache* cache = nullptr;
+
+    ~LocalState() {
+      if (cache != nullptr) {
+        cache->unregister(&stats);
+      }
+    }
+  };
+
+  LocalState& local_state() {
+    thread_local LocalState local;
+    if (local.cache == nullptr) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      thread_stats_.push_back(&local.stats);
+      local.cache = this;
+    }
+    return local;
+  }
+
+  // Keeps the counts of an exiting thread in the totals
+  void unregister(ThreadStats* stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exited_hits_ += stats->hits.load(std::memory_order_relaxed);
+    exited_misses_ += stats->misses.load(std::memory_order_relaxed);
+    auto it = std::find(thread_stats_.begin(), thread_stats_.end(), stats);
+    if (it != thread_stats_.end()) {
+      *it = thread_stats_.back();
+      thread_stats_.pop_back();
+    }
+  }
+
+  // Called with mutex_
+  std::pair<int64_t, int64_t> sum_thread_stats() {
+    int64_t hits = exited_hits_, misses = exited_misses_;
+    for (auto stats : thread_stats_) {
+      hits += stats->hits.load(std::memory_order_relaxed);
+      misses += stats->misses.load(std::memory_order_relaxed);
+    }
+    return {hits, misses};
   }
-  return cached_weight;
+
+  // Evicts the least recently used entries except keep, called with mutex_
+  void evict(c10::TensorImpl* keep) {
+    int64_t bytes = 0;
+    for (auto& kv : map_) {
+      bytes += kv.second->bytes;
+    }
+    while (capacity_ > 0 && bytes > capacity_) {
+      auto victim = map_.end();
+      for (auto it = map_.begin(); it != map_.end(); ++it) {
+        if (it->first != keep &&
+            (victim == map_.end() ||
+             it->second->last_use < victim->second->last_use)) {
+          victim = it;
+        }
+      }
+      if (victim == map_.end()) {
+        break;
+      }
+      bytes -= victim->second->bytes;
+      map_.erase(victim);
+      evictions_++;
+    }
+    bytes_ = bytes;
+  }
+
+  // Called with mutex_
+  void publish() {
+    auto snapshot = std::make_shared<snapshot_map>();
+    snapshot->reserve(map_.size());
+    for (auto& kv : map_) {
+      snapshot->emplace(kv.first, kv.second);
+    }
+    snapshot_ = std::move(snapshot);
+    generation_.fetch_add(1, std::memory_order_release);
+  }
+
+  // guarded by mutex_
+  cache_map map_;
+  // the snapshot of the last update, guarded by mutex_
+  std::shared_ptr<const snapshot_map> snapshot_;
+  std::atomic<uint64_t> generation_{1};
+  std::mutex mutex_;
+  // the counters of the live threads
+  std::vector<ThreadStats*> thread_stats_;
+  int64_t bytes_{0};
+  int64_t capacity_{0};
+  // bumped by the inserts only
+  std::atomic<uint64_t> clock_{0};
+  // the counts of the exited threads
+  int64_t exited_hits_{0};
+  int64_t exited_misses_{0};
+  int64_t hits_base_{0};
+  int64_t misses_base_{0};
+  int64_t evictions_{0};
+};
+
+PackedWeightCache& packed_weight_cache() {
+  // never destroyed, the weights may be freed until the process exits
+  static PackedWeightCache* cache = new PackedWeightCache();
+  return *cache;
+}
+
+ideep::tensor read_cached_weights(const at::Tensor& weight) {
+  return packed_weight_cache().lookup(weight);
 }
 
 void write_cached_weights(const at::Tensor& weight, ideep::tensor& result) {
-  torch_ipex::UniqueWriteLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  cached_weights.emplace(
-      weight.unsafeGetTensorImpl(),
-      val_blocked{weakref_type(weight.getIntrusivePtr()), result});
+  packed_weight_cache().insert(weight, result);
 }
 
 } // namespace
@@ -43,6 +285,22 @@ bool is_packed(const at::Tensor& weight) {
   return !cached_weight.is_empty();
 }
 
+WeightPackCacheStats weight_pack_cache_stats() {
+  return packed_weight_cache().stats();
+}
+
+void weight_pack_cache_reset_stats() {
+  packed_weight_cache().reset_stats();
+}
+
+void weight_pack_cache_set_capacity(int64_t capacity) {
+  packed_weight_cache().set_capacity(capacity);
+}
+
+void weight_pack_cache_clear() {
+  packed_weight_cache().clear();
+}
+
 #define LSTM_PACKED_WEIGHT(TYPE)                     \
   lstm_packed_weight<LstmInferenceWeightDesc<TYPE>>( \
       weight_ih,                                     \
@@ -164,15 +422,8 @@ std::tuple<ideep::tensor, ideep::tensor> lstm_packed_weight(
     const QuantizedLstmParams& quantizedLstmParams) {
   auto cached_weight_ih = read_cached_weights(weight_ih);
   auto cached_weight_hh = read_cached_weights(weight_hh);
-  bool all_in_cache =
-      !cached_weight_ih.is_empty() && !cached_weight_hh.is_empty();
-  bool all_miss = cached_weight_ih.is_empty() && cached_weight_hh.is_empty();
-  TORCH_CHECK(
-      all_in_cache || all_miss,
-      "both of the weights of LSTM should be "
-      "cached or neither should be cached");
-
-  if (!cached_weight_ih.is_empty()) {
+  // One of the weights may have been evicted, both are packed again then
+  if (!cached_weight_ih.is_empty() && !cached_weight_hh.is_empty()) {
     return std::make_tuple(cached_weight_ih, cached_weight_hh);
   }
 
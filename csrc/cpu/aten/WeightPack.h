@@ -203,6 +203,22 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
 
 bool is_packed(const at::Tensor& weight);
 
+struct WeightPackCacheStats {
+  int64_t entries;
+  int64_t bytes;
+  // 0 means unlimited
+  int64_t capacity;
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+};
+
+// Statistics and control of the cache of the packed LSTM weights
+WeightPackCacheStats weight_pack_cache_stats();
+void weight_pack_cache_reset_stats();
+void weight_pack_cache_set_capacity(int64_t capacity);
+void weight_pack_cache_clear();
+
 // Get the conv_transpose's expected ideep weight tensor desc.
 ideep::tensor::desc get_conv_transpose_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
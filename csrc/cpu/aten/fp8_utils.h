@@ -1,6 +1,7 @@
 #include <ATen/Tensor.h>
 #include <c10/util/Float8_e4m3fn.h>
 #include <c10/util/Float8_e5m2.h>
+#include <array>
 
 namespace torch_ipex {
 namespace cpu {
@@ -54,6 +55,19 @@ struct is_fp8<fp8e4m3> : std::true_type {};
 template <>
 struct is_fp8<fp8e5m2> : std::true_type {};
 
+// The 256 values of fp8 e4m3, the vectorized kernels convert fp8 e4m3 by a
+// gather from this table, which stays in L1
+inline const float* fp8e4m3_to_float_lut() {
+  static const std::array<float, 256> lut = [] {
+    std::array<float, 256> values;
+    for (int i = 0; i < 256; i++) {
+      values[i] = static_cast<float>(fp8e4m3((uint8_t)i, fp8e4m3::from_bits()));
+    }
+    return values;
+  }();
+  return lut.data();
+}
+
 #define FP8_CHECK(stat, msg) stat ? Status::OK() : errors::InvalidArgument(msg)
 
 #define IPEX_TYPE_SWITCH_FP8ONLY(dtype, type, ...) \
@@ -2,6 +2,7 @@
 #include <ATen/ATen.h>
 #include <ATen/Tensor.h>
 #include <aten/CollectiveCommunicationPrimitive.h>
+#include <comm/comm_thread.h>
 #include <comm/messager.h>
 #include <torch/csrc/autograd/function.h>
 
@@ -10,7 +11,20 @@ namespace cpu {
 
 namespace {
 at::Tensor all_reduce_add_kernel_impl(at::Tensor& t_in) {
-  Messenger::getInstance().reduceAdd(t_in);
+  auto& messenger = Messenger::getInstance();
+  CommThread::getInstance().run([&]() { messenger.reduceAdd(t_in); });
+  return t_in;
+}
+
+int64_t all_reduce_add_async_kernel_impl(at::Tensor& t_in) {
+  // Set up the communicator on the calling thread
+  auto& messenger = Messenger::getInstance();
+  return CommThread::getInstance().submit(
+      [&messenger, t_in]() mutable { messenger.reduceAdd(t_in); });
+}
+
+at::Tensor all_reduce_wait_kernel_impl(at::Tensor& t_in, int64_t handle) {
+  CommThread::getInstance().wait(handle);
   return t_in;
 }
 
@@ -26,13 +40,25 @@ at::Tensor allgather_kernel_impl(
     output_tensors.push_back(at::empty(t_out_shape, t_in.options()));
   }
 
-  return Messenger::getInstance().allgather(t_in, output_tensors);
+  auto& messenger = Messenger::getInstance();
+  at::Tensor output;
+  CommThread::getInstance().run(
+      [&]() { output = messenger.allgather(t_in, output_tensors); });
+  return output;
 }
 
 } // anonymous namespace
 
 IPEX_REGISTER_DISPATCH(all_reduce_add_kernel_stub, &all_reduce_add_kernel_impl);
 
+IPEX_REGISTER_DISPATCH(
+    all_reduce_add_async_kernel_stub,
+    &all_reduce_add_async_kernel_impl);
+
+IPEX_REGISTER_DISPATCH(
+    all_reduce_wait_kernel_stub,
+    &all_reduce_wait_kernel_impl);
+
 IPEX_REGISTER_DISPATCH(allgather_kernel_stub, &allgather_kernel_impl);
 
 } // namespace cpu
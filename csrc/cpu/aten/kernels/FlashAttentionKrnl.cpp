@@ -14,6 +14,7 @@
 #include "../cpu/utils/isa_utils.h"
 #include "csrc/cpu/tpp/woq/tla.h"
 #include "mkl.h"
+#include "utils/ScratchAllocator.h"
 #include "vec/vec.h"
 
 inline void _mkl_gemm(
@@ -491,6 +492,8 @@ inline void reshape_attn_mask_to_4d(
  *@param is_causal: assume causal attention masking if true
  *@param attention_mask: attention mask
  *@param scale: scaling factor applied prior to softmax
+ *@param window_size: sliding window size, query i only attends keys in
+ *                    (i - window_size, i]; disabled if <= 0
  */
 template <
     typename scalar_t,
@@ -507,7 +510,8 @@ cpu_flash_attention(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale) {
+    c10::optional<double> scale,
+    int64_t window_size) {
   // Query (Batch x Num_heads  x Q_seq_len  x Dim_per_head)
   //    -> (Batch x Q_seq_len  x Num_heads  x Dim_per_head)
   // Key   (Batch x Num_heads  x KV_seq_len x Dim_per_head)
@@ -589,7 +593,7 @@ cpu_flash_attention(
       /* qk_sum */ qSplitSize +
       /* dst    */ qSplitSize * headSize;
 
-  at::Tensor buf = at::empty(
+  at::Tensor buf = utils::empty_scratch(
       {num_thread, size_per_thread}, query.options().dtype(accumulate_dtype));
   // Data ptrs
   scalar_t* q_data = query.data_ptr<scalar_t>();
@@ -627,7 +631,13 @@ cpu_flash_attention(
               qk_sum_data, static_cast<accum_t>(0), qBlockSize);
           int64_t num_keys =
               is_causal ? std::min(m + qBlockSize, kvSize) : kvSize;
-          for (int64_t n = 0; n < num_keys; n += kvSplitSize) {
+          // Skip the kv blocks that are before the sliding window of the
+          // first row in this query block
+          int64_t kv_start = window_size > 0
+              ? std::max<int64_t>(0, m - window_size + 1) / kvSplitSize *
+                  kvSplitSize
+              : 0;
+          for (int64_t n = kv_start; n < num_keys; n += kvSplitSize) {
             int64_t kvBlockSize = std::min(kvSplitSize, kvSize - n);
             // Calculate scale * q @ k.T
             _mkl_gemm(
@@ -656,6 +666,19 @@ cpu_flash_attention(
                     kvBlockSize - last_col - 1);
               }
             }
+            // Apply sliding window mask, fill keys before the window with -inf
+            if (window_size > 0 && n + window_size < m + qBlockSize) {
+              for (const auto row : c10::irange(qBlockSize)) {
+                int64_t first_col =
+                    std::min(m + row - window_size + 1 - n, kvBlockSize);
+                if (first_col > 0) {
+                  torch_ipex::cpu::kernel::fill_stub(
+                      qk_data + row * kvBlockSize,
+                      -std::numeric_limits<accum_t>::infinity(),
+                      first_col);
+                }
+              }
+            }
             // Update attention weights with attention mask
             // And apply scaling factor
             if (attention_mask.has_value()) {
@@ -701,20 +724,26 @@ cpu_flash_attention(
               }
               tmp_max = qk_max_data[row] > tmp_max ? qk_max_data[row] : tmp_max;
               // qk <- exp(qk - max) and sum per row
-              tmp_sum = tmp_max;
+              // A row with no visible key so far (sliding window) keeps
+              // max = -inf, use 0 as the base so that it gets zeros, not NaN
+              accum_t max_base =
+                  tmp_max == -std::numeric_limits<accum_t>::infinity()
+                  ? static_cast<accum_t>(0)
+                  : tmp_max;
+              tmp_sum = max_base;
               _exp_reduce_sum_fusion_kernel(
                   qk_data + row * kvBlockSize,
                   kvBlockSize,
                   qk_data + row * kvBlockSize,
                   tmp_sum);
               // exp_tmp <- exp(max[row] - max)
-              exp_tmp = std::exp(qk_max_data[row] - tmp_max);
+              exp_tmp = std::exp(qk_max_data[row] - max_base);
               // sum[row] <- sum + exp_tmp * sum[row]
               qk_sum_data[row] = tmp_sum + exp_tmp * qk_sum_data[row];
               // max[row] <- max
               qk_max_data[row] = tmp_max;
               // dst <- dst * exp_tmp
-              if (n > 0) {
+              if (n > kv_start) {
                 at::vec::map<accum_t>(
                     [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
                     dst_data + row * headSize,
@@ -735,7 +764,8 @@ cpu_flash_attention(
                 vStrideN,
                 qk_data,
                 kvBlockSize,
-                n == 0 ? static_cast<accum_t>(0) : static_cast<accum_t>(1),
+                n == kv_start ? static_cast<accum_t>(0)
+                              : static_cast<accum_t>(1),
                 dst_data,
                 headSize);
           }
@@ -779,7 +809,8 @@ cpu_flash_attention(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale) {
+    c10::optional<double> scale,
+    int64_t window_size) {
   // Query (Batch x Num_heads  x Q_seq_len  x Dim_per_head)
   //    -> (Batch x Q_seq_len  x Num_heads  x Dim_per_head)
   // Key   (Batch x Num_heads  x KV_seq_len x Dim_per_head)
@@ -864,9 +895,9 @@ cpu_flash_attention(
       /* qk_sum */ qSplitSize +
       /* dst    */ qSplitSize * headSize;
 
-  at::Tensor buf = at::empty(
+  at::Tensor buf = utils::empty_scratch(
       {num_thread, size_per_thread}, query.options().dtype(accumulate_dtype));
-  at::Tensor buf_reduced = at::empty(
+  at::Tensor buf_reduced = utils::empty_scratch(
       {num_thread,
        qSplitSize,
        kvSplitSize % 2 == 0 ? kvSplitSize : kvSplitSize + 1},
@@ -1234,6 +1265,12 @@ cpu_flash_attention(
               qk_sum_data, static_cast<accum_t>(0), qBlockSize);
           int64_t num_keys =
               is_causal ? std::min(m + qBlockSize, kvSize) : kvSize;
+          // Skip the kv blocks that are before the sliding window of the
+          // first row in this query block
+          int64_t kv_start = window_size > 0
+              ? std::max<int64_t>(0, m - window_size + 1) / kvSplitSize *
+                  kvSplitSize
+              : 0;
           if (is_fp16 && !headSize_even) {
             // pad query if headSize is not even for fp16
             // [qBlockSize, headSize] -> [qBlockSize, headSize + 1]
@@ -1244,7 +1281,7 @@ cpu_flash_attention(
                 headSize + 1,
                 qStrideM);
           }
-          for (int64_t n = 0; n < num_keys; n += kvSplitSize) {
+          for (int64_t n = kv_start; n < num_keys; n += kvSplitSize) {
             int64_t kvBlockSize = std::min(kvSplitSize, kvSize - n);
             // Calculate scale * q @ k.T
             if ((!is_fp16 && headSize_even) || is_fp16) {
@@ -1322,6 +1359,19 @@ cpu_flash_attention(
                     kvBlockSize - last_col - 1);
               }
             }
+            // Apply sliding window mask, fill keys before the window with -inf
+            if (window_size > 0 && n + window_size < m + qBlockSize) {
+              for (const auto row : c10::irange(qBlockSize)) {
+                int64_t first_col =
+                    std::min(m + row - window_size + 1 - n, kvBlockSize);
+                if (first_col > 0) {
+                  torch_ipex::cpu::kernel::fill_stub(
+                      qk_data + row * kvBlockSize,
+                      -std::numeric_limits<accum_t>::infinity(),
+                      first_col);
+                }
+              }
+            }
             // Update attention weights with attention mask
             // And apply scaling factor
             if (attention_mask.has_value()) {
@@ -1367,7 +1417,13 @@ cpu_flash_attention(
               }
               tmp_max = qk_max_data[row] > tmp_max ? qk_max_data[row] : tmp_max;
               // qk <- exp(qk - max) and sum per row
-              tmp_sum = tmp_max;
+              // A row with no visible key so far (sliding window) keeps
+              // max = -inf, use 0 as the base so that it gets zeros, not NaN
+              accum_t max_base =
+                  tmp_max == -std::numeric_limits<accum_t>::infinity()
+                  ? static_cast<accum_t>(0)
+                  : tmp_max;
+              tmp_sum = max_base;
               _exp_reduce_sum_fusion_kernel(
                   qk_data + row * kvBlockSize,
                   kvBlockSize,
@@ -1377,13 +1433,13 @@ cpu_flash_attention(
                                                   : kvBlockSize),
                   tmp_sum);
               // exp_tmp <- exp(max[row] - max)
-              exp_tmp = std::exp(qk_max_data[row] - tmp_max);
+              exp_tmp = std::exp(qk_max_data[row] - max_base);
               // sum[row] <- sum + exp_tmp * sum[row]
               qk_sum_data[row] = tmp_sum + exp_tmp * qk_sum_data[row];
               // max[row] <- max
               qk_max_data[row] = tmp_max;
               // dst <- dst * exp_tmp
-              if (n > 0) {
+              if (n > kv_start) {
                 at::vec::map<accum_t>(
                     [exp_tmp](Vec x) { return x * Vec(exp_tmp); },
                     dst_data + row * headSize,
@@ -1404,7 +1460,7 @@ cpu_flash_attention(
               int64_t psize = n / kvSplitSize * av_gemm_K;
               if (n + kvSplitSize < kvSize) {
                 // main
-                if (n == 0) {
+                if (n == kv_start) {
                   av_gemm(
                       qk_reduced_data,
                       vnni_pack
@@ -1430,7 +1486,7 @@ cpu_flash_attention(
                 }
               } else if (n + kvSplitSize >= kvSize) {
                 // tail
-                if (n == 0) {
+                if (n == kv_start) {
                   av_gemm_tail(
                       qk_reduced_data,
                       vnni_pack
@@ -1468,7 +1524,8 @@ cpu_flash_attention(
                   vStrideN,
                   qk_reduced_data,
                   kvBlockSize % 2 == 0 ? kvBlockSize : kvBlockSize + 1,
-                  n == 0 ? static_cast<accum_t>(0) : static_cast<accum_t>(1),
+                  n == kv_start ? static_cast<accum_t>(0)
+                                : static_cast<accum_t>(1),
                   dst_data,
                   headSize);
             }
@@ -1521,7 +1578,8 @@ void flash_attention_kernel_impl(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale) {
+    c10::optional<double> scale,
+    int64_t window_size) {
   auto q_seq_len = query.size(2);
 
   AT_DISPATCH_FLOATING_TYPES_AND2(
@@ -1537,7 +1595,8 @@ void flash_attention_kernel_impl(
                 dropout_p,
                 is_causal,
                 attention_mask,
-                scale);
+                scale,
+                window_size);
           } else if (q_seq_len >= 192) {
             cpu_flash_attention<scalar_t, scalar_t, 64, 512>(
                 output,
@@ -1548,7 +1607,8 @@ void flash_attention_kernel_impl(
                 dropout_p,
                 is_causal,
                 attention_mask,
-                scale);
+                scale,
+                window_size);
           } else {
             cpu_flash_attention<scalar_t, scalar_t, 32, 512>(
                 output,
@@ -1559,7 +1619,8 @@ void flash_attention_kernel_impl(
                 dropout_p,
                 is_causal,
                 attention_mask,
-                scale);
+                scale,
+                window_size);
           }
         } else {
           AT_DISPATCH_MASK_TYPES(
@@ -1576,7 +1637,8 @@ void flash_attention_kernel_impl(
                       dropout_p,
                       is_causal,
                       attention_mask,
-                      scale);
+                      scale,
+                      window_size);
                 } else if (q_seq_len >= 192) {
                   cpu_flash_attention<scalar_t, mask_t, 64, 512>(
                       output,
@@ -1587,7 +1649,8 @@ void flash_attention_kernel_impl(
                       dropout_p,
                       is_causal,
                       attention_mask,
-                      scale);
+                      scale,
+                      window_size);
                 } else {
                   cpu_flash_attention<scalar_t, mask_t, 32, 512>(
                       output,
@@ -1598,7 +1661,8 @@ void flash_attention_kernel_impl(
                       dropout_p,
                       is_causal,
                       attention_mask,
-                      scale);
+                      scale,
+                      window_size);
                 }
               });
         }
@@ -1612,7 +1676,8 @@ std::tuple<at::Tensor, at::Tensor> flash_attention_kernel(
     double dropout_p,
     bool is_causal,
     c10::optional<at::Tensor> attention_mask,
-    c10::optional<double> scale) {
+    c10::optional<double> scale,
+    int64_t window_size) {
   RECORD_FUNCTION(
       "torch_ipex::flash_attention_kernel", c10::ArrayRef<c10::IValue>({}));
 
@@ -1669,7 +1734,8 @@ std::tuple<at::Tensor, at::Tensor> flash_attention_kernel(
       dropout_p,
       is_causal,
       attn_mask,
-      scale);
+      scale,
+      window_size);
 
   output = output.transpose(1, 2);
   logsumexp = logsumexp.transpose(1, 2);
@@ -1299,6 +1299,236 @@ zero_copy_kv_cache_masked_multihead_self_attention_kernel_impl(
       attention_mask);
 }
 
+/*
+ *The scale-dot product for verifying cur_len draft tokens of speculative
+ *decoding against the indirect access kv cache. The key/value of the draft
+ *tokens are appended to the cache at [offset, offset + cur_len), so rejected
+ *tokens are rolled back by passing a smaller offset to the next step and the
+ *accepted ones are overwritten in place.
+ *@param  query Query embeeding with the of [batch, cur_len, head_num,
+ *head_size]
+ *@param  key Key embeeding with the of [batch, cur_len, kv_head, head_size]
+ *@param  value Value embeeding with the of [batch, cur_len, kv_head,
+ *head_size]
+ *@param  key_cache Cache past key embeeding with the of [max_len, batch,
+ *kv_head, head_size]
+ *@param  value_chache Cache past value embeeding with the of [max_len, batch,
+ *kv_head, head_size]
+ *@param  offset  The length of decoded(past) token.
+ *@param  scale_factor the sqrt(head_dim).
+ *@param  attention_mask The padding mask of [batch, 1 or head_num, 1 or
+ *cur_len, offset + cur_len].
+ *@param  tree_mask The ancestry of the draft tokens of [(batch,) cur_len,
+ *cur_len], the draft token i attends to the draft token j only if
+ *tree_mask[i][j] is nonzero. The draft tokens are causal if it is not given.
+ *@return attn_outs, None, key_cache, value_cache, beam_idx
+ */
+template <typename QT, typename VT>
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+multi_token_scale_dot_product_for_indirect_access_kv_cache(
+    at::Tensor query,
+    at::Tensor key,
+    at::Tensor value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& beam_idx,
+    const int64_t offset,
+    const double scale_factor,
+    at::Tensor& attention_mask,
+    const c10::optional<at::Tensor>& tree_mask) {
+  RECORD_FUNCTION(
+      "ipex::multi_token_scale_dot_product_for_indirect_access_kv_cache",
+      c10::ArrayRef<c10::IValue>({}));
+  auto bs = query.size(0);
+  auto cur_len = query.size(1);
+  auto head_num = query.size(2);
+  auto kv_head = key.size(2);
+  auto group_size = head_num / kv_head;
+  auto head_size = query.size(3);
+  auto seq_len = offset + cur_len;
+  auto kc_token_stride = bs * kv_head * head_size;
+  auto q_ptr = query.data_ptr<QT>();
+  auto k_ptr = key.data_ptr<QT>();
+  auto v_ptr = value.data_ptr<VT>();
+  auto k_cache_ptr = key_cache.data_ptr<QT>();
+  auto v_cache_ptr = value_cache.data_ptr<VT>();
+  auto mask_ptr = attention_mask.data_ptr<QT>();
+  auto mask_head_num = attention_mask.size(1);
+  auto mask_dim2 = attention_mask.size(2);
+  auto mask_bs_stride = mask_head_num * mask_dim2 * seq_len;
+  TORCH_CHECK(
+      attention_mask.size(3) == seq_len,
+      "attention mask should cover the past and the draft tokens");
+  at::Tensor tree_mask_v;
+  int64_t tree_bs_stride = 0;
+  if (tree_mask.has_value()) {
+    tree_mask_v = tree_mask.value().to(at::kBool).contiguous();
+    TORCH_CHECK(
+        tree_mask_v.size(-1) == cur_len && tree_mask_v.size(-2) == cur_len &&
+            (tree_mask_v.dim() == 2 ||
+             (tree_mask_v.dim() == 3 && tree_mask_v.size(0) == bs)),
+        "tree_mask should be [cur_len, cur_len] or [batch, cur_len, cur_len]");
+    tree_bs_stride = tree_mask_v.dim() == 3 ? cur_len * cur_len : 0;
+  }
+  auto tree_ptr =
+      tree_mask.has_value() ? tree_mask_v.data_ptr<bool>() : nullptr;
+  auto attn_outs =
+      at::empty({bs, head_num, cur_len, head_size}, value.options());
+  auto attn_out_ptr = attn_outs.data_ptr<VT>();
+
+  {
+    RECORD_FUNCTION(
+        "ipex::iakv_sdp::append_draft_kv", c10::ArrayRef<c10::IValue>({}));
+#pragma omp parallel for collapse(2)
+    for (auto ti = 0; ti < cur_len; ti++) {
+      for (auto bi = 0; bi < bs; bi++) {
+        auto cache_start = (offset + ti) * kc_token_stride +
+            bi * kv_head * head_size;
+        auto state_start = (bi * cur_len + ti) * kv_head * head_size;
+        torch_ipex::cpu::kernel::move_ker<QT, QT>(
+            k_cache_ptr + cache_start,
+            k_ptr + state_start,
+            kv_head * head_size);
+        torch_ipex::cpu::kernel::move_ker<VT, VT>(
+            v_cache_ptr + cache_start,
+            v_ptr + state_start,
+            kv_head * head_size);
+      }
+    }
+  }
+
+  // the draft tokens are few, every (batch, head, draft token) walks the
+  // whole cache once: qk, softmax and the weighted value in the same thread
+  auto thread_numbers = omp_get_max_threads();
+  auto attn_w_buf = at::empty({thread_numbers, seq_len}, at::kFloat);
+  auto attn_out_buf = at::empty({thread_numbers, head_size}, at::kFloat);
+  auto attn_w_buf_ptr = attn_w_buf.data_ptr<float>();
+  auto attn_out_buf_ptr = attn_out_buf.data_ptr<float>();
+  {
+    RECORD_FUNCTION(
+        "ipex::iakv_sdp::draft_tokens_attention",
+        c10::ArrayRef<c10::IValue>({}));
+#pragma omp parallel for collapse(3)
+    for (auto bi = 0; bi < bs; bi++) {
+      for (auto hi = 0; hi < head_num; hi++) {
+        for (auto qi = 0; qi < cur_len; qi++) {
+          auto thread_id = omp_get_thread_num();
+          auto attn_w = attn_w_buf_ptr + thread_id * seq_len;
+          auto attn_out = attn_out_buf_ptr + thread_id * head_size;
+          auto kv_hi = hi / group_size;
+          auto q_ptr_start =
+              q_ptr + ((bi * cur_len + qi) * head_num + hi) * head_size;
+          auto mask_ptr_start = mask_ptr + bi * mask_bs_stride +
+              (hi % mask_head_num) * mask_dim2 * seq_len +
+              (qi % mask_dim2) * seq_len;
+          auto tree_row = tree_ptr
+              ? tree_ptr + bi * tree_bs_stride + qi * cur_len
+              : nullptr;
+          auto visible = [&](int64_t ti) {
+            if (ti < offset)
+              return true;
+            auto di = ti - offset;
+            return tree_row ? tree_row[di] : di <= qi;
+          };
+          auto max_val = -std::numeric_limits<float>::infinity();
+          for (auto ti = 0; ti < seq_len; ti++) {
+            if (!visible(ti)) {
+              attn_w[ti] = -std::numeric_limits<float>::infinity();
+              continue;
+            }
+            attn_w[ti] = 0.0f;
+            auto kc_head_start = k_cache_ptr + ti * kc_token_stride +
+                (bi * kv_head + kv_hi) * head_size;
+            reduce_head(
+                q_ptr_start,
+                kc_head_start,
+                attn_w + ti,
+                head_size,
+                false,
+                static_cast<QT*>(nullptr));
+            attn_w[ti] = attn_w[ti] / scale_factor + mask_ptr_start[ti];
+            max_val = std::max(max_val, attn_w[ti]);
+          }
+          float sum = 0.0f;
+          for (auto ti = 0; ti < seq_len; ti++) {
+            attn_w[ti] = std::exp(attn_w[ti] - max_val);
+            sum += attn_w[ti];
+          }
+          bool accumulate = false;
+          for (auto ti = 0; ti < seq_len; ti++) {
+            if (attn_w[ti] == 0.0f)
+              continue;
+            attn_w[ti] = attn_w[ti] / sum;
+            auto vc_head_start = v_cache_ptr + ti * kc_token_stride +
+                (bi * kv_head + kv_hi) * head_size;
+            mul_attenion_weights_and_value_of_head<VT, float>(
+                attn_w[ti],
+                vc_head_start,
+                attn_out,
+                head_size,
+                false,
+                nullptr,
+                accumulate);
+            accumulate = true;
+          }
+          if (!accumulate) {
+            torch_ipex::cpu::kernel::zero_ker(attn_out, head_size);
+          }
+          auto attn_outs_start = attn_out_ptr +
+              ((bi * head_num + hi) * cur_len + qi) * head_size;
+          torch_ipex::cpu::kernel::move_ker<VT, float>(
+              attn_outs_start, attn_out, head_size);
+        }
+      }
+    }
+  }
+  return std::make_tuple(
+      attn_outs, at::Tensor(), key_cache, value_cache, beam_idx);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor>
+multi_token_masked_multihead_self_attention_kernel_impl(
+    at::Tensor query,
+    at::Tensor key,
+    at::Tensor value,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    at::Tensor& beam_idx,
+    const int64_t offset,
+    const double scale_attn,
+    at::Tensor& attention_mask,
+    const c10::optional<at::Tensor>& tree_mask) {
+  auto q_type = query.scalar_type();
+  auto v_type = value.scalar_type();
+#define MULTI_TOKEN_IAKV_SDP(QT, VT)                                         \
+  return multi_token_scale_dot_product_for_indirect_access_kv_cache<QT, VT>( \
+      query,                                                                 \
+      key,                                                                   \
+      value,                                                                 \
+      key_cache,                                                             \
+      value_cache,                                                           \
+      beam_idx,                                                              \
+      offset,                                                                \
+      scale_attn,                                                            \
+      attention_mask,                                                        \
+      tree_mask)
+  if (q_type == at::kFloat && v_type == at::kFloat) {
+    MULTI_TOKEN_IAKV_SDP(float, float);
+  } else if (q_type == at::kFloat && v_type == at::kBFloat16) {
+    MULTI_TOKEN_IAKV_SDP(float, at::BFloat16);
+  } else if (q_type == at::kBFloat16 && v_type == at::kFloat) {
+    MULTI_TOKEN_IAKV_SDP(at::BFloat16, float);
+  } else if (q_type == at::kHalf && v_type == at::kHalf) {
+    MULTI_TOKEN_IAKV_SDP(at::Half, at::Half);
+  } else if (q_type == at::kFloat && v_type == at::kHalf) {
+    MULTI_TOKEN_IAKV_SDP(float, at::Half);
+  } else if (q_type == at::kHalf && v_type == at::kFloat) {
+    MULTI_TOKEN_IAKV_SDP(at::Half, float);
+  }
+  MULTI_TOKEN_IAKV_SDP(at::BFloat16, at::BFloat16);
+#undef MULTI_TOKEN_IAKV_SDP
+}
+
 std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor, at::Tensor>
 first_token_masked_mha(
     at::Tensor query,
@@ -1355,7 +1585,8 @@ first_token_masked_mha(
         /* dropout */ 0.0,
         add_casual_mask,
         attention_mask,
-        1. / scale_attn));
+        1. / scale_attn,
+        /* window_size */ -1));
   } else {
     if (origin_type == at::kHalf) {
       key = key.to(at::kFloat);
@@ -1392,7 +1623,8 @@ masked_multihead_self_attention_kernel_impl(
     int64_t max_positions,
     const c10::optional<at::Tensor>& head_mask /* optional */,
     const c10::optional<at::Tensor>& attention_mask /* optional */,
-    c10::optional<bool> add_casual_mask /* optional */) {
+    c10::optional<bool> add_casual_mask /* optional */,
+    const c10::optional<at::Tensor>& tree_mask /* optional */) {
   TORCH_CHECK(
       attention_mask.has_value(),
       "Attention mask is necessary for ipex::masked_multihead_self_attention_kernel_impl");
@@ -1481,6 +1713,23 @@ masked_multihead_self_attention_kernel_impl(
           offset,
           scale_attn,
           attention_mask_v);
+    // the draft tokens of speculative decoding, there is no beam to trace
+    auto prompt_bs = beam_idx.accessor<long, 2>()[beam_idx.size(0) - 1][0];
+    if (prompt_bs == beam_batch && query.size(0) == beam_batch)
+      return multi_token_masked_multihead_self_attention_kernel_impl(
+          query,
+          key,
+          value,
+          key_cache,
+          value_cache,
+          beam_idx,
+          offset,
+          scale_attn,
+          attention_mask_v,
+          tree_mask);
+    TORCH_CHECK(
+        !tree_mask.has_value(),
+        "tree_mask is not supported with beam search in ipex::masked_multihead_self_attention_kernel_impl");
     // just a  funcationality path,need to optimize
     auto tokens_outs = std::vector<at::Tensor>(cur_len);
     for (auto i = 0; i < cur_len; i++) {
@@ -10,6 +10,8 @@
 #include <immintrin.h>
 #include <torch/csrc/autograd/function.h>
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include "tpp/kernels/TPPGEMMKrnl.h"
 
 namespace torch_ipex {
@@ -255,6 +257,311 @@ at::Tensor mixtral_moe_woq_kernl_impl(
 
   return output;
 }
+
+// Accumulates w * src into the fp32 row buffer acc.
+template <typename T>
+inline void fma_row_to_float(float* acc, const T* src, float w, int64_t len) {
+  using fVec = at::vec::Vectorized<float>;
+  int64_t i = 0;
+  if constexpr (std::is_same<T, float>::value) {
+    auto w_v = fVec(w);
+    for (; i <= len - fVec::size(); i += fVec::size()) {
+      auto out_v = fVec::loadu(acc + i) + fVec::loadu(src + i) * w_v;
+      out_v.store(acc + i);
+    }
+  } else {
+    using lpVec = at::vec::Vectorized<T>;
+    auto w_v = fVec(w);
+    for (; i <= len - lpVec::size(); i += lpVec::size()) {
+      fVec src_v1, src_v2;
+      std::tie(src_v1, src_v2) =
+          at::vec::convert_to_float(lpVec::loadu(src + i));
+      auto out_v1 = fVec::loadu(acc + i) + src_v1 * w_v;
+      auto out_v2 = fVec::loadu(acc + i + fVec::size()) + src_v2 * w_v;
+      out_v1.store(acc + i);
+      out_v2.store(acc + i + fVec::size());
+    }
+  }
+  for (; i < len; ++i) {
+    acc[i] += w * static_cast<float>(src[i]);
+  }
+}
+
+// Weighted combine of the expert outputs back into token order. Every token
+// reads its top-k rows from the expert-sorted outputs, so the loop is
+// parallel over tokens and needs neither atomics nor a zeroed output.
+template <typename T>
+void moe_combine_sorted(
+    at::Tensor& output,
+    const std::vector<at::Tensor>& expert_outs,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    const std::vector<int64_t>& expert_offsets,
+    const std::vector<int64_t>& slot_of) {
+  RECORD_FUNCTION("ipex::moe_combine_sorted", c10::ArrayRef<c10::IValue>({}));
+  auto num_tokens = output.size(0);
+  auto hidden_size = output.size(1);
+  auto top_k = selected_experts.size(1);
+  auto* output_ptr = output.data_ptr<T>();
+  auto* experts_ptr = selected_experts.data_ptr<int64_t>();
+  auto* rw_ptr = routing_weights.data_ptr<T>();
+  int64_t rw_stride0 = routing_weights.stride(0);
+  int64_t rw_stride1 = routing_weights.stride(1);
+  at::parallel_for(0, num_tokens, 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> acc(hidden_size);
+    for (int64_t t = begin; t < end; ++t) {
+      std::fill(acc.begin(), acc.end(), 0.f);
+      for (int64_t k = 0; k < top_k; ++k) {
+        auto e = experts_ptr[t * top_k + k];
+        auto row = slot_of[t * top_k + k] - expert_offsets[e];
+        float w = static_cast<float>(rw_ptr[t * rw_stride0 + k * rw_stride1]);
+        fma_row_to_float<T>(
+            acc.data(),
+            expert_outs[e].data_ptr<T>() + row * hidden_size,
+            w,
+            hidden_size);
+      }
+      auto* out_row = output_ptr + t * hidden_size;
+      if constexpr (std::is_same<T, float>::value) {
+        std::memcpy(out_row, acc.data(), hidden_size * sizeof(float));
+      } else {
+        for (int64_t j = 0; j < hidden_size; ++j) {
+          out_row[j] = static_cast<T>(acc[j]);
+        }
+      }
+    }
+  });
+}
+
+// Shared driver of the grouped MoE ops: buckets the (token, k) assignments
+// by expert with a counting sort, gathers the tokens of each expert into one
+// contiguous slab, runs expert_fn on the slab of every active expert and
+// combines the results. The down projection is row parallel under tensor
+// parallel, so the all-reduce commutes with the weighted sum and is issued
+// once for the whole layer.
+at::Tensor moe_grouped_forward(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    int64_t num_experts,
+    const std::function<at::Tensor(int64_t, const at::Tensor&)>& expert_fn,
+    bool is_distributed) {
+  TORCH_CHECK(
+      hidden_states.dim() == 2,
+      "mixtral_moe_grouped: hidden_states should be [num_tokens, hidden_size]");
+  TORCH_CHECK(
+      selected_experts.dim() == 2 &&
+          selected_experts.size(0) == hidden_states.size(0),
+      "mixtral_moe_grouped: selected_experts should be [num_tokens, top_k]");
+  TORCH_CHECK(
+      routing_weights.sizes() == selected_experts.sizes(),
+      "mixtral_moe_grouped: routing_weights should match selected_experts");
+  auto hidden = hidden_states.contiguous();
+  auto experts = selected_experts.to(at::kLong).contiguous();
+  auto rw = routing_weights.to(hidden.scalar_type());
+  auto num_tokens = hidden.size(0);
+  auto hidden_size = hidden.size(1);
+  auto top_k = experts.size(1);
+  auto num_slots = num_tokens * top_k;
+  auto* experts_ptr = experts.data_ptr<int64_t>();
+
+  // Counting sort of the assignments by expert. slot_of maps the (token, k)
+  // pair to its row in the expert-sorted slab and token_of goes back.
+  std::vector<int64_t> expert_offsets(num_experts + 1, 0);
+  for (int64_t i = 0; i < num_slots; ++i) {
+    auto e = experts_ptr[i];
+    TORCH_CHECK(
+        e >= 0 && e < num_experts,
+        "mixtral_moe_grouped: expert index out of range");
+    expert_offsets[e + 1]++;
+  }
+  for (int64_t e = 0; e < num_experts; ++e) {
+    expert_offsets[e + 1] += expert_offsets[e];
+  }
+  std::vector<int64_t> slot_of(num_slots);
+  std::vector<int64_t> token_of(num_slots);
+  {
+    std::vector<int64_t> fill(expert_offsets.begin(), expert_offsets.end() - 1);
+    for (int64_t i = 0; i < num_slots; ++i) {
+      auto slot = fill[experts_ptr[i]]++;
+      slot_of[i] = slot;
+      token_of[slot] = i / top_k;
+    }
+  }
+
+  auto sorted_states = at::empty({num_slots, hidden_size}, hidden.options());
+  auto row_bytes = hidden_size * hidden.element_size();
+  auto* src_ptr = static_cast<char*>(hidden.data_ptr());
+  auto* dst_ptr = static_cast<char*>(sorted_states.data_ptr());
+  at::parallel_for(0, num_slots, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; ++s) {
+      std::memcpy(
+          dst_ptr + s * row_bytes,
+          src_ptr + token_of[s] * row_bytes,
+          row_bytes);
+    }
+  });
+
+  std::vector<at::Tensor> expert_outs(num_experts);
+  for (int64_t e = 0; e < num_experts; ++e) {
+    auto count = expert_offsets[e + 1] - expert_offsets[e];
+    if (count == 0)
+      continue;
+    auto curr_state =
+        sorted_states.narrow(0, expert_offsets[e], count).unsqueeze(0);
+    expert_outs[e] = expert_fn(e, curr_state)
+                         .view({count, hidden_size})
+                         .to(hidden.scalar_type())
+                         .contiguous();
+  }
+
+  auto output = at::empty({num_tokens, hidden_size}, hidden.options());
+  if (hidden.scalar_type() == at::ScalarType::Float) {
+    moe_combine_sorted<float>(
+        output, expert_outs, experts, rw, expert_offsets, slot_of);
+  } else if (hidden.scalar_type() == at::ScalarType::BFloat16) {
+    moe_combine_sorted<at::BFloat16>(
+        output, expert_outs, experts, rw, expert_offsets, slot_of);
+  } else if (hidden.scalar_type() == at::ScalarType::Half) {
+    moe_combine_sorted<at::Half>(
+        output, expert_outs, experts, rw, expert_offsets, slot_of);
+  } else {
+    TORCH_CHECK(false, "mixtral_moe_grouped: unsupported data type");
+  }
+  if (is_distributed) {
+    call_AllReduce(output);
+  }
+  return output;
+}
+
+at::Tensor mixtral_moe_tpp_grouped_kernl_impl(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool tpp_fallback,
+    bool is_distributed) {
+  auto num_experts = gate_wei.size();
+  TORCH_CHECK(
+      up_wei.size() == num_experts && down_wei.size() == num_experts,
+      "mixtral_moe_tpp_grouped: expert weight lists should have the same size");
+  return moe_grouped_forward(
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      num_experts,
+      [&](int64_t e, const at::Tensor& curr_state) {
+        if (tpp_fallback) {
+          return at::linear(
+              at::silu(at::linear(curr_state, gate_wei[e])) *
+                  at::linear(curr_state, up_wei[e]),
+              down_wei[e]);
+        }
+        auto out = tpp_fused_gate_up_proj_forward_cpu(
+            curr_state,
+            gate_wei[e],
+            at::empty(0, curr_state.options()),
+            up_wei[e],
+            at::empty(0, curr_state.options()),
+            c10::nullopt);
+        return tpp_linear_nobias_forward_cpu(out, down_wei[e], c10::nullopt);
+      },
+      is_distributed);
+}
+
+at::Tensor mixtral_moe_grouped_kernl_impl(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList gate_op_ctx,
+    at::TensorList up_wei,
+    at::TensorList up_op_ctx,
+    at::TensorList down_wei,
+    at::TensorList down_op_ctx,
+    bool use_dnnl,
+    bool is_distributed) {
+  auto num_experts = gate_wei.size();
+  TORCH_CHECK(
+      gate_op_ctx.size() == num_experts && up_wei.size() == num_experts &&
+          up_op_ctx.size() == num_experts && down_wei.size() == num_experts &&
+          down_op_ctx.size() == num_experts,
+      "mixtral_moe_grouped: expert weight lists should have the same size");
+  return moe_grouped_forward(
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      num_experts,
+      [&](int64_t e, const at::Tensor& curr_state) {
+        if (use_dnnl) {
+          return ipex_linear(
+              at::silu(ipex_linear(
+                  curr_state,
+                  gate_wei[e],
+                  c10::nullopt,
+                  gate_op_ctx[e],
+                  c10::nullopt)) *
+                  ipex_linear(
+                      curr_state,
+                      up_wei[e],
+                      c10::nullopt,
+                      up_op_ctx[e],
+                      c10::nullopt),
+              down_wei[e],
+              c10::nullopt,
+              down_op_ctx[e],
+              c10::nullopt);
+        }
+        return mkl_sgemm_forward(
+            at::silu(mkl_sgemm_forward(
+                curr_state,
+                gate_wei[e],
+                c10::nullopt,
+                gate_op_ctx[e],
+                c10::nullopt)) *
+                mkl_sgemm_forward(
+                    curr_state,
+                    up_wei[e],
+                    c10::nullopt,
+                    up_op_ctx[e],
+                    c10::nullopt),
+            down_wei[e],
+            c10::nullopt,
+            down_op_ctx[e],
+            c10::nullopt);
+      },
+      is_distributed);
+}
+
+at::Tensor mixtral_moe_woq_grouped_kernl_impl(
+    const at::Tensor& hidden_states,
+    const at::Tensor& selected_experts,
+    const at::Tensor& routing_weights,
+    at::TensorList gate_wei,
+    at::TensorList up_wei,
+    at::TensorList down_wei,
+    bool is_distributed) {
+  auto num_experts = gate_wei.size();
+  TORCH_CHECK(
+      up_wei.size() == num_experts && down_wei.size() == num_experts,
+      "mixtral_moe_woq_grouped: expert weight lists should have the same size");
+  return moe_grouped_forward(
+      hidden_states,
+      selected_experts,
+      routing_weights,
+      num_experts,
+      [&](int64_t e, const at::Tensor& curr_state) {
+        return woq_linear_forward(
+            woq_linear_mul_forward(
+                curr_state,
+                up_wei[e],
+                {woq_linear_silu_forward(curr_state, gate_wei[e])}),
+            down_wei[e]);
+      },
+      is_distributed);
+}
 } // anonymous namespace
 
 IPEX_REGISTER_DISPATCH(
@@ -264,6 +571,15 @@ IPEX_REGISTER_DISPATCH(
     mixtral_moe_woq_kernel_stub,
     &mixtral_moe_woq_kernl_impl);
 IPEX_REGISTER_DISPATCH(mixtral_moe_kernel_stub, &mixtral_moe_kernl_impl);
+IPEX_REGISTER_DISPATCH(
+    mixtral_moe_tpp_grouped_kernel_stub,
+    &mixtral_moe_tpp_grouped_kernl_impl);
+IPEX_REGISTER_DISPATCH(
+    mixtral_moe_woq_grouped_kernel_stub,
+    &mixtral_moe_woq_grouped_kernl_impl);
+IPEX_REGISTER_DISPATCH(
+    mixtral_moe_grouped_kernel_stub,
+    &mixtral_moe_grouped_kernl_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -20,18 +20,114 @@
 #endif
 
 #include <aten/PagedAttention.h>
+#include <aten/fp8_utils.h>
 #include <omp.h>
+#include <cstring>
 #include <limits>
 #include "mkl.h"
+#include "utils/ScratchAllocator.h"
 #include "vec/vec.h"
 
 #define PARTITION_SIZE 128
+#define Q_SPLIT_SIZE 32
 
 namespace torch_ipex {
 namespace cpu {
 
 namespace {
 
+template <typename T>
+struct is_quantized_kv_cache : std::false_type {};
+
+template <>
+struct is_quantized_kv_cache<int8_t> : std::true_type {};
+
+template <>
+struct is_quantized_kv_cache<fp8e5m2> : std::true_type {};
+
+template <>
+struct is_quantized_kv_cache<fp8e4m3> : std::true_type {};
+
+// The max absolute value of the low precision kv cache data type.
+template <typename CT>
+inline constexpr float kv_cache_quant_max() {
+  if constexpr (std::is_same_v<CT, int8_t>) {
+    return 127.0f;
+  } else if constexpr (std::is_same_v<CT, fp8e4m3>) {
+    return 448.0f;
+  } else {
+    return 57344.0f;
+  }
+}
+
+// The scale of one token of one head in the quantized kv cache, 1 for the
+// kv cache with the same data type as the activations.
+inline float kv_cache_scale(const float* scale_ptr, int64_t offset) {
+  return scale_ptr == nullptr ? 1.0f : scale_ptr[offset];
+}
+
+// 1) scale = max(abs(src)) / quant_max
+// 2) dst = src / scale
+template <typename CT, typename ST>
+inline float quantize_kv_head(const ST* src, CT* dst, int64_t head_size) {
+  float amax = 0;
+  for (auto hsi = 0; hsi < head_size; hsi++) {
+    amax = std::max(amax, std::abs((float)src[hsi]));
+  }
+  auto quant_max = kv_cache_quant_max<CT>();
+  float scale = amax == 0 ? 1.0f : amax / quant_max;
+  float inverse_scale = 1.0f / scale;
+  for (auto hsi = 0; hsi < head_size; hsi++) {
+    auto val = std::min(
+        std::max((float)src[hsi] * inverse_scale, -quant_max), quant_max);
+    if constexpr (std::is_same_v<CT, int8_t>) {
+      dst[hsi] = static_cast<int8_t>(std::nearbyint(val));
+    } else {
+      dst[hsi] = static_cast<CT>(val);
+    }
+  }
+  return scale;
+}
+
+// dst = src * scale
+template <typename CT>
+inline void dequantize_kv_head(
+    const CT* src,
+    float scale,
+    float* dst,
+    int64_t head_size) {
+  int64_t hsi = 0;
+#if defined(CPU_CAPABILITY_AVX512)
+  auto vec_scale = _mm512_set1_ps(scale);
+  if constexpr (std::is_same_v<CT, int8_t>) {
+    for (; hsi <= head_size - 16; hsi += 16) {
+      auto src_vec = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(
+          _mm_loadu_si128((const __m128i*)(src + hsi))));
+      _mm512_storeu_ps(dst + hsi, _mm512_mul_ps(src_vec, vec_scale));
+    }
+  } else if constexpr (std::is_same_v<CT, fp8e5m2>) {
+    // e5m2 is the high byte of fp16
+    for (; hsi <= head_size - 16; hsi += 16) {
+      auto src_vec = _mm512_cvtph_ps(_mm256_slli_epi16(
+          _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + hsi))),
+          8));
+      _mm512_storeu_ps(dst + hsi, _mm512_mul_ps(src_vec, vec_scale));
+    }
+  } else if constexpr (std::is_same_v<CT, fp8e4m3>) {
+    for (; hsi <= head_size - 16; hsi += 16) {
+      auto src_vec = _mm512_i32gather_ps(
+          _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)(src + hsi))),
+          fp8e4m3_to_float_lut(),
+          sizeof(float));
+      _mm512_storeu_ps(dst + hsi, _mm512_mul_ps(src_vec, vec_scale));
+    }
+  }
+#endif
+  for (; hsi < head_size; hsi++) {
+    dst[hsi] = (float)src[hsi] * scale;
+  }
+}
+
 template <typename QT, typename KT>
 void reduce_head(
     const QT* q_ptr_start,
@@ -39,28 +135,42 @@ void reduce_head(
     const KT* k_cache_start,
     float* attn_w_pos,
     int attn_w_stride,
-    int64_t head_size) {
+    int64_t head_size,
+    float k_scale = 1.0f,
+    float* kv_buf = nullptr) {
+  if constexpr (is_quantized_kv_cache<KT>::value) {
+    // dequantize the key once, it is shared by the whole head group
+    dequantize_kv_head(k_cache_start, k_scale, kv_buf, head_size);
+    reduce_head<QT, float>(
+        q_ptr_start,
+        kv_head_group_size,
+        kv_buf,
+        attn_w_pos,
+        attn_w_stride,
+        head_size);
+  } else {
 #if defined(CPU_CAPABILITY_AVX512)
-  for (auto i = 0; i < kv_head_group_size; i++) {
-    attn_w_pos[i * attn_w_stride] = 0;
-    torch_ipex::cpu::kernel::_reduce_head<QT, KT, KT>(
-        q_ptr_start + i * head_size,
-        k_cache_start,
-        attn_w_pos + i * attn_w_stride,
-        head_size,
-        false,
-        nullptr);
-  }
+    for (auto i = 0; i < kv_head_group_size; i++) {
+      attn_w_pos[i * attn_w_stride] = 0;
+      torch_ipex::cpu::kernel::_reduce_head<QT, KT, KT>(
+          q_ptr_start + i * head_size,
+          k_cache_start,
+          attn_w_pos + i * attn_w_stride,
+          head_size,
+          false,
+          nullptr);
+    }
 #else
-  for (auto i = 0; i < kv_head_group_size; i++) {
-    attn_w_pos[i * attn_w_stride] = 0;
-    for (auto hsi = 0; hsi < head_size; hsi++) {
-      attn_w_pos[i * attn_w_stride] +=
-          (float)q_ptr_start[i * head_size + hsi] * (float)k_cache_start[hsi];
+    for (auto i = 0; i < kv_head_group_size; i++) {
+      attn_w_pos[i * attn_w_stride] = 0;
+      for (auto hsi = 0; hsi < head_size; hsi++) {
+        attn_w_pos[i * attn_w_stride] +=
+            (float)q_ptr_start[i * head_size + hsi] * (float)k_cache_start[hsi];
+      }
     }
-  }
 
 #endif
+  }
 }
 
 template <typename OT, typename CT>
@@ -72,33 +182,49 @@ inline void mul_attenion_weights_and_value_of_head(
     int attn_out_strideH,
     int kv_head_group_size,
     int64_t head_size,
-    bool accumulated) {
-  auto vec_size = 16; // 512/32
-  auto hsi = 0;
-#if defined(CPU_CAPABILITY_AVX512)
-  for (auto i = 0; i < kv_head_group_size; i++) {
-    torch_ipex::cpu::kernel::_mul_and_accumulate<CT, OT, CT>(
-        attn_w[i * attn_w_stride],
-        v_cache_start,
-        attn_out_start + i * attn_out_strideH,
+    bool accumulated,
+    float v_scale = 1.0f,
+    float* kv_buf = nullptr) {
+  if constexpr (is_quantized_kv_cache<CT>::value) {
+    // dequantize the value once, it is shared by the whole head group
+    dequantize_kv_head(v_cache_start, v_scale, kv_buf, head_size);
+    mul_attenion_weights_and_value_of_head<OT, float>(
+        attn_w,
+        attn_w_stride,
+        kv_buf,
+        attn_out_start,
+        attn_out_strideH,
+        kv_head_group_size,
         head_size,
-        false,
-        nullptr,
         accumulated);
-  }
+  } else {
+    auto vec_size = 16; // 512/32
+    auto hsi = 0;
+#if defined(CPU_CAPABILITY_AVX512)
+    for (auto i = 0; i < kv_head_group_size; i++) {
+      torch_ipex::cpu::kernel::_mul_and_accumulate<CT, OT, CT>(
+          attn_w[i * attn_w_stride],
+          v_cache_start,
+          attn_out_start + i * attn_out_strideH,
+          head_size,
+          false,
+          nullptr,
+          accumulated);
+    }
 #else
-  for (auto i = 0; i < kv_head_group_size; i++) {
-    for (hsi = 0; hsi < head_size; hsi++) {
-      if (accumulated) {
-        attn_out_start[i * attn_out_strideH + hsi] +=
-            attn_w[i * attn_w_stride] * (float)v_cache_start[hsi];
-      } else {
-        attn_out_start[i * attn_out_strideH + hsi] =
-            attn_w[i * attn_w_stride] * (float)v_cache_start[hsi];
+    for (auto i = 0; i < kv_head_group_size; i++) {
+      for (hsi = 0; hsi < head_size; hsi++) {
+        if (accumulated) {
+          attn_out_start[i * attn_out_strideH + hsi] +=
+              attn_w[i * attn_w_stride] * (float)v_cache_start[hsi];
+        } else {
+          attn_out_start[i * attn_out_strideH + hsi] =
+              attn_w[i * attn_w_stride] * (float)v_cache_start[hsi];
+        }
       }
     }
-  }
 #endif
+  }
 }
 
 // 1) out = exp(a - val)
@@ -136,6 +262,13 @@ inline void _exp_reduce_sum_fusion_kernel(
   val = tmp_sum;
 }
 
+// The first token visible to the query at position (context_len - 1) with a
+// sliding window, the window is disabled if window_size <= 0.
+inline int64_t sliding_window_start(int64_t context_len, int64_t window_size) {
+  return window_size > 0 ? std::max<int64_t>(0, context_len - window_size)
+                         : 0;
+}
+
 // 1) out = a * scale + alibi_mask
 // 2) max = max(out)
 template <typename scalar_t>
@@ -215,8 +348,15 @@ inline void _mul_reduce_max_fusion_kernel(
  * @param max_context_len Maximum context length.
  * @param alibi_slopes  Optional tensor of alibi slopes with the shape of
  * (num_heads).
+ * @param k_scale       The scales of the int8/fp8 key cache with the shape of
+ * [num_blocks, num_kv_heads, block_size]. Only used by the quantized cache.
+ * @param v_scale       The scales of the int8/fp8 value cache with the shape of
+ * [num_blocks, num_kv_heads, block_size]. Only used by the quantized cache.
+ * @param window_size   Sliding window size, the query only attends the last
+ * window_size tokens of the context if it is positive. The blocks before the
+ * window are never read, so the caller can recycle them.
  */
-template <typename scalar_t>
+template <typename scalar_t, typename cache_t>
 void single_query_cached_kv_attention_kernel(
     at::Tensor& out,
     at::Tensor& query,
@@ -227,11 +367,18 @@ void single_query_cached_kv_attention_kernel(
     at::Tensor& context_lens,
     int64_t block_size,
     int64_t max_context_len,
-    const c10::optional<at::Tensor>& alibi_slopes) {
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size) {
   auto out_ptr = out.data_ptr<scalar_t>();
   auto query_ptr = query.data_ptr<scalar_t>();
-  auto key_cache_ptr = key_cache.data_ptr<scalar_t>();
-  auto value_cache_ptr = value_cache.data_ptr<scalar_t>();
+  auto key_cache_ptr = key_cache.data_ptr<cache_t>();
+  auto value_cache_ptr = value_cache.data_ptr<cache_t>();
+  auto k_scale_ptr = k_scale.has_value() ? k_scale.value().data_ptr<float>()
+                                         : nullptr;
+  auto v_scale_ptr = v_scale.has_value() ? v_scale.value().data_ptr<float>()
+                                         : nullptr;
   auto block_tables_ptr = block_tables.data_ptr<int>();
   auto context_lens_ptr = context_lens.data_ptr<int>();
   auto alibi_slopes_ptr = alibi_slopes.has_value()
@@ -257,15 +404,15 @@ void single_query_cached_kv_attention_kernel(
   auto max_num_partitions =
       (max_context_len + PARTITION_SIZE - 1) / PARTITION_SIZE;
 
-  auto max_logits = at::empty(
+  auto max_logits = utils::empty_scratch(
       {num_seqs, num_heads, max_num_partitions + 1},
       query.options().dtype(at::ScalarType::Float));
 
-  auto exp_sum = at::empty(
+  auto exp_sum = utils::empty_scratch(
       {num_seqs, num_heads, max_num_partitions + 1},
       query.options().dtype(at::ScalarType::Float));
 
-  auto tmp_out = at::empty(
+  auto tmp_out = utils::empty_scratch(
       {num_seqs, num_heads, max_num_partitions, head_size},
       query.options().dtype(at::ScalarType::Float));
 
@@ -285,6 +432,16 @@ void single_query_cached_kv_attention_kernel(
 
   auto thread_numbers = omp_get_max_threads();
   auto max_parallel_parts = thread_numbers * 4;
+
+  // per thread buffer to dequantize one key/value head of the int8/fp8 cache
+  auto scale_strideN = k_scale.has_value() ? k_scale.value().stride(0) : 0;
+  auto scale_strideH = k_scale.has_value() ? k_scale.value().stride(1) : 0;
+  auto kv_buf_size =
+      is_quantized_kv_cache<cache_t>::value ? head_size : (int64_t)0;
+  auto kv_buf = utils::empty_scratch(
+      {thread_numbers, kv_buf_size},
+      query.options().dtype(at::ScalarType::Float));
+  auto kv_buf_ptr = kv_buf.data_ptr<float>();
   if (alibi_slopes.has_value()) {
     auto alibi_slopes_size = alibi_slopes.value().size(0);
     TORCH_CHECK(
@@ -303,10 +460,15 @@ void single_query_cached_kv_attention_kernel(
           continue;
         auto partition_end =
             std::min(partition_start + PARTITION_SIZE, context_len);
+        // skip the partitions before the sliding window and clip the one
+        // crossing it, the tokens before the window are never read
+        auto window_start = sliding_window_start(context_len, window_size);
+        if (partition_end <= window_start)
+          continue;
+        partition_start = std::max<int64_t>(partition_start, window_start);
         auto token_num = partition_end - partition_start;
-        auto block_num = (token_num + block_size - 1) / block_size;
         auto logical_block_start = partition_start / block_size;
-        auto logical_block_end = logical_block_start + block_num;
+        auto logical_block_end = (partition_end + block_size - 1) / block_size;
         auto kv_head_id = head_group_start / kv_head_group_size;
         auto q_ptr_start =
             query_ptr + seq_id * q_strideN + head_group_start * q_strideH;
@@ -319,28 +481,33 @@ void single_query_cached_kv_attention_kernel(
             head_group_start * tmp_out_strideH + partition_id * tmp_out_strideS;
         float logits[16 * PARTITION_SIZE] __attribute__((aligned(64))) = {0};
         auto logits_position = 0;
+        auto thread_kv_buf = kv_buf_ptr + omp_get_thread_num() * kv_buf_size;
         // 1)calculate the matmul(query, key) for this partition
         for (auto logical_block_id = logical_block_start;
              logical_block_id < logical_block_end;
              logical_block_id++) {
           auto physical_block_id = block_tables_ptr
               [seq_id * max_num_blocks_per_seq + logical_block_id];
-          auto tokens_in_block =
-              std::min(block_size, context_len - logical_block_id * block_size);
-          auto token_start = logical_block_id * block_size;
-          auto token_end = token_start + tokens_in_block;
+          auto block_start = logical_block_id * block_size;
+          auto token_start = std::max<int64_t>(block_start, partition_start);
+          auto token_end =
+              std::min<int64_t>(block_start + block_size, partition_end);
           for (auto token_id = token_start; token_id < token_end; token_id++) {
-            auto block_offset = token_id - token_start;
+            auto block_offset = token_id - block_start;
             auto k_cache_start = key_cache_ptr +
                 physical_block_id * kv_block_strideN +
                 block_offset * kv_block_strideP + kv_head_id * kv_block_strideH;
+            auto scale_offset = physical_block_id * scale_strideN +
+                kv_head_id * scale_strideH + block_offset;
             reduce_head(
                 q_ptr_start,
                 kv_head_group_size,
                 k_cache_start,
                 &(logits[logits_position]),
                 PARTITION_SIZE,
-                head_size);
+                head_size,
+                kv_cache_scale(k_scale_ptr, scale_offset),
+                thread_kv_buf);
             logits_position++;
           }
         }
@@ -383,16 +550,18 @@ void single_query_cached_kv_attention_kernel(
              logical_block_id++) {
           auto physical_block_id = block_tables_ptr
               [seq_id * max_num_blocks_per_seq + logical_block_id];
-          auto tokens_in_block =
-              std::min(block_size, context_len - logical_block_id * block_size);
-          auto token_start = logical_block_id * block_size;
-          auto token_end = token_start + tokens_in_block;
+          auto block_start = logical_block_id * block_size;
+          auto token_start = std::max<int64_t>(block_start, partition_start);
+          auto token_end =
+              std::min<int64_t>(block_start + block_size, partition_end);
           for (auto token_id = token_start; token_id < token_end; token_id++) {
-            auto block_offset = token_id - token_start;
+            auto block_offset = token_id - block_start;
             auto v_cache_start = value_cache_ptr +
                 physical_block_id * kv_block_strideN +
                 block_offset * kv_block_strideP + kv_head_id * kv_block_strideH;
             auto accumulated = logits_position > 0;
+            auto scale_offset = physical_block_id * scale_strideN +
+                kv_head_id * scale_strideH + block_offset;
             mul_attenion_weights_and_value_of_head(
                 &(logits[logits_position]),
                 PARTITION_SIZE,
@@ -401,7 +570,9 @@ void single_query_cached_kv_attention_kernel(
                 tmp_out_strideH,
                 kv_head_group_size,
                 head_size,
-                accumulated);
+                accumulated,
+                kv_cache_scale(v_scale_ptr, scale_offset),
+                thread_kv_buf);
             logits_position++;
           }
         }
@@ -417,8 +588,12 @@ void single_query_cached_kv_attention_kernel(
       auto global_exp_sum = 0.0;
       auto context_len = context_lens_ptr[seq_id];
       auto partition_num = (context_len + PARTITION_SIZE - 1) / PARTITION_SIZE;
+      // the partitions before the sliding window are skipped
+      auto first_partition =
+          sliding_window_start(context_len, window_size) / PARTITION_SIZE;
       // calculate the global max and exp_sum for this head
-      for (auto partition_id = 0; partition_id < max_num_partitions;
+      for (auto partition_id = first_partition;
+           partition_id < max_num_partitions;
            partition_id++) {
         if (partition_id >= partition_num)
           break;
@@ -427,14 +602,16 @@ void single_query_cached_kv_attention_kernel(
              partition_id];
         global_max = std::max(global_max, max_logit);
       }
-      // update the partition 0 result with the global max
-      auto partition0_out_start =
-          tmp_out_ptr + seq_id * tmp_out_strideN + head_id * tmp_out_strideH;
+      // update the first partition result with the global max
+      auto partition0_out_start = tmp_out_ptr + seq_id * tmp_out_strideN +
+          head_id * tmp_out_strideH + first_partition * tmp_out_strideS;
       auto max_logit0 = max_logits_ptr
-          [seq_id * max_logits_strideN + head_id * max_logits_strideH];
+          [seq_id * max_logits_strideN + head_id * max_logits_strideH +
+           first_partition];
       float exp_val = expf(max_logit0 - global_max);
-      global_exp_sum +=
-          exp_sum_ptr[seq_id * exp_sum_strideN + head_id * exp_sum_strideH] *
+      global_exp_sum += exp_sum_ptr
+                            [seq_id * exp_sum_strideN +
+                             head_id * exp_sum_strideH + first_partition] *
           exp_val;
       at::vec::Vectorized<float> exp_val_vec0(exp_val);
       at::vec::map<float>(
@@ -443,9 +620,10 @@ void single_query_cached_kv_attention_kernel(
           partition0_out_start,
           head_size);
 
-      // accumulate the partition 1 to partition n result into partition 0
-      if (partition_num > 1) {
-        for (auto partition_id = 1; partition_id < partition_num;
+      // accumulate the rest partition results into the first partition
+      if (partition_num > first_partition + 1) {
+        for (auto partition_id = first_partition + 1;
+             partition_id < partition_num;
              partition_id++) {
           if (partition_id * PARTITION_SIZE >= context_len)
             break;
@@ -491,6 +669,307 @@ void single_query_cached_kv_attention_kernel(
 
 } // single_query_cached_kv_attention_kernel
 
+/**
+ * Performs causal scale-dot-product for a batch of query tokens against the
+ * paged key-value cache. Every sequence contributes a contiguous chunk of
+ * query tokens (a prefill chunk or a single decode token), so prefill and
+ * decode can be mixed in one batch without materializing contiguous K/V.
+ *
+ * The key/value of the query tokens must already be stored in the cache (by
+ * reshape_and_cache) and be counted in context_lens. The query tokens of
+ * sequence i are the last (query_start_loc[i + 1] - query_start_loc[i]) tokens
+ * of its context, and query token j of the chunk attends to the keys up to and
+ * including its own position.
+ *
+ * @param out             Output tensor [num_tokens, num_heads, head_size].
+ * @param query           Query tensor [num_tokens, num_heads, head_size].
+ * @param key_cache       The pre-allocated buffer to store the key cache. The
+ * shape should be [num_blocks, num_kv_heads, block_size, head_size].
+ * @param value_cache     The pre-allocated buffer to store the value cache. The
+ * shape should be [num_blocks, num_kv_heads, block_size, head_size].
+ * @param scale           Scaling factor for attention weights.
+ * @param block_tables    Block tables tensor [num_seqs,
+ * max_num_blocks_per_seq].
+ * @param context_lens    Context lengths tensor [num_seqs], including the
+ * query tokens of this step.
+ * @param query_start_loc Cumulative query lengths tensor [num_seqs + 1].
+ * @param block_size      The number of tokens in every block.
+ * @param max_query_len   Maximum number of query tokens of one sequence.
+ * @param alibi_slopes    Optional tensor of alibi slopes with the shape of
+ * (num_heads).
+ * @param k_scale         The scales of the int8/fp8 key cache with the shape
+ * of [num_blocks, num_kv_heads, block_size].
+ * @param v_scale         The scales of the int8/fp8 value cache with the shape
+ * of [num_blocks, num_kv_heads, block_size].
+ * @param window_size     Sliding window size, query token at position p only
+ * attends the keys in (p - window_size, p] if it is positive.
+ */
+template <typename scalar_t, typename cache_t>
+void multi_query_cached_kv_attention_kernel(
+    at::Tensor& out,
+    at::Tensor& query,
+    at::Tensor& key_cache,
+    at::Tensor& value_cache,
+    const double scale,
+    at::Tensor& block_tables,
+    at::Tensor& context_lens,
+    at::Tensor& query_start_loc,
+    int64_t block_size,
+    int64_t max_query_len,
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size) {
+  // the quantized cache block is dequantized into the per thread buffer
+  using kv_t = std::
+      conditional_t<is_quantized_kv_cache<cache_t>::value, float, cache_t>;
+  auto out_ptr = out.data_ptr<scalar_t>();
+  auto query_ptr = query.data_ptr<scalar_t>();
+  auto key_cache_ptr = key_cache.data_ptr<cache_t>();
+  auto value_cache_ptr = value_cache.data_ptr<cache_t>();
+  auto k_scale_ptr = k_scale.has_value() ? k_scale.value().data_ptr<float>()
+                                         : nullptr;
+  auto v_scale_ptr = v_scale.has_value() ? v_scale.value().data_ptr<float>()
+                                         : nullptr;
+  auto block_tables_ptr = block_tables.data_ptr<int>();
+  auto context_lens_ptr = context_lens.data_ptr<int>();
+  auto query_start_loc_ptr = query_start_loc.data_ptr<int>();
+  auto alibi_slopes_ptr = alibi_slopes.has_value()
+      ? alibi_slopes.value().data_ptr<float>()
+      : nullptr;
+  auto num_seqs = context_lens.size(0);
+  auto num_heads = query.size(1);
+  auto head_size = query.size(2);
+  auto num_kv_heads = key_cache.size(1);
+  auto kv_head_group_size = num_heads / num_kv_heads;
+  auto max_num_blocks_per_seq = block_tables.size(1);
+
+  auto kv_block_strideN = key_cache.stride(0);
+  auto kv_block_strideP = key_cache.stride(2);
+  auto kv_block_strideH = key_cache.stride(1);
+
+  auto out_strideN = out.stride(0);
+  auto out_strideH = out.stride(1);
+
+  auto q_strideN = query.stride(0);
+  auto q_strideH = query.stride(1);
+
+  TORCH_CHECK(
+      query_start_loc.size(0) == num_seqs + 1,
+      "query_start_loc size should be num_seqs + 1");
+  for (auto seq_id = 0; seq_id < num_seqs; seq_id++) {
+    auto query_len =
+        query_start_loc_ptr[seq_id + 1] - query_start_loc_ptr[seq_id];
+    TORCH_CHECK(
+        query_len <= max_query_len && query_len <= context_lens_ptr[seq_id],
+        "the query length of every sequence should not exceed max_query_len and its context length");
+  }
+  if (alibi_slopes.has_value()) {
+    auto alibi_slopes_size = alibi_slopes.value().size(0);
+    TORCH_CHECK(
+        alibi_slopes_size == num_heads,
+        "alibi_slopes size is not equal to num_heads");
+  }
+
+  auto q_split_size = std::min<int64_t>(Q_SPLIT_SIZE, max_query_len);
+  auto max_num_q_splits = (max_query_len + q_split_size - 1) / q_split_size;
+  auto rows_per_split = q_split_size * kv_head_group_size;
+
+  // per thread buffers: logits, running max, running exp_sum, output and the
+  // dequantized key/value block of the int8/fp8 cache
+  auto logits_size = rows_per_split * block_size;
+  auto kv_buf_size = is_quantized_kv_cache<cache_t>::value
+      ? 2 * block_size * head_size
+      : (int64_t)0;
+  auto size_per_thread = logits_size + rows_per_split * 2 +
+      rows_per_split * head_size + kv_buf_size;
+  auto scale_strideN = k_scale.has_value() ? k_scale.value().stride(0) : 0;
+  auto scale_strideH = k_scale.has_value() ? k_scale.value().stride(1) : 0;
+  auto thread_numbers = omp_get_max_threads();
+  auto buf = utils::empty_scratch(
+      {thread_numbers, size_per_thread},
+      query.options().dtype(at::ScalarType::Float));
+  auto buf_ptr = buf.data_ptr<float>();
+
+#pragma omp parallel for collapse(3) schedule(dynamic, 1)
+  for (auto seq_id = 0; seq_id < num_seqs; seq_id++) {
+    for (auto q_split_id = 0; q_split_id < max_num_q_splits; q_split_id++) {
+      for (auto head_group_start = 0; head_group_start < num_heads;
+           head_group_start += kv_head_group_size) {
+        auto query_start = query_start_loc_ptr[seq_id];
+        auto query_len = query_start_loc_ptr[seq_id + 1] - query_start;
+        auto row_start = q_split_id * q_split_size;
+        if (row_start >= query_len)
+          continue;
+        auto row_end = std::min<int64_t>(row_start + q_split_size, query_len);
+        auto context_len = context_lens_ptr[seq_id];
+        // the absolute position of the first query token of this sequence
+        auto query_pos_start = context_len - query_len;
+        // keys after the position of the last query row are never visible
+        auto num_keys = query_pos_start + row_end;
+        auto logical_block_end = (num_keys + block_size - 1) / block_size;
+        // the blocks before the sliding window of the first row are skipped
+        auto logical_block_start =
+            sliding_window_start(query_pos_start + row_start + 1, window_size) /
+            block_size;
+        auto kv_head_id = head_group_start / kv_head_group_size;
+
+        auto thread_buf = buf_ptr + omp_get_thread_num() * size_per_thread;
+        auto logits = thread_buf;
+        auto max_logits = logits + logits_size;
+        auto exp_sums = max_logits + rows_per_split;
+        auto acc_out = exp_sums + rows_per_split;
+        auto kv_buf = acc_out + rows_per_split * head_size;
+        auto rows = (row_end - row_start) * kv_head_group_size;
+        torch_ipex::cpu::kernel::fill_stub(
+            max_logits, -std::numeric_limits<float>::infinity(), rows);
+        torch_ipex::cpu::kernel::fill_stub(exp_sums, 0.0f, rows);
+        torch_ipex::cpu::kernel::fill_stub(acc_out, 0.0f, rows * head_size);
+
+        for (auto logical_block_id = logical_block_start;
+             logical_block_id < logical_block_end;
+             logical_block_id++) {
+          auto physical_block_id = block_tables_ptr
+              [seq_id * max_num_blocks_per_seq + logical_block_id];
+          auto token_start = logical_block_id * block_size;
+          auto tokens_in_block = std::min(block_size, num_keys - token_start);
+          const kv_t* k_block_start;
+          const kv_t* v_block_start;
+          auto k_block_strideP = kv_block_strideP;
+          if constexpr (is_quantized_kv_cache<cache_t>::value) {
+            // dequantize the block once, it is shared by all the query rows
+            auto scale_offset = physical_block_id * scale_strideN +
+                kv_head_id * scale_strideH;
+            for (auto block_offset = 0; block_offset < tokens_in_block;
+                 block_offset++) {
+              auto cache_offset = physical_block_id * kv_block_strideN +
+                  kv_head_id * kv_block_strideH +
+                  block_offset * kv_block_strideP;
+              dequantize_kv_head(
+                  key_cache_ptr + cache_offset,
+                  k_scale_ptr[scale_offset + block_offset],
+                  kv_buf + block_offset * head_size,
+                  head_size);
+              dequantize_kv_head(
+                  value_cache_ptr + cache_offset,
+                  v_scale_ptr[scale_offset + block_offset],
+                  kv_buf + (block_size + block_offset) * head_size,
+                  head_size);
+            }
+            k_block_start = kv_buf;
+            v_block_start = kv_buf + block_size * head_size;
+            k_block_strideP = head_size;
+          } else {
+            k_block_start = key_cache_ptr +
+                physical_block_id * kv_block_strideN +
+                kv_head_id * kv_block_strideH;
+            v_block_start = value_cache_ptr +
+                physical_block_id * kv_block_strideN +
+                kv_head_id * kv_block_strideH;
+          }
+          for (auto row = row_start; row < row_end; row++) {
+            auto query_pos = query_pos_start + row;
+            // causal mask at block granularity: only the visible prefix of
+            // the block is computed
+            auto valid_tokens = std::min<int64_t>(
+                tokens_in_block, query_pos + 1 - token_start);
+            // sliding window at block granularity: the tokens before the
+            // window are skipped instead of being masked
+            auto first_token = std::max<int64_t>(
+                0,
+                sliding_window_start(query_pos + 1, window_size) -
+                    token_start);
+            if (valid_tokens <= first_token)
+              continue;
+            auto row_offset = (row - row_start) * kv_head_group_size;
+            auto q_ptr_start = query_ptr + (query_start + row) * q_strideN +
+                head_group_start * q_strideH;
+            auto row_logits = logits + row_offset * block_size;
+            auto num_tokens = valid_tokens - first_token;
+            // 1) calculate the matmul(query, key) for the visible tokens
+            for (auto block_offset = first_token; block_offset < valid_tokens;
+                 block_offset++) {
+              reduce_head(
+                  q_ptr_start,
+                  kv_head_group_size,
+                  k_block_start + block_offset * k_block_strideP,
+                  row_logits + block_offset,
+                  block_size,
+                  head_size);
+            }
+            // 2) update the running max and exp_sum with this block
+            for (auto hi = 0; hi < kv_head_group_size; hi++) {
+              auto head_logits = row_logits + hi * block_size + first_token;
+              auto block_max = -std::numeric_limits<float>::infinity();
+              if (alibi_slopes_ptr != nullptr) {
+                _mul_alibi_reduce_max_fusion_kernel<float>(
+                    head_logits,
+                    scale,
+                    num_tokens,
+                    head_logits,
+                    block_max,
+                    token_start + first_token,
+                    query_pos + 1,
+                    alibi_slopes_ptr[head_group_start + hi]);
+              } else {
+                _mul_reduce_max_fusion_kernel<float>(
+                    head_logits, scale, num_tokens, head_logits, block_max);
+              }
+              auto old_max = max_logits[row_offset + hi];
+              auto new_max = std::max(old_max, block_max);
+              auto block_sum = new_max;
+              _exp_reduce_sum_fusion_kernel<float, float>(
+                  head_logits, num_tokens, head_logits, block_sum);
+              auto exp_val = expf(old_max - new_max);
+              exp_sums[row_offset + hi] =
+                  exp_sums[row_offset + hi] * exp_val + block_sum;
+              max_logits[row_offset + hi] = new_max;
+              if (logical_block_id > logical_block_start) {
+                at::vec::Vectorized<float> exp_val_vec(exp_val);
+                auto head_out = acc_out + (row_offset + hi) * head_size;
+                at::vec::map<float>(
+                    [&](auto a) { return a * exp_val_vec; },
+                    head_out,
+                    head_out,
+                    head_size);
+              }
+            }
+            // 3) accumulate matmul(exp(logits - max), value) of this block
+            for (auto block_offset = first_token; block_offset < valid_tokens;
+                 block_offset++) {
+              mul_attenion_weights_and_value_of_head(
+                  row_logits + block_offset,
+                  block_size,
+                  v_block_start + block_offset * k_block_strideP,
+                  acc_out + row_offset * head_size,
+                  head_size,
+                  kv_head_group_size,
+                  head_size,
+                  true);
+            }
+          }
+        }
+
+        // rescale with the exp_sum and copy into the output
+        for (auto row = row_start; row < row_end; row++) {
+          auto row_offset = (row - row_start) * kv_head_group_size;
+          for (auto hi = 0; hi < kv_head_group_size; hi++) {
+            auto attn_out_start = out_ptr + (query_start + row) * out_strideN +
+                (head_group_start + hi) * out_strideH;
+            float inverse_sum = 1.0 / (exp_sums[row_offset + hi] + 1e-8);
+            at::vec::Vectorized<float> inverse_sum_vec(inverse_sum);
+            at::vec::map<scalar_t>(
+                [&](auto a) { return a * inverse_sum_vec; },
+                attn_out_start,
+                acc_out + (row_offset + hi) * head_size,
+                head_size);
+          }
+        }
+      }
+    }
+  }
+} // multi_query_cached_kv_attention_kernel
+
 /**
  * Reshapes and caches the key and value tensors based on the provided slot
  * mapping.
@@ -510,6 +989,11 @@ void single_query_cached_kv_attention_kernel(
  * sequences. For sequence i, the slot_mapping[i]//block_number can get the
  * block index, and the slot_mapping%block_size can get the offset of this
  * block.
+ * @param k_scale The scales of the int8/fp8 key cache with the shape of
+ * [num_blocks, num_kv_heads, block_size]. Every head of every token is
+ * quantized with its own scale when it is stored.
+ * @param v_scale The scales of the int8/fp8 value cache with the shape of
+ * [num_blocks, num_kv_heads, block_size].
  *
  * @tparam DST_T The data type of the output tensors.
  * @tparam SRC_T The data type of the input tensors.
@@ -520,7 +1004,9 @@ void reshape_and_cache_kernel(
     at::Tensor& value,
     at::Tensor& key_cache,
     at::Tensor& value_cache,
-    at::Tensor& slot_mapping) {
+    at::Tensor& slot_mapping,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale) {
   auto num_tokens = key.size(0);
   auto head_num = key.size(1);
   auto head_size = key.size(2);
@@ -536,6 +1022,12 @@ void reshape_and_cache_kernel(
   auto cache_strideH = key_cache.stride(1);
   auto state_strideN = key.stride(0);
   auto state_strideH = key.stride(1);
+  auto k_scale_ptr = k_scale.has_value() ? k_scale.value().data_ptr<float>()
+                                         : nullptr;
+  auto v_scale_ptr = v_scale.has_value() ? v_scale.value().data_ptr<float>()
+                                         : nullptr;
+  auto scale_strideN = k_scale.has_value() ? k_scale.value().stride(0) : 0;
+  auto scale_strideH = k_scale.has_value() ? k_scale.value().stride(1) : 0;
 #pragma omp parallel for collapse(2)
   for (auto ti = 0; ti < num_tokens; ti++) {
     for (auto hi = 0; hi < head_num; hi++) {
@@ -548,14 +1040,65 @@ void reshape_and_cache_kernel(
       auto key_ptr_start = key_ptr + state_offset;
       auto value_cache_start = value_cache_ptr + cache_offset;
       auto value_ptr_start = value_ptr + state_offset;
-      torch_ipex::cpu::kernel::move_ker<DST_T, SRC_T>(
-          key_cache_start, key_ptr_start, head_size);
-      torch_ipex::cpu::kernel::move_ker<DST_T, SRC_T>(
-          value_cache_start, value_ptr_start, head_size);
+      if constexpr (is_quantized_kv_cache<DST_T>::value) {
+        auto scale_offset = physical_block_id * scale_strideN +
+            hi * scale_strideH + block_offset;
+        k_scale_ptr[scale_offset] =
+            quantize_kv_head(key_ptr_start, key_cache_start, head_size);
+        v_scale_ptr[scale_offset] =
+            quantize_kv_head(value_ptr_start, value_cache_start, head_size);
+      } else {
+        torch_ipex::cpu::kernel::move_ker<DST_T, SRC_T>(
+            key_cache_start, key_ptr_start, head_size);
+        torch_ipex::cpu::kernel::move_ker<DST_T, SRC_T>(
+            value_cache_start, value_ptr_start, head_size);
+      }
     }
   }
 }
 
+// Checks the scales of the int8/fp8 kv cache and calls func with a value of
+// the kv cache data type.
+template <typename scalar_t, typename func_t>
+inline void kv_cache_type_switch(
+    const at::Tensor& key_cache,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    const func_t& func) {
+  auto cache_type = key_cache.scalar_type();
+  if (cache_type == at::ScalarType::Char ||
+      cache_type == at::ScalarType::Float8_e5m2 ||
+      cache_type == at::ScalarType::Float8_e4m3fn) {
+    TORCH_CHECK(
+        k_scale.has_value() && v_scale.has_value(),
+        "k_scale and v_scale are required by the int8/fp8 kv cache");
+    for (auto& kv_scale : {k_scale.value(), v_scale.value()}) {
+      TORCH_CHECK(
+          kv_scale.scalar_type() == at::ScalarType::Float &&
+              kv_scale.dim() == 3 && kv_scale.size(0) == key_cache.size(0) &&
+              kv_scale.size(1) == key_cache.size(1) &&
+              kv_scale.size(2) == key_cache.size(2) &&
+              kv_scale.stride(2) == 1,
+          "the scales of the kv cache should be float with the shape of [num_blocks, num_kv_heads, block_size]");
+    }
+    TORCH_CHECK(
+        k_scale.value().strides() == v_scale.value().strides(),
+        "k_scale and v_scale should have the same strides");
+  }
+  if (cache_type == at::ScalarType::Char) {
+    func(int8_t());
+  } else if (cache_type == at::ScalarType::Float8_e5m2) {
+    func(fp8e5m2());
+  } else if (cache_type == at::ScalarType::Float8_e4m3fn) {
+    func(fp8e4m3());
+  } else {
+    TORCH_CHECK(
+        cache_type == c10::CppTypeToScalarType<scalar_t>::value,
+        "the kv cache should be int8, fp8 or the same data type as the query");
+    func(scalar_t());
+  }
+}
+
 void single_query_cached_kv_attention_kernel_impl(
     at::Tensor& out, // [num_seqs, num_heads, head_size]
     at::Tensor& query, // [num_seqs, num_heads, head_size]
@@ -567,60 +1110,166 @@ void single_query_cached_kv_attention_kernel_impl(
     at::Tensor& context_lens, // [num_seqs]
     int64_t block_size,
     int64_t max_context_len,
-    const c10::optional<at::Tensor>& alibi_slopes) {
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size) {
   RECORD_FUNCTION(
       "ipex::single_query_cached_kv_attention_kernel_impl",
       c10::ArrayRef<c10::IValue>({}));
   // dispatch kernel according to the data type of input tensor
   if (out.scalar_type() == at::ScalarType::Float) {
-    single_query_cached_kv_attention_kernel<float>(
-        out,
-        query,
-        key_cache,
-        value_cache,
-        scale,
-        block_tables,
-        context_lens,
-        block_size,
-        max_context_len,
-        alibi_slopes);
+    kv_cache_type_switch<float>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          single_query_cached_kv_attention_kernel<float, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              block_size,
+              max_context_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
   } else if (out.scalar_type() == at::ScalarType::BFloat16) {
-    single_query_cached_kv_attention_kernel<at::BFloat16>(
-        out,
-        query,
-        key_cache,
-        value_cache,
-        scale,
-        block_tables,
-        context_lens,
-        block_size,
-        max_context_len,
-        alibi_slopes);
+    kv_cache_type_switch<at::BFloat16>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          single_query_cached_kv_attention_kernel<at::BFloat16, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              block_size,
+              max_context_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
   } else if (out.scalar_type() == at::ScalarType::Half) {
-    single_query_cached_kv_attention_kernel<at::Half>(
-        out,
-        query,
-        key_cache,
-        value_cache,
-        scale,
-        block_tables,
-        context_lens,
-        block_size,
-        max_context_len,
-        alibi_slopes);
+    kv_cache_type_switch<at::Half>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          single_query_cached_kv_attention_kernel<at::Half, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              block_size,
+              max_context_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
   } else {
     TORCH_CHECK(
         false, "Unsupported data type for single_query_cached_kv_attention");
   }
 }
 
+void multi_query_cached_kv_attention_kernel_impl(
+    at::Tensor& out, // [num_tokens, num_heads, head_size]
+    at::Tensor& query, // [num_tokens, num_heads, head_size]
+    at::Tensor& key_cache, // [num_blocks, num_kv_heads, block_size, head_size]
+    at::Tensor& value_cache, // [num_blocks, num_kv_heads, block_size,
+                             // head_size]
+    const double scale,
+    at::Tensor& block_tables, // [num_seqs, max_num_blocks_per_seq]
+    at::Tensor& context_lens, // [num_seqs]
+    at::Tensor& query_start_loc, // [num_seqs + 1]
+    int64_t block_size,
+    int64_t max_query_len,
+    const c10::optional<at::Tensor>& alibi_slopes,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale,
+    int64_t window_size) {
+  RECORD_FUNCTION(
+      "ipex::multi_query_cached_kv_attention_kernel_impl",
+      c10::ArrayRef<c10::IValue>({}));
+  // dispatch kernel according to the data type of input tensor
+  if (out.scalar_type() == at::ScalarType::Float) {
+    kv_cache_type_switch<float>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          multi_query_cached_kv_attention_kernel<float, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              query_start_loc,
+              block_size,
+              max_query_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
+  } else if (out.scalar_type() == at::ScalarType::BFloat16) {
+    kv_cache_type_switch<at::BFloat16>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          multi_query_cached_kv_attention_kernel<at::BFloat16, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              query_start_loc,
+              block_size,
+              max_query_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
+  } else if (out.scalar_type() == at::ScalarType::Half) {
+    kv_cache_type_switch<at::Half>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          multi_query_cached_kv_attention_kernel<at::Half, decltype(cache_type)>(
+              out,
+              query,
+              key_cache,
+              value_cache,
+              scale,
+              block_tables,
+              context_lens,
+              query_start_loc,
+              block_size,
+              max_query_len,
+              alibi_slopes,
+              k_scale,
+              v_scale,
+              window_size);
+        });
+  } else {
+    TORCH_CHECK(
+        false, "Unsupported data type for multi_query_cached_kv_attention");
+  }
+}
+
 // void reshape_and_cache_kernel
 void reshape_and_cache_cpu_kernel_impl(
     at::Tensor& key,
     at::Tensor& value,
     at::Tensor& key_cache,
     at::Tensor& value_cache,
-    at::Tensor& slot_mapping) {
+    at::Tensor& slot_mapping,
+    const c10::optional<at::Tensor>& k_scale,
+    const c10::optional<at::Tensor>& v_scale) {
   TORCH_CHECK(
       key.scalar_type() == value.scalar_type(),
       "key and value should have the same data type");
@@ -633,27 +1282,191 @@ void reshape_and_cache_cpu_kernel_impl(
       "ipex::reshape_and_cache_cpu_kernel_impl",
       c10::ArrayRef<c10::IValue>({}));
   if (key.scalar_type() == at::ScalarType::Float) {
-    reshape_and_cache_kernel<float, float>(
-        key, value, key_cache, value_cache, slot_mapping);
+    kv_cache_type_switch<float>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          reshape_and_cache_kernel<decltype(cache_type), float>(
+              key,
+              value,
+              key_cache,
+              value_cache,
+              slot_mapping,
+              k_scale,
+              v_scale);
+        });
   } else if (key.scalar_type() == at::ScalarType::BFloat16) {
-    reshape_and_cache_kernel<at::BFloat16, at::BFloat16>(
-        key, value, key_cache, value_cache, slot_mapping);
+    kv_cache_type_switch<at::BFloat16>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          reshape_and_cache_kernel<decltype(cache_type), at::BFloat16>(
+              key,
+              value,
+              key_cache,
+              value_cache,
+              slot_mapping,
+              k_scale,
+              v_scale);
+        });
   } else if (key.scalar_type() == at::ScalarType::Half) {
-    reshape_and_cache_kernel<at::Half, at::Half>(
-        key, value, key_cache, value_cache, slot_mapping);
+    kv_cache_type_switch<at::Half>(
+        key_cache, k_scale, v_scale, [&](auto cache_type) {
+          reshape_and_cache_kernel<decltype(cache_type), at::Half>(
+              key,
+              value,
+              key_cache,
+              value_cache,
+              slot_mapping,
+              k_scale,
+              v_scale);
+        });
   } else {
     TORCH_CHECK(false, "Unsupported data type for ipex::reshape_and_cache");
   }
 }
 
+/**
+ * Copies the blocks of every layer in key_caches/value_caches. It is used by
+ * the copy-on-write of the shared prefix and the fork of beams.
+ *
+ * @param key_caches The key caches of all layers. Every cache should be
+ * contiguous and its first dimension should be the block index, so the scales
+ * of the int8/fp8 kv cache can be copied together by passing them here.
+ * @param value_caches The value caches of all layers.
+ * @param block_mapping The pairs of the source and destination block index
+ * with the shape of [num_pairs, 2].
+ */
+void copy_blocks_kernel_impl(
+    at::TensorList key_caches,
+    at::TensorList value_caches,
+    const at::Tensor& block_mapping) {
+  RECORD_FUNCTION(
+      "ipex::copy_blocks_kernel_impl", c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      key_caches.size() == value_caches.size(),
+      "key_caches and value_caches should have the same number of layers");
+  TORCH_CHECK(
+      block_mapping.dim() == 2 && block_mapping.size(1) == 2,
+      "block_mapping should be with the shape of [num_pairs, 2]");
+  int64_t num_layers = key_caches.size();
+  auto num_pairs = block_mapping.size(0);
+  if (num_layers == 0 || num_pairs == 0) {
+    return;
+  }
+  auto block_mapping_contig =
+      block_mapping.to(at::ScalarType::Long).contiguous();
+  auto block_mapping_ptr = block_mapping_contig.data_ptr<int64_t>();
+
+  // the base address and the block bytes of every cache tensor
+  std::vector<char*> cache_ptrs(num_layers * 2);
+  std::vector<int64_t> block_bytes(num_layers * 2);
+  auto num_blocks = std::numeric_limits<int64_t>::max();
+  for (auto layer_id = 0; layer_id < num_layers; layer_id++) {
+    for (auto kv_id = 0; kv_id < 2; kv_id++) {
+      auto& cache = kv_id == 0 ? key_caches[layer_id] : value_caches[layer_id];
+      TORCH_CHECK(cache.is_contiguous(), "the kv cache should be contiguous");
+      cache_ptrs[layer_id * 2 + kv_id] = static_cast<char*>(cache.data_ptr());
+      block_bytes[layer_id * 2 + kv_id] = cache.stride(0) * cache.element_size();
+      num_blocks = std::min(num_blocks, cache.size(0));
+    }
+  }
+  for (auto pair_id = 0; pair_id < num_pairs; pair_id++) {
+    for (auto i = 0; i < 2; i++) {
+      auto block_id = block_mapping_ptr[pair_id * 2 + i];
+      TORCH_CHECK(
+          block_id >= 0 && block_id < num_blocks,
+          "block index ",
+          block_id,
+          " in block_mapping is out of range");
+    }
+  }
+
+  at::parallel_for(
+      0, num_layers * 2 * num_pairs, 1, [&](int64_t begin, int64_t end) {
+        for (auto task_id = begin; task_id < end; task_id++) {
+          auto cache_id = task_id / num_pairs;
+          auto pair_id = task_id % num_pairs;
+          auto src_block_id = block_mapping_ptr[pair_id * 2];
+          auto dst_block_id = block_mapping_ptr[pair_id * 2 + 1];
+          auto bytes = block_bytes[cache_id];
+          std::memcpy(
+              cache_ptrs[cache_id] + dst_block_id * bytes,
+              cache_ptrs[cache_id] + src_block_id * bytes,
+              bytes);
+        }
+      });
+}
+
+/**
+ * Copies the blocks from src to dst, e.g. swaps the blocks between the active
+ * cache and the overflow pool.
+ *
+ * @param src The source cache. It should be contiguous and its first dimension
+ * should be the block index.
+ * @param dst The destination cache with the same block layout as src.
+ * @param block_mapping The pairs of the source and destination block index
+ * with the shape of [num_pairs, 2].
+ */
+void swap_blocks_kernel_impl(
+    at::Tensor& src,
+    at::Tensor& dst,
+    const at::Tensor& block_mapping) {
+  RECORD_FUNCTION(
+      "ipex::swap_blocks_kernel_impl", c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      src.is_contiguous() && dst.is_contiguous(),
+      "src and dst should be contiguous");
+  TORCH_CHECK(
+      src.scalar_type() == dst.scalar_type() &&
+          src.sizes().slice(1) == dst.sizes().slice(1),
+      "src and dst should have the same data type and block shape");
+  TORCH_CHECK(
+      block_mapping.dim() == 2 && block_mapping.size(1) == 2,
+      "block_mapping should be with the shape of [num_pairs, 2]");
+  auto num_pairs = block_mapping.size(0);
+  auto block_mapping_contig =
+      block_mapping.to(at::ScalarType::Long).contiguous();
+  auto block_mapping_ptr = block_mapping_contig.data_ptr<int64_t>();
+  for (auto pair_id = 0; pair_id < num_pairs; pair_id++) {
+    auto src_block_id = block_mapping_ptr[pair_id * 2];
+    auto dst_block_id = block_mapping_ptr[pair_id * 2 + 1];
+    TORCH_CHECK(
+        src_block_id >= 0 && src_block_id < src.size(0) &&
+            dst_block_id >= 0 && dst_block_id < dst.size(0),
+        "block index in block_mapping is out of range");
+  }
+  auto src_ptr = static_cast<char*>(src.data_ptr());
+  auto dst_ptr = static_cast<char*>(dst.data_ptr());
+  auto block_bytes = src.stride(0) * src.element_size();
+  // split the big blocks so that a few pairs still use all the threads
+  constexpr int64_t chunk_bytes = 64 * 1024;
+  auto num_chunks = (block_bytes + chunk_bytes - 1) / chunk_bytes;
+  at::parallel_for(
+      0, num_pairs * num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (auto task_id = begin; task_id < end; task_id++) {
+          auto pair_id = task_id / num_chunks;
+          auto chunk_start = task_id % num_chunks * chunk_bytes;
+          auto bytes = std::min(chunk_bytes, block_bytes - chunk_start);
+          std::memcpy(
+              dst_ptr + block_mapping_ptr[pair_id * 2 + 1] * block_bytes +
+                  chunk_start,
+              src_ptr + block_mapping_ptr[pair_id * 2] * block_bytes +
+                  chunk_start,
+              bytes);
+        }
+      });
+}
+
 } // namespace
 
 IPEX_REGISTER_DISPATCH(
     single_query_cached_kv_attention_kernel_stub,
     &single_query_cached_kv_attention_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    multi_query_cached_kv_attention_kernel_stub,
+    &multi_query_cached_kv_attention_kernel_impl);
 IPEX_REGISTER_DISPATCH(
     reshape_and_cache_kernel_stub,
     &reshape_and_cache_cpu_kernel_impl);
+IPEX_REGISTER_DISPATCH(copy_blocks_kernel_stub, &copy_blocks_kernel_impl);
+IPEX_REGISTER_DISPATCH(swap_blocks_kernel_stub, &swap_blocks_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -0,0 +1,519 @@
+#include <ATen/Parallel.h>
+#include <ATen/Tensor.h>
+#include <ATen/record_function.h>
+#include <aten/MergedEmbeddingBag.h>
+#include <aten/RowwiseQuantizedMergedEmb.h>
+#include <aten/fp8_utils.h>
+#include <torch/all.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include "vec/vec.h"
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at;
+
+inline float row_scale(const uint8_t* row, int64_t data_bytes) {
+  float scale;
+  std::memcpy(&scale, row + data_bytes, sizeof(float));
+  return scale;
+}
+
+inline float row_bias(const uint8_t* row, int64_t data_bytes) {
+  float bias;
+  std::memcpy(&bias, row + data_bytes + sizeof(float), sizeof(float));
+  return bias;
+}
+
+inline void set_row_scale_bias(
+    uint8_t* row,
+    int64_t data_bytes,
+    float scale,
+    float bias) {
+  std::memcpy(row + data_bytes, &scale, sizeof(float));
+  std::memcpy(row + data_bytes + sizeof(float), &bias, sizeof(float));
+}
+
+// Asymmetric quantization of a row to [0, qmax], returns the scale and the
+// bias (the min of the row)
+inline std::pair<float, float> rowwise_min_max_qparams(
+    const float* src,
+    int64_t emb_dim,
+    float qmax) {
+  float min = src[0];
+  float max = src[0];
+  for (int64_t d = 1; d < emb_dim; d++) {
+    min = std::min(min, src[d]);
+    max = std::max(max, src[d]);
+  }
+  float scale = (max - min) / qmax;
+  // a constant row is exactly its bias
+  return {scale > 0.f ? scale : 1.f, min};
+}
+
+inline uint8_t quantize_val(float x, float inv_scale, float bias, float qmax) {
+  float q = std::nearbyint((x - bias) * inv_scale);
+  return (uint8_t)std::min(std::max(q, 0.f), qmax);
+}
+
+// The row-wise quantized dtypes. load(row, d) returns element d of a row
+// without its scale and bias, load16/load8 the 16/8 elements from d. The
+// kernels call them on an instance made once per call, which holds the state
+// of the dequantization.
+
+struct RowwiseInt8 {
+  static int64_t data_bytes(int64_t emb_dim) {
+    return emb_dim;
+  }
+
+  static void quantize(const float* src, uint8_t* row, int64_t emb_dim) {
+    float scale, bias;
+    std::tie(scale, bias) = rowwise_min_max_qparams(src, emb_dim, 255.f);
+    float inv_scale = 1.f / scale;
+    for (int64_t d = 0; d < emb_dim; d++) {
+      row[d] = quantize_val(src[d], inv_scale, bias, 255.f);
+    }
+    set_row_scale_bias(row, emb_dim, scale, bias);
+  }
+
+  static float load(const uint8_t* row, int64_t d) {
+    return row[d];
+  }
+
+#if defined(CPU_CAPABILITY_AVX512)
+  static __m512 load16(const uint8_t* row, int64_t d) {
+    __m128i q = _mm_loadu_si128((const __m128i*)(row + d));
+    return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(q));
+  }
+#elif defined(CPU_CAPABILITY_AVX2)
+  static __m256 load8(const uint8_t* row, int64_t d) {
+    __m128i q = _mm_loadl_epi64((const __m128i*)(row + d));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(q));
+  }
+#endif
+};
+
+struct RowwiseInt4 {
+  static int64_t data_bytes(int64_t emb_dim) {
+    return (emb_dim + 1) / 2;
+  }
+
+  static void quantize(const float* src, uint8_t* row, int64_t emb_dim) {
+    float scale, bias;
+    std::tie(scale, bias) = rowwise_min_max_qparams(src, emb_dim, 15.f);
+    float inv_scale = 1.f / scale;
+    for (int64_t d = 0; d < emb_dim; d += 2) {
+      uint8_t lo = quantize_val(src[d], inv_scale, bias, 15.f);
+      uint8_t hi = d + 1 < emb_dim
+          ? quantize_val(src[d + 1], inv_scale, bias, 15.f)
+          : 0;
+      row[d / 2] = lo | (hi << 4);
+    }
+    set_row_scale_bias(row, data_bytes(emb_dim), scale, bias);
+  }
+
+  static float load(const uint8_t* row, int64_t d) {
+    return (row[d / 2] >> ((d & 1) * 4)) & 0xF;
+  }
+
+#if defined(CPU_CAPABILITY_AVX512) || defined(CPU_CAPABILITY_AVX2)
+  // interleaves the low and high nibbles of the bytes into bytes
+  static __m128i unpack_nibbles(__m128i packed) {
+    const __m128i mask = _mm_set1_epi8(0xF);
+    __m128i lo = _mm_and_si128(packed, mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+    return _mm_unpacklo_epi8(lo, hi);
+  }
+#endif
+
+#if defined(CPU_CAPABILITY_AVX512)
+  static __m512 load16(const uint8_t* row, int64_t d) {
+    __m128i q = unpack_nibbles(_mm_loadl_epi64((const __m128i*)(row + d / 2)));
+    return _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(q));
+  }
+#elif defined(CPU_CAPABILITY_AVX2)
+  static __m256 load8(const uint8_t* row, int64_t d) {
+    int32_t packed;
+    std::memcpy(&packed, row + d / 2, sizeof(packed));
+    __m128i q = unpack_nibbles(_mm_cvtsi32_si128(packed));
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(q));
+  }
+#endif
+};
+
+struct RowwiseFp8 {
+  // fetched once, fp8e4m3_to_float_lut() checks the init guard of the table
+  const float* lut = fp8e4m3_to_float_lut();
+
+  static int64_t data_bytes(int64_t emb_dim) {
+    return emb_dim;
+  }
+
+  static void quantize(const float* src, uint8_t* row, int64_t emb_dim) {
+    // the max normal of e4m3
+    constexpr float kFp8Max = 448.f;
+    float amax = 0.f;
+    for (int64_t d = 0; d < emb_dim; d++) {
+      amax = std::max(amax, std::abs(src[d]));
+    }
+    float scale = amax > 0.f ? amax / kFp8Max : 1.f;
+    float inv_scale = 1.f / scale;
+    for (int64_t d = 0; d < emb_dim; d++) {
+      float x = std::min(std::max(src[d] * inv_scale, -kFp8Max), kFp8Max);
+      row[d] = fp8e4m3(x).x;
+    }
+    set_row_scale_bias(row, emb_dim, scale, 0.f);
+  }
+
+  float load(const uint8_t* row, int64_t d) const {
+    return lut[row[d]];
+  }
+
+#if defined(CPU_CAPABILITY_AVX512)
+  __m512 load16(const uint8_t* row, int64_t d) const {
+    __m128i q = _mm_loadu_si128((const __m128i*)(row + d));
+    return _mm512_i32gather_ps(_mm512_cvtepu8_epi32(q), lut, sizeof(float));
+  }
+#elif defined(CPU_CAPABILITY_AVX2)
+  __m256 load8(const uint8_t* row, int64_t d) const {
+    __m128i q = _mm_loadl_epi64((const __m128i*)(row + d));
+    return _mm256_i32gather_ps(lut, _mm256_cvtepu8_epi32(q), sizeof(float));
+  }
+#endif
+};
+
+template <typename F>
+inline void dispatch_rowwise_dtype(at::ScalarType dtype, const F& f) {
+  switch (dtype) {
+    case at::kByte:
+      f(RowwiseInt8());
+      break;
+    case at::kQUInt4x2:
+      f(RowwiseInt4());
+      break;
+    case at::kFloat8_e4m3fn:
+      f(RowwiseFp8());
+      break;
+    default:
+      TORCH_CHECK(
+          false,
+          "row-wise quantized embedding only supports uint8, quint4x2 and "
+          "float8_e4m3fn, got ",
+          dtype);
+  }
+}
+
+// Pools the bags [bs_begin, bs_end) of a row-wise quantized table into fp32.
+// The dequantization is fused into the accumulation, each row adds
+// data * scale to the accumulator, and the biases of the rows, the same for
+// all the elements, are summed once per bag.
+template <typename qtype_t, typename index_t>
+inline void rowwise_embeddingbag_kern(
+    const qtype_t& qtype,
+    const int64_t bs_begin,
+    const int64_t bs_end,
+    const int64_t emb_dim,
+    const index_t last_offset,
+    const index_t* indices,
+    const index_t* offsets,
+    const uint8_t* weight,
+    float* result,
+    const int64_t result_stride,
+    const int64_t pooling_mode) {
+  const int64_t data_bytes = qtype_t::data_bytes(emb_dim);
+  const int64_t row_bytes = data_bytes + 2 * sizeof(float);
+  for (int64_t b = bs_begin; b < bs_end; ++b) {
+    int64_t start_idx = offsets[b];
+    int64_t end_idx =
+        ((b + 1) == bs_end && last_offset != -1) ? last_offset : offsets[b + 1];
+    float bias_sum = 0.f;
+    for (int64_t j = start_idx; j < end_idx; ++j) {
+      bias_sum +=
+          row_bias(weight + (int64_t)indices[j] * row_bytes, data_bytes);
+    }
+    float out_scale = (pooling_mode == MEAN && end_idx > start_idx)
+        ? 1.f / (end_idx - start_idx)
+        : 1.f;
+    int64_t i = 0;
+#if defined(CPU_CAPABILITY_AVX512)
+    for (; i + 16 <= emb_dim; i += 16) {
+      __m512 acc = _mm512_set1_ps(bias_sum);
+      for (int64_t j = start_idx; j < end_idx; ++j) {
+        const uint8_t* row = weight + (int64_t)indices[j] * row_bytes;
+        acc = _mm512_fmadd_ps(
+            qtype.load16(row, i),
+            _mm512_set1_ps(row_scale(row, data_bytes)),
+            acc);
+      }
+      _mm512_storeu_ps(
+          result + i, _mm512_mul_ps(acc, _mm512_set1_ps(out_scale)));
+    }
+#elif defined(CPU_CAPABILITY_AVX2)
+    for (; i + 8 <= emb_dim; i += 8) {
+      __m256 acc = _mm256_set1_ps(bias_sum);
+      for (int64_t j = start_idx; j < end_idx; ++j) {
+        const uint8_t* row = weight + (int64_t)indices[j] * row_bytes;
+        acc = _mm256_fmadd_ps(
+            qtype.load8(row, i),
+            _mm256_set1_ps(row_scale(row, data_bytes)),
+            acc);
+      }
+      _mm256_storeu_ps(
+          result + i, _mm256_mul_ps(acc, _mm256_set1_ps(out_scale)));
+    }
+#endif
+    // scalar tail
+    for (; i < emb_dim; ++i) {
+      float acc = bias_sum;
+      for (int64_t j = start_idx; j < end_idx; ++j) {
+        const uint8_t* row = weight + (int64_t)indices[j] * row_bytes;
+        acc += qtype.load(row, i) * row_scale(row, data_bytes);
+      }
+      result[i] = acc * out_scale;
+    }
+    result += result_stride;
+  }
+}
+
+// o_ptr[0] is the output of the dense feature, which is copied when dense is
+// not null, o_ptr[1 + m] the output of table m. The rows of all the outputs
+// are o_stride apart.
+template <typename qtype_t, typename index_t>
+void rowwise_merged_embeddingbag(
+    const qtype_t& qtype,
+    float** o_ptr,
+    const int64_t o_stride,
+    const float* dense,
+    const uint8_t** w_ptr,
+    index_t** indices_ptr,
+    index_t** offsets_ptr,
+    int64_t num_batch,
+    int64_t num_emb,
+    int64_t emb_dim,
+    const std::vector<int64_t>& last_offsets,
+    int64_t pooling_mode) {
+  constexpr int64_t b_block = 128;
+  const int64_t n_b_blocks = (num_batch - 1) / b_block + 1;
+  const int64_t n_begin = dense ? 0 : 1;
+#pragma omp parallel for collapse(2)
+  for (int64_t b = 0; b < n_b_blocks; ++b) {
+    for (int64_t n = n_begin; n < (num_emb + 1); ++n) {
+      const int64_t bs_begin = b * b_block;
+      const int64_t bs_end = std::min(num_batch, (b + 1) * b_block);
+      float* r = o_ptr[n] + bs_begin * o_stride;
+      if (n == 0) {
+        for (int64_t bs = bs_begin; bs < bs_end; ++bs) {
+          std::memcpy(r, &dense[bs * emb_dim], emb_dim * sizeof(float));
+          r += o_stride;
+        }
+      } else {
+        const int64_t m = n - 1;
+        // avoid offsets not include last batch
+        const index_t last_offset = bs_end == num_batch ? last_offsets[m] : -1;
+        rowwise_embeddingbag_kern<qtype_t, index_t>(
+            qtype,
+            bs_begin,
+            bs_end,
+            emb_dim,
+            last_offset,
+            indices_ptr[m],
+            offsets_ptr[m],
+            w_ptr[m],
+            r,
+            o_stride,
+            pooling_mode);
+      }
+    }
+  }
+}
+
+void check_rowwise_inputs(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    at::ScalarType dtype,
+    int64_t emb_dim) {
+  int64_t num_emb = qweights.size();
+  TORCH_CHECK(
+      num_emb > 0 && num_emb == indices.size() && num_emb == offsets.size(),
+      "merged_embeddingbag_rowwise: expect the same number of tables, indices "
+      "and offsets");
+  int64_t row_bytes = rowwise_quantized_row_bytes(dtype, emb_dim);
+  auto index_type = indices[0].scalar_type();
+  for (int i = 0; i < num_emb; i++) {
+    TORCH_CHECK(
+        qweights[i].is_contiguous() && qweights[i].scalar_type() == at::kByte &&
+            qweights[i].dim() == 2 && qweights[i].size(1) == row_bytes,
+        "merged_embeddingbag_rowwise: expect contiguous uint8 tables of ",
+        row_bytes,
+        " bytes per row");
+    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
+        indices[i].is_contiguous() && indices[i].scalar_type() == index_type);
+    TORCH_INTERNAL_ASSERT_DEBUG_ONLY(
+        offsets[i].is_contiguous() && offsets[i].scalar_type() == index_type);
+  }
+}
+
+Tensor rowwise_quantize_embedding_kernel_impl(
+    const Tensor& weight,
+    at::ScalarType dtype) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.size(1) > 0,
+      "merged_embeddingbag_rowwise_quantize: expect a 2D table");
+  auto weight_ = weight.to(at::kFloat).contiguous();
+  int64_t num_rows = weight_.size(0);
+  int64_t emb_dim = weight_.size(1);
+  int64_t row_bytes = rowwise_quantized_row_bytes(dtype, emb_dim);
+  auto qweight =
+      at::empty({num_rows, row_bytes}, weight_.options().dtype(kByte));
+  const float* w_ptr = weight_.data_ptr<float>();
+  uint8_t* q_ptr = qweight.data_ptr<uint8_t>();
+  dispatch_rowwise_dtype(dtype, [&](auto tag) {
+    using qtype_t = decltype(tag);
+    at::parallel_for(0, num_rows, 64, [&](int64_t begin, int64_t end) {
+      for (int64_t r = begin; r < end; r++) {
+        qtype_t::quantize(
+            w_ptr + r * emb_dim, q_ptr + r * row_bytes, emb_dim);
+      }
+    });
+  });
+  return qweight;
+}
+
+std::vector<Tensor> rowwise_merged_embeddingbag_forward_kernel_impl(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const int64_t pooling_mode,
+    const bool include_last_offsets,
+    at::ScalarType dtype,
+    const int64_t emb_dim) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  check_rowwise_inputs(qweights, indices, offsets, dtype, emb_dim);
+  int64_t num_emb = qweights.size();
+  int64_t batch_size = offsets[0].size(0);
+  if (include_last_offsets) {
+    batch_size -= 1;
+  }
+
+  std::vector<int64_t> last_offsets(num_emb, -1);
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < num_emb; i++) {
+    // handle last offsets
+    last_offsets[i] = indices[i].numel();
+    outputs.emplace_back(
+        empty({batch_size, emb_dim}, qweights[i].options().dtype(kFloat)));
+  }
+
+  dispatch_rowwise_dtype(dtype, [&](auto tag) {
+    using qtype_t = decltype(tag);
+    AT_DISPATCH_INDEX_TYPES(
+        indices[0].scalar_type(), "merged_embeddingbag_rowwise", [&] {
+          float* outputs_ptr[num_emb + 1];
+          const uint8_t* weights_ptr[num_emb];
+          index_t* indices_ptr[num_emb];
+          index_t* offsets_ptr[num_emb];
+          outputs_ptr[0] = nullptr;
+          for (int i = 0; i < num_emb; i++) {
+            outputs_ptr[i + 1] = outputs[i].data_ptr<float>();
+            weights_ptr[i] = qweights[i].data_ptr<uint8_t>();
+            indices_ptr[i] = indices[i].data_ptr<index_t>();
+            offsets_ptr[i] = offsets[i].data_ptr<index_t>();
+          }
+          rowwise_merged_embeddingbag<qtype_t, index_t>(
+              tag,
+              outputs_ptr,
+              /*o_stride=*/emb_dim,
+              /*dense=*/nullptr,
+              weights_ptr,
+              indices_ptr,
+              offsets_ptr,
+              batch_size,
+              num_emb,
+              emb_dim,
+              last_offsets,
+              pooling_mode);
+        });
+  });
+  return outputs;
+}
+
+Tensor rowwise_merged_embeddingbag_cat_forward_kernel_impl(
+    const TensorList& qweights,
+    const TensorList& indices,
+    const TensorList& offsets,
+    const Tensor& dense,
+    at::ScalarType dtype) {
+  RECORD_FUNCTION(__FUNCTION__, c10::ArrayRef<c10::IValue>({}));
+  TORCH_CHECK(
+      dense.dim() == 2 && dense.scalar_type() == at::kFloat,
+      "merged_embeddingbag_rowwise_cat: expect a 2D float dense feature");
+  auto dense_ = dense.contiguous();
+  int64_t batch_size = dense_.size(0);
+  int64_t emb_dim = dense_.size(1);
+  check_rowwise_inputs(qweights, indices, offsets, dtype, emb_dim);
+  int64_t num_emb = qweights.size();
+
+  std::vector<int64_t> last_offsets(num_emb, -1);
+  for (int i = 0; i < num_emb; i++) {
+    // handle last offsets
+    last_offsets[i] = indices[i].numel();
+  }
+
+  Tensor output =
+      empty({batch_size, (num_emb + 1) * emb_dim}, dense_.options());
+
+  dispatch_rowwise_dtype(dtype, [&](auto tag) {
+    using qtype_t = decltype(tag);
+    AT_DISPATCH_INDEX_TYPES(
+        indices[0].scalar_type(), "merged_embeddingbag_rowwise_cat", [&] {
+          float* outputs_ptr[num_emb + 1];
+          const uint8_t* weights_ptr[num_emb];
+          index_t* indices_ptr[num_emb];
+          index_t* offsets_ptr[num_emb];
+          for (int i = 0; i < num_emb + 1; i++) {
+            outputs_ptr[i] = output.data_ptr<float>() + i * emb_dim;
+          }
+          for (int i = 0; i < num_emb; i++) {
+            weights_ptr[i] = qweights[i].data_ptr<uint8_t>();
+            indices_ptr[i] = indices[i].data_ptr<index_t>();
+            offsets_ptr[i] = offsets[i].data_ptr<index_t>();
+          }
+          rowwise_merged_embeddingbag<qtype_t, index_t>(
+              tag,
+              outputs_ptr,
+              /*o_stride=*/(num_emb + 1) * emb_dim,
+              dense_.data_ptr<float>(),
+              weights_ptr,
+              indices_ptr,
+              offsets_ptr,
+              batch_size,
+              num_emb,
+              emb_dim,
+              last_offsets,
+              SUM);
+        });
+  });
+  return output;
+}
+
+} // anonymous namespace
+
+IPEX_REGISTER_DISPATCH(
+    rowwise_quantize_embedding_kernel_stub,
+    &rowwise_quantize_embedding_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    rowwise_merged_embeddingbag_forward_kernel_stub,
+    &rowwise_merged_embeddingbag_forward_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    rowwise_merged_embeddingbag_cat_forward_kernel_stub,
+    &rowwise_merged_embeddingbag_cat_forward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -11,9 +11,28 @@ namespace cpu {
 
 namespace {
 
-enum shm_state { INIT = 0, RANK0_COPY = 1, RANKX_COPY_ADD = 2, BROADCAST = 3 };
+enum shm_state {
+  INIT = 0,
+  RANK0_COPY = 1,
+  RANKX_COPY_ADD = 2,
+  BROADCAST = 3,
+  // states of the reduce-scatter + all-gather algorithm
+  SLOT_COPY = 4,
+  SLICE_REDUCE = 5,
+  GATHER = 6
+};
 enum shm_block_state { INIT_BLOCK = 0, COPY_ADD_DONE_BLOCK = 1 };
 
+// The reduce-scatter + all-gather algorithm has a fixed number of
+// synchronizations, while the serial chain of reduceAdd_impl hands over
+// world_size times. The chain is only kept for 2 ranks, where both are
+// equivalent, and for the messages that do not fit in the per-rank slots.
+#define SHM_RS_AG_MIN_WORLD_SIZE 3
+// slices are aligned to a cache line of floats
+#define SHM_RS_AG_SLICE_ALIGN 16
+// number of elements sharing a scale in the int8 all-reduce
+#define SHM_INT8_BLOCK 64
+
 inline void wait_state_until(
     int* states_ptr,
     const int index,
@@ -32,6 +51,15 @@ inline void wait_block_until(
     _mm_pause();
 }
 
+inline void wait_state_at_least(
+    int* states_ptr,
+    const int index,
+    enum shm_state state) {
+  volatile int* state_ptr = states_ptr + index;
+  while (*state_ptr < state)
+    _mm_pause();
+}
+
 template <typename DST_T, typename SRC_T>
 static inline void multiThreadCopy(DST_T* dst, SRC_T* src, int size) {
   RECORD_FUNCTION("multiThreadCopy", c10::ArrayRef<c10::IValue>({}));
@@ -56,6 +84,7 @@ static inline void multiThreadCopy(DST_T* dst, SRC_T* src, int size) {
  * all-reduce, e.g, initialized or last round all-reduce finished; 1: rank-0
  * copy ready; 2: finish add for other ranks; 3: finish broadcast
  * @tparam T The data type of the elements in the buffers.
+ * @tparam W The data type of the elements in the shared memory buffer.
  * @param sendBuf Pointer to the send buffer.
  * @param recvBuf Pointer to the receive buffer.
  * @param t_address The tensor of the shared memory buffer.
@@ -67,7 +96,7 @@ static inline void multiThreadCopy(DST_T* dst, SRC_T* src, int size) {
  * @param rank The rank of the current process.
  * @param rankSize The total number of processes.
  */
-template <typename T>
+template <typename T, typename W>
 void reduceAdd_impl(
     T* sendBuf,
     T* recvBuf,
@@ -83,7 +112,7 @@ void reduceAdd_impl(
   int nBlockBytes = shm_block_size * element_size;
   int nblocks = (size + shm_block_size - 1) / shm_block_size;
   int nthreads = std::min(nblocks, omp_get_max_threads());
-  float* address = (float*)t_address.data_ptr();
+  W* address = (W*)t_address.data_ptr();
   uint8_t* block_states_ptr = (uint8_t*)t_blockState.data_ptr();
   int* states_ptr = t_state.data_ptr<int>();
   {
@@ -93,7 +122,7 @@ void reduceAdd_impl(
       for (int i = 1; i < rankSize; i++) {
         wait_state_until(states_ptr, i, INIT);
       }
-      multiThreadCopy<float, T>(address, sendBuf, size);
+      multiThreadCopy<W, T>(address, sendBuf, size);
 
     } else {
       wait_state_until(states_ptr, rank, INIT);
@@ -122,7 +151,7 @@ void reduceAdd_impl(
               blockIndex * rankSize + rank - 1,
               COPY_ADD_DONE_BLOCK);
         }
-        torch_ipex::cpu::kernel::add_ker<float, T>(
+        torch_ipex::cpu::kernel::add_ker<W, T>(
             lAddrBuf, lSendBuf, realBlockSize);
         std::atomic_thread_fence(std::memory_order_release);
         block_states_ptr[blockIndex * rankSize + rank - 1] = INIT_BLOCK;
@@ -137,7 +166,7 @@ void reduceAdd_impl(
     RECORD_FUNCTION(
         "ipex::shm_all_reduce_add::broadcast", c10::ArrayRef<c10::IValue>({}));
     wait_state_until(states_ptr, rankSize - 1, RANKX_COPY_ADD);
-    multiThreadCopy<T, float>(recvBuf, address, size);
+    multiThreadCopy<T, W>(recvBuf, address, size);
     if (rank == rankSize - 1) {
       for (int i = 0; i < rankSize - 1; i++) {
         wait_state_until(states_ptr, i, BROADCAST);
@@ -154,7 +183,259 @@ void reduceAdd_impl(
   }
 }
 
-at::Tensor shm_all_reduce_add_kernel_impl(
+/**
+ * @brief Performs the same reduction as reduceAdd_impl with a reduce-scatter
+ * followed by an all-gather. The shared memory buffer is split into one slot
+ * per rank and the message into one slice per rank:
+ * 1. every rank copies its send buffer into its own slot;
+ * 2. once all the slots are ready, every rank adds the slice it owns from
+ * the slots of all the peers into its own slot;
+ * 3. once all the slices are reduced, every rank copies the reduced slices
+ * of all the slots into its receive buffer.
+ * Each rank adds only size / rankSize elements and the ranks do not depend
+ * on each other but for the two barriers. Rank 0 resets the states once
+ * every rank has finished the all-gather. The slices are accumulated in fp32
+ * whatever the type of the shared memory buffer, so the result is rounded
+ * only once.
+ * @tparam T The data type of the elements in the buffers.
+ * @tparam W The data type of the elements in the shared memory buffer.
+ * @param sendBuf Pointer to the send buffer.
+ * @param recvBuf Pointer to the receive buffer.
+ * @param t_address The tensor of the shared memory buffer.
+ * @param t_state The tensor of the state.
+ * @param slot_size The number of elements of the slot of each rank.
+ * @param size The number of elements in the buffers.
+ * @param rank The rank of the current process.
+ * @param rankSize The total number of processes.
+ */
+template <typename T, typename W>
+void reduceScatterAllGather_impl(
+    T* sendBuf,
+    T* recvBuf,
+    at::Tensor t_address,
+    at::Tensor t_state,
+    int64_t slot_size,
+    int64_t size,
+    int rank,
+    int rankSize) {
+  W* address = (W*)t_address.data_ptr();
+  int* states_ptr = t_state.data_ptr<int>();
+  int64_t slice_size = (size + rankSize - 1) / rankSize;
+  slice_size = (slice_size + SHM_RS_AG_SLICE_ALIGN - 1) /
+      SHM_RS_AG_SLICE_ALIGN * SHM_RS_AG_SLICE_ALIGN;
+  auto slice_start = [&](int r) { return std::min(size, r * slice_size); };
+  auto slice_len = [&](int r) {
+    return std::min(size, (r + 1) * slice_size) - slice_start(r);
+  };
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::slot_copy", c10::ArrayRef<c10::IValue>({}));
+    wait_state_until(states_ptr, rank, INIT);
+    multiThreadCopy<W, T>(address + rank * slot_size, sendBuf, size);
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = SLOT_COPY;
+  }
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::reduce_scatter",
+        c10::ArrayRef<c10::IValue>({}));
+    for (int i = 0; i < rankSize; i++) {
+      wait_state_at_least(states_ptr, i, SLOT_COPY);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto start = slice_start(rank);
+    auto len = slice_len(rank);
+    constexpr int64_t chunk_size = 512;
+    int64_t nchunks = (len + chunk_size - 1) / chunk_size;
+    auto dst = address + rank * slot_size + start;
+#pragma omp parallel for
+    for (int64_t c = 0; c < nchunks; c++) {
+      auto offset = c * chunk_size;
+      auto chunk_len = std::min(chunk_size, len - offset);
+      alignas(64) float acc[chunk_size];
+      torch_ipex::cpu::kernel::move_ker<float, W>(
+          acc, dst + offset, chunk_len);
+      for (int i = 1; i < rankSize; i++) {
+        int peer = (rank + i) % rankSize;
+        auto src = address + peer * slot_size + start + offset;
+        torch_ipex::cpu::kernel::add_ker<float, W>(acc, src, chunk_len);
+      }
+      torch_ipex::cpu::kernel::move_ker<W, float>(
+          dst + offset, acc, chunk_len);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = SLICE_REDUCE;
+  }
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::all_gather", c10::ArrayRef<c10::IValue>({}));
+    for (int i = 0; i < rankSize; i++) {
+      wait_state_at_least(states_ptr, i, SLICE_REDUCE);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    for (int i = 0; i < rankSize; i++) {
+      int peer = (rank + i) % rankSize;
+      auto start = slice_start(peer);
+      multiThreadCopy<T, W>(
+          recvBuf + start, address + peer * slot_size + start, slice_len(peer));
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = GATHER;
+    if (rank == 0) {
+      for (int i = 0; i < rankSize; i++) {
+        wait_state_until(states_ptr, i, GATHER);
+      }
+      for (int i = 0; i < rankSize; i++) {
+        std::atomic_thread_fence(std::memory_order_release);
+        states_ptr[i] = INIT;
+      }
+    }
+  }
+}
+
+// Quantizes len (<= SHM_INT8_BLOCK) elements with a symmetric fp32 scale
+template <typename T>
+inline void quantize_int8_block(
+    int8_t* dst,
+    float* scale,
+    const T* src,
+    int64_t len) {
+  float amax = 0.f;
+#pragma omp simd reduction(max : amax)
+  for (int64_t j = 0; j < len; j++) {
+    amax = std::max(amax, std::abs((float)src[j]));
+  }
+  float inv_scale = amax > 0.f ? 127.f / amax : 0.f;
+#pragma omp simd
+  for (int64_t j = 0; j < len; j++) {
+    dst[j] = (int8_t)std::nearbyint((float)src[j] * inv_scale);
+  }
+  *scale = amax / 127.f;
+}
+
+inline void dequantize_add_int8_block(
+    float* acc,
+    const int8_t* src,
+    float scale,
+    int64_t len) {
+#pragma omp simd
+  for (int64_t j = 0; j < len; j++) {
+    acc[j] += (float)src[j] * scale;
+  }
+}
+
+/**
+ * @brief Same as reduceScatterAllGather_impl, with the slots holding the
+ * message as int8 blocks of SHM_INT8_BLOCK elements and a fp32 scale per
+ * block, which divides the memory traffic by 4 against fp32 at the cost of
+ * the quantization error. The slot of a rank is laid out as
+ * [int8 data: slot_size][fp32 scales: slot_size / SHM_INT8_BLOCK]. Each rank
+ * reduces its slice in fp32 from its own exact input and the dequantized
+ * slices of the peers, then quantizes it again for the all-gather, so all the
+ * ranks get the same result.
+ * @param slot_size The number of int8 elements of the slot of each rank,
+ * multiple of SHM_INT8_BLOCK.
+ */
+template <typename T>
+void reduceScatterAllGatherInt8_impl(
+    T* sendBuf,
+    T* recvBuf,
+    at::Tensor t_address,
+    at::Tensor t_state,
+    int64_t slot_bytes,
+    int64_t slot_size,
+    int64_t size,
+    int rank,
+    int rankSize) {
+  uint8_t* address = (uint8_t*)t_address.data_ptr();
+  int* states_ptr = t_state.data_ptr<int>();
+  auto slot_data = [&](int r) { return (int8_t*)(address + r * slot_bytes); };
+  auto slot_scales = [&](int r) {
+    return (float*)(address + r * slot_bytes + slot_size);
+  };
+  int64_t nblocks = (size + SHM_INT8_BLOCK - 1) / SHM_INT8_BLOCK;
+  int64_t slice_blocks = (nblocks + rankSize - 1) / rankSize;
+  auto block_len = [&](int64_t b) {
+    return std::min<int64_t>(SHM_INT8_BLOCK, size - b * SHM_INT8_BLOCK);
+  };
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::slot_quantize",
+        c10::ArrayRef<c10::IValue>({}));
+    wait_state_until(states_ptr, rank, INIT);
+    auto data = slot_data(rank);
+    auto scales = slot_scales(rank);
+#pragma omp parallel for
+    for (int64_t b = 0; b < nblocks; b++) {
+      auto offset = b * SHM_INT8_BLOCK;
+      quantize_int8_block(
+          data + offset, scales + b, sendBuf + offset, block_len(b));
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = SLOT_COPY;
+  }
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::reduce_scatter",
+        c10::ArrayRef<c10::IValue>({}));
+    for (int i = 0; i < rankSize; i++) {
+      wait_state_at_least(states_ptr, i, SLOT_COPY);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto begin = std::min(nblocks, rank * slice_blocks);
+    auto end = std::min(nblocks, (rank + 1) * slice_blocks);
+#pragma omp parallel for
+    for (int64_t b = begin; b < end; b++) {
+      auto offset = b * SHM_INT8_BLOCK;
+      auto len = block_len(b);
+      alignas(64) float acc[SHM_INT8_BLOCK];
+      torch_ipex::cpu::kernel::move_ker<float, T>(acc, sendBuf + offset, len);
+      for (int i = 1; i < rankSize; i++) {
+        int peer = (rank + i) % rankSize;
+        dequantize_add_int8_block(
+            acc, slot_data(peer) + offset, slot_scales(peer)[b], len);
+      }
+      // The peers only read the blocks of their own slices of this slot
+      quantize_int8_block(
+          slot_data(rank) + offset, slot_scales(rank) + b, acc, len);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = SLICE_REDUCE;
+  }
+  {
+    RECORD_FUNCTION(
+        "ipex::shm_all_reduce_add::all_gather", c10::ArrayRef<c10::IValue>({}));
+    for (int i = 0; i < rankSize; i++) {
+      wait_state_at_least(states_ptr, i, SLICE_REDUCE);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+#pragma omp parallel for
+    for (int64_t b = 0; b < nblocks; b++) {
+      int owner = b / slice_blocks;
+      auto offset = b * SHM_INT8_BLOCK;
+      auto len = block_len(b);
+      alignas(64) float acc[SHM_INT8_BLOCK] = {0.f};
+      dequantize_add_int8_block(
+          acc, slot_data(owner) + offset, slot_scales(owner)[b], len);
+      torch_ipex::cpu::kernel::move_ker<T, float>(recvBuf + offset, acc, len);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    states_ptr[rank] = GATHER;
+    if (rank == 0) {
+      for (int i = 0; i < rankSize; i++) {
+        wait_state_until(states_ptr, i, GATHER);
+      }
+      for (int i = 0; i < rankSize; i++) {
+        std::atomic_thread_fence(std::memory_order_release);
+        states_ptr[i] = INIT;
+      }
+    }
+  }
+}
+
+// Runs the all-reduce with the shared memory buffer holding W elements
+template <typename T, typename W>
+void shm_all_reduce_add_wire(
     at::Tensor& t_in,
     at::Tensor& t_address,
     at::Tensor& t_state,
@@ -162,69 +443,153 @@ at::Tensor shm_all_reduce_add_kernel_impl(
     int64_t shm_block_size,
     int64_t rank,
     int64_t world_size) {
+  T* buf = (T*)t_in.data_ptr();
+  int64_t size = t_in.numel();
+  int64_t slot_size = t_address.nbytes() / sizeof(W) / world_size;
+  slot_size = slot_size / SHM_RS_AG_SLICE_ALIGN * SHM_RS_AG_SLICE_ALIGN;
+  if (world_size >= SHM_RS_AG_MIN_WORLD_SIZE && size <= slot_size) {
+    reduceScatterAllGather_impl<T, W>(
+        buf, buf, t_address, t_state, slot_size, size, rank, world_size);
+  } else {
+    reduceAdd_impl<T, W>(
+        buf,
+        buf,
+        t_address,
+        t_state,
+        t_blockState,
+        shm_block_size,
+        size,
+        sizeof(T),
+        rank,
+        world_size);
+  }
+}
+
+template <typename T>
+void shm_all_reduce_add_impl(
+    at::Tensor& t_in,
+    at::Tensor& t_address,
+    at::Tensor& t_state,
+    at::Tensor& t_blockState,
+    int64_t shm_block_size,
+    int64_t rank,
+    int64_t world_size,
+    int64_t precision) {
+  constexpr bool is_low_precision = std::is_same<T, at::BFloat16>::value ||
+      std::is_same<T, at::Half>::value;
+  constexpr bool is_floating_point =
+      is_low_precision || std::is_same<T, float>::value;
+  int64_t size = t_in.numel();
+  if (is_floating_point && precision == SHM_REDUCE_INT8) {
+    int64_t slot_bytes = t_address.nbytes() / world_size / 64 * 64;
+    // int8 data and one fp32 scale per block
+    int64_t slot_size = slot_bytes * SHM_INT8_BLOCK / (SHM_INT8_BLOCK + 4) /
+        SHM_INT8_BLOCK * SHM_INT8_BLOCK;
+    if (size <= slot_size) {
+      T* buf = (T*)t_in.data_ptr();
+      reduceScatterAllGatherInt8_impl(
+          buf,
+          buf,
+          t_address,
+          t_state,
+          slot_bytes,
+          slot_size,
+          size,
+          rank,
+          world_size);
+      return;
+    }
+  }
+  // Every hop of the serial chain rounds to W, so the chain only keeps the
+  // low precision for 2 ranks, where there is a single hop.
+  int64_t slot_size = t_address.nbytes() / sizeof(T) / world_size;
+  slot_size = slot_size / SHM_RS_AG_SLICE_ALIGN * SHM_RS_AG_SLICE_ALIGN;
+  bool use_native = is_low_precision && precision != SHM_REDUCE_FP32 &&
+      (world_size == 2 ||
+       (world_size >= SHM_RS_AG_MIN_WORLD_SIZE && size <= slot_size));
+  if (use_native) {
+    shm_all_reduce_add_wire<T, T>(
+        t_in,
+        t_address,
+        t_state,
+        t_blockState,
+        shm_block_size,
+        rank,
+        world_size);
+  } else {
+    shm_all_reduce_add_wire<T, float>(
+        t_in,
+        t_address,
+        t_state,
+        t_blockState,
+        shm_block_size,
+        rank,
+        world_size);
+  }
+}
+
+at::Tensor shm_all_reduce_add_kernel_impl(
+    at::Tensor& t_in,
+    at::Tensor& t_address,
+    at::Tensor& t_state,
+    at::Tensor& t_blockState,
+    int64_t shm_block_size,
+    int64_t rank,
+    int64_t world_size,
+    int64_t precision) {
   RECORD_FUNCTION("ipex::shm_all_reduce_add", c10::ArrayRef<c10::IValue>({}));
   // torch_ipex::cpu::shm_all_reduce_add_kernel_stub(kCPU, t_in);
   auto dtype = t_in.scalar_type();
   if (dtype == at::ScalarType::BFloat16) {
-    reduceAdd_impl(
-        (at::BFloat16*)t_in.data_ptr(),
-        (at::BFloat16*)t_in.data_ptr(),
+    shm_all_reduce_add_impl<at::BFloat16>(
+        t_in,
         t_address,
         t_state,
         t_blockState,
         shm_block_size,
-        t_in.numel(),
-        sizeof(at::BFloat16),
         rank,
-        world_size);
+        world_size,
+        precision);
   } else if (dtype == at::ScalarType::Half) {
-    reduceAdd_impl(
-        (at::Half*)t_in.data_ptr(),
-        (at::Half*)t_in.data_ptr(),
+    shm_all_reduce_add_impl<at::Half>(
+        t_in,
         t_address,
         t_state,
         t_blockState,
         shm_block_size,
-        t_in.numel(),
-        sizeof(at::Half),
         rank,
-        world_size);
+        world_size,
+        precision);
   } else if (dtype == at::ScalarType::Float) {
-    reduceAdd_impl(
-        (float*)t_in.data_ptr(),
-        (float*)t_in.data_ptr(),
+    shm_all_reduce_add_impl<float>(
+        t_in,
         t_address,
         t_state,
         t_blockState,
         shm_block_size,
-        t_in.numel(),
-        sizeof(float),
         rank,
-        world_size);
+        world_size,
+        precision);
   } else if (dtype == at::ScalarType::Int) {
-    reduceAdd_impl(
-        (int*)t_in.data_ptr(),
-        (int*)t_in.data_ptr(),
+    shm_all_reduce_add_impl<int>(
+        t_in,
         t_address,
         t_state,
         t_blockState,
         shm_block_size,
-        t_in.numel(),
-        sizeof(int),
         rank,
-        world_size);
+        world_size,
+        precision);
   } else if (dtype == at::ScalarType::Long) {
-    reduceAdd_impl(
-        (int64_t*)t_in.data_ptr(),
-        (int64_t*)t_in.data_ptr(),
+    shm_all_reduce_add_impl<int64_t>(
+        t_in,
         t_address,
         t_state,
         t_blockState,
         shm_block_size,
-        t_in.numel(),
-        sizeof(int64_t),
         rank,
-        world_size);
+        world_size,
+        precision);
   } else {
     TORCH_CHECK(
         false,
@@ -0,0 +1,306 @@
+#include <ATen/ATen.h>
+#include <ATen/CPUGeneratorImpl.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <aten/Sampling.h>
+#include <c10/util/Exception.h>
+#include <torch/csrc/autograd/function.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+// The first round of the top-p candidate selection when top_k is not set.
+// The nucleus is usually much smaller than the vocabulary, the candidates are
+// enlarged by SAMPLING_CANDIDATE_GROWTH times until they cover top_p.
+#define SAMPLING_MIN_CANDIDATES 256
+#define SAMPLING_CANDIDATE_GROWTH 4
+
+template <typename T>
+inline void load_logits_row(const T* src, float* dst, int64_t vocab_size) {
+  using fVec = at::vec::Vectorized<float>;
+  if constexpr (std::is_same<T, float>::value) {
+    std::memcpy(dst, src, vocab_size * sizeof(float));
+  } else {
+    using lpVec = at::vec::Vectorized<T>;
+    int64_t i = 0;
+    for (; i <= vocab_size - lpVec::size(); i += lpVec::size()) {
+      fVec v1, v2;
+      std::tie(v1, v2) = at::vec::convert_to_float(lpVec::loadu(src + i));
+      v1.store(dst + i);
+      v2.store(dst + i + fVec::size());
+    }
+    for (; i < vocab_size; ++i) {
+      dst[i] = static_cast<float>(src[i]);
+    }
+  }
+}
+
+// Same as RepetitionPenaltyLogitsProcessor: every token appearing in the
+// input is penalized once, no matter how many times it appears.
+inline void apply_repetition_penalty(
+    float* scores,
+    const int64_t* ids,
+    int64_t seq_len,
+    int64_t vocab_size,
+    float penalty,
+    std::vector<int64_t>& unique_ids) {
+  unique_ids.assign(ids, ids + seq_len);
+  std::sort(unique_ids.begin(), unique_ids.end());
+  auto end = std::unique(unique_ids.begin(), unique_ids.end());
+  for (auto it = unique_ids.begin(); it != end; ++it) {
+    auto id = *it;
+    if (id < 0 || id >= vocab_size)
+      continue;
+    scores[id] = scores[id] < 0 ? scores[id] * penalty : scores[id] / penalty;
+  }
+}
+
+// scores <- exp((scores - max) / temperature), returns the sum
+inline float exp_scaled_and_sum(
+    float* scores,
+    int64_t vocab_size,
+    float max_val,
+    float inv_temperature) {
+  using fVec = at::vec::Vectorized<float>;
+  auto max_vec = fVec(max_val);
+  auto scale_vec = fVec(inv_temperature);
+  auto sum_vec = fVec(0.f);
+  int64_t i = 0;
+  for (; i <= vocab_size - fVec::size(); i += fVec::size()) {
+    auto v = ((fVec::loadu(scores + i) - max_vec) * scale_vec).exp();
+    v.store(scores + i);
+    sum_vec = sum_vec + v;
+  }
+  float sum = at::vec::vec_reduce_all<float>(
+      [](fVec& x, fVec& y) { return x + y; }, sum_vec);
+  for (; i < vocab_size; ++i) {
+    scores[i] = std::exp((scores[i] - max_val) * inv_temperature);
+    sum += scores[i];
+  }
+  return sum;
+}
+
+// Draw from the categorical distribution of the unnormalized probs, the
+// candidates are all the tokens if ids is null.
+inline int64_t sample_from_probs(
+    const float* probs,
+    const int32_t* ids,
+    int64_t num,
+    float mass,
+    float uniform) {
+  float target = uniform * mass;
+  float cum = 0.f;
+  int64_t last_valid = 0;
+  for (int64_t i = 0; i < num; ++i) {
+    auto id = ids ? ids[i] : i;
+    if (probs[id] > 0.f)
+      last_valid = id;
+    cum += probs[id];
+    if (cum > target)
+      return id;
+  }
+  // rounding error, fall back to the last token that can be sampled
+  return last_valid;
+}
+
+template <typename T>
+void fused_sampling_kernel(
+    const at::Tensor& logits,
+    const c10::optional<at::Tensor>& input_ids,
+    float repetition_penalty,
+    float temperature,
+    int64_t top_k,
+    float top_p,
+    const at::Tensor& uniforms,
+    at::Tensor& next_tokens) {
+  auto batch = logits.size(0);
+  auto vocab_size = logits.size(1);
+  auto logits_ptr = logits.data_ptr<T>();
+  auto logits_stride = logits.stride(0);
+  auto ids_ptr = input_ids.has_value() ? input_ids.value().data_ptr<int64_t>()
+                                       : nullptr;
+  auto seq_len = input_ids.has_value() ? input_ids.value().size(1) : 0;
+  auto uniforms_ptr = uniforms.data_ptr<float>();
+  auto next_tokens_ptr = next_tokens.data_ptr<int64_t>();
+  bool greedy = temperature <= 0.f;
+  bool use_top_k = top_k > 0 && top_k < vocab_size;
+  bool use_top_p = top_p < 1.f;
+
+  // per thread buffers: the scores of one row and the candidate token ids
+  auto num_threads = at::get_num_threads();
+  auto scores_buf = at::empty(
+      {num_threads, vocab_size}, logits.options().dtype(at::kFloat));
+  auto ids_buf = at::empty(
+      {num_threads, (use_top_k || use_top_p) ? vocab_size : 0},
+      logits.options().dtype(at::kInt));
+  auto scores_buf_ptr = scores_buf.data_ptr<float>();
+  auto ids_buf_ptr = ids_buf.data_ptr<int32_t>();
+
+  at::parallel_for(0, batch, 1, [&](int64_t begin, int64_t end) {
+    auto thread_id = at::get_thread_num();
+    auto scores = scores_buf_ptr + thread_id * vocab_size;
+    auto cand = ids_buf_ptr + thread_id * ids_buf.size(1);
+    std::vector<int64_t> unique_ids;
+    for (int64_t b = begin; b < end; ++b) {
+      load_logits_row<T>(logits_ptr + b * logits_stride, scores, vocab_size);
+      if (ids_ptr != nullptr && repetition_penalty != 1.f) {
+        apply_repetition_penalty(
+            scores,
+            ids_ptr + b * seq_len,
+            seq_len,
+            vocab_size,
+            repetition_penalty,
+            unique_ids);
+      }
+      float max_val = at::vec::reduce_all<float>(
+          [](at::vec::Vectorized<float>& x, at::vec::Vectorized<float>& y) {
+            return at::vec::maximum(x, y);
+          },
+          scores,
+          vocab_size);
+      if (greedy) {
+        next_tokens_ptr[b] = std::find(scores, scores + vocab_size, max_val) -
+            scores;
+        continue;
+      }
+      float total =
+          exp_scaled_and_sum(scores, vocab_size, max_val, 1.f / temperature);
+      if (!use_top_k && !use_top_p) {
+        next_tokens_ptr[b] = sample_from_probs(
+            scores, nullptr, vocab_size, total, uniforms_ptr[b]);
+        continue;
+      }
+
+      // Partial selection of the largest candidates, only the candidates
+      // are sorted instead of the whole vocabulary.
+      auto by_prob = [&](int32_t a, int32_t c) {
+        return scores[a] > scores[c];
+      };
+      std::iota(cand, cand + vocab_size, 0);
+      int64_t num_cand = use_top_k
+          ? top_k
+          : std::min<int64_t>(SAMPLING_MIN_CANDIDATES, vocab_size);
+      int64_t num_keep = num_cand;
+      float keep_mass = 0.f;
+      while (true) {
+        std::nth_element(cand, cand + num_cand, cand + vocab_size, by_prob);
+        std::sort(cand, cand + num_cand, by_prob);
+        // top-p is renormalized over the top-k tokens as the warpers do
+        float cand_mass = 0.f;
+        if (use_top_k) {
+          for (int64_t i = 0; i < num_cand; ++i) {
+            cand_mass += scores[cand[i]];
+          }
+        } else {
+          cand_mass = total;
+        }
+        if (!use_top_p) {
+          keep_mass = cand_mass;
+          break;
+        }
+        // keep the smallest prefix whose mass reaches top_p
+        float limit = top_p * cand_mass;
+        float cum = 0.f;
+        num_keep = 0;
+        while (num_keep < num_cand && cum < limit) {
+          cum += scores[cand[num_keep++]];
+        }
+        keep_mass = cum;
+        if (cum >= limit || num_cand == vocab_size || use_top_k)
+          break;
+        num_cand = std::min<int64_t>(
+            num_cand * SAMPLING_CANDIDATE_GROWTH, vocab_size);
+      }
+      next_tokens_ptr[b] = sample_from_probs(
+          scores, cand, num_keep, keep_mass, uniforms_ptr[b]);
+    }
+  });
+}
+
+at::Tensor fused_sampling_kernel_impl(
+    const at::Tensor& logits,
+    const c10::optional<at::Tensor>& input_ids,
+    double repetition_penalty,
+    double temperature,
+    int64_t top_k,
+    double top_p,
+    c10::optional<int64_t> seed) {
+  TORCH_CHECK(
+      logits.dim() == 2,
+      "fused_sampling: logits should be [batch, vocab_size], but got ",
+      logits.dim(),
+      " dims");
+  TORCH_CHECK(
+      repetition_penalty > 0,
+      "fused_sampling: repetition_penalty should be positive");
+  TORCH_CHECK(
+      top_p > 0 && top_p <= 1, "fused_sampling: top_p should be in (0, 1]");
+  auto logits_ = logits.stride(1) == 1 ? logits : logits.contiguous();
+  c10::optional<at::Tensor> input_ids_;
+  if (input_ids.has_value()) {
+    TORCH_CHECK(
+        input_ids.value().dim() == 2 &&
+            input_ids.value().size(0) == logits.size(0),
+        "fused_sampling: input_ids should be [batch, seq_len]");
+    input_ids_ = input_ids.value().to(at::kLong).contiguous();
+  }
+  auto batch = logits.size(0);
+  auto next_tokens = at::empty({batch}, logits.options().dtype(at::kLong));
+
+  // Draw the uniforms up front from the torch generator, so that the result
+  // is reproducible with the seed and independent of the thread count.
+  at::Generator gen = seed.has_value()
+      ? at::make_generator<at::CPUGeneratorImpl>(seed.value())
+      : at::detail::getDefaultCPUGenerator();
+  auto uniforms = at::rand({batch}, gen, logits.options().dtype(at::kFloat));
+
+  if (logits_.scalar_type() == at::ScalarType::Float) {
+    fused_sampling_kernel<float>(
+        logits_,
+        input_ids_,
+        repetition_penalty,
+        temperature,
+        top_k,
+        top_p,
+        uniforms,
+        next_tokens);
+  } else if (logits_.scalar_type() == at::ScalarType::BFloat16) {
+    fused_sampling_kernel<at::BFloat16>(
+        logits_,
+        input_ids_,
+        repetition_penalty,
+        temperature,
+        top_k,
+        top_p,
+        uniforms,
+        next_tokens);
+  } else if (logits_.scalar_type() == at::ScalarType::Half) {
+    fused_sampling_kernel<at::Half>(
+        logits_,
+        input_ids_,
+        repetition_penalty,
+        temperature,
+        top_k,
+        top_p,
+        uniforms,
+        next_tokens);
+  } else {
+    TORCH_CHECK(false, "Unsupported data type for fused_sampling");
+  }
+  return next_tokens;
+}
+
+} // anonymous namespace
+
+IPEX_REGISTER_DISPATCH(fused_sampling_kernel_stub, &fused_sampling_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -8,6 +8,9 @@
 #include "aten/utils/woq.h"
 #include "csrc/cpu/tpp/kernels/TPPGEMMKrnl.h"
 #include "csrc/cpu/tpp/woq/tla.h"
+#include "utils/ScratchAllocator.h"
+
+#include <immintrin.h>
 
 #ifdef __GNUC__
 #include <features.h>
@@ -37,6 +40,16 @@ using TensorList = std::vector<at::Tensor>;
 #define QINT4 2
 #define NF4 3
 
+#define UNQUANT_A -1
+#define QUANT_A_PER_TENSOR 0
+#define QUANT_A_PER_K_BLOCK 1
+#define QUANT_A_PER_M 2
+#define QUANT_A_PER_M_K_BLOCK 3
+#define QUANT_A_PER_TENSOR_SYM 4
+#define QUANT_A_PER_K_BLOCK_SYM 5
+#define QUANT_A_PER_M_SYM 6
+#define QUANT_A_PER_M_K_BLOCK_SYM 7
+
 static int IPEX_KCB_BLOCK_SIZE = env2int("IPEX_KCB_BLOCK_SIZE", 64);
 
 constexpr bool is_4bit(const int qw_type) {
@@ -60,16 +73,6 @@ static int SMALL_BATCH_THRESHOLD = env2int("IPEX_WOQ_SMALL_BATCH_THRESHOLD", 5);
 constexpr long PREFETCH_K_DIST = 64; // TODO(jgong5): do not hard-code
 constexpr long LOOP_K_UNROLL = 4; // TODO(jgong5): do not hard-code
 
-#define UNQUANT_A -1
-#define QUANT_A_PER_TENSOR 0
-#define QUANT_A_PER_K_BLOCK 1
-#define QUANT_A_PER_M 2
-#define QUANT_A_PER_M_K_BLOCK 3
-#define QUANT_A_PER_TENSOR_SYM 4
-#define QUANT_A_PER_K_BLOCK_SYM 5
-#define QUANT_A_PER_M_SYM 6
-#define QUANT_A_PER_M_K_BLOCK_SYM 7
-
 #define QUANT_W_PER_CHANNEL 0
 #define QUANT_W_PER_K_BLOCK 1
 
@@ -1847,8 +1850,8 @@ void qlinear_woq_affine_dequant_upfront_impl(
   auto pw = GetVLAPtr<uint8_t>((uint8_t*)qw_packed.data_ptr(), {Kc, Kb * Nb});
   auto ldy = N;
 
-  torch::Tensor dqw =
-      torch::empty({Nc, Kc, Kb, Nb}, c10::CppTypeToScalarType<TComp>::value);
+  torch::Tensor dqw = utils::empty_scratch(
+      {Nc, Kc, Kb, Nb}, c10::CppTypeToScalarType<TComp>::value);
   if (std::is_same<TComp, bfloat16>()) {
     // reshape to VNNI format
     dqw = dqw.view({Nc, Kc, Kb / 2, Nb, 2});
@@ -2004,7 +2007,7 @@ void qlinear_woq_affine_dequant_upfront_impl(
             auto maybe_cvt_x_and_compute = [&](at::Tensor& y,
                                                int fuse_type = 0) {
               if constexpr (!std::is_same<T, TComp>()) {
-                auto x_comp = at::empty(
+                auto x_comp = utils::empty_scratch(
                     x_reshaped.sizes(),
                     x_reshaped.options().dtype(
                         c10::CppTypeToScalarType<TComp>::value));
@@ -2031,7 +2034,7 @@ void qlinear_woq_affine_dequant_upfront_impl(
             // If Tout != TGemmOut, such as the lowp-mode=bf16 case, we need a
             // buffer for output
             if constexpr (!std::is_same<Tout, TGemmOut>()) {
-              auto y_gemm = at::empty(
+              auto y_gemm = utils::empty_scratch(
                   {M, y.size(-1)},
                   y.options().dtype(c10::CppTypeToScalarType<TGemmOut>::value));
               maybe_cvt_x_and_compute(y_gemm);
@@ -4842,6 +4845,578 @@ at::Tensor dequantize_int4_weight_to_int8_packed(
 
 #define SMALL_BATCH_THRESHOLD 32
 
+#if defined(__AVX2__) && defined(__FMA__)
+#define WOQ_INREG_DEQUANT
+
+// The kernels below are for the CPUs without AVX512_FP16 (AVX2, AVX2_VNNI,
+// AVX512 and AVX512_VNNI). The weight stays in the plain [N, K] layout and is
+// dequantized in registers, 32 elements of K at a time, right before the dot
+// product, instead of dequantizing the whole weight ahead of the GEMM. N is
+// blocked by BLOCK_N and K by the quantization group (or IPEX_KCB_BLOCK_SIZE
+// for per-channel quantization) as qlinear_woq_affine_impl does.
+constexpr int WOQ_INREG_K_STEP = 32;
+// Rows of the activation sharing one dequantized weight vector
+constexpr int WOQ_INREG_BLOCK_M = 4;
+// Larger M is compute bound, dequantizing the weight upfront and calling the
+// GEMM of oneDNN is faster
+static int WOQ_INREG_M_THRESHOLD =
+    env2int("IPEX_WOQ_INREG_DEQUANT_M_THRESHOLD", 32);
+
+#if defined(__AVX512VNNI__) || defined(__AVXVNNI__)
+constexpr int WOQ_INREG_QMAX_A = 255;
+#else
+// vpmaddubsw saturates the sum of two u8 * s8 products to int16, so the
+// activation is quantized to 7 bits without VNNI
+constexpr int WOQ_INREG_QMAX_A = 127;
+#endif
+
+#ifdef __AVX512F__
+using woq_fvec = __m512;
+constexpr int WOQ_FVEC_SIZE = 16;
+inline woq_fvec woq_fvec_zero() {
+  return _mm512_setzero_ps();
+}
+inline woq_fvec woq_fvec_set1(float v) {
+  return _mm512_set1_ps(v);
+}
+inline woq_fvec woq_fvec_load(const float* p) {
+  return _mm512_loadu_ps(p);
+}
+inline woq_fvec woq_fvec_fma(woq_fvec a, woq_fvec b, woq_fvec c) {
+  return _mm512_fmadd_ps(a, b, c);
+}
+inline float woq_fvec_reduce_add(woq_fvec v) {
+  return _mm512_reduce_add_ps(v);
+}
+// 32 int8 to 2 x 16 floats
+inline void cvt_s8_to_fvecs(__m256i w, woq_fvec* out) {
+  out[0] = _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm256_castsi256_si128(w)));
+  out[1] =
+      _mm512_cvtepi32_ps(_mm512_cvtepi8_epi32(_mm256_extracti128_si256(w, 1)));
+}
+// 32 NF4 codes to 2 x 16 floats
+inline void lookup_nf4_fvecs(__m256i idx, woq_fvec* out) {
+  auto lut = _mm512_loadu_ps(NF4_DEQUANT_TABLE.data());
+  out[0] = _mm512_permutexvar_ps(
+      _mm512_cvtepi8_epi32(_mm256_castsi256_si128(idx)), lut);
+  out[1] = _mm512_permutexvar_ps(
+      _mm512_cvtepi8_epi32(_mm256_extracti128_si256(idx, 1)), lut);
+}
+#else
+using woq_fvec = __m256;
+constexpr int WOQ_FVEC_SIZE = 8;
+inline woq_fvec woq_fvec_zero() {
+  return _mm256_setzero_ps();
+}
+inline woq_fvec woq_fvec_set1(float v) {
+  return _mm256_set1_ps(v);
+}
+inline woq_fvec woq_fvec_load(const float* p) {
+  return _mm256_loadu_ps(p);
+}
+inline woq_fvec woq_fvec_fma(woq_fvec a, woq_fvec b, woq_fvec c) {
+  return _mm256_fmadd_ps(a, b, c);
+}
+inline float woq_fvec_reduce_add(woq_fvec v) {
+  auto s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_movehdup_ps(s));
+  return _mm_cvtss_f32(s);
+}
+// the 4 x 8 int8 of 32 int8, each in the low 64 bits
+inline void split_s8_x32(__m256i w, __m128i* parts) {
+  auto lo = _mm256_castsi256_si128(w);
+  auto hi = _mm256_extracti128_si256(w, 1);
+  parts[0] = lo;
+  parts[1] = _mm_srli_si128(lo, 8);
+  parts[2] = hi;
+  parts[3] = _mm_srli_si128(hi, 8);
+}
+// 32 int8 to 4 x 8 floats
+inline void cvt_s8_to_fvecs(__m256i w, woq_fvec* out) {
+  __m128i parts[4];
+  split_s8_x32(w, parts);
+  for (int i = 0; i < 4; i++) {
+    out[i] = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(parts[i]));
+  }
+}
+// 32 NF4 codes to 4 x 8 floats, the 16-entry table is looked up as two
+// 8-entry tables
+inline void lookup_nf4_fvecs(__m256i idx, woq_fvec* out) {
+  auto lut_lo = _mm256_loadu_ps(NF4_DEQUANT_TABLE.data());
+  auto lut_hi = _mm256_loadu_ps(NF4_DEQUANT_TABLE.data() + 8);
+  auto seven = _mm256_set1_epi32(7);
+  __m128i parts[4];
+  split_s8_x32(idx, parts);
+  for (int i = 0; i < 4; i++) {
+    auto idx32 = _mm256_cvtepi8_epi32(parts[i]);
+    auto from_hi = _mm256_castsi256_ps(_mm256_cmpgt_epi32(idx32, seven));
+    out[i] = _mm256_blendv_ps(
+        _mm256_permutevar8x32_ps(lut_lo, idx32),
+        _mm256_permutevar8x32_ps(lut_hi, idx32),
+        from_hi);
+  }
+}
+#endif
+constexpr int WOQ_FVECS_PER_STEP = WOQ_INREG_K_STEP / WOQ_FVEC_SIZE;
+
+// 16 bytes of packed 4-bit weight to 32 int8 in the order of K, the even
+// elements are in the low nibbles
+inline __m256i load_4bit_as_s8_x32(const uint8_t* p) {
+  auto packed = _mm_loadu_si128((const __m128i*)p);
+  auto mask = _mm_set1_epi8(0x0f);
+  auto lo = _mm_and_si128(packed, mask);
+  auto hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+  return _mm256_set_m128i(
+      _mm_unpackhi_epi8(lo, hi), _mm_unpacklo_epi8(lo, hi));
+}
+
+// NF4 codes to int8 with vpshufb, the table is round(NF4_DEQUANT_TABLE * 127)
+// so the weight scale is divided by 127
+constexpr float WOQ_NF4_S8_SCALE = 127.f;
+inline __m256i lookup_nf4_s8(__m256i idx) {
+  auto lut = _mm256_setr_epi8(
+      -127, -88, -67, -50, -36, -23, -12, 0,
+      10, 20, 31, 43, 56, 71, 92, 127,
+      -127, -88, -67, -50, -36, -23, -12, 0,
+      10, 20, 31, 43, 56, 71, 92, 127);
+  return _mm256_shuffle_epi8(lut, idx);
+}
+
+template <int qw_type>
+inline __m256i load_weight_s8_x32(const uint8_t* qw, int64_t k) {
+  if constexpr (qw_type == QINT8) {
+    return _mm256_loadu_si256((const __m256i*)(qw + k));
+  } else if constexpr (qw_type == QINT4) {
+    return load_4bit_as_s8_x32(qw + k / 2);
+  } else {
+    return lookup_nf4_s8(load_4bit_as_s8_x32(qw + k / 2));
+  }
+}
+
+// acc += the dot products of u8 a and s8 b in every group of 4 bytes
+inline __m256i dpbusd_s32(__m256i acc, __m256i a, __m256i b) {
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+  return _mm256_dpbusd_epi32(acc, a, b);
+#elif defined(__AVXVNNI__)
+  return _mm256_dpbusd_avx_epi32(acc, a, b);
+#else
+  auto dot16 = _mm256_maddubs_epi16(a, b);
+  return _mm256_add_epi32(acc, _mm256_madd_epi16(dot16, _mm256_set1_epi16(1)));
+#endif
+}
+
+inline int32_t reduce_add_s32(__m256i v) {
+  auto s = _mm_add_epi32(
+      _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  s = _mm_hadd_epi32(s, s);
+  s = _mm_hadd_epi32(s, s);
+  return _mm_cvtsi128_si32(s);
+}
+
+struct WoqInregShape {
+  int64_t M;
+  int64_t N;
+  int64_t K;
+  // row stride of the weight in bytes
+  int64_t ldw;
+  // the K block and the number of K blocks
+  int64_t kblock;
+  int64_t KB;
+  // number of scales per row, 1 for per-channel quantization
+  int64_t G;
+};
+
+/*
+ *y[m0:m0+BM, n] in fp32. The weight is dequantized once for the BM rows, the
+ *zero point is applied with the per K-block sums of x afterwards.
+ */
+template <int qw_type, int BM>
+inline void woq_inreg_fp32_micro_kernel(
+    const float* x,
+    const float* x_sums,
+    const uint8_t* qw,
+    const float* scales,
+    const float* zps,
+    float* y,
+    int64_t m0,
+    int64_t n,
+    const WoqInregShape& s) {
+  woq_fvec total[BM];
+  float corr[BM];
+  for (int m = 0; m < BM; m++) {
+    total[m] = woq_fvec_zero();
+    corr[m] = 0.f;
+  }
+  auto qw_row = qw + n * s.ldw;
+  for (int64_t b = 0; b < s.KB; b++) {
+    auto k_end = std::min(s.K, (b + 1) * s.kblock);
+    woq_fvec acc[BM];
+    for (int m = 0; m < BM; m++) {
+      acc[m] = woq_fvec_zero();
+    }
+    for (int64_t k = b * s.kblock; k < k_end; k += WOQ_INREG_K_STEP) {
+      woq_fvec w[WOQ_FVECS_PER_STEP];
+      if constexpr (qw_type == NF4) {
+        lookup_nf4_fvecs(load_4bit_as_s8_x32(qw_row + k / 2), w);
+      } else if constexpr (qw_type == QINT4) {
+        cvt_s8_to_fvecs(load_4bit_as_s8_x32(qw_row + k / 2), w);
+      } else {
+        cvt_s8_to_fvecs(_mm256_loadu_si256((const __m256i*)(qw_row + k)), w);
+      }
+      for (int m = 0; m < BM; m++) {
+        auto x_ptr = x + (m0 + m) * s.K + k;
+        for (int i = 0; i < WOQ_FVECS_PER_STEP; i++) {
+          acc[m] = woq_fvec_fma(
+              w[i], woq_fvec_load(x_ptr + i * WOQ_FVEC_SIZE), acc[m]);
+        }
+      }
+    }
+    auto g = s.G == 1 ? 0 : b;
+    auto scale = scales[n * s.G + g];
+    for (int m = 0; m < BM; m++) {
+      total[m] = woq_fvec_fma(acc[m], woq_fvec_set1(scale), total[m]);
+    }
+    if (zps) {
+      auto zp_scale = zps[n * s.G + g] * scale;
+      for (int m = 0; m < BM; m++) {
+        corr[m] += zp_scale * x_sums[(m0 + m) * s.KB + b];
+      }
+    }
+  }
+  for (int m = 0; m < BM; m++) {
+    y[(m0 + m) * s.N + n] = woq_fvec_reduce_add(total[m]) - corr[m];
+  }
+}
+
+/*
+ *y[m0:m0+BM, n] with u8 x s8 dot products. With x = sa * (xq - za) and
+ *w = sw * (wq - zw), every K block contributes
+ *sa * sw * (dot(xq, wq) - za * sum(wq) - zw * (sum(xq) - kb * za)).
+ */
+template <int qw_type, int BM>
+inline void woq_inreg_int8_micro_kernel(
+    const uint8_t* xq,
+    const float* x_scales,
+    const int32_t* x_zps,
+    const int32_t* x_sums,
+    const uint8_t* qw,
+    const float* scales,
+    const float* zps,
+    float* y,
+    int64_t m0,
+    int64_t n,
+    const WoqInregShape& s) {
+  float total[BM];
+  for (int m = 0; m < BM; m++) {
+    total[m] = 0.f;
+  }
+  auto ones = _mm256_set1_epi8(1);
+  auto qw_row = qw + n * s.ldw;
+  for (int64_t b = 0; b < s.KB; b++) {
+    auto k_start = b * s.kblock;
+    auto k_end = std::min(s.K, k_start + s.kblock);
+    __m256i acc[BM];
+    for (int m = 0; m < BM; m++) {
+      acc[m] = _mm256_setzero_si256();
+    }
+    auto w_sum_vec = _mm256_setzero_si256();
+    for (int64_t k = k_start; k < k_end; k += WOQ_INREG_K_STEP) {
+      auto w = load_weight_s8_x32<qw_type>(qw_row, k);
+      w_sum_vec = dpbusd_s32(w_sum_vec, ones, w);
+      for (int m = 0; m < BM; m++) {
+        auto a = _mm256_loadu_si256((const __m256i*)(xq + (m0 + m) * s.K + k));
+        acc[m] = dpbusd_s32(acc[m], a, w);
+      }
+    }
+    auto g = s.G == 1 ? 0 : b;
+    auto w_scale = scales[n * s.G + g];
+    if constexpr (qw_type == NF4) {
+      w_scale /= WOQ_NF4_S8_SCALE;
+    }
+    auto w_zp = zps ? zps[n * s.G + g] : 0.f;
+    auto w_sum = reduce_add_s32(w_sum_vec);
+    for (int m = 0; m < BM; m++) {
+      auto idx = (m0 + m) * s.KB + b;
+      auto za = x_zps[idx];
+      auto dot = reduce_add_s32(acc[m]) - za * w_sum;
+      total[m] += x_scales[idx] * w_scale *
+          (dot - w_zp * (x_sums[idx] - (k_end - k_start) * za));
+    }
+  }
+  for (int m = 0; m < BM; m++) {
+    y[(m0 + m) * s.N + n] = total[m];
+  }
+}
+
+// Dispatch the M tail to the micro kernel with a compile-time BM
+template <template <int, int> class Kernel, int qw_type, typename... Args>
+inline void woq_inreg_call_micro_kernel(int64_t bm, Args&&... args) {
+  switch (bm) {
+    case 1:
+      Kernel<qw_type, 1>::call(std::forward<Args>(args)...);
+      break;
+    case 2:
+      Kernel<qw_type, 2>::call(std::forward<Args>(args)...);
+      break;
+    case 3:
+      Kernel<qw_type, 3>::call(std::forward<Args>(args)...);
+      break;
+    default:
+      Kernel<qw_type, WOQ_INREG_BLOCK_M>::call(std::forward<Args>(args)...);
+  }
+}
+
+template <int qw_type, int BM>
+struct WoqInregFp32MicroKernel {
+  template <typename... Args>
+  static void call(Args&&... args) {
+    woq_inreg_fp32_micro_kernel<qw_type, BM>(std::forward<Args>(args)...);
+  }
+};
+
+template <int qw_type, int BM>
+struct WoqInregInt8MicroKernel {
+  template <typename... Args>
+  static void call(Args&&... args) {
+    woq_inreg_int8_micro_kernel<qw_type, BM>(std::forward<Args>(args)...);
+  }
+};
+
+// Parallel over the blocks of (N, M), the M blocks of one N block are
+// adjacent so that its weight is reused from cache
+template <typename F>
+inline void woq_inreg_parallel(const WoqInregShape& s, const F& f) {
+  auto Nc = (s.N + BLOCK_N - 1) / BLOCK_N;
+  auto Mc = (s.M + WOQ_INREG_BLOCK_M - 1) / WOQ_INREG_BLOCK_M;
+  at::parallel_for(0, Nc * Mc, 0, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; i++) {
+      auto n_start = i / Mc * BLOCK_N;
+      auto n_end = std::min(s.N, n_start + BLOCK_N);
+      auto m0 = i % Mc * WOQ_INREG_BLOCK_M;
+      auto bm = std::min<int64_t>(WOQ_INREG_BLOCK_M, s.M - m0);
+      for (auto n = n_start; n < n_end; n++) {
+        f(m0, bm, n);
+      }
+    }
+  });
+}
+
+template <int qw_type>
+void woq_inreg_gemm_fp32(
+    const at::Tensor& x,
+    const at::Tensor& qw,
+    const at::Tensor& scales,
+    const at::Tensor& zps,
+    at::Tensor& y,
+    const WoqInregShape& s) {
+  auto x_ptr = x.data_ptr<float>();
+  const float* x_sums_ptr = nullptr;
+  at::Tensor x_sums;
+  if (zps.defined()) {
+    x_sums = at::empty({s.M, s.KB}, x.options());
+    auto sums = x_sums.data_ptr<float>();
+    at::parallel_for(0, s.M * s.KB, 0, [&](int64_t begin, int64_t end) {
+      for (auto i = begin; i < end; i++) {
+        auto m = i / s.KB, b = i % s.KB;
+        auto k_start = b * s.kblock;
+        auto k_end = std::min(s.K, k_start + s.kblock);
+        float sum = 0.f;
+        for (auto k = k_start; k < k_end; k++) {
+          sum += x_ptr[m * s.K + k];
+        }
+        sums[i] = sum;
+      }
+    });
+    x_sums_ptr = sums;
+  }
+  auto qw_ptr = (const uint8_t*)qw.data_ptr();
+  auto scales_ptr = scales.data_ptr<float>();
+  auto zps_ptr = zps.defined() ? zps.data_ptr<float>() : nullptr;
+  auto y_ptr = y.data_ptr<float>();
+  woq_inreg_parallel(s, [&](int64_t m0, int64_t bm, int64_t n) {
+    woq_inreg_call_micro_kernel<WoqInregFp32MicroKernel, qw_type>(
+        bm, x_ptr, x_sums_ptr, qw_ptr, scales_ptr, zps_ptr, y_ptr, m0, n, s);
+  });
+}
+
+template <int qw_type>
+void woq_inreg_gemm_int8(
+    const at::Tensor& x,
+    const at::Tensor& qw,
+    const at::Tensor& scales,
+    const at::Tensor& zps,
+    at::Tensor& y,
+    const WoqInregShape& s,
+    int64_t quant_a_mode) {
+  // quantize x to u8, the qparams are kept per (row, K block) whatever the
+  // granularity of quant_a_mode is
+  auto xq = at::empty({s.M, s.K}, x.options().dtype(at::kByte));
+  auto x_min = at::empty({s.M, s.KB}, x.options());
+  auto x_max = at::empty({s.M, s.KB}, x.options());
+  auto x_scales = at::empty({s.M, s.KB}, x.options());
+  auto x_zps = at::empty({s.M, s.KB}, x.options().dtype(at::kInt));
+  auto x_sums = at::empty({s.M, s.KB}, x.options().dtype(at::kInt));
+  auto x_ptr = x.data_ptr<float>();
+  auto xq_ptr = xq.data_ptr<uint8_t>();
+  auto x_min_ptr = x_min.data_ptr<float>();
+  auto x_max_ptr = x_max.data_ptr<float>();
+  auto x_scales_ptr = x_scales.data_ptr<float>();
+  auto x_zps_ptr = x_zps.data_ptr<int32_t>();
+  auto x_sums_ptr = x_sums.data_ptr<int32_t>();
+  at::parallel_for(0, s.M * s.KB, 0, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; i++) {
+      auto m = i / s.KB, b = i % s.KB;
+      auto k_start = b * s.kblock;
+      auto k_end = std::min(s.K, k_start + s.kblock);
+      auto src = x_ptr + m * s.K;
+      float min_val = 0.f, max_val = 0.f;
+      for (auto k = k_start; k < k_end; k++) {
+        min_val = std::min(min_val, src[k]);
+        max_val = std::max(max_val, src[k]);
+      }
+      x_min_ptr[i] = min_val;
+      x_max_ptr[i] = max_val;
+    }
+  });
+  bool per_m = quant_a_mode != QUANT_A_PER_TENSOR &&
+      quant_a_mode != QUANT_A_PER_K_BLOCK &&
+      quant_a_mode != QUANT_A_PER_TENSOR_SYM &&
+      quant_a_mode != QUANT_A_PER_K_BLOCK_SYM;
+  bool per_k_block = quant_a_mode != QUANT_A_PER_TENSOR &&
+      quant_a_mode != QUANT_A_PER_M &&
+      quant_a_mode != QUANT_A_PER_TENSOR_SYM &&
+      quant_a_mode != QUANT_A_PER_M_SYM;
+  if (!per_m) {
+    x_min = x_min.amin(0, /*keepdim*/ true).expand({s.M, s.KB}).contiguous();
+    x_max = x_max.amax(0, /*keepdim*/ true).expand({s.M, s.KB}).contiguous();
+  }
+  if (!per_k_block) {
+    x_min = x_min.amin(1, /*keepdim*/ true).expand({s.M, s.KB}).contiguous();
+    x_max = x_max.amax(1, /*keepdim*/ true).expand({s.M, s.KB}).contiguous();
+  }
+  x_min_ptr = x_min.data_ptr<float>();
+  x_max_ptr = x_max.data_ptr<float>();
+  // the symmetric modes are s8 shifted to u8 by half of the range
+  bool sym_quant_a = quant_a_mode >= QUANT_A_PER_TENSOR_SYM;
+  constexpr int32_t half_range = (WOQ_INREG_QMAX_A + 1) / 2;
+  at::parallel_for(0, s.M * s.KB, 0, [&](int64_t begin, int64_t end) {
+    for (auto i = begin; i < end; i++) {
+      auto m = i / s.KB, b = i % s.KB;
+      auto k_start = b * s.kblock;
+      auto k_end = std::min(s.K, k_start + s.kblock);
+      auto src = x_ptr + m * s.K;
+      float scale;
+      int32_t zp = 0;
+      if (sym_quant_a) {
+        auto amax = std::max(-x_min_ptr[i], x_max_ptr[i]);
+        scale = amax / (half_range - 1);
+        zp = half_range;
+      } else {
+        scale = (x_max_ptr[i] - x_min_ptr[i]) / WOQ_INREG_QMAX_A;
+      }
+      scale = scale > 0.f ? scale : 1.f;
+      float inv_scale = 1.f / scale;
+      if (!sym_quant_a) {
+        zp = static_cast<int32_t>(std::nearbyint(-x_min_ptr[i] * inv_scale));
+        zp = std::min(std::max(zp, 0), WOQ_INREG_QMAX_A);
+      }
+      int32_t sum = 0;
+      for (auto k = k_start; k < k_end; k++) {
+        int32_t q =
+            static_cast<int32_t>(std::nearbyint(src[k] * inv_scale)) + zp;
+        q = std::min(std::max(q, 0), WOQ_INREG_QMAX_A);
+        xq_ptr[m * s.K + k] = q;
+        sum += q;
+      }
+      x_scales_ptr[i] = scale;
+      x_zps_ptr[i] = zp;
+      x_sums_ptr[i] = sum;
+    }
+  });
+  auto qw_ptr = (const uint8_t*)qw.data_ptr();
+  auto scales_ptr = scales.data_ptr<float>();
+  auto zps_ptr = zps.defined() ? zps.data_ptr<float>() : nullptr;
+  auto y_ptr = y.data_ptr<float>();
+  woq_inreg_parallel(s, [&](int64_t m0, int64_t bm, int64_t n) {
+    woq_inreg_call_micro_kernel<WoqInregInt8MicroKernel, qw_type>(
+        bm,
+        xq_ptr,
+        x_scales_ptr,
+        x_zps_ptr,
+        x_sums_ptr,
+        qw_ptr,
+        scales_ptr,
+        zps_ptr,
+        y_ptr,
+        m0,
+        n,
+        s);
+  });
+}
+
+/*
+ *Compute x * dequant(qw)^T in fp32 with the weight dequantized in registers.
+ *Returns an undefined tensor if the shapes are not supported by the kernels,
+ *and the caller falls back to dequantizing the whole weight.
+ *lowp_mode FP16 and BF16 are computed in fp32 too: lowp_mode is the lowest
+ *precision allowed, not a required one, and for small M the GEMM is bound by
+ *reading the weight rather than by the FMAs. LOWP_MODE_INT8 quantizes x to u8
+ *per quant_a_mode.
+ */
+at::Tensor woq_inreg_dequant_gemm(
+    const at::Tensor& x,
+    const at::Tensor& qw,
+    const at::Tensor& scales,
+    const at::Tensor& zps,
+    const int qw_type,
+    int64_t lowp_mode,
+    int64_t quant_a_mode,
+    int64_t quant_block_k) {
+  auto K = x.size(-1);
+  auto M = x.numel() / K;
+  auto N = scales.size(0);
+  auto kblock = quant_block_k > 0 ? quant_block_k : IPEX_KCB_BLOCK_SIZE;
+  auto ldw = qw.size(1);
+  bool supported = M <= WOQ_INREG_M_THRESHOLD && qw.dim() == 2 &&
+      qw.is_contiguous() && qw.size(0) >= N && qw.element_size() == 1 &&
+      K % WOQ_INREG_K_STEP == 0 && kblock % WOQ_INREG_K_STEP == 0 &&
+      (is_4bit(qw_type) ? ldw * 2 >= K : ldw == K);
+  if (!supported) {
+    return at::Tensor();
+  }
+  WoqInregShape s{M, N, K, ldw, kblock, (K + kblock - 1) / kblock, 1};
+  if (quant_block_k > 0) {
+    s.G = s.KB;
+  }
+  auto scales_ = scales.to(at::kFloat).contiguous();
+  TORCH_CHECK(
+      scales_.numel() == N * s.G,
+      "WOQ: Unexpected number of weight scales: ",
+      scales_.numel());
+  auto zps_ = zps.defined() ? zps.to(at::kFloat).contiguous() : zps;
+  auto x_fp32 = x.reshape({M, K}).to(at::kFloat).contiguous();
+  auto y = at::empty({M, N}, x_fp32.options());
+  auto call = [&](auto qw_type_) {
+    constexpr int kQwType = decltype(qw_type_)::value;
+    if (lowp_mode == LOWP_MODE_INT8) {
+      woq_inreg_gemm_int8<kQwType>(
+          x_fp32, qw, scales_, zps_, y, s, quant_a_mode);
+    } else {
+      woq_inreg_gemm_fp32<kQwType>(x_fp32, qw, scales_, zps_, y, s);
+    }
+  };
+  if (qw_type == QINT8) {
+    call(std::integral_constant<int, QINT8>());
+  } else if (qw_type == QINT4) {
+    call(std::integral_constant<int, QINT4>());
+  } else {
+    call(std::integral_constant<int, NF4>());
+  }
+  return y;
+}
+#endif // defined(__AVX2__) && defined(__FMA__)
+
 at::Tensor qlinear_woq_affine(
     const at::Tensor& x,
     const at::Tensor& qw,
@@ -4872,20 +5447,39 @@ at::Tensor qlinear_woq_affine(
   } else if (lowp_mode == LOWP_MODE_BF16) {
     compute_dtype = K >= SMALL_BATCH_THRESHOLD ? at::kBFloat16 : at::kHalf;
   }
-  at::Tensor scale, zp;
-  scale = scales_list[fp32_idx].unsqueeze(-1);
-  if (!sym_quant) {
-    zp = zp_list[fp32_idx].unsqueeze(-1);
+  at::Tensor y;
+#ifdef WOQ_INREG_DEQUANT
+  y = woq_inreg_dequant_gemm(
+      x,
+      qw,
+      scales_list[fp32_idx],
+      sym_quant ? at::Tensor() : zp_list[fp32_idx],
+      qw_type,
+      lowp_mode,
+      quant_a_mode,
+      quant_block_k);
+  if (y.defined()) {
+    N = y.size(1);
+    // computed in fp32 whatever lowp_mode is, see woq_inreg_dequant_gemm
+    compute_dtype = at::kFloat;
+  }
+#endif
+  if (!y.defined()) {
+    at::Tensor scale, zp;
+    scale = scales_list[fp32_idx].unsqueeze(-1);
+    if (!sym_quant) {
+      zp = zp_list[fp32_idx].unsqueeze(-1);
+    }
+    auto w = torch_ipex::cpu::dequantize_woq_weight(
+                 qw, {N, K}, scale, zp, qw_type, quant_block_k)
+                 .to(compute_dtype);
+    auto x_reshape = x.reshape({M, K});
+    auto x_fp = x_reshape.to(compute_dtype);
+    // PyTorch does not support computing in half yet
+    y = compute_dtype == at::kHalf
+        ? at::linear(x_fp.to(c10::kFloat), w.to(c10::kFloat))
+        : at::linear(x_fp, w);
   }
-  auto w = torch_ipex::cpu::dequantize_woq_weight(
-               qw, {N, K}, scale, zp, qw_type, quant_block_k)
-               .to(compute_dtype);
-  auto x_reshape = x.reshape({M, K});
-  auto x_fp = x_reshape.to(compute_dtype);
-  // PyTorch does not support computing in half yet
-  auto y = compute_dtype == at::kHalf
-      ? at::linear(x_fp.to(c10::kFloat), w.to(c10::kFloat))
-      : at::linear(x_fp, w);
   if (biases[0].defined()) {
     auto b_index = compute_dtype == at::kFloat ? fp32_idx
         : compute_dtype == at::kHalf           ? fp16_idx
@@ -20,7 +20,9 @@ void adagrad_fused_step_kernel(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    int64_t begin,
+    int64_t end) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* grad_data = grad.data_ptr<scalar_t>();
   scalar_t* state_sum_data = state_sum.data_ptr<scalar_t>();
@@ -31,42 +33,37 @@ void adagrad_fused_step_kernel(
 
   using Vec = at::vec::Vectorized<scalar_t>;
 
-  int64_t grain_size = 512;
-
   // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        scalar_t* param_ptr = param_data + begin;
-        scalar_t* grad_ptr = grad_data + begin;
-        scalar_t* state_sum_ptr = state_sum_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % Vec::size()); d += Vec::size()) {
-          Vec param_vec = Vec::loadu(param_ptr + d);
-          Vec grad_vec = Vec::loadu(grad_ptr + d);
-          if (_w_decay)
-            grad_vec += param_vec * Vec(scalar_t(weight_decay));
-
-          Vec sum_vec = Vec::loadu(state_sum_ptr + d) + grad_vec * grad_vec;
-          sum_vec.store(state_sum_ptr + d);
-
-          Vec std_vec = sum_vec.sqrt() + Vec(scalar_t(eps));
-          param_vec = param_vec + Vec(scalar_t(-clr)) * grad_vec / std_vec;
-          param_vec.store(param_ptr + d);
-        }
-        for (; d < size; d++) {
-          scalar_t grad_val = grad_ptr[d];
-          if (_w_decay)
-            grad_val += param_ptr[d] * weight_decay;
-          state_sum_ptr[d] += grad_val * grad_val;
-
-          scalar_t std_val = std::sqrt(state_sum_ptr[d]) + eps;
-          param_ptr[d] -= clr * grad_val / std_val;
-        }
-      });
+  // local pointers
+  scalar_t* param_ptr = param_data + begin;
+  scalar_t* grad_ptr = grad_data + begin;
+  scalar_t* state_sum_ptr = state_sum_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec = Vec::loadu(param_ptr + d);
+    Vec grad_vec = Vec::loadu(grad_ptr + d);
+    if (_w_decay)
+      grad_vec += param_vec * Vec(scalar_t(weight_decay));
+
+    Vec sum_vec = Vec::loadu(state_sum_ptr + d) + grad_vec * grad_vec;
+    sum_vec.store(state_sum_ptr + d);
+
+    Vec std_vec = sum_vec.sqrt() + Vec(scalar_t(eps));
+    param_vec = param_vec + Vec(scalar_t(-clr)) * grad_vec / std_vec;
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    scalar_t grad_val = grad_ptr[d];
+    if (_w_decay)
+      grad_val += param_ptr[d] * weight_decay;
+    state_sum_ptr[d] += grad_val * grad_val;
+
+    scalar_t std_val = std::sqrt(state_sum_ptr[d]) + eps;
+    param_ptr[d] -= clr * grad_val / std_val;
+  }
 }
 
 template <>
@@ -79,7 +76,9 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    int64_t begin,
+    int64_t end) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "adagrad_fused_step_kernel: expect param to be at::BFloat16");
@@ -105,67 +104,60 @@ void adagrad_fused_step_kernel<at::BFloat16, at::BFloat16>(
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
   // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        at::BFloat16* param_ptr = param_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        float* state_sum_ptr = state_sum_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
-          fVec param_fvec, param_fvec2;
-          std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
-
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-
-          if (_w_decay) {
-            grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
-            grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
-          }
-
-          fVec sum_fvec =
-              fVec::loadu(state_sum_ptr + d) + grad_fvec * grad_fvec;
-          fVec sum_fvec2 = fVec::loadu(state_sum_ptr + d + fVec::size()) +
-              grad_fvec2 * grad_fvec2;
-          sum_fvec.store(state_sum_ptr + d);
-          sum_fvec2.store(state_sum_ptr + d + fVec::size());
-
-          fVec std_fvec = sum_fvec.sqrt() + fVec(float(eps));
-          fVec std_fvec2 = sum_fvec2.sqrt() + fVec(float(eps));
-          param_fvec = param_fvec - grad_fvec / std_fvec * fVec(float(clr));
-          param_fvec2 = param_fvec2 - grad_fvec2 / std_fvec2 * fVec(float(clr));
-
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = float(grad_ptr[d]);
-          if (_w_decay)
-            grad_val += param_ptr[d] * weight_decay;
-          state_sum_ptr[d] += grad_val * grad_val;
-
-          float std_val = std::sqrt(state_sum_ptr[d]) + eps;
-          param_val -= grad_val / std_val * clr;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
-        }
-      });
+  // local pointers
+  at::BFloat16* param_ptr = param_data + begin;
+  at::BFloat16* grad_ptr = grad_data + begin;
+  float* state_sum_ptr = state_sum_data + begin;
+  at::BFloat16* param2_ptr = param2_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    bVec param_bvec = bVec::loadu(param_ptr + d);
+    bVec param2_bvec = bVec::loadu(param2_ptr + d);
+    fVec param_fvec, param_fvec2;
+    std::tie(param_fvec, param_fvec2) =
+        at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+
+    if (_w_decay) {
+      grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
+      grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
+    }
+
+    fVec sum_fvec = fVec::loadu(state_sum_ptr + d) + grad_fvec * grad_fvec;
+    fVec sum_fvec2 = fVec::loadu(state_sum_ptr + d + fVec::size()) +
+        grad_fvec2 * grad_fvec2;
+    sum_fvec.store(state_sum_ptr + d);
+    sum_fvec2.store(state_sum_ptr + d + fVec::size());
+
+    fVec std_fvec = sum_fvec.sqrt() + fVec(float(eps));
+    fVec std_fvec2 = sum_fvec2.sqrt() + fVec(float(eps));
+    param_fvec = param_fvec - grad_fvec / std_fvec * fVec(float(clr));
+    param_fvec2 = param_fvec2 - grad_fvec2 / std_fvec2 * fVec(float(clr));
+
+    std::tie(param_bvec, param2_bvec) =
+        at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
+    param_bvec.store(param_ptr + d);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+    float grad_val = float(grad_ptr[d]);
+    if (_w_decay)
+      grad_val += param_ptr[d] * weight_decay;
+    state_sum_ptr[d] += grad_val * grad_val;
+
+    float std_val = std::sqrt(state_sum_ptr[d]) + eps;
+    param_val -= grad_val / std_val * clr;
+    std::tie(param_ptr[d], param2_ptr[d]) =
+        at::vec::unpack_float_bfloat16(param_val);
+  }
 }
 
 template <>
@@ -178,7 +170,9 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
+    double eps,
+    int64_t begin,
+    int64_t end) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "adagrad_fused_step_kernel: expect param to be float32");
@@ -204,84 +198,75 @@ void adagrad_fused_step_kernel<float, at::BFloat16>(
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
   // purely element-wise operations
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        float* param_ptr = param_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        float* state_sum_ptr = state_sum_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          fVec param_fvec = fVec::loadu(param_ptr + d);
-          fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
-
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-
-          if (_w_decay) {
-            grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
-            grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
-          }
-
-          fVec sum_fvec =
-              fVec::loadu(state_sum_ptr + d) + grad_fvec * grad_fvec;
-          fVec sum_fvec2 = fVec::loadu(state_sum_ptr + d + fVec::size()) +
-              grad_fvec2 * grad_fvec2;
-          sum_fvec.store(state_sum_ptr + d);
-          sum_fvec2.store(state_sum_ptr + d + fVec::size());
-
-          fVec std_fvec = sum_fvec.sqrt() + fVec(float(eps));
-          fVec std_fvec2 = sum_fvec2.sqrt() + fVec(float(eps));
-          param_fvec = param_fvec - grad_fvec / std_fvec * fVec(float(clr));
-          param_fvec2 = param_fvec2 - grad_fvec2 / std_fvec2 * fVec(float(clr));
-
-          param_fvec.store(param_ptr + d);
-          param_fvec2.store(param_ptr + d + fVec::size());
-          // sync float param to bfloat16
-          bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = float(grad_ptr[d]);
-          if (_w_decay)
-            grad_val += param_ptr[d] * weight_decay;
-          state_sum_ptr[d] += grad_val * grad_val;
-
-          float std_val = std::sqrt(state_sum_ptr[d]) + eps;
-          param_val -= grad_val / std_val * clr;
-          param_ptr[d] = param_val;
-          param2_ptr[d] = at::BFloat16(param_val);
-        }
-      });
+  // local pointers
+  float* param_ptr = param_data + begin;
+  at::BFloat16* grad_ptr = grad_data + begin;
+  float* state_sum_ptr = state_sum_data + begin;
+  at::BFloat16* param2_ptr = param2_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec param_fvec = fVec::loadu(param_ptr + d);
+    fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
+
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+
+    if (_w_decay) {
+      grad_fvec = grad_fvec + param_fvec * fVec(float(weight_decay));
+      grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(float(weight_decay));
+    }
+
+    fVec sum_fvec = fVec::loadu(state_sum_ptr + d) + grad_fvec * grad_fvec;
+    fVec sum_fvec2 = fVec::loadu(state_sum_ptr + d + fVec::size()) +
+        grad_fvec2 * grad_fvec2;
+    sum_fvec.store(state_sum_ptr + d);
+    sum_fvec2.store(state_sum_ptr + d + fVec::size());
+
+    fVec std_fvec = sum_fvec.sqrt() + fVec(float(eps));
+    fVec std_fvec2 = sum_fvec2.sqrt() + fVec(float(eps));
+    param_fvec = param_fvec - grad_fvec / std_fvec * fVec(float(clr));
+    param_fvec2 = param_fvec2 - grad_fvec2 / std_fvec2 * fVec(float(clr));
+
+    param_fvec.store(param_ptr + d);
+    param_fvec2.store(param_ptr + d + fVec::size());
+    // sync float param to bfloat16
+    bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+    float grad_val = float(grad_ptr[d]);
+    if (_w_decay)
+      grad_val += param_ptr[d] * weight_decay;
+    state_sum_ptr[d] += grad_val * grad_val;
+
+    float std_val = std::sqrt(state_sum_ptr[d]) + eps;
+    param_val -= grad_val / std_val * clr;
+    param_ptr[d] = param_val;
+    param2_ptr[d] = at::BFloat16(param_val);
+  }
 }
 
-std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
-    const at::Tensor& param_,
-    const at::Tensor& grad_,
-    const at::Tensor& state_sum_,
-    const at::Tensor& param2_,
+// Updates the elements [begin, end) of one parameter
+void adagrad_fused_step_range(
+    const at::Tensor& param,
+    const at::Tensor& grad,
+    const at::Tensor& state_sum,
+    const at::Tensor& param2,
     double step,
     double learning_rate,
     double weight_decay,
     double lr_decay,
-    double eps) {
-  auto param = param_.contiguous();
-  auto grad = grad_.contiguous();
-  auto state_sum = state_sum_.contiguous();
-  auto param2 = param2_.contiguous();
-
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+    double eps,
+    int64_t begin,
+    int64_t end) {
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
   if (at::ScalarType::Float == grad_dtype) {
     adagrad_fused_step_kernel<float, float>(
         param,
@@ -292,7 +277,9 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        begin,
+        end);
   } else if (at::ScalarType::Double == grad_dtype) {
     adagrad_fused_step_kernel<double, double>(
         param,
@@ -303,7 +290,9 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        begin,
+        end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -316,7 +305,9 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        begin,
+        end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -329,10 +320,44 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
         learning_rate,
         weight_decay,
         lr_decay,
-        eps);
+        eps,
+        begin,
+        end);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
+}
+
+std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& grad_,
+    const at::Tensor& state_sum_,
+    const at::Tensor& param2_,
+    double step,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  auto param = param_.contiguous();
+  auto grad = grad_.contiguous();
+  auto state_sum = state_sum_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  at::parallel_for(
+      0, param.numel(), /*grain_size=*/512, [&](int64_t begin, int64_t end) {
+        adagrad_fused_step_range(
+            param,
+            grad,
+            state_sum,
+            param2,
+            step,
+            learning_rate,
+            weight_decay,
+            lr_decay,
+            eps,
+            begin,
+            end);
+      });
 
   if (!param_.is_contiguous()) {
     param_.copy_(param);
@@ -347,11 +372,63 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step_kernel_impl(
   return std::make_tuple(param_, state_sum_);
 }
 
+void adagrad_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  std::vector<at::Tensor> params, grads, state_sums, params2;
+  std::vector<int64_t> numels;
+  for (size_t i = 0; i < params_.size(); i++) {
+    params.push_back(params_[i].contiguous());
+    grads.push_back(grads_[i].contiguous());
+    state_sums.push_back(state_sums_[i].contiguous());
+    params2.push_back(params2_[i].contiguous());
+    numels.push_back(params_[i].numel());
+  }
+
+  multi_tensor_parallel_for(
+      numels, /*grain_size=*/512, [&](size_t i, int64_t begin, int64_t end) {
+        adagrad_fused_step_range(
+            params[i],
+            grads[i],
+            state_sums[i],
+            params2[i],
+            steps[i],
+            learning_rate,
+            weight_decay,
+            lr_decay,
+            eps,
+            begin,
+            end);
+      });
+
+  for (size_t i = 0; i < params_.size(); i++) {
+    if (!params_[i].is_contiguous()) {
+      params_[i].copy_(params[i]);
+    }
+    if (!state_sums_[i].is_contiguous()) {
+      state_sums_[i].copy_(state_sums[i]);
+    }
+    if (!params2_[i].is_contiguous()) {
+      params2_[i].copy_(params2[i]);
+    }
+  }
+}
+
 } // anonymous namespace
 
 IPEX_REGISTER_DISPATCH(
     adagrad_fused_step_kernel_stub,
     &adagrad_fused_step_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    adagrad_fused_step_multi_tensor_kernel_stub,
+    &adagrad_fused_step_multi_tensor_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
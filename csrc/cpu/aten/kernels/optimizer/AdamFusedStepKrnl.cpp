@@ -22,11 +22,14 @@ void adam_fused_step_kernel(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
+    double param_decay_double,
     double eps_double,
     double step_size_double,
     double bias_correction2_sqrt_double,
     double exp_avg_grad_coefficient_double,
-    double exp_avg_sq_grad_coefficient_double) {
+    double exp_avg_sq_grad_coefficient_double,
+    int64_t begin,
+    int64_t end) {
   scalar_t* param_data = param.data_ptr<scalar_t>();
   scalar_t* exp_avg_data = exp_avg.data_ptr<scalar_t>();
   scalar_t* exp_avg_sq_data = exp_avg_sq.data_ptr<scalar_t>();
@@ -37,6 +40,7 @@ void adam_fused_step_kernel(
   scalar_t beta2 = scalar_t(beta2_double);
   scalar_t learning_rate = scalar_t(learning_rate_double);
   scalar_t weight_decay = scalar_t(weight_decay_double);
+  scalar_t param_decay = scalar_t(param_decay_double);
   scalar_t eps = scalar_t(eps_double);
   scalar_t step_size = scalar_t(step_size_double);
   scalar_t bias_correction2_sqrt = scalar_t(bias_correction2_sqrt_double);
@@ -45,93 +49,94 @@ void adam_fused_step_kernel(
       scalar_t(exp_avg_sq_grad_coefficient_double);
 
   using Vec = at::vec::Vectorized<scalar_t>;
-  int64_t grain_size = 512;
 
   // update momentum vt and mt
   // also accumulate sum of param_norm and rtw_norm
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        scalar_t* param_ptr = param_data + begin;
-        scalar_t* exp_avg_ptr = exp_avg_data + begin;
-        scalar_t* exp_avg_sq_ptr = exp_avg_sq_data + begin;
-        scalar_t* grad_ptr = grad_data + begin;
-        scalar_t* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % Vec::size()); d += Vec::size()) {
-          Vec param_vec = Vec::loadu(param_ptr + d);
-          Vec grad_vec = Vec::loadu(grad_ptr + d);
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_vec += param_vec * Vec(weight_decay);
-          }
-
-          Vec exp_avg_vec = Vec::loadu(exp_avg_ptr + d);
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          const Vec lerp_weight = Vec(exp_avg_grad_coefficient);
-          auto mask = lerp_weight.abs() < Vec(0.5);
-          auto coeff = Vec::blendv(lerp_weight - Vec(1), lerp_weight, mask);
-          auto base = Vec::blendv(grad_vec, exp_avg_vec, mask);
-          exp_avg_vec = fmadd(coeff, grad_vec - exp_avg_vec, base);
-
-          Vec exp_avg_sq_vec = Vec::loadu(exp_avg_sq_ptr + d) * Vec(beta2) +
-              Vec(exp_avg_sq_grad_coefficient) * grad_vec * grad_vec;
-          exp_avg_vec.store(exp_avg_ptr + d);
-          exp_avg_sq_vec.store(exp_avg_sq_ptr + d);
-
-          Vec denom_vec;
-          if (amsgrad) {
-            Vec max_exp_avg_sq_vec =
-                maximum(Vec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_vec);
-            max_exp_avg_sq_vec.store(max_exp_avg_sq_ptr + d);
-            denom_vec = max_exp_avg_sq_vec.sqrt() / Vec(bias_correction2_sqrt) +
-                Vec(eps);
-          } else {
-            denom_vec =
-                exp_avg_sq_vec.sqrt() / Vec(bias_correction2_sqrt) + Vec(eps);
-          }
-          param_vec = param_vec - Vec(step_size) * exp_avg_vec / denom_vec;
-          param_vec.store(param_ptr + d);
-        }
-        for (; d < size; d++) {
-          scalar_t grad_val = grad_ptr[d];
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_val += param_ptr[d] * weight_decay;
-          }
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
-          if (is_lerp_weight_small) {
-            exp_avg_ptr[d] = exp_avg_ptr[d] +
-                exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
-          } else {
-            exp_avg_ptr[d] = grad_val -
-                (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
-          }
-          exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
-              exp_avg_sq_grad_coefficient * grad_val * grad_val;
-          scalar_t demon_val;
-          if (amsgrad) {
-            max_exp_avg_sq_ptr[d] =
-                std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
-            demon_val =
-                std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          } else {
-            demon_val =
-                std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          }
-          param_ptr[d] = param_ptr[d] - step_size * exp_avg_ptr[d] / demon_val;
-        }
-      });
+  // local pointers
+  scalar_t* param_ptr = param_data + begin;
+  scalar_t* exp_avg_ptr = exp_avg_data + begin;
+  scalar_t* exp_avg_sq_ptr = exp_avg_sq_data + begin;
+  scalar_t* grad_ptr = grad_data + begin;
+  scalar_t* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec param_vec = Vec::loadu(param_ptr + d);
+    if (param_decay != 1.f) {
+      // decoupled weight decay
+      param_vec = param_vec * Vec(param_decay);
+    }
+    Vec grad_vec = Vec::loadu(grad_ptr + d);
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_vec += param_vec * Vec(weight_decay);
+    }
+
+    Vec exp_avg_vec = Vec::loadu(exp_avg_ptr + d);
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    const Vec lerp_weight = Vec(exp_avg_grad_coefficient);
+    auto mask = lerp_weight.abs() < Vec(0.5);
+    auto coeff = Vec::blendv(lerp_weight - Vec(1), lerp_weight, mask);
+    auto base = Vec::blendv(grad_vec, exp_avg_vec, mask);
+    exp_avg_vec = fmadd(coeff, grad_vec - exp_avg_vec, base);
+
+    Vec exp_avg_sq_vec = Vec::loadu(exp_avg_sq_ptr + d) * Vec(beta2) +
+        Vec(exp_avg_sq_grad_coefficient) * grad_vec * grad_vec;
+    exp_avg_vec.store(exp_avg_ptr + d);
+    exp_avg_sq_vec.store(exp_avg_sq_ptr + d);
+
+    Vec denom_vec;
+    if (amsgrad) {
+      Vec max_exp_avg_sq_vec =
+          maximum(Vec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_vec);
+      max_exp_avg_sq_vec.store(max_exp_avg_sq_ptr + d);
+      denom_vec = max_exp_avg_sq_vec.sqrt() / Vec(bias_correction2_sqrt) +
+          Vec(eps);
+    } else {
+      denom_vec = exp_avg_sq_vec.sqrt() / Vec(bias_correction2_sqrt) + Vec(eps);
+    }
+    param_vec = param_vec - Vec(step_size) * exp_avg_vec / denom_vec;
+    param_vec.store(param_ptr + d);
+  }
+  for (; d < size; d++) {
+    if (param_decay != 1.f) {
+      param_ptr[d] = param_ptr[d] * param_decay;
+    }
+    scalar_t grad_val = grad_ptr[d];
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_val += param_ptr[d] * weight_decay;
+    }
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
+    if (is_lerp_weight_small) {
+      exp_avg_ptr[d] = exp_avg_ptr[d] +
+          exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
+    } else {
+      exp_avg_ptr[d] = grad_val -
+          (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
+    }
+    exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
+        exp_avg_sq_grad_coefficient * grad_val * grad_val;
+    scalar_t demon_val;
+    if (amsgrad) {
+      max_exp_avg_sq_ptr[d] =
+          std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
+      demon_val =
+          std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    } else {
+      demon_val = std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    }
+    param_ptr[d] = param_ptr[d] - step_size * exp_avg_ptr[d] / demon_val;
+  }
 }
 
 template <>
@@ -146,11 +151,14 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
+    double param_decay_double,
     double eps_double,
     double step_size_double,
     double bias_correction2_sqrt_double,
     double exp_avg_grad_coefficient_double,
-    double exp_avg_sq_grad_coefficient_double) {
+    double exp_avg_sq_grad_coefficient_double,
+    int64_t begin,
+    int64_t end) {
   TORCH_CHECK(
       param.scalar_type() == at::kBFloat16,
       "adam_fused_step_kernel: expect param to be at::BFloat16");
@@ -181,6 +189,7 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
   float beta2 = float(beta2_double);
   float learning_rate = float(learning_rate_double);
   float weight_decay = float(weight_decay_double);
+  float param_decay = float(param_decay_double);
   float eps = float(eps_double);
   float step_size = float(step_size_double);
   float bias_correction2_sqrt = float(bias_correction2_sqrt_double);
@@ -190,132 +199,132 @@ void adam_fused_step_kernel<at::BFloat16, at::BFloat16>(
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        at::BFloat16* param_ptr = param_data + begin;
-        float* exp_avg_ptr = exp_avg_data + begin;
-        float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
-        float* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          // load grad vec
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-          // load param vec
-          bVec param_bvec = bVec::loadu(param_ptr + d);
-          bVec param2_bvec = bVec::loadu(param2_ptr + d);
-          fVec param_fvec, param_fvec2;
-          std::tie(param_fvec, param_fvec2) =
-              at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
-          // weight decay
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
-            grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
-          }
-
-          // update exp_avg, exp_avg_sq
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d);
-          fVec exp_avg_fvec2 = fVec::loadu(exp_avg_ptr + d + fVec::size());
-          fVec lerp_weight = fVec(exp_avg_grad_coefficient);
-          auto mask = lerp_weight.abs() < fVec(0.5);
-          auto coeff = fVec::blendv(lerp_weight - fVec(1), lerp_weight, mask);
-          auto base = fVec::blendv(grad_fvec, exp_avg_fvec, mask);
-          exp_avg_fvec = fmadd(coeff, grad_fvec - exp_avg_fvec, base);
-          auto base2 = fVec::blendv(grad_fvec2, exp_avg_fvec2, mask);
-          exp_avg_fvec2 = fmadd(coeff, grad_fvec2 - exp_avg_fvec2, base2);
-          exp_avg_fvec.store(exp_avg_ptr + d);
-          exp_avg_fvec2.store(exp_avg_ptr + d + fVec::size());
-
-          fVec exp_avg_sq_fvec = fVec::loadu(exp_avg_sq_ptr + d) * fVec(beta2) +
-              fVec(exp_avg_sq_grad_coefficient) * grad_fvec * grad_fvec;
-          fVec exp_avg_sq_fvec2 =
-              fVec::loadu(exp_avg_sq_ptr + d + fVec::size()) * fVec(beta2) +
-              fVec(exp_avg_sq_grad_coefficient) * grad_fvec2 * grad_fvec2;
-          exp_avg_sq_fvec.store(exp_avg_sq_ptr + d);
-          exp_avg_sq_fvec2.store(exp_avg_sq_ptr + d + fVec::size());
-          // amsgrad
-          fVec denom_fvec, denom_fvec2;
-          if (amsgrad) {
-            fVec max_exp_avg_sq_fvec =
-                maximum(fVec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_fvec);
-            fVec max_exp_avg_sq_fvec2 = maximum(
-                fVec::loadu(max_exp_avg_sq_ptr + d + fVec::size()),
-                exp_avg_sq_fvec2);
-            max_exp_avg_sq_fvec.store(max_exp_avg_sq_ptr + d);
-            max_exp_avg_sq_fvec2.store(max_exp_avg_sq_ptr + d + fVec::size());
-            denom_fvec =
-                max_exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-            denom_fvec2 =
-                max_exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-          } else {
-            denom_fvec = exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-            denom_fvec2 =
-                exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-          }
-          // update param
-          param_fvec = param_fvec - fVec(step_size) * exp_avg_fvec / denom_fvec;
-          param_fvec2 =
-              param_fvec2 - fVec(step_size) * exp_avg_fvec2 / denom_fvec2;
-          std::tie(param_bvec, param2_bvec) =
-              at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
-          param_bvec.store(param_ptr + d);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float param_val =
-              at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
-          float grad_val = grad_ptr[d];
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_val = grad_val + param_val * weight_decay;
-          }
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
-          if (is_lerp_weight_small) {
-            exp_avg_ptr[d] = exp_avg_ptr[d] +
-                exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
-          } else {
-            exp_avg_ptr[d] = grad_val -
-                (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
-          }
-          exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
-              exp_avg_sq_grad_coefficient * grad_val * grad_val;
-          float demon_val;
-          if (amsgrad) {
-            max_exp_avg_sq_ptr[d] =
-                std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
-            demon_val =
-                std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          } else {
-            demon_val =
-                std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          }
-          param_val = param_val - step_size * exp_avg_ptr[d] / demon_val;
-          std::tie(param_ptr[d], param2_ptr[d]) =
-              at::vec::unpack_float_bfloat16(param_val);
-        }
-      });
+  // local pointers
+  at::BFloat16* param_ptr = param_data + begin;
+  float* exp_avg_ptr = exp_avg_data + begin;
+  float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
+  float* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
+  at::BFloat16* grad_ptr = grad_data + begin;
+  at::BFloat16* param2_ptr = param2_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    // load grad vec
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+    // load param vec
+    bVec param_bvec = bVec::loadu(param_ptr + d);
+    bVec param2_bvec = bVec::loadu(param2_ptr + d);
+    fVec param_fvec, param_fvec2;
+    std::tie(param_fvec, param_fvec2) =
+        at::vec::pack_bfloat16_float(param_bvec, param2_bvec);
+    if (param_decay != 1.f) {
+      // decoupled weight decay
+      param_fvec = param_fvec * fVec(param_decay);
+      param_fvec2 = param_fvec2 * fVec(param_decay);
+    }
+    // weight decay
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
+      grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
+    }
+
+    // update exp_avg, exp_avg_sq
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d);
+    fVec exp_avg_fvec2 = fVec::loadu(exp_avg_ptr + d + fVec::size());
+    fVec lerp_weight = fVec(exp_avg_grad_coefficient);
+    auto mask = lerp_weight.abs() < fVec(0.5);
+    auto coeff = fVec::blendv(lerp_weight - fVec(1), lerp_weight, mask);
+    auto base = fVec::blendv(grad_fvec, exp_avg_fvec, mask);
+    exp_avg_fvec = fmadd(coeff, grad_fvec - exp_avg_fvec, base);
+    auto base2 = fVec::blendv(grad_fvec2, exp_avg_fvec2, mask);
+    exp_avg_fvec2 = fmadd(coeff, grad_fvec2 - exp_avg_fvec2, base2);
+    exp_avg_fvec.store(exp_avg_ptr + d);
+    exp_avg_fvec2.store(exp_avg_ptr + d + fVec::size());
+
+    fVec exp_avg_sq_fvec = fVec::loadu(exp_avg_sq_ptr + d) * fVec(beta2) +
+        fVec(exp_avg_sq_grad_coefficient) * grad_fvec * grad_fvec;
+    fVec exp_avg_sq_fvec2 =
+        fVec::loadu(exp_avg_sq_ptr + d + fVec::size()) * fVec(beta2) +
+        fVec(exp_avg_sq_grad_coefficient) * grad_fvec2 * grad_fvec2;
+    exp_avg_sq_fvec.store(exp_avg_sq_ptr + d);
+    exp_avg_sq_fvec2.store(exp_avg_sq_ptr + d + fVec::size());
+    // amsgrad
+    fVec denom_fvec, denom_fvec2;
+    if (amsgrad) {
+      fVec max_exp_avg_sq_fvec =
+          maximum(fVec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_fvec);
+      fVec max_exp_avg_sq_fvec2 = maximum(
+          fVec::loadu(max_exp_avg_sq_ptr + d + fVec::size()),
+          exp_avg_sq_fvec2);
+      max_exp_avg_sq_fvec.store(max_exp_avg_sq_ptr + d);
+      max_exp_avg_sq_fvec2.store(max_exp_avg_sq_ptr + d + fVec::size());
+      denom_fvec =
+          max_exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+      denom_fvec2 =
+          max_exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+    } else {
+      denom_fvec = exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+      denom_fvec2 =
+          exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+    }
+    // update param
+    param_fvec = param_fvec - fVec(step_size) * exp_avg_fvec / denom_fvec;
+    param_fvec2 = param_fvec2 - fVec(step_size) * exp_avg_fvec2 / denom_fvec2;
+    std::tie(param_bvec, param2_bvec) =
+        at::vec::unpack_float_bfloat16(param_fvec, param_fvec2);
+    param_bvec.store(param_ptr + d);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    float param_val = at::vec::pack_bfloat16_float(param_ptr[d], param2_ptr[d]);
+    if (param_decay != 1.f) {
+      param_val = param_val * param_decay;
+    }
+    float grad_val = grad_ptr[d];
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_val = grad_val + param_val * weight_decay;
+    }
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
+    if (is_lerp_weight_small) {
+      exp_avg_ptr[d] = exp_avg_ptr[d] +
+          exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
+    } else {
+      exp_avg_ptr[d] = grad_val -
+          (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
+    }
+    exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
+        exp_avg_sq_grad_coefficient * grad_val * grad_val;
+    float demon_val;
+    if (amsgrad) {
+      max_exp_avg_sq_ptr[d] =
+          std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
+      demon_val =
+          std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    } else {
+      demon_val = std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    }
+    param_val = param_val - step_size * exp_avg_ptr[d] / demon_val;
+    std::tie(param_ptr[d], param2_ptr[d]) =
+        at::vec::unpack_float_bfloat16(param_val);
+  }
 }
 
 template <>
@@ -330,11 +339,14 @@ void adam_fused_step_kernel<float, at::BFloat16>(
     double beta2_double,
     double learning_rate_double,
     double weight_decay_double,
+    double param_decay_double,
     double eps_double,
     double step_size_double,
     double bias_correction2_sqrt_double,
     double exp_avg_grad_coefficient_double,
-    double exp_avg_sq_grad_coefficient_double) {
+    double exp_avg_sq_grad_coefficient_double,
+    int64_t begin,
+    int64_t end) {
   TORCH_CHECK(
       param.scalar_type() == at::kFloat,
       "adam_fused_step_kernel: expect param to be at::Float");
@@ -365,6 +377,7 @@ void adam_fused_step_kernel<float, at::BFloat16>(
   float beta2 = float(beta2_double);
   float learning_rate = float(learning_rate_double);
   float weight_decay = float(weight_decay_double);
+  float param_decay = float(param_decay_double);
   float eps = float(eps_double);
   float step_size = float(step_size_double);
   float bias_correction2_sqrt = float(bias_correction2_sqrt_double);
@@ -374,151 +387,157 @@ void adam_fused_step_kernel<float, at::BFloat16>(
   using bVec = at::vec::Vectorized<at::BFloat16>;
   using fVec = at::vec::Vectorized<float>;
 
-  int64_t grain_size = 512;
-
-  at::parallel_for(
-      0, param.numel(), grain_size, [&](int64_t begin, int64_t end) {
-        // local pointers
-        float* param_ptr = param_data + begin;
-        float* exp_avg_ptr = exp_avg_data + begin;
-        float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
-        float* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
-        at::BFloat16* grad_ptr = grad_data + begin;
-        at::BFloat16* param2_ptr = param2_data + begin;
-
-        const int64_t size = end - begin;
-
-        int64_t d = 0;
-        for (; d < size - (size % bVec::size()); d += bVec::size()) {
-          // load grad vec
-          bVec grad_bvec = bVec::loadu(grad_ptr + d);
-          fVec grad_fvec, grad_fvec2;
-          std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
-          // load param vec
-          fVec param_fvec = fVec::loadu(param_ptr + d);
-          fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
-          // weight decay
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
-            grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
-          }
-          // update exp_avg, exp_avg_sq
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d);
-          fVec exp_avg_fvec2 = fVec::loadu(exp_avg_ptr + d + fVec::size());
-          fVec lerp_weight = fVec(exp_avg_grad_coefficient);
-          auto mask = lerp_weight.abs() < fVec(0.5);
-          auto coeff = fVec::blendv(lerp_weight - fVec(1), lerp_weight, mask);
-          auto base = fVec::blendv(grad_fvec, exp_avg_fvec, mask);
-          exp_avg_fvec = fmadd(coeff, grad_fvec - exp_avg_fvec, base);
-          auto base2 = fVec::blendv(grad_fvec2, exp_avg_fvec2, mask);
-          exp_avg_fvec2 = fmadd(coeff, grad_fvec2 - exp_avg_fvec2, base2);
-          exp_avg_fvec.store(exp_avg_ptr + d);
-          exp_avg_fvec2.store(exp_avg_ptr + d + fVec::size());
-
-          fVec exp_avg_sq_fvec = fVec::loadu(exp_avg_sq_ptr + d) * fVec(beta2) +
-              fVec(exp_avg_sq_grad_coefficient) * grad_fvec * grad_fvec;
-          fVec exp_avg_sq_fvec2 =
-              fVec::loadu(exp_avg_sq_ptr + d + fVec::size()) * fVec(beta2) +
-              fVec(exp_avg_sq_grad_coefficient) * grad_fvec2 * grad_fvec2;
-          exp_avg_sq_fvec.store(exp_avg_sq_ptr + d);
-          exp_avg_sq_fvec2.store(exp_avg_sq_ptr + d + fVec::size());
-          // amsgrad
-          fVec denom_fvec, denom_fvec2;
-          if (amsgrad) {
-            fVec max_exp_avg_sq_fvec =
-                maximum(fVec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_fvec);
-            fVec max_exp_avg_sq_fvec2 = maximum(
-                fVec::loadu(max_exp_avg_sq_ptr + d + fVec::size()),
-                exp_avg_sq_fvec2);
-            max_exp_avg_sq_fvec.store(max_exp_avg_sq_ptr + d);
-            max_exp_avg_sq_fvec2.store(max_exp_avg_sq_ptr + d + fVec::size());
-            denom_fvec =
-                max_exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-            denom_fvec2 =
-                max_exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-          } else {
-            denom_fvec = exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-            denom_fvec2 =
-                exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
-                fVec(eps);
-          }
-          // update param
-          param_fvec = param_fvec - fVec(step_size) * exp_avg_fvec / denom_fvec;
-          param_fvec2 =
-              param_fvec2 - fVec(step_size) * exp_avg_fvec2 / denom_fvec2;
-          param_fvec.store(param_ptr + d);
-          param_fvec2.store(param_ptr + d + fVec::size());
-          // sync float param to bfloat16
-          bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
-          param2_bvec.store(param2_ptr + d);
-        }
-        for (; d < size; d++) {
-          float grad_val = grad_ptr[d];
-          if (weight_decay != 0.f) {
-            // only accumulate weight decay when weight_decay != 0 to avoid NaN
-            // propagation from param to grad
-            grad_val = grad_val + param_ptr[d] * weight_decay;
-          }
-          // exp_avg.lerp_(grad, 1 - beta1)
-          // exactly match
-          // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
-          auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
-          if (is_lerp_weight_small) {
-            exp_avg_ptr[d] = exp_avg_ptr[d] +
-                exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
-          } else {
-            exp_avg_ptr[d] = grad_val -
-                (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
-          }
-          exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
-              exp_avg_sq_grad_coefficient * grad_val * grad_val;
-          float demon_val;
-          if (amsgrad) {
-            max_exp_avg_sq_ptr[d] =
-                std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
-            demon_val =
-                std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          } else {
-            demon_val =
-                std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
-          }
-          param_ptr[d] = param_ptr[d] - step_size * exp_avg_ptr[d] / demon_val;
-          param2_ptr[d] = at::BFloat16(param_ptr[d]);
-        }
-      });
+  // local pointers
+  float* param_ptr = param_data + begin;
+  float* exp_avg_ptr = exp_avg_data + begin;
+  float* exp_avg_sq_ptr = exp_avg_sq_data + begin;
+  float* max_exp_avg_sq_ptr = max_exp_avg_sq_data + begin;
+  at::BFloat16* grad_ptr = grad_data + begin;
+  at::BFloat16* param2_ptr = param2_data + begin;
+
+  const int64_t size = end - begin;
+
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    // load grad vec
+    bVec grad_bvec = bVec::loadu(grad_ptr + d);
+    fVec grad_fvec, grad_fvec2;
+    std::tie(grad_fvec, grad_fvec2) = convert_bfloat16_float(grad_bvec);
+    // load param vec
+    fVec param_fvec = fVec::loadu(param_ptr + d);
+    fVec param_fvec2 = fVec::loadu(param_ptr + d + fVec::size());
+    if (param_decay != 1.f) {
+      // decoupled weight decay
+      param_fvec = param_fvec * fVec(param_decay);
+      param_fvec2 = param_fvec2 * fVec(param_decay);
+    }
+    // weight decay
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_fvec = grad_fvec + param_fvec * fVec(weight_decay);
+      grad_fvec2 = grad_fvec2 + param_fvec2 * fVec(weight_decay);
+    }
+    // update exp_avg, exp_avg_sq
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    fVec exp_avg_fvec = fVec::loadu(exp_avg_ptr + d);
+    fVec exp_avg_fvec2 = fVec::loadu(exp_avg_ptr + d + fVec::size());
+    fVec lerp_weight = fVec(exp_avg_grad_coefficient);
+    auto mask = lerp_weight.abs() < fVec(0.5);
+    auto coeff = fVec::blendv(lerp_weight - fVec(1), lerp_weight, mask);
+    auto base = fVec::blendv(grad_fvec, exp_avg_fvec, mask);
+    exp_avg_fvec = fmadd(coeff, grad_fvec - exp_avg_fvec, base);
+    auto base2 = fVec::blendv(grad_fvec2, exp_avg_fvec2, mask);
+    exp_avg_fvec2 = fmadd(coeff, grad_fvec2 - exp_avg_fvec2, base2);
+    exp_avg_fvec.store(exp_avg_ptr + d);
+    exp_avg_fvec2.store(exp_avg_ptr + d + fVec::size());
+
+    fVec exp_avg_sq_fvec = fVec::loadu(exp_avg_sq_ptr + d) * fVec(beta2) +
+        fVec(exp_avg_sq_grad_coefficient) * grad_fvec * grad_fvec;
+    fVec exp_avg_sq_fvec2 =
+        fVec::loadu(exp_avg_sq_ptr + d + fVec::size()) * fVec(beta2) +
+        fVec(exp_avg_sq_grad_coefficient) * grad_fvec2 * grad_fvec2;
+    exp_avg_sq_fvec.store(exp_avg_sq_ptr + d);
+    exp_avg_sq_fvec2.store(exp_avg_sq_ptr + d + fVec::size());
+    // amsgrad
+    fVec denom_fvec, denom_fvec2;
+    if (amsgrad) {
+      fVec max_exp_avg_sq_fvec =
+          maximum(fVec::loadu(max_exp_avg_sq_ptr + d), exp_avg_sq_fvec);
+      fVec max_exp_avg_sq_fvec2 = maximum(
+          fVec::loadu(max_exp_avg_sq_ptr + d + fVec::size()),
+          exp_avg_sq_fvec2);
+      max_exp_avg_sq_fvec.store(max_exp_avg_sq_ptr + d);
+      max_exp_avg_sq_fvec2.store(max_exp_avg_sq_ptr + d + fVec::size());
+      denom_fvec =
+          max_exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+      denom_fvec2 =
+          max_exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+    } else {
+      denom_fvec = exp_avg_sq_fvec.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+      denom_fvec2 =
+          exp_avg_sq_fvec2.sqrt() / fVec(bias_correction2_sqrt) +
+          fVec(eps);
+    }
+    // update param
+    param_fvec = param_fvec - fVec(step_size) * exp_avg_fvec / denom_fvec;
+    param_fvec2 = param_fvec2 - fVec(step_size) * exp_avg_fvec2 / denom_fvec2;
+    param_fvec.store(param_ptr + d);
+    param_fvec2.store(param_ptr + d + fVec::size());
+    // sync float param to bfloat16
+    bVec param2_bvec = convert_float_bfloat16(param_fvec, param_fvec2);
+    param2_bvec.store(param2_ptr + d);
+  }
+  for (; d < size; d++) {
+    if (param_decay != 1.f) {
+      param_ptr[d] = param_ptr[d] * param_decay;
+    }
+    float grad_val = grad_ptr[d];
+    if (weight_decay != 0.f) {
+      // only accumulate weight decay when weight_decay != 0 to avoid NaN
+      // propagation from param to grad
+      grad_val = grad_val + param_ptr[d] * weight_decay;
+    }
+    // exp_avg.lerp_(grad, 1 - beta1)
+    // exactly match
+    // https://github.com/pytorch/pytorch/blob/d04957c0c682d766987cad07dce20986ca4a5b78/aten/src/ATen/native/cpu/LerpKernel.cpp#L99-L110
+    auto is_lerp_weight_small = std::abs(exp_avg_grad_coefficient) < 0.5;
+    if (is_lerp_weight_small) {
+      exp_avg_ptr[d] = exp_avg_ptr[d] +
+          exp_avg_grad_coefficient * (grad_val - exp_avg_ptr[d]);
+    } else {
+      exp_avg_ptr[d] = grad_val -
+          (grad_val - exp_avg_ptr[d]) * (1 - exp_avg_grad_coefficient);
+    }
+    exp_avg_sq_ptr[d] = exp_avg_sq_ptr[d] * beta2 +
+        exp_avg_sq_grad_coefficient * grad_val * grad_val;
+    float demon_val;
+    if (amsgrad) {
+      max_exp_avg_sq_ptr[d] =
+          std::max(max_exp_avg_sq_ptr[d], exp_avg_sq_ptr[d]);
+      demon_val =
+          std::sqrt(max_exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    } else {
+      demon_val = std::sqrt(exp_avg_sq_ptr[d]) / bias_correction2_sqrt + eps;
+    }
+    param_ptr[d] = param_ptr[d] - step_size * exp_avg_ptr[d] / demon_val;
+    param2_ptr[d] = at::BFloat16(param_ptr[d]);
+  }
 }
 
-void adam_fused_step_kernel_impl(
-    const at::Tensor& param_,
-    const at::Tensor& exp_avg_,
-    const at::Tensor& exp_avg_sq_,
-    const at::Tensor& max_exp_avg_sq_,
-    const at::Tensor& grad_,
-    const at::Tensor& param2_,
+// Updates the elements [begin, end) of one parameter
+void adam_fused_step_range(
+    const at::Tensor& param,
+    const at::Tensor& exp_avg,
+    const at::Tensor& exp_avg_sq,
+    const at::Tensor& max_exp_avg_sq,
+    const at::Tensor& grad,
+    const at::Tensor& param2,
     bool amsgrad,
     double step,
     double beta1,
     double beta2,
     double learning_rate,
     double weight_decay,
-    double eps) {
-  auto param = param_.contiguous();
-  auto exp_avg = exp_avg_.contiguous();
-  auto exp_avg_sq = exp_avg_sq_.contiguous();
-  auto max_exp_avg_sq = max_exp_avg_sq_.contiguous();
-  auto grad = grad_.contiguous();
-  auto param2 = param2_.contiguous();
-
-  auto grad_dtype = grad_.scalar_type();
-  auto param_dtype = param_.scalar_type();
+    bool decoupled_weight_decay,
+    double eps,
+    int64_t begin,
+    int64_t end) {
+  auto grad_dtype = grad.scalar_type();
+  auto param_dtype = param.scalar_type();
+
+  // AdamW decays param by lr * weight_decay instead of adding weight_decay *
+  // param to grad
+  double param_decay = 1;
+  if (decoupled_weight_decay) {
+    param_decay = 1 - learning_rate * weight_decay;
+    weight_decay = 0;
+  }
 
   // make sure all scalar args are computationed with double precision
   double bias_correction1 = 1 - std::pow(beta1, step);
@@ -540,11 +559,14 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
+        param_decay,
         eps,
         step_size,
         bias_correction2_sqrt,
         exp_avg_grad_coefficient,
-        exp_avg_sq_grad_coefficient);
+        exp_avg_sq_grad_coefficient,
+        begin,
+        end);
   } else if (at::ScalarType::Double == grad_dtype) {
     adam_fused_step_kernel<double, double>(
         param,
@@ -557,11 +579,14 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
+        param_decay,
         eps,
         step_size,
         bias_correction2_sqrt,
         exp_avg_grad_coefficient,
-        exp_avg_sq_grad_coefficient);
+        exp_avg_sq_grad_coefficient,
+        begin,
+        end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::BFloat16 == param_dtype) {
@@ -576,11 +601,14 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
+        param_decay,
         eps,
         step_size,
         bias_correction2_sqrt,
         exp_avg_grad_coefficient,
-        exp_avg_sq_grad_coefficient);
+        exp_avg_sq_grad_coefficient,
+        begin,
+        end);
   } else if (
       at::ScalarType::BFloat16 == grad_dtype &&
       at::ScalarType::Float == param_dtype) {
@@ -595,14 +623,61 @@ void adam_fused_step_kernel_impl(
         beta2,
         learning_rate,
         weight_decay,
+        param_decay,
         eps,
         step_size,
         bias_correction2_sqrt,
         exp_avg_grad_coefficient,
-        exp_avg_sq_grad_coefficient);
+        exp_avg_sq_grad_coefficient,
+        begin,
+        end);
   } else {
     TORCH_CHECK(false, "expect bfloat16 or float or double param");
   }
+}
+
+void adam_fused_step_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    bool decoupled_weight_decay,
+    double eps) {
+  auto param = param_.contiguous();
+  auto exp_avg = exp_avg_.contiguous();
+  auto exp_avg_sq = exp_avg_sq_.contiguous();
+  auto max_exp_avg_sq = max_exp_avg_sq_.contiguous();
+  auto grad = grad_.contiguous();
+  auto param2 = param2_.contiguous();
+
+  at::parallel_for(
+      0, param.numel(), /*grain_size=*/512, [&](int64_t begin, int64_t end) {
+        adam_fused_step_range(
+            param,
+            exp_avg,
+            exp_avg_sq,
+            max_exp_avg_sq,
+            grad,
+            param2,
+            amsgrad,
+            step,
+            beta1,
+            beta2,
+            learning_rate,
+            weight_decay,
+            decoupled_weight_decay,
+            eps,
+            begin,
+            end);
+      });
 
   if (!param_.is_contiguous()) {
     param_.copy_(param);
@@ -621,11 +696,215 @@ void adam_fused_step_kernel_impl(
   }
 }
 
+void adam_fused_step_multi_tensor_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    bool decoupled_weight_decay,
+    double eps) {
+  std::vector<at::Tensor> params, exp_avgs, exp_avg_sqs, max_exp_avg_sqs,
+      grads, params2;
+  std::vector<int64_t> numels;
+  for (size_t i = 0; i < params_.size(); i++) {
+    params.push_back(params_[i].contiguous());
+    exp_avgs.push_back(exp_avgs_[i].contiguous());
+    exp_avg_sqs.push_back(exp_avg_sqs_[i].contiguous());
+    // max_exp_avg_sqs is empty without amsgrad
+    max_exp_avg_sqs.push_back(
+        amsgrad ? max_exp_avg_sqs_[i].contiguous()
+                : at::empty({0}, exp_avgs_[i].options()));
+    grads.push_back(grads_[i].contiguous());
+    params2.push_back(params2_[i].contiguous());
+    numels.push_back(params_[i].numel());
+  }
+
+  multi_tensor_parallel_for(
+      numels, /*grain_size=*/512, [&](size_t i, int64_t begin, int64_t end) {
+        adam_fused_step_range(
+            params[i],
+            exp_avgs[i],
+            exp_avg_sqs[i],
+            max_exp_avg_sqs[i],
+            grads[i],
+            params2[i],
+            amsgrad,
+            steps[i],
+            beta1,
+            beta2,
+            learning_rate,
+            weight_decay,
+            decoupled_weight_decay,
+            eps,
+            begin,
+            end);
+      });
+
+  for (size_t i = 0; i < params_.size(); i++) {
+    if (!params_[i].is_contiguous()) {
+      params_[i].copy_(params[i]);
+    }
+    if (!exp_avgs_[i].is_contiguous()) {
+      exp_avgs_[i].copy_(exp_avgs[i]);
+    }
+    if (!exp_avg_sqs_[i].is_contiguous()) {
+      exp_avg_sqs_[i].copy_(exp_avg_sqs[i]);
+    }
+    if (amsgrad && !max_exp_avg_sqs_[i].is_contiguous()) {
+      max_exp_avg_sqs_[i].copy_(max_exp_avg_sqs[i]);
+    }
+    if (!params2_[i].is_contiguous()) {
+      params2_[i].copy_(params2[i]);
+    }
+  }
+}
+
+void adam_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  adam_fused_step_impl(
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      /*decoupled_weight_decay=*/false,
+      eps);
+}
+
+void adamw_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  adam_fused_step_impl(
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      /*decoupled_weight_decay=*/true,
+      eps);
+}
+
+void adam_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  adam_fused_step_multi_tensor_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      /*decoupled_weight_decay=*/false,
+      eps);
+}
+
+void adamw_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  adam_fused_step_multi_tensor_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      /*decoupled_weight_decay=*/true,
+      eps);
+}
+
 } // anonymous namespace
 
 IPEX_REGISTER_DISPATCH(
     adam_fused_step_kernel_stub,
     &adam_fused_step_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    adam_fused_step_multi_tensor_kernel_stub,
+    &adam_fused_step_multi_tensor_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    adamw_fused_step_kernel_stub,
+    &adamw_fused_step_kernel_impl);
+IPEX_REGISTER_DISPATCH(
+    adamw_fused_step_multi_tensor_kernel_stub,
+    &adamw_fused_step_multi_tensor_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
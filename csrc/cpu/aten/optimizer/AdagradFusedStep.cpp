@@ -7,6 +7,7 @@ namespace torch_ipex {
 namespace cpu {
 
 IPEX_DEFINE_DISPATCH(adagrad_fused_step_kernel_stub);
+IPEX_DEFINE_DISPATCH(adagrad_fused_step_multi_tensor_kernel_stub);
 
 std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
     const at::Tensor& param_,
@@ -72,6 +73,73 @@ std::tuple<at::Tensor, at::Tensor> adagrad_fused_step(
       eps);
 }
 
+// Adagrad step of all the params of a param group, the elements of all the
+// params are split among the threads in a single parallel region
+void adagrad_fused_step_multi_tensor(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adagrad_fused_step_multi_tensor",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(lr_decay >= 0, "Expect lr_decay >=0.0 , got ", lr_decay);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto num_params = params_.size();
+  TORCH_CHECK(
+      grads_.size() == num_params && state_sums_.size() == num_params &&
+          params2_.size() == num_params && steps.size() == num_params,
+      "Expect the tensor lists and steps have the same lengths as params, got ",
+      num_params,
+      " params");
+  for (size_t i = 0; i < num_params; i++) {
+    TORCH_CHECK(
+        params_[i].sizes() == grads_[i].sizes() &&
+            params_[i].sizes() == state_sums_[i].sizes() &&
+            (params2_[i].numel() == 0 ||
+             params_[i].sizes() == params2_[i].sizes()),
+        "Expect param ",
+        i,
+        " and its grad and state_sum have the same sizes, param sizes: ",
+        params_[i].sizes());
+  }
+
+  /*
+  pointer to adagrad_fused_step_multi_tensor_kernel_impl(
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+  */
+  adagrad_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      state_sums_,
+      params2_,
+      steps,
+      learning_rate,
+      weight_decay,
+      lr_decay,
+      eps);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -83,6 +151,11 @@ TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
       "state_sum, Tensor trail, float step, float lr, float weight_decay, "
       "float lr_decay, float eps) -> (Tensor(a!), Tensor(b!))",
       torch_ipex::cpu::adagrad_fused_step);
+  m.def(
+      "adagrad_fused_step_multi_tensor(Tensor(a!)[] params, Tensor[] grads, "
+      "Tensor(b!)[] state_sums, Tensor(c!)[] trails, float[] steps, float lr, "
+      "float weight_decay, float lr_decay, float eps) -> ()",
+      torch_ipex::cpu::adagrad_fused_step_multi_tensor);
 }
 
 } // namespace
@@ -8,8 +8,13 @@ namespace torch_ipex {
 namespace cpu {
 
 IPEX_DEFINE_DISPATCH(adam_fused_step_kernel_stub);
+IPEX_DEFINE_DISPATCH(adam_fused_step_multi_tensor_kernel_stub);
+IPEX_DEFINE_DISPATCH(adamw_fused_step_kernel_stub);
+IPEX_DEFINE_DISPATCH(adamw_fused_step_multi_tensor_kernel_stub);
 
-void adam_fused_step(
+namespace {
+
+void check_adam_fused_step_args(
     const at::Tensor& param_,
     const at::Tensor& exp_avg_,
     const at::Tensor& exp_avg_sq_,
@@ -17,15 +22,11 @@ void adam_fused_step(
     const at::Tensor& grad_,
     const at::Tensor& param2_,
     bool amsgrad,
-    double step,
     double beta1,
     double beta2,
     double learning_rate,
     double weight_decay,
     double eps) {
-  RECORD_FUNCTION(
-      "torch_ipex::adam_fused_step", c10::ArrayRef<c10::IValue>({}));
-
   TORCH_CHECK(
       learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
   TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
@@ -66,6 +67,86 @@ void adam_fused_step(
       param_.sizes(),
       "; param2_ sizes: ",
       param2_.sizes());
+}
+
+void check_adam_fused_step_multi_tensor_args(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto num_params = params_.size();
+  TORCH_CHECK(
+      exp_avgs_.size() == num_params && exp_avg_sqs_.size() == num_params &&
+          (!amsgrad || max_exp_avg_sqs_.size() == num_params) &&
+          grads_.size() == num_params && params2_.size() == num_params &&
+          steps.size() == num_params,
+      "Expect the tensor lists and steps have the same lengths as params, got ",
+      num_params,
+      " params");
+  for (size_t i = 0; i < num_params; i++) {
+    TORCH_CHECK(
+        params_[i].sizes() == grads_[i].sizes() &&
+            params_[i].sizes() == exp_avgs_[i].sizes() &&
+            params_[i].sizes() == exp_avg_sqs_[i].sizes() &&
+            (!amsgrad || params_[i].sizes() == max_exp_avg_sqs_[i].sizes()) &&
+            (params2_[i].numel() == 0 ||
+             params_[i].sizes() == params2_[i].sizes()),
+        "Expect param ",
+        i,
+        " and its grad and states have the same sizes, param sizes: ",
+        params_[i].sizes());
+  }
+}
+
+} // namespace
+
+void adam_fused_step(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adam_fused_step", c10::ArrayRef<c10::IValue>({}));
+
+  check_adam_fused_step_args(
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
 
   /*
   pointer to adam_fused_step_kernel_impl(
@@ -100,6 +181,209 @@ void adam_fused_step(
       eps);
 }
 
+// Adam step of all the params of a param group, the elements of all the params
+// are split among the threads in a single parallel region
+void adam_fused_step_multi_tensor(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adam_fused_step_multi_tensor",
+      c10::ArrayRef<c10::IValue>({}));
+
+  check_adam_fused_step_multi_tensor_args(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+
+  /*
+  pointer to adam_fused_step_multi_tensor_kernel_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  */
+  adam_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+}
+
+// AdamW step, same as adam_fused_step except that param is decayed by
+// learning_rate * weight_decay instead of adding weight_decay * param to grad.
+// A bfloat16 param with a bfloat16 param2 is the top half of the fp32 master
+// weight with param2 its trail (split master weight), a fp32 param with a
+// bfloat16 param2 is the master weight of the bfloat16 param2.
+void adamw_fused_step(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adamw_fused_step", c10::ArrayRef<c10::IValue>({}));
+
+  check_adam_fused_step_args(
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+
+  /*
+  pointer to adamw_fused_step_kernel_impl(
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  */
+  adamw_fused_step_kernel_stub(
+      kCPU,
+      param_,
+      exp_avg_,
+      exp_avg_sq_,
+      max_exp_avg_sq_,
+      grad_,
+      param2_,
+      amsgrad,
+      step,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+}
+
+void adamw_fused_step_multi_tensor(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::adamw_fused_step_multi_tensor",
+      c10::ArrayRef<c10::IValue>({}));
+
+  check_adam_fused_step_multi_tensor_args(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+
+  /*
+  pointer to adamw_fused_step_multi_tensor_kernel_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  */
+  adamw_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      max_exp_avg_sqs_,
+      grads_,
+      params2_,
+      amsgrad,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -110,6 +394,18 @@ IPEX_LIBRARY_FRAGMENT() {
       "adam_fused_step",
       torch_ipex::cpu::adam_fused_step,
       at::DispatchKey::CPU);
+  IPEX_OP_REGISTER_DISPATCH(
+      "adam_fused_step_multi_tensor",
+      torch_ipex::cpu::adam_fused_step_multi_tensor,
+      at::DispatchKey::CPU);
+  IPEX_OP_REGISTER_DISPATCH(
+      "adamw_fused_step",
+      torch_ipex::cpu::adamw_fused_step,
+      at::DispatchKey::CPU);
+  IPEX_OP_REGISTER_DISPATCH(
+      "adamw_fused_step_multi_tensor",
+      torch_ipex::cpu::adamw_fused_step_multi_tensor,
+      at::DispatchKey::CPU);
 }
 
 } // namespace
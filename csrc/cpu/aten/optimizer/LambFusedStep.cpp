@@ -8,6 +8,7 @@ namespace torch_ipex {
 namespace cpu {
 
 IPEX_DEFINE_DISPATCH(lamb_fused_step_kernel_stub);
+IPEX_DEFINE_DISPATCH(lamb_fused_step_multi_tensor_kernel_stub);
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
     const at::Tensor& param_,
@@ -86,6 +87,83 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> lamb_fused_step(
       eps);
 }
 
+// LAMB step of all the params of a param group. The moments and the norms of
+// all the params are computed in one parallel region and the params are
+// updated in a second one, as the update needs the finished norms.
+void lamb_fused_step_multi_tensor(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    at::ArrayRef<int64_t> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps) {
+  RECORD_FUNCTION(
+      "torch_ipex::lamb_fused_step_multi_tensor",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      learning_rate >= 0, "Expect learning rate >= 0.0, got ", learning_rate);
+  TORCH_CHECK(eps >= 0, "Expect eps >= 0.0, got ", eps);
+  TORCH_CHECK(beta1 >= 0 && beta1 < 1, "Expect 0.0 <= beta1 < 1.0, got", beta1);
+  TORCH_CHECK(beta2 >= 0 && beta2 < 1, "Expect 0.0 <= beta2 < 1.0, got", beta2);
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto num_params = params_.size();
+  TORCH_CHECK(
+      exp_avgs_.size() == num_params && exp_avg_sqs_.size() == num_params &&
+          grads_.size() == num_params && params2_.size() == num_params &&
+          steps.size() == num_params,
+      "Expect the tensor lists and steps have the same lengths as params, got ",
+      num_params,
+      " params");
+  for (size_t i = 0; i < num_params; i++) {
+    TORCH_CHECK(
+        params_[i].sizes() == grads_[i].sizes() &&
+            params_[i].sizes() == exp_avgs_[i].sizes() &&
+            params_[i].sizes() == exp_avg_sqs_[i].sizes() &&
+            (params2_[i].numel() == 0 ||
+             params_[i].sizes() == params2_[i].sizes()),
+        "Expect param ",
+        i,
+        " and its grad and states have the same sizes, param sizes: ",
+        params_[i].sizes());
+  }
+
+  /*
+  pointer to lamb_fused_step_multi_tensor_kernel_impl(
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      grads_,
+      params2_,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+  */
+  lamb_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      exp_avgs_,
+      exp_avg_sqs_,
+      grads_,
+      params2_,
+      steps,
+      beta1,
+      beta2,
+      learning_rate,
+      weight_decay,
+      eps);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -96,6 +174,10 @@ IPEX_LIBRARY_FRAGMENT() {
       "lamb_fused_step",
       torch_ipex::cpu::lamb_fused_step,
       at::DispatchKey::CPU);
+  IPEX_OP_REGISTER_DISPATCH(
+      "lamb_fused_step_multi_tensor",
+      torch_ipex::cpu::lamb_fused_step_multi_tensor,
+      at::DispatchKey::CPU);
 }
 
 } // namespace
@@ -8,6 +8,7 @@ namespace torch_ipex {
 namespace cpu {
 
 IPEX_DEFINE_DISPATCH(sgd_fused_step_kernel_stub);
+IPEX_DEFINE_DISPATCH(sgd_fused_step_multi_tensor_kernel_stub);
 
 /**
  * SGD fused update kernel.
@@ -84,6 +85,76 @@ c10::optional<at::Tensor> sgd_fused_step(
       nesterov);
 }
 
+/**
+ * SGD fused update kernel for all the params of a param group, the elements of
+ * all the params are split among the threads in a single parallel region.
+ * Same args as sgd_fused_step, one list entry per param.
+ *@return the momentum bufs of the params, allocated for the None entries of
+ *momentum_bufs_, or an empty list if momentum is 0.
+ */
+std::vector<at::Tensor> sgd_fused_step_multi_tensor(
+    at::TensorList params_,
+    at::TensorList grads_,
+    const c10::List<c10::optional<at::Tensor>>& momentum_bufs_,
+    at::TensorList params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov) {
+  RECORD_FUNCTION(
+      "torch_ipex::sgd_fused_step_multi_tensor",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      weight_decay >= 0, "Expect weight_decay >= 0.0, got ", weight_decay);
+
+  auto num_params = params_.size();
+  TORCH_CHECK(
+      grads_.size() == num_params && momentum_bufs_.size() == num_params &&
+          params2_.size() == num_params,
+      "Expect the tensor lists have the same lengths as params, got ",
+      num_params,
+      " params");
+  for (size_t i = 0; i < num_params; i++) {
+    c10::optional<at::Tensor> momentum_buf = momentum_bufs_[i];
+    TORCH_CHECK(
+        params_[i].sizes() == grads_[i].sizes() &&
+            (!momentum_buf.has_value() ||
+             params_[i].sizes() == momentum_buf.value().sizes()) &&
+            (params2_[i].numel() == 0 ||
+             params_[i].sizes() == params2_[i].sizes()),
+        "Expect param ",
+        i,
+        " and its grad and momentum_buf have the same sizes, param sizes: ",
+        params_[i].sizes());
+  }
+
+  /*
+  pointer to sgd_fused_step_multi_tensor_kernel_impl(
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov);
+  */
+  return sgd_fused_step_multi_tensor_kernel_stub(
+      kCPU,
+      params_,
+      grads_,
+      momentum_bufs_,
+      params2_,
+      momentum,
+      learning_rate,
+      weight_decay,
+      dampening,
+      nesterov);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
 
@@ -91,5 +162,9 @@ namespace {
 IPEX_LIBRARY_FRAGMENT() {
   IPEX_OP_REGISTER_DISPATCH(
       "sgd_fused_step", torch_ipex::cpu::sgd_fused_step, at::DispatchKey::CPU);
+  IPEX_OP_REGISTER_DISPATCH(
+      "sgd_fused_step_multi_tensor",
+      torch_ipex::cpu::sgd_fused_step_multi_tensor,
+      at::DispatchKey::CPU);
 }
 } // namespace
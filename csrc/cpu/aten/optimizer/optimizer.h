@@ -2,6 +2,9 @@
 #include <ATen/ATen.h>
 #include <dyndisp/DispatchStub.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace torch_ipex {
 namespace cpu {
 
@@ -63,8 +66,116 @@ void adam_fused_step_kernel_impl(
     double weight_decay,
     double eps);
 
+void adam_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps);
+
+void adamw_fused_step_kernel_impl(
+    const at::Tensor& param_,
+    const at::Tensor& exp_avg_,
+    const at::Tensor& exp_avg_sq_,
+    const at::Tensor& max_exp_avg_sq_,
+    const at::Tensor& grad_,
+    const at::Tensor& param2_,
+    bool amsgrad,
+    double step,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps);
+
+void adamw_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList max_exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    bool amsgrad,
+    at::ArrayRef<double> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps);
+
+void lamb_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList exp_avgs_,
+    at::TensorList exp_avg_sqs_,
+    at::TensorList grads_,
+    at::TensorList params2_,
+    at::ArrayRef<int64_t> steps,
+    double beta1,
+    double beta2,
+    double learning_rate,
+    double weight_decay,
+    double eps);
+
+void adagrad_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    at::TensorList state_sums_,
+    at::TensorList params2_,
+    at::ArrayRef<double> steps,
+    double learning_rate,
+    double weight_decay,
+    double lr_decay,
+    double eps);
+
+std::vector<at::Tensor> sgd_fused_step_multi_tensor_kernel_impl(
+    at::TensorList params_,
+    at::TensorList grads_,
+    const c10::List<c10::optional<at::Tensor>>& momentum_bufs_,
+    at::TensorList params2_,
+    double momentum,
+    double learning_rate,
+    double weight_decay,
+    double dampening,
+    bool nesterov);
+
 } // namespace
 
+// Runs fn(i, begin, end) on the elements [begin, end) of the i-th tensor, in a
+// single parallel region splitting the elements of all the tensors as if they
+// were one flattened tensor, so that the many small tensors of a model are
+// updated without one omp session each.
+template <typename F>
+inline void multi_tensor_parallel_for(
+    const std::vector<int64_t>& numels,
+    int64_t grain_size,
+    const F& fn) {
+  std::vector<int64_t> offsets(numels.size() + 1, 0);
+  for (size_t i = 0; i < numels.size(); i++) {
+    offsets[i + 1] = offsets[i] + numels[i];
+  }
+  at::parallel_for(
+      0, offsets.back(), grain_size, [&](int64_t begin, int64_t end) {
+        // the last tensor starting at or before begin
+        size_t i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+            offsets.begin() - 1;
+        for (; begin < end; i++) {
+          int64_t tensor_end = std::min(end, offsets[i + 1]);
+          if (tensor_end > begin) {
+            fn(i, begin - offsets[i], tensor_end - offsets[i]);
+          }
+          begin = tensor_end;
+        }
+      });
+}
+
 using adagrad_fused_step_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
     const at::Tensor&,
     const at::Tensor&,
@@ -125,6 +236,73 @@ using adam_fused_step_kernel_fn = void (*)(
     double,
     double);
 IPEX_DECLARE_DISPATCH(adam_fused_step_kernel_fn, adam_fused_step_kernel_stub);
+// AdamW shares the Adam kernels, with decoupled weight decay
+IPEX_DECLARE_DISPATCH(adam_fused_step_kernel_fn, adamw_fused_step_kernel_stub);
+
+using adam_fused_step_multi_tensor_kernel_fn = void (*)(
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    bool,
+    at::ArrayRef<double>,
+    double,
+    double,
+    double,
+    double,
+    double);
+IPEX_DECLARE_DISPATCH(
+    adam_fused_step_multi_tensor_kernel_fn,
+    adam_fused_step_multi_tensor_kernel_stub);
+IPEX_DECLARE_DISPATCH(
+    adam_fused_step_multi_tensor_kernel_fn,
+    adamw_fused_step_multi_tensor_kernel_stub);
+
+using lamb_fused_step_multi_tensor_kernel_fn = void (*)(
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::ArrayRef<int64_t>,
+    double,
+    double,
+    double,
+    double,
+    double);
+IPEX_DECLARE_DISPATCH(
+    lamb_fused_step_multi_tensor_kernel_fn,
+    lamb_fused_step_multi_tensor_kernel_stub);
+
+using adagrad_fused_step_multi_tensor_kernel_fn = void (*)(
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::TensorList,
+    at::ArrayRef<double>,
+    double,
+    double,
+    double,
+    double);
+IPEX_DECLARE_DISPATCH(
+    adagrad_fused_step_multi_tensor_kernel_fn,
+    adagrad_fused_step_multi_tensor_kernel_stub);
+
+using sgd_fused_step_multi_tensor_kernel_fn = std::vector<at::Tensor> (*)(
+    at::TensorList,
+    at::TensorList,
+    const c10::List<c10::optional<at::Tensor>>&,
+    at::TensorList,
+    double,
+    double,
+    double,
+    double,
+    bool);
+IPEX_DECLARE_DISPATCH(
+    sgd_fused_step_multi_tensor_kernel_fn,
+    sgd_fused_step_multi_tensor_kernel_stub);
 
 using lars_norm_kernel_fn = float (*)(const at::Tensor&);
 
@@ -0,0 +1,135 @@
+#ifdef BUILD_CPU_WITH_ONECCL
+#include "comm_thread.h"
+#include <omp.h>
+#include <runtime/CPUPool.h>
+#include <cstdlib>
+#include <sstream>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+std::vector<int32_t> comm_thread_cores() {
+  std::vector<int32_t> cores;
+  auto env = std::getenv("IPEX_COMM_THREAD_CORES");
+  if (env == nullptr)
+    return cores;
+  std::stringstream ss(env);
+  std::string core;
+  while (std::getline(ss, core, ',')) {
+    if (!core.empty())
+      cores.push_back(std::stoi(core));
+  }
+  return cores;
+}
+} // anonymous namespace
+
+CommThread& CommThread::getInstance() {
+  static CommThread instance;
+  return instance;
+}
+
+bool CommThread::enabled() {
+  static bool enabled = !comm_thread_cores().empty();
+  return enabled;
+}
+
+CommThread::~CommThread() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_.notify_all();
+  if (worker_ && worker_->joinable())
+    worker_->join();
+}
+
+void CommThread::start() {
+  std::shared_ptr<runtime::CPUPool> pool;
+  auto cores = comm_thread_cores();
+  // Notice: the iomp symbols should be loaded by the main thread, refer to
+  // TaskExecutor.
+  if (!cores.empty() && runtime::is_runtime_ext_enabled()) {
+    pool = std::make_shared<runtime::CPUPool>(
+        runtime::filter_cores_by_thread_affinity(cores));
+  }
+  worker_ = std::make_unique<std::thread>([this, pool] {
+    if (pool != nullptr) {
+      runtime::_pin_cpu_cores(*pool);
+      // The reduction kernels are parallelized with OpenMP, keep them on the
+      // cores given to the communication instead of the ones of the compute.
+      omp_set_num_threads(pool->get_cpu_core_list().size());
+    }
+    loop();
+  });
+}
+
+void CommThread::loop() {
+  while (true) {
+    std::packaged_task<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (stop_ && tasks_.empty())
+        return;
+      task = std::move(tasks_.front());
+      tasks_.pop();
+    }
+    task();
+  }
+}
+
+int64_t CommThread::submit(std::function<void()> fn) {
+  std::packaged_task<void()> task(std::move(fn));
+  int64_t handle;
+  if (!enabled()) {
+    // The error, if any, is rethrown by wait
+    task();
+    std::unique_lock<std::mutex> lock(mutex_);
+    handle = next_handle_++;
+    pending_.emplace(handle, task.get_future());
+    return handle;
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (worker_ == nullptr)
+      start();
+    handle = next_handle_++;
+    pending_.emplace(handle, task.get_future());
+    tasks_.push(std::move(task));
+  }
+  condition_.notify_one();
+  return handle;
+}
+
+void CommThread::wait(int64_t handle) {
+  std::future<void> future;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = pending_.find(handle);
+    TORCH_CHECK(
+        it != pending_.end(),
+        "all_reduce_wait: unknown or already waited handle ",
+        handle);
+    future = std::move(it->second);
+    pending_.erase(it);
+  }
+  future.get();
+}
+
+void CommThread::run(const std::function<void()>& fn) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (worker_ == nullptr) {
+      // No asynchronous collective was ever issued, nothing to order with
+      lock.unlock();
+      fn();
+      return;
+    }
+  }
+  wait(submit(fn));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+#ifdef BUILD_CPU_WITH_ONECCL
+#include <ATen/ATen.h>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * Dedicated thread running the collectives, so that they can overlap with the
+ * compute of the main thread. The collectives are run in the order they are
+ * submitted, which is the same on all the ranks as long as the ranks submit
+ * them in the same order. Once the thread is started, the blocking
+ * collectives are run on it as well to keep that order.
+ *
+ * The thread is opt-in: it is only started when IPEX_COMM_THREAD_CORES (a
+ * comma separated list of core ids) is set, and pinned to these cores via
+ * runtime::CPUPool when the runtime extension is enabled. Otherwise the
+ * submitted collectives run synchronously on the calling thread.
+ */
+class CommThread {
+ public:
+  static CommThread& getInstance();
+  // Whether IPEX_COMM_THREAD_CORES is set
+  static bool enabled();
+
+  // Enqueues the collective and returns the handle to wait on
+  int64_t submit(std::function<void()> fn);
+  // Blocks until the collective of the handle is done, rethrows its error
+  void wait(int64_t handle);
+  // Runs the collective in order with the submitted ones
+  void run(const std::function<void()>& fn);
+
+ private:
+  CommThread() = default;
+  ~CommThread();
+  CommThread(const CommThread&) = delete;
+  CommThread& operator=(const CommThread&) = delete;
+
+  void start();
+  void loop();
+
+  std::unique_ptr<std::thread> worker_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::queue<std::packaged_task<void()>> tasks_;
+  std::unordered_map<int64_t, std::future<void>> pending_;
+  int64_t next_handle_{0};
+  bool stop_{false};
+};
+
+} // namespace cpu
+} // namespace torch_ipex
+#endif
@@ -0,0 +1,216 @@
+#ifdef USE_SHM
+#include "local_rendezvous.h"
+#include <c10/util/Exception.h>
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+int rendezvous_timeout_ms() {
+  auto env = std::getenv("IPEX_COMM_RENDEZVOUS_TIMEOUT");
+  return (env != nullptr ? std::atoi(env) : 300) * 1000;
+}
+
+// Abstract socket address, the name starts with a null byte
+socklen_t make_address(const std::string& name, sockaddr_un* addr) {
+  memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  TORCH_CHECK(
+      name.size() + 1 < sizeof(addr->sun_path),
+      "IPEX_COMM_JOB_ID is too long");
+  memcpy(addr->sun_path + 1, name.data(), name.size());
+  return offsetof(sockaddr_un, sun_path) + 1 + name.size();
+}
+
+void send_all(int fd, const void* data, size_t nbytes) {
+  auto ptr = static_cast<const char*>(data);
+  while (nbytes > 0) {
+    auto ret = send(fd, ptr, nbytes, MSG_NOSIGNAL);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    TORCH_CHECK(ret > 0, "Local rendezvous send failed: ", strerror(errno));
+    ptr += ret;
+    nbytes -= ret;
+  }
+}
+
+void recv_all(int fd, void* data, size_t nbytes) {
+  auto ptr = static_cast<char*>(data);
+  while (nbytes > 0) {
+    auto ret = recv(fd, ptr, nbytes, 0);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    TORCH_CHECK(
+        ret > 0,
+        "Local rendezvous recv failed: ",
+        ret == 0 ? "peer closed the connection" : strerror(errno));
+    ptr += ret;
+    nbytes -= ret;
+  }
+}
+} // anonymous namespace
+
+LocalRendezvous::LocalRendezvous(const std::string& job_id, int rank, int size)
+    : rank_(rank), size_(size), peers_(size, -1) {
+  TORCH_CHECK(
+      rank >= 0 && rank < size,
+      "Invalid rank ",
+      rank,
+      " for world size ",
+      size);
+  if (size == 1)
+    return;
+  auto address = "ipex_rdzv_" + job_id;
+  auto timeout_ms = rendezvous_timeout_ms();
+  if (rank == 0) {
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    TORCH_CHECK(listen_fd >= 0, "socket failed: ", strerror(errno));
+    sockaddr_un addr;
+    auto len = make_address(address, &addr);
+    if (bind(listen_fd, (sockaddr*)&addr, len) != 0 ||
+        listen(listen_fd, size) != 0) {
+      auto err = errno;
+      close(listen_fd);
+      TORCH_CHECK(
+          false,
+          "Unable to listen on the local rendezvous of job '",
+          job_id,
+          "': ",
+          strerror(err));
+    }
+    accept_peers(listen_fd, timeout_ms);
+    // The abstract address is released with the socket
+    close(listen_fd);
+  } else {
+    connect_root(address, timeout_ms);
+  }
+}
+
+LocalRendezvous::~LocalRendezvous() {
+  for (auto fd : peers_) {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+void LocalRendezvous::accept_peers(int listen_fd, int timeout_ms) {
+  auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(timeout_ms);
+  for (int i = 1; i < size_; i++) {
+    pollfd pfd = {listen_fd, POLLIN, 0};
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         deadline - std::chrono::steady_clock::now())
+                         .count();
+    auto ret = poll(&pfd, 1, std::max<int64_t>(remaining, 0));
+    if (ret < 0 && errno == EINTR) {
+      i--;
+      continue;
+    }
+    TORCH_CHECK(
+        ret > 0,
+        "Local rendezvous timed out, ",
+        i - 1,
+        " of ",
+        size_ - 1,
+        " ranks joined");
+    int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    TORCH_CHECK(fd >= 0, "accept failed: ", strerror(errno));
+    int peer_rank = -1;
+    recv_all(fd, &peer_rank, sizeof(peer_rank));
+    TORCH_CHECK(
+        peer_rank > 0 && peer_rank < size_ && peers_[peer_rank] < 0,
+        "Local rendezvous got an invalid or duplicated rank ",
+        peer_rank);
+    peers_[peer_rank] = fd;
+  }
+}
+
+void LocalRendezvous::connect_root(const std::string& address, int timeout_ms) {
+  sockaddr_un addr;
+  auto len = make_address(address, &addr);
+  auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(timeout_ms);
+  while (true) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    TORCH_CHECK(fd >= 0, "socket failed: ", strerror(errno));
+    if (connect(fd, (sockaddr*)&addr, len) == 0) {
+      peers_[0] = fd;
+      break;
+    }
+    auto err = errno;
+    close(fd);
+    // Rank 0 is not listening yet
+    TORCH_CHECK(
+        (err == ECONNREFUSED || err == ENOENT || err == EAGAIN) &&
+            std::chrono::steady_clock::now() < deadline,
+        "Unable to join the local rendezvous: ",
+        strerror(err));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  send_all(peers_[0], &rank_, sizeof(rank_));
+}
+
+void LocalRendezvous::broadcast(void* data, size_t nbytes) {
+  if (rank_ == 0) {
+    for (int r = 1; r < size_; r++)
+      send_all(peers_[r], data, nbytes);
+  } else {
+    recv_all(peers_[0], data, nbytes);
+  }
+}
+
+void LocalRendezvous::barrier() {
+  char token = 0;
+  if (rank_ == 0) {
+    for (int r = 1; r < size_; r++)
+      recv_all(peers_[r], &token, 1);
+    for (int r = 1; r < size_; r++)
+      send_all(peers_[r], &token, 1);
+  } else {
+    send_all(peers_[0], &token, 1);
+    recv_all(peers_[0], &token, 1);
+  }
+}
+
+void LocalRendezvous::allgatherv(
+    const void* send,
+    size_t send_nbytes,
+    const std::vector<void*>& recv,
+    const std::vector<size_t>& recv_nbytes) {
+  TORCH_CHECK(
+      (int)recv.size() == size_ && (int)recv_nbytes.size() == size_ &&
+          recv_nbytes[rank_] == send_nbytes,
+      "allgatherv: mismatched receive buffers");
+  if (recv[rank_] != send)
+    memcpy(recv[rank_], send, send_nbytes);
+  if (rank_ == 0) {
+    for (int r = 1; r < size_; r++)
+      recv_all(peers_[r], recv[r], recv_nbytes[r]);
+    for (int r = 1; r < size_; r++) {
+      for (int i = 0; i < size_; i++) {
+        if (i != r)
+          send_all(peers_[r], recv[i], recv_nbytes[i]);
+      }
+    }
+  } else {
+    send_all(peers_[0], send, send_nbytes);
+    for (int i = 0; i < size_; i++) {
+      if (i != rank_)
+        recv_all(peers_[0], recv[i], recv_nbytes[i]);
+    }
+  }
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+#endif
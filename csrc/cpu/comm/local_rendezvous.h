@@ -0,0 +1,52 @@
+#pragma once
+#ifdef USE_SHM
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace torch_ipex {
+namespace cpu {
+
+/**
+ * Rendezvous of the ranks of a single node job without MPI. Rank 0 listens on
+ * the abstract unix socket "ipex_rdzv_<job_id>" and the other ranks connect
+ * to it, so no launcher, file or cleanup is needed and two jobs on the same
+ * host only need different job ids. The connections are kept to run the
+ * control plane collectives (broadcast, barrier, allgatherv) through rank 0,
+ * the data plane all-reduce goes through the SHM buffer.
+ *
+ * IPEX_COMM_RENDEZVOUS_TIMEOUT sets how long (in seconds, default 300) the
+ * ranks wait for each other.
+ */
+class LocalRendezvous {
+ public:
+  LocalRendezvous(const std::string& job_id, int rank, int size);
+  ~LocalRendezvous();
+
+  // Broadcasts nbytes of data from rank 0
+  void broadcast(void* data, size_t nbytes);
+  void barrier();
+  // recv[r] receives the recv_nbytes[r] bytes sent by rank r
+  void allgatherv(
+      const void* send,
+      size_t send_nbytes,
+      const std::vector<void*>& recv,
+      const std::vector<size_t>& recv_nbytes);
+
+ private:
+  LocalRendezvous(const LocalRendezvous&) = delete;
+  LocalRendezvous& operator=(const LocalRendezvous&) = delete;
+
+  void accept_peers(int listen_fd, int timeout_ms);
+  void connect_root(const std::string& address, int timeout_ms);
+
+  int rank_;
+  int size_;
+  // On rank 0, the socket of rank r is peers_[r]. On the other ranks,
+  // peers_[0] is the socket of rank 0.
+  std::vector<int> peers_;
+};
+
+} // namespace cpu
+} // namespace torch_ipex
+#endif
@@ -3,16 +3,25 @@
 #include <mpi.h>
 
 #include <torch/all.h>
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include "oneapi/ccl.hpp"
 #ifdef USE_SHM
+#include "local_rendezvous.h"
 #include "shm_reduction.h"
 #endif
 
 class Messenger {
  private:
   Messenger() {
+    // Single node job launched without MPI, e.g. by plain process spawning
+    if (std::getenv("SINGLE_INSTANCE") == nullptr &&
+        std::getenv("IPEX_COMM_JOB_ID") != nullptr) {
+      initLocal(std::getenv("IPEX_COMM_JOB_ID"));
+      return;
+    }
+
     // User has set the SINGLE_INSTANCE environment variable
     // or program is not with MPI.
     if (std::getenv("SINGLE_INSTANCE") != nullptr || !withMpirun()) {
@@ -20,6 +29,7 @@ class Messenger {
       this->pcomm = nullptr;
 #ifdef USE_SHM
       this->pshm = nullptr;
+      this->plocal = nullptr;
 #endif
       this->rank = 0;
       this->size = 1;
@@ -87,6 +97,7 @@ class Messenger {
       }
     }
 
+    plocal = nullptr;
     if (same_hostnames) {
       pshm = new ShmReduction(rank, size, [this](int* pid_fd, size_t count) {
         this->broadcast(pid_fd, count);
@@ -97,11 +108,47 @@ class Messenger {
 #endif
   }
 
+  /**
+   * Brings up the ranks of a single node job without MPI and oneCCL. The rank
+   * and the world size are read from the RANK and WORLD_SIZE environment
+   * variables, the ranks rendezvous on a local socket keyed by the job id,
+   * which also carries the pid_fd exchange of the SHM buffer, and all the
+   * reductions go through SHM.
+   */
+  void initLocal(const char* job_id) {
+#ifdef USE_SHM
+    auto env_rank = std::getenv("RANK");
+    auto env_size = std::getenv("WORLD_SIZE");
+    TORCH_CHECK(
+        env_rank != nullptr && env_size != nullptr,
+        "IPEX_COMM_JOB_ID requires RANK and WORLD_SIZE to be set");
+    rank = std::atoi(env_rank);
+    size = std::atoi(env_size);
+    pcomm = nullptr;
+    plocal = new torch_ipex::cpu::LocalRendezvous(job_id, rank, size);
+    // One SHM buffer per job, so that jobs on the same host do not collide
+    std::string shm_name = std::string(SHM_NAME) + "_" + job_id;
+    std::replace(shm_name.begin(), shm_name.end(), '/', '_');
+    pshm = check() ? new ShmReduction(
+                         rank,
+                         size,
+                         [this](int* pid_fd, size_t count) {
+                           this->broadcast(pid_fd, count);
+                         },
+                         shm_name)
+                   : nullptr;
+#else
+    TORCH_CHECK(false, "IPEX_COMM_JOB_ID requires to build with USE_SHM");
+#endif
+  }
+
   ~Messenger() {
     delete pcomm;
 #ifdef USE_SHM
     if (pshm != nullptr)
       delete pshm;
+    if (plocal != nullptr)
+      delete plocal;
 #endif
   }
 
@@ -154,18 +201,24 @@ class Messenger {
 
   /**
    * Performs a reduction operation by adding the elements of the input tensor.
-   * If USE_SHM is defined and the size of the tensor exceeds the shared memory
-   * size or local ranks flag is false, the reduction is performed using the
-   * ccl_allreduce_add method. Otherwise, the reduction is performed using the
-   * reduceAdd method of the pshm object which used SHM. If USE_SHM is not
-   * defined, the reduction is always performed using the ccl_allreduce_add
-   * method.
+   * If USE_SHM is defined and the ranks are on the same machine, the reduction
+   * is performed using the reduceAdd method of the pshm object which used SHM,
+   * tensors larger than the shared memory are streamed through it in chunks.
+   * Otherwise, the reduction is performed using the ccl_allreduce_add method.
    *
    * @param t_in The input tensor to be reduced.
    */
   void reduceAdd(at::Tensor& t_in) {
+    if (!check()) {
+      return;
+    }
 #ifdef USE_SHM
-    if (t_in.numel() * sizeof(float) > pshm->getSHMSize() || pshm == nullptr) {
+    if (plocal != nullptr && !t_in.is_contiguous()) {
+      // No oneCCL communicator to fall back to
+      auto t_contig = t_in.contiguous();
+      pshm->reduceAdd(t_contig);
+      t_in.copy_(t_contig);
+    } else if (pshm == nullptr || !t_in.is_contiguous()) {
       this->ccl_allreduce_add(t_in);
     } else {
       pshm->reduceAdd(t_in);
@@ -190,6 +243,19 @@ class Messenger {
         vec_data_out.end(),
         std::back_inserter(recvBufs),
         [](const at::Tensor& t) { return t.data_ptr(); });
+#ifdef USE_SHM
+    if (plocal != nullptr) {
+      RECORD_FUNCTION("ipex::local_allgatherv", std::vector<c10::IValue>());
+      auto t_contig = data.contiguous();
+      std::vector<size_t> recvBytes;
+      for (auto count : recvCounts) {
+        recvBytes.push_back(count * data.element_size());
+      }
+      plocal->allgatherv(
+          t_contig.data_ptr(), t_contig.nbytes(), recvBufs, recvBytes);
+      return at::cat(vec_data_out, -1);
+    }
+#endif
     {
       RECORD_FUNCTION("ccl::allgatherv", std::vector<c10::IValue>());
       ccl::allgatherv(
@@ -205,12 +271,24 @@ class Messenger {
   }
 
   void barrier() {
+#ifdef USE_SHM
+    if (plocal != nullptr) {
+      plocal->barrier();
+      return;
+    }
+#endif
     if (check()) {
       ccl::barrier(*pcomm);
     }
   }
 
   void broadcast(int* pid_fd, size_t count) {
+#ifdef USE_SHM
+    if (plocal != nullptr) {
+      plocal->broadcast(pid_fd, count * sizeof(int));
+      return;
+    }
+#endif
     if (check()) {
       ccl::broadcast(pid_fd, count, ccl::datatype::int32, 0, *pcomm).wait();
     }
@@ -252,6 +330,8 @@ class Messenger {
 
 #ifdef USE_SHM
   ShmReduction* pshm;
+  // Set when the ranks rendezvous locally instead of with MPI
+  torch_ipex::cpu::LocalRendezvous* plocal;
 #endif
 };
 #endif
\ No newline at end of file
@@ -13,8 +13,12 @@
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 #include "aten/ShmAllReduceAdd.h"
 
 namespace torch_ipex {
@@ -128,6 +132,21 @@ inline void create_shm(ShmContext* ctx) {
                        .to(at::kCPU);
 }
 
+// IPEX_SHM_ALLREDUCE_PRECISION: "native" (default), "fp32" or "int8", all the
+// ranks must use the same
+inline ShmReducePrecision shm_reduce_precision_from_env() {
+  auto env = std::getenv("IPEX_SHM_ALLREDUCE_PRECISION");
+  if (env == nullptr || std::string(env) == "native") {
+    return SHM_REDUCE_NATIVE;
+  } else if (std::string(env) == "fp32") {
+    return SHM_REDUCE_FP32;
+  } else if (std::string(env) == "int8") {
+    return SHM_REDUCE_INT8;
+  }
+  TORCH_CHECK(false, "Unknown IPEX_SHM_ALLREDUCE_PRECISION ", env);
+  return SHM_REDUCE_NATIVE;
+}
+
 inline void close_shm(ShmContext* ctx) {
   const int total_size = ctx->nstates * sizeof(int) + ctx->nbytes;
   if (ctx->fp != -1) {
@@ -139,12 +158,27 @@ inline void close_shm(ShmContext* ctx) {
 } // namespace cpu
 } // namespace torch_ipex
 
+// The shared memory buffer is split into SHM_CHANNELS channels, each with its
+// own states. Messages larger than a chunk are streamed through the buffer
+// instead of falling back to oneCCL: the chunks go round-robin through the
+// channels, and every channel runs its chunks on its own thread with its share
+// of the OpenMP threads, so a rank copies chunk i + 1 into the next channel
+// while chunk i is still reduced in the other one.
+#define SHM_CHANNELS 2
+
 class ShmReduction {
  public:
-  ShmReduction(int rank, int size, std::function<void(int*, size_t)> callback)
-      : rank_(rank), rank_size_(size) {
-    shmCtx_.name = SHM_NAME;
-    shmCtx_.nstates = size;
+  ShmReduction(
+      int rank,
+      int size,
+      std::function<void(int*, size_t)> callback,
+      const std::string& name = SHM_NAME)
+      : rank_(rank),
+        rank_size_(size),
+        shm_name_(name),
+        precision_(torch_ipex::cpu::shm_reduce_precision_from_env()) {
+    shmCtx_.name = shm_name_.c_str();
+    shmCtx_.nstates = size * SHM_CHANNELS;
     shmCtx_.nbytes = MAX_SHM_SIZE;
     shmCtx_.nblocks = MAX_SHM_BLOCK_COUNT;
     if (rank_ == 0) {
@@ -158,6 +192,33 @@ class ShmReduction {
     if (rank != 0) {
       torch_ipex::cpu::connect_shm(&shmCtx_);
     }
+
+    auto channel_elems = shmCtx_.t_address.numel() / SHM_CHANNELS;
+    auto channel_blocks = shmCtx_.nblocks * size;
+    for (int c = 0; c < SHM_CHANNELS; c++) {
+      channels_[c].t_state = shmCtx_.t_state.narrow(0, c * size, size);
+      channels_[c].t_blockState =
+          shmCtx_.t_blockState.view(-1)
+              .narrow(0, c * channel_blocks, channel_blocks)
+              .view({(int64_t)shmCtx_.nblocks, size});
+      channels_[c].t_address =
+          shmCtx_.t_address.narrow(0, c * channel_elems, channel_elems);
+    }
+    // Fits in the slot of a rank of one channel, see the reduce-scatter +
+    // all-gather kernel, and in the block states of a channel with the large
+    // blocks of the serial chain
+    auto max_chunk_elems = std::min<int64_t>(
+        channel_elems, (int64_t)MAX_SHM_BLOCK_COUNT * SHM_BLOCK_SIZE_L);
+    chunk_elems_ =
+        std::min<int64_t>(channel_elems / size / 16 * 16, max_chunk_elems);
+    // IPEX_SHM_ALLREDUCE_CHUNK overrides the number of elements of a chunk,
+    // the chunks larger than a slot run the serial chain
+    auto env_chunk = std::getenv("IPEX_SHM_ALLREDUCE_CHUNK");
+    if (env_chunk != nullptr) {
+      chunk_elems_ = std::min<int64_t>(
+          std::max<int64_t>(std::atoll(env_chunk) / 16 * 16, 16),
+          max_chunk_elems);
+    }
   }
 
   ~ShmReduction() {
@@ -169,22 +230,74 @@ class ShmReduction {
   }
 
   void reduceAdd(at::Tensor& t_in) {
-    bool is_small = t_in.numel() < 51200;
+    auto t_flat = t_in.view(-1);
+    auto numel = t_flat.numel();
+    if (numel <= chunk_elems_) {
+      auto c = next_channel_;
+      next_channel_ = (next_channel_ + 1) % SHM_CHANNELS;
+      reduceChunk(t_flat, c);
+      return;
+    }
+    // The ranks take the same channel for the same chunk, and every channel
+    // reduces its chunks in order
+    int64_t nchunks = (numel + chunk_elems_ - 1) / chunk_elems_;
+    int nthreads = std::max(1, omp_get_max_threads() / SHM_CHANNELS);
+    std::exception_ptr errors[SHM_CHANNELS];
+    std::vector<std::thread> workers;
+    for (int c = 0; c < SHM_CHANNELS; c++) {
+      workers.emplace_back([&, c]() {
+        omp_set_num_threads(nthreads);
+        try {
+          for (int64_t i = c; i < nchunks; i += SHM_CHANNELS) {
+            auto start = i * chunk_elems_;
+            auto chunk = std::min(chunk_elems_, numel - start);
+            reduceChunk(t_flat.narrow(0, start, chunk), c);
+          }
+        } catch (...) {
+          errors[c] = std::current_exception();
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    for (auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+
+  int rank_;
+  int rank_size_;
+
+ private:
+  void reduceChunk(at::Tensor t_chunk, int c) {
+    bool is_small = t_chunk.numel() < 51200;
     auto block_size = is_small ? SHM_BLOCK_SIZE_S : SHM_BLOCK_SIZE_L;
+    auto& channel = channels_[c];
     torch_ipex::cpu::shm_all_reduce_add_kernel_stub(
         kCPU,
-        t_in,
-        shmCtx_.t_address,
-        shmCtx_.t_state,
-        shmCtx_.t_blockState,
+        t_chunk,
+        channel.t_address,
+        channel.t_state,
+        channel.t_blockState,
         block_size,
         rank_,
-        rank_size_);
+        rank_size_,
+        precision_);
   }
 
-  int rank_;
-  int rank_size_;
+  struct ShmChannel {
+    at::Tensor t_state;
+    at::Tensor t_blockState;
+    at::Tensor t_address;
+  };
 
- private:
+  std::string shm_name_;
+  int64_t precision_;
   torch_ipex::cpu::ShmContext shmCtx_;
+  ShmChannel channels_[SHM_CHANNELS];
+  int next_channel_ = 0;
+  int64_t chunk_elems_;
 };
@@ -3,9 +3,14 @@
 #include "utils.h"
 
 #include <ATen/code_template.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
 #include <torch/csrc/jit/passes/remove_mutation.h>
 #include "utils/onednn_utils.h"
 
+#ifdef BUILD_CPU_WITH_ONECCL
+#include "comm/comm_thread.h"
+#endif
+
 namespace torch_ipex {
 namespace jit {
 namespace graph_rewrite {
@@ -1335,6 +1340,60 @@ void replaceAtenMaxPool2dWithIpexMaxPool2d(std::shared_ptr<Graph>& graph) {
   rewriter_max_pool2d.runOnGraph(graph, filter);
 }
 
+#ifdef BUILD_CPU_WITH_ONECCL
+// Sinks the waits of the asynchronous all-reduces down to the first node that
+// may access the reduced tensor, so that the nodes in between run while the
+// reduction is in flight on the communication thread.
+static void sinkAllReduceWait(Block* block, AliasDb& aliasDb) {
+  static const auto wait_kind =
+      Symbol::fromQualString("torch_ipex::all_reduce_wait");
+  std::vector<Node*> waits;
+  for (auto node : block->nodes()) {
+    for (auto sub_block : node->blocks()) {
+      sinkAllReduceWait(sub_block, aliasDb);
+    }
+    if (node->kind() == wait_kind) {
+      waits.push_back(node);
+    }
+  }
+  for (auto wait : waits) {
+    auto reduced = wait->input(0);
+    auto next = wait->next();
+    // Conservatively stop at nodes with side effects or sub-blocks
+    while (next != block->return_node() && !next->hasSideEffects() &&
+           next->blocks().empty() && !aliasDb.writesToWildcard(next) &&
+           !aliasDb.mayContainAlias(reduced, next->inputs())) {
+      next = next->next();
+    }
+    if (next != wait->next()) {
+      wait->moveBefore(next);
+    }
+  }
+}
+
+// Splits torch_ipex::all_reduce_add into an asynchronous all-reduce and its
+// wait, and delays the wait as late as possible to overlap the communication
+// with the compute.
+static void overlapAllReduce(std::shared_ptr<Graph>& graph) {
+  std::string all_reduce = R"(
+    graph(%a):
+      %r = torch_ipex::all_reduce_add(%a)
+      return (%r) )";
+  std::string all_reduce_async = R"(
+    graph(%a):
+      %handle : int = torch_ipex::all_reduce_add_async(%a)
+      %r = torch_ipex::all_reduce_wait(%a, %handle)
+      return (%r) )";
+
+  SubgraphRewriter rewriter;
+  rewriter.RegisterRewritePattern(all_reduce, all_reduce_async);
+  rewriter.runOnGraph(graph);
+
+  AliasDb aliasDb(graph);
+  sinkAllReduceWait(graph->block(), aliasDb);
+}
+#endif
+
 void simplifyAllReduce(std::shared_ptr<Graph>& graph) {
   std::string all_reduce_v1 = R"(
     graph(%a, %weight, %out_features1, %none, %b, %fc_in_weight, %fc_in_bias, %fc_out_weight, %fc_out_bias, %alpha, %no, %dtype, %zero):
@@ -1415,6 +1474,12 @@ void simplifyAllReduce(std::shared_ptr<Graph>& graph) {
   rewriter_v1.runOnGraph(graph);
   rewriter_v2.runOnGraph(graph);
   rewriter_v3.runOnGraph(graph);
+#ifdef BUILD_CPU_WITH_ONECCL
+  // The all-reduce only overlaps with the compute on the communication thread
+  if (torch_ipex::cpu::CommThread::enabled()) {
+    overlapAllReduce(graph);
+  }
+#endif
 }
 
 } // namespace graph_rewrite
@@ -0,0 +1,240 @@
+#include "BatchScheduler.h"
+
+#include <ATen/ATen.h>
+#include <ATen/core/grad_mode.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+// Rows of a request, the batch size of its first tensor input
+int64_t request_rows(const std::vector<c10::IValue>& inputs) {
+  for (auto& input : inputs) {
+    if (input.isTensor() && input.toTensor().dim() > 0) {
+      return input.toTensor().size(0);
+    }
+  }
+  return 1;
+}
+
+// Splits output into the outputs of requests with rows each
+std::vector<c10::IValue> scatter_output(
+    const c10::IValue& output,
+    const std::vector<int64_t>& rows,
+    int64_t total_rows) {
+  auto num_requests = rows.size();
+  if (output.isTensor()) {
+    auto tensor = output.toTensor();
+    if (tensor.dim() > 0 && tensor.size(0) == total_rows) {
+      auto splits = tensor.split_with_sizes(rows, 0);
+      return std::vector<c10::IValue>(splits.begin(), splits.end());
+    }
+  } else if (output.isTuple()) {
+    std::vector<std::vector<c10::IValue>> elements(num_requests);
+    for (auto& element : output.toTupleRef().elements()) {
+      auto scattered = scatter_output(element, rows, total_rows);
+      for (size_t i = 0; i < num_requests; i++) {
+        elements[i].push_back(std::move(scattered[i]));
+      }
+    }
+    std::vector<c10::IValue> outputs;
+    for (auto& request_elements : elements) {
+      outputs.emplace_back(
+          c10::ivalue::Tuple::create(std::move(request_elements)));
+    }
+    return outputs;
+  } else if (output.isList()) {
+    auto list = output.toList();
+    std::vector<c10::impl::GenericList> lists(
+        num_requests, c10::impl::GenericList(list.elementType()));
+    for (size_t j = 0; j < list.size(); j++) {
+      auto scattered = scatter_output(list.get(j), rows, total_rows);
+      for (size_t i = 0; i < num_requests; i++) {
+        lists[i].push_back(std::move(scattered[i]));
+      }
+    }
+    return std::vector<c10::IValue>(lists.begin(), lists.end());
+  } else if (output.isGenericDict()) {
+    auto dict = output.toGenericDict();
+    std::vector<c10::impl::GenericDict> dicts(
+        num_requests,
+        c10::impl::GenericDict(dict.keyType(), dict.valueType()));
+    for (auto& entry : dict) {
+      auto scattered = scatter_output(entry.value(), rows, total_rows);
+      for (size_t i = 0; i < num_requests; i++) {
+        dicts[i].insert(entry.key(), std::move(scattered[i]));
+      }
+    }
+    return std::vector<c10::IValue>(dicts.begin(), dicts.end());
+  }
+  // Not batched, e.g. a scalar
+  return std::vector<c10::IValue>(num_requests, output);
+}
+} // namespace
+
+BatchScheduler::BatchScheduler(
+    Runner runner,
+    const std::vector<std::vector<int32_t>>& stream_cores,
+    int64_t max_batch_size,
+    int64_t max_wait_us)
+    : runner_(std::move(runner)),
+      max_batch_size_(std::max<int64_t>(max_batch_size, 1)),
+      max_wait_(std::max<int64_t>(max_wait_us, 0)) {
+  if (stream_cores.empty()) {
+    throw std::runtime_error("BatchScheduler needs at least one stream.");
+  }
+  for (auto& cores : stream_cores) {
+    cpu_pools_.emplace_back(new CPUPool(cores));
+    executors_.push_back(std::make_shared<TaskExecutor>(*cpu_pools_.back()));
+  }
+  // Each stream runs the batching loop until the scheduler stops
+  for (auto& executor : executors_) {
+    {
+      std::unique_lock<std::mutex> lock(executor->get_mutex());
+      executor->get_tasks().emplace([this]() { this->batch_loop(); });
+    }
+    executor->get_condition().notify_one();
+  }
+}
+
+BatchScheduler::~BatchScheduler() {
+  this->stop();
+}
+
+int64_t BatchScheduler::num_batches() const {
+  return num_batches_.load();
+}
+
+int64_t BatchScheduler::num_requests() const {
+  return num_requests_.load();
+}
+
+std::future<c10::IValue> BatchScheduler::submit(
+    std::vector<c10::IValue>&& inputs) {
+  Request request;
+  request.rows = request_rows(inputs);
+  request.inputs = std::move(inputs);
+  request.grad_mode = at::GradMode::is_enabled();
+  request.arrival = std::chrono::steady_clock::now();
+  auto future = request.promise.get_future();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // submit task to a stopping scheduler is not allowed
+    if (stop_) {
+      throw std::runtime_error("Task submit on stopped BatchScheduler");
+    }
+    pending_rows_ += request.rows;
+    requests_.push_back(std::move(request));
+  }
+  condition_.notify_one();
+  return future;
+}
+
+void BatchScheduler::batch_loop() {
+  while (true) {
+    std::vector<Request> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this] { return stop_ || !requests_.empty(); });
+      if (requests_.empty()) {
+        return;
+      }
+      // Wait for a full batch, at most until the deadline of the oldest
+      // request. A stopping scheduler flushes the pending requests.
+      auto deadline = requests_.front().arrival + max_wait_;
+      condition_.wait_until(lock, deadline, [this] {
+        return stop_ || requests_.empty() || pending_rows_ >= max_batch_size_;
+      });
+      if (requests_.empty()) {
+        // Taken by another stream
+        continue;
+      }
+      int64_t rows = 0;
+      auto grad_mode = requests_.front().grad_mode;
+      while (!requests_.empty() && requests_.front().grad_mode == grad_mode &&
+             (batch.empty() ||
+              rows + requests_.front().rows <= max_batch_size_)) {
+        rows += requests_.front().rows;
+        pending_rows_ -= requests_.front().rows;
+        batch.push_back(std::move(requests_.front()));
+        requests_.pop_front();
+      }
+    }
+    // Let another stream batch the requests left
+    condition_.notify_one();
+    run_batch(batch);
+  }
+}
+
+void BatchScheduler::run_batch(std::vector<Request>& batch) {
+  // set the thread local status, such as the grad mode before execuating the
+  // batch
+  at::GradMode::set_enabled(batch[0].grad_mode);
+  std::vector<c10::IValue> outputs;
+  try {
+    std::vector<int64_t> rows;
+    int64_t total_rows = 0;
+    for (auto& request : batch) {
+      rows.push_back(request.rows);
+      total_rows += request.rows;
+    }
+    std::vector<c10::IValue> stack;
+    if (batch.size() == 1) {
+      stack = std::move(batch[0].inputs);
+    } else {
+      auto num_inputs = batch[0].inputs.size();
+      for (auto& request : batch) {
+        if (request.inputs.size() != num_inputs) {
+          throw std::runtime_error(
+              "BatchScheduler can't batch requests with " +
+              std::to_string(num_inputs) + " and " +
+              std::to_string(request.inputs.size()) + " inputs.");
+        }
+      }
+      for (size_t j = 0; j < num_inputs; j++) {
+        if (!batch[0].inputs[j].isTensor()) {
+          stack.push_back(batch[0].inputs[j]);
+          continue;
+        }
+        std::vector<at::Tensor> tensors;
+        for (auto& request : batch) {
+          tensors.push_back(request.inputs[j].toTensor());
+        }
+        stack.emplace_back(at::cat(tensors, 0));
+      }
+    }
+    auto output = runner_(stack);
+    outputs = scatter_output(output, rows, total_rows);
+  } catch (...) {
+    for (auto& request : batch) {
+      request.promise.set_exception(std::current_exception());
+    }
+    return;
+  }
+  num_batches_.fetch_add(1);
+  num_requests_.fetch_add(batch.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    batch[i].promise.set_value(std::move(outputs[i]));
+  }
+}
+
+void BatchScheduler::stop() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_) {
+      return;
+    }
+    stop_ = true;
+  }
+  condition_.notify_all();
+  // The batching loops return once the pending requests are done
+  for (auto& executor : executors_) {
+    executor->stop_executor();
+  }
+}
+
+} // namespace runtime
+} // namespace torch_ipex
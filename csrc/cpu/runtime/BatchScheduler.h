@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <ATen/core/ivalue.h>
+#include <Macros.h>
+#include "CPUPool.h"
+#include "TaskExecutor.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+/*
+BatchScheduler gathers the inputs submitted one by one, e.g. by many client
+threads, into batches run on several streams, each stream being a
+TaskExecutor pinned to its own CPUPool.
+- A free stream takes the pending requests once they reach max_batch_size rows
+  or the oldest one has waited max_wait_us, so a stream never waits longer
+  than max_wait_us for a batch to fill.
+- The tensor inputs of the requests are concatenated along dim 0, the other
+  inputs are taken from the first request of the batch.
+- The tensors of the output (also inside tuples, lists and dicts) are split
+  back along dim 0 into the outputs of the requests, the other outputs are
+  returned as is to every request.
+*/
+class IPEX_API BatchScheduler {
+ public:
+  using Runner = std::function<c10::IValue(std::vector<c10::IValue>&)>;
+
+  explicit BatchScheduler(
+      Runner runner,
+      const std::vector<std::vector<int32_t>>& stream_cores,
+      int64_t max_batch_size,
+      int64_t max_wait_us);
+  ~BatchScheduler();
+
+  std::future<c10::IValue> submit(std::vector<c10::IValue>&& inputs);
+  int64_t num_batches() const;
+  int64_t num_requests() const;
+  void stop();
+
+ private:
+  struct Request {
+    std::vector<c10::IValue> inputs;
+    int64_t rows;
+    bool grad_mode;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<c10::IValue> promise;
+  };
+
+  void batch_loop();
+  void run_batch(std::vector<Request>& batch);
+
+  Runner runner_;
+  int64_t max_batch_size_;
+  std::chrono::microseconds max_wait_;
+  // TaskExecutor keeps a reference to its CPUPool
+  std::vector<std::unique_ptr<CPUPool>> cpu_pools_;
+  std::vector<std::shared_ptr<TaskExecutor>> executors_;
+
+  std::deque<Request> requests_;
+  int64_t pending_rows_{0};
+  bool stop_{false};
+  std::mutex mutex_;
+  std::condition_variable condition_;
+
+  std::atomic<int64_t> num_batches_{0};
+  std::atomic<int64_t> num_requests_{0};
+
+  BatchScheduler(const BatchScheduler&) = delete;
+  BatchScheduler(BatchScheduler&&) = delete;
+  BatchScheduler& operator=(const BatchScheduler&) = delete;
+  BatchScheduler& operator=(BatchScheduler&&) = delete;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -3,9 +3,11 @@
 #ifdef _WIN32
 #include <Windows.h>
 #else
+#include <dirent.h>
 #include <dlfcn.h>
 #include <unistd.h>
 #endif
+#include <string>
 
 namespace torch_ipex {
 namespace runtime {
@@ -221,6 +223,12 @@ void _pin_cpu_cores(const torch_ipex::runtime::CPUPool& cpu_pool) {
         "Didn't preload IOMP before using the runtime API");
   }
 
+  auto memory_policy = cpu_pool.get_memory_policy();
+  std::vector<int32_t> numa_nodes;
+  if (memory_policy != MEMORY_POLICY_NONE) {
+    numa_nodes = cpu_pool.get_numa_nodes();
+  }
+
   // Create the OMP thread pool and bind to cores of cpu_pools one by one
   omp_set_num_threads(cpu_core_list.size());
 #pragma omp parallel num_threads(cpu_core_list.size())
@@ -233,6 +241,11 @@ void _pin_cpu_cores(const torch_ipex::runtime::CPUPool& cpu_pool) {
     kmp_set_affinity_mask_proc_ext(phy_core_id, &mask);
     kmp_set_affinity_ext(&mask);
     kmp_destroy_affinity_mask_ext(&mask);
+    // The memory policy is per thread as well. Nothing to do without NUMA
+    // support, the allocations stay first touch.
+    if (memory_policy != MEMORY_POLICY_NONE) {
+      set_thread_memory_policy(memory_policy, numa_nodes);
+    }
   }
   // Cache the cpu_core_list for query.
   current_cpu_core_list = cpu_core_list;
@@ -251,6 +264,7 @@ CPUPool get_cpu_pool_from_mask_affinity() {
   int max_number_threads = omp_get_max_threads();
   // init the vector<mask>
   std::vector<kmp_affinity_mask_t> threads_mask(max_number_threads);
+  std::vector<ThreadMemoryPolicy> threads_memory_policy(max_number_threads);
 #pragma omp parallel
   {
     int thread_id = omp_get_thread_num();
@@ -258,8 +272,11 @@ CPUPool get_cpu_pool_from_mask_affinity() {
     kmp_create_affinity_mask_ext(&mask);
     kmp_get_affinity_ext(&mask);
     threads_mask[thread_id] = mask;
+    threads_memory_policy[thread_id] = get_thread_memory_policy();
   }
-  return CPUPool(std::move(threads_mask));
+  CPUPool cpu_pool(std::move(threads_mask));
+  cpu_pool.set_thread_memory_policies(std::move(threads_memory_policy));
+  return cpu_pool;
 }
 
 void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool) {
@@ -276,9 +293,37 @@ void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool) {
     int thread_id = omp_get_thread_num();
     kmp_affinity_mask_t mask = threads_mask[thread_id];
     kmp_set_affinity_ext(&mask);
+    auto& memory_policies = cpu_pool.get_thread_memory_policies();
+    if (thread_id < memory_policies.size()) {
+      restore_thread_memory_policy(memory_policies[thread_id]);
+    }
   }
 }
 
+int32_t get_core_numa_node(int32_t core_id) {
+#ifdef _WIN32
+  return -1;
+#else
+  // The node of a cpu is exposed as a nodeN link in its sysfs directory
+  auto path = "/sys/devices/system/cpu/cpu" + std::to_string(core_id);
+  DIR* dir = opendir(path.c_str());
+  if (dir == NULL) {
+    return -1;
+  }
+  int32_t node = -1;
+  while (auto entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+        name.find_first_not_of("0123456789", 4) == std::string::npos) {
+      node = std::stoi(name.substr(4));
+      break;
+    }
+  }
+  closedir(dir);
+  return node;
+#endif
+}
+
 CPUPool::CPUPool(const std::vector<int32_t>& cpu_core_list) {
   this->cpu_core_list = filter_cores_by_thread_affinity(cpu_core_list);
   this->cpu_core_list_initialized_ = true;
@@ -311,6 +356,9 @@ CPUPool::CPUPool(CPUPool&& source_cpu_pool) {
             source_cpu_pool.get_cpu_affinity_mask()));
     this->cpu_affinity_mask_initialized_ = true;
   }
+  this->memory_policy_ = source_cpu_pool.memory_policy_;
+  this->thread_memory_policies_ =
+      std::move(source_cpu_pool.thread_memory_policies_);
 }
 
 const std::vector<int32_t>& CPUPool::get_cpu_core_list() const {
@@ -337,6 +385,41 @@ bool CPUPool::is_cpu_affinity_mask_initialized() const {
   return this->cpu_affinity_mask_initialized_;
 }
 
+void CPUPool::set_memory_policy(MemoryPolicy memory_policy) {
+  if (memory_policy != MEMORY_POLICY_NONE &&
+      !this->cpu_core_list_initialized_) {
+    throw std::runtime_error(
+        "Fail to set_memory_policy. Current CPUPool object didn't express as cpu_core_list format.");
+  }
+  this->memory_policy_ = memory_policy;
+}
+
+MemoryPolicy CPUPool::get_memory_policy() const {
+  return this->memory_policy_;
+}
+
+std::vector<int32_t> CPUPool::get_numa_nodes() const {
+  std::vector<int32_t> nodes;
+  for (auto core : this->get_cpu_core_list()) {
+    auto node = get_core_numa_node(core);
+    if (node >= 0 &&
+        std::find(nodes.begin(), nodes.end(), node) == nodes.end()) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+void CPUPool::set_thread_memory_policies(
+    std::vector<ThreadMemoryPolicy>&& thread_memory_policies) {
+  this->thread_memory_policies_ = std::move(thread_memory_policies);
+}
+
+const std::vector<ThreadMemoryPolicy>& CPUPool::get_thread_memory_policies()
+    const {
+  return this->thread_memory_policies_;
+}
+
 CPUPool::~CPUPool() {
   if (this->cpu_affinity_mask_initialized_) {
     // If we are using the cpu_affinity_mask expression for CPUPool
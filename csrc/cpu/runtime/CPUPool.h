@@ -7,6 +7,7 @@
 
 #include <Macros.h>
 #include <torch/csrc/jit/api/module.h>
+#include "NumaMemory.h"
 
 namespace torch_ipex {
 namespace runtime {
@@ -29,6 +30,15 @@ class IPEX_API CPUPool {
   const std::vector<kmp_affinity_mask_t>& get_cpu_affinity_mask() const;
   bool is_cpu_core_list_initialized() const;
   bool is_cpu_affinity_mask_initialized() const;
+  // The memory policy is applied on the NUMA nodes of the cores together with
+  // the affinity
+  void set_memory_policy(MemoryPolicy memory_policy);
+  MemoryPolicy get_memory_policy() const;
+  std::vector<int32_t> get_numa_nodes() const;
+  // Policies of the threads saved with cpu_affinity_mask, to restore them
+  void set_thread_memory_policies(
+      std::vector<ThreadMemoryPolicy>&& thread_memory_policies);
+  const std::vector<ThreadMemoryPolicy>& get_thread_memory_policies() const;
   ~CPUPool();
 
  private:
@@ -39,6 +49,8 @@ class IPEX_API CPUPool {
   bool cpu_core_list_initialized_{false};
   std::vector<kmp_affinity_mask_t> cpu_affinity_mask;
   bool cpu_affinity_mask_initialized_{false};
+  MemoryPolicy memory_policy_{MEMORY_POLICY_NONE};
+  std::vector<ThreadMemoryPolicy> thread_memory_policies_;
 
   // Put deleted function into private.
   CPUPool() = delete;
@@ -60,6 +72,8 @@ IPEX_API void _pin_cpu_cores(const torch_ipex::runtime::CPUPool& cpu_pool);
 IPEX_API bool is_same_core_affinity_setting(
     const std::vector<int32_t>& cpu_core_list);
 IPEX_API CPUPool get_cpu_pool_from_mask_affinity();
+// NUMA node of the core, -1 if unknown
+IPEX_API int32_t get_core_numa_node(int32_t core_id);
 IPEX_API void set_mask_affinity_from_cpu_pool(const CPUPool& cpu_pool);
 
 class IPEX_API WithCPUPool {
@@ -0,0 +1,277 @@
+#include "MultiStreamExecutor.h"
+
+#include <ATen/core/grad_mode.h>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace torch_ipex {
+namespace runtime {
+
+MultiStreamExecutor::MultiStreamExecutor(
+    Runner runner,
+    const std::vector<std::vector<int32_t>>& stream_cores,
+    int64_t max_pending,
+    MemoryPolicy memory_policy)
+    : runner_(std::move(runner)),
+      slots_(new TaskSlot[std::max<int64_t>(max_pending, 1)]),
+      num_slots_(std::max<int64_t>(max_pending, 1)),
+      free_slots_(num_slots_) {
+  // Notice: We shouldn't load iomp symbol in sub_thread, otherwise race
+  // condition happens.
+  if (!is_runtime_ext_enabled()) {
+    throw std::runtime_error(
+        "Fail to init MultiStreamExecutor. Didn't preload IOMP "
+        "before using the runtime API.");
+  }
+  if (stream_cores.empty()) {
+    throw std::runtime_error("MultiStreamExecutor needs at least one stream.");
+  }
+  for (uint32_t i = 0; i < num_slots_; i++) {
+    free_slots_.push(i);
+  }
+
+  std::vector<int32_t> numa_nodes;
+  for (auto& cores : stream_cores) {
+    if (cores.empty()) {
+      throw std::runtime_error("MultiStreamExecutor stream without cores.");
+    }
+    numa_nodes.push_back(get_core_numa_node(cores[0]));
+    workers_.emplace_back(new Worker(cores, num_slots_));
+    workers_.back()->cpu_pool.set_memory_policy(memory_policy);
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
+    for (size_t j = 0; j < workers_.size(); j++) {
+      if (j != i && numa_nodes[j] == numa_nodes[i]) {
+        workers_[i]->siblings.push_back(j);
+      }
+    }
+  }
+  for (size_t i = 0; i < workers_.size(); i++) {
+    workers_[i]->thread = std::thread([this, i] { this->worker_loop(i); });
+  }
+}
+
+MultiStreamExecutor::~MultiStreamExecutor() {
+  this->stop();
+}
+
+int64_t MultiStreamExecutor::num_streams() const {
+  return workers_.size();
+}
+
+std::vector<int64_t> MultiStreamExecutor::stolen_counts() const {
+  std::vector<int64_t> counts;
+  for (auto& worker : workers_) {
+    counts.push_back(worker->stolen.load(std::memory_order_relaxed));
+  }
+  return counts;
+}
+
+uint32_t MultiStreamExecutor::acquire_slot(
+    std::vector<c10::IValue>&& inputs,
+    bool grad_mode) {
+  uint32_t idx;
+  if (!free_slots_.pop(idx)) {
+    throw std::runtime_error(
+        "MultiStreamExecutor has " + std::to_string(num_slots_) +
+        " pending tasks, get the finished ones before submitting more.");
+  }
+  auto& slot = slots_[idx];
+  // Move the inputs into the pooled stack to keep its storage
+  slot.stack.insert(
+      slot.stack.end(),
+      std::make_move_iterator(inputs.begin()),
+      std::make_move_iterator(inputs.end()));
+  slot.grad_mode = grad_mode;
+  slot.state.store(SLOT_QUEUED, std::memory_order_relaxed);
+  return idx;
+}
+
+void MultiStreamExecutor::enqueue(uint32_t idx, size_t stream) {
+  // Never full, a queue can hold all the slots
+  workers_[stream]->queue.push(idx);
+}
+
+void MultiStreamExecutor::notify(size_t stream) {
+  // Pairs with the fence of a worker going to sleep: either it sees the new
+  // task or we see it sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto& worker = *workers_[stream];
+  if (worker.sleeping.load(std::memory_order_relaxed)) {
+    { std::lock_guard<std::mutex> lock(worker.mutex); }
+    worker.condition.notify_one();
+    return;
+  }
+  // The stream is busy, let an idle stream of the same node steal the task
+  for (auto sibling : worker.siblings) {
+    auto& thief = *workers_[sibling];
+    if (thief.sleeping.load(std::memory_order_relaxed)) {
+      thief.wake.store(true);
+      { std::lock_guard<std::mutex> lock(thief.mutex); }
+      thief.condition.notify_one();
+      return;
+    }
+  }
+}
+
+int64_t MultiStreamExecutor::submit(
+    std::vector<c10::IValue>&& inputs,
+    int64_t stream) {
+  // submit task to a stopping executor is not allowed
+  if (stop_.load()) {
+    throw std::runtime_error("Task submit on stopped MultiStreamExecutor");
+  }
+  size_t target = stream < 0
+      ? next_stream_.fetch_add(1, std::memory_order_relaxed) % workers_.size()
+      : stream;
+  if (target >= workers_.size()) {
+    throw std::runtime_error(
+        "MultiStreamExecutor has no stream " + std::to_string(stream));
+  }
+  auto idx = acquire_slot(std::move(inputs), at::GradMode::is_enabled());
+  int64_t handle = ((int64_t)slots_[idx].generation.load() << 32) | idx;
+  enqueue(idx, target);
+  notify(target);
+  return handle;
+}
+
+std::vector<int64_t> MultiStreamExecutor::submit_batch(
+    std::vector<std::vector<c10::IValue>>&& inputs) {
+  if (stop_.load()) {
+    throw std::runtime_error("Task submit on stopped MultiStreamExecutor");
+  }
+  auto grad_mode = at::GradMode::is_enabled();
+  std::vector<uint32_t> idxs;
+  idxs.reserve(inputs.size());
+  try {
+    for (auto& input : inputs) {
+      idxs.push_back(acquire_slot(std::move(input), grad_mode));
+    }
+  } catch (...) {
+    for (auto idx : idxs) {
+      slots_[idx].stack.clear();
+      slots_[idx].state.store(SLOT_FREE);
+      free_slots_.push(idx);
+    }
+    throw;
+  }
+
+  std::vector<int64_t> handles;
+  handles.reserve(idxs.size());
+  for (size_t i = 0; i < idxs.size(); i++) {
+    handles.push_back(
+        ((int64_t)slots_[idxs[i]].generation.load() << 32) | idxs[i]);
+    enqueue(idxs[i], i % workers_.size());
+  }
+  for (size_t s = 0; s < std::min(idxs.size(), workers_.size()); s++) {
+    notify(s);
+  }
+  return handles;
+}
+
+c10::IValue MultiStreamExecutor::get(int64_t handle) {
+  uint32_t idx = handle & 0xffffffff;
+  uint32_t generation = handle >> 32;
+  if (handle < 0 || idx >= num_slots_ ||
+      slots_[idx].generation.load() != generation ||
+      slots_[idx].state.load() == SLOT_FREE) {
+    throw std::runtime_error(
+        "MultiStreamExecutor get on an unknown or already consumed handle");
+  }
+  auto& slot = slots_[idx];
+  if (slot.state.load(std::memory_order_acquire) != SLOT_DONE) {
+    std::unique_lock<std::mutex> lock(slot.mutex);
+    slot.done.wait(lock, [&slot] {
+      return slot.state.load(std::memory_order_acquire) == SLOT_DONE;
+    });
+  }
+  auto output = std::move(slot.output);
+  slot.output = c10::IValue();
+  auto error = slot.error;
+  slot.error = nullptr;
+  slot.stack.clear();
+  // Invalidate the handle before the slot can be reused
+  slot.generation.store((generation + 1) & 0x7fffffff);
+  slot.state.store(SLOT_FREE);
+  free_slots_.push(idx);
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return output;
+}
+
+bool MultiStreamExecutor::try_steal(size_t stream, uint32_t& idx) {
+  // Only steal from busy streams, an idle one runs its own tasks soon
+  for (auto victim : workers_[stream]->siblings) {
+    auto& worker = *workers_[victim];
+    if (worker.busy.load(std::memory_order_relaxed) && worker.queue.pop(idx)) {
+      workers_[stream]->stolen.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void MultiStreamExecutor::run_task(uint32_t idx, size_t stream) {
+  auto& slot = slots_[idx];
+  // set the thread local status, such as the grad mode before execuating the
+  // task
+  at::GradMode::set_enabled(slot.grad_mode);
+  try {
+    slot.output = runner_(slot.stack, stream);
+  } catch (...) {
+    slot.error = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.state.store(SLOT_DONE, std::memory_order_release);
+  }
+  slot.done.notify_all();
+}
+
+void MultiStreamExecutor::worker_loop(size_t stream) {
+  auto& worker = *workers_[stream];
+  _pin_cpu_cores(worker.cpu_pool);
+  uint32_t idx;
+  while (true) {
+    if (worker.queue.pop(idx) || try_steal(stream, idx)) {
+      worker.busy.store(true, std::memory_order_relaxed);
+      run_task(idx, stream);
+      worker.busy.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    worker.sleeping.store(true, std::memory_order_relaxed);
+    // Pairs with the fence in notify()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    worker.condition.wait(lock, [this, &worker] {
+      return stop_.load() || !worker.queue.empty() ||
+          worker.wake.exchange(false);
+    });
+    worker.sleeping.store(false, std::memory_order_relaxed);
+    if (stop_.load() && worker.queue.empty()) {
+      return;
+    }
+  }
+}
+
+void MultiStreamExecutor::stop() {
+  bool expected = false;
+  if (!stop_.compare_exchange_strong(expected, true)) {
+    return;
+  }
+  for (auto& worker : workers_) {
+    { std::lock_guard<std::mutex> lock(worker->mutex); }
+    worker->condition.notify_all();
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ATen/core/ivalue.h>
+#include <Macros.h>
+#include "CPUPool.h"
+#include "LockFreeQueue.h"
+
+namespace torch_ipex {
+namespace runtime {
+
+/*
+MultiStreamExecutor runs the same function on several streams, each stream
+being a worker thread pinned to its own CPUPool.
+- Each stream has a lock-free queue, so submission never takes a lock shared
+  with the other streams and one slow stream does not block the others.
+- A stream whose queue is empty steals the queued tasks of the busy streams on
+  the same NUMA node.
+- The tasks live in a fixed array of slots reused across submissions (the
+  input stack keeps its capacity), so a submission does not allocate. A handle
+  identifies the slot and its generation, and get() releases the slot.
+- submit_batch() submits several inputs at once, the i-th input going to the
+  i-th stream, and wakes each stream once.
+*/
+class IPEX_API MultiStreamExecutor {
+ public:
+  // Runs the stack on the given stream. The runner may consume the stack but
+  // should keep its storage.
+  using Runner =
+      std::function<c10::IValue(std::vector<c10::IValue>&, size_t stream)>;
+
+  explicit MultiStreamExecutor(
+      Runner runner,
+      const std::vector<std::vector<int32_t>>& stream_cores,
+      int64_t max_pending = 1024,
+      MemoryPolicy memory_policy = MEMORY_POLICY_NONE);
+  ~MultiStreamExecutor();
+
+  // stream -1 selects the streams round-robin
+  int64_t submit(std::vector<c10::IValue>&& inputs, int64_t stream = -1);
+  std::vector<int64_t> submit_batch(
+      std::vector<std::vector<c10::IValue>>&& inputs);
+  // Waits for the task and rethrows its exception, if any
+  c10::IValue get(int64_t handle);
+
+  int64_t num_streams() const;
+  // Number of tasks each stream stole from the others
+  std::vector<int64_t> stolen_counts() const;
+  void stop();
+
+ private:
+  enum SlotState { SLOT_FREE, SLOT_QUEUED, SLOT_DONE };
+
+  struct TaskSlot {
+    std::vector<c10::IValue> stack;
+    c10::IValue output;
+    std::exception_ptr error;
+    bool grad_mode{true};
+    std::atomic<uint32_t> generation{0};
+    std::atomic<int> state{SLOT_FREE};
+    std::mutex mutex;
+    std::condition_variable done;
+  };
+
+  struct Worker {
+    explicit Worker(std::vector<int32_t> cores, size_t queue_size)
+        : cpu_pool(std::move(cores)), queue(queue_size) {}
+    CPUPool cpu_pool;
+    BoundedMPMCQueue<uint32_t> queue;
+    // Streams on the same NUMA node, which this stream may steal from
+    std::vector<size_t> siblings;
+    std::atomic<bool> busy{false};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> wake{false};
+    std::atomic<int64_t> stolen{0};
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::thread thread;
+  };
+
+  uint32_t acquire_slot(std::vector<c10::IValue>&& inputs, bool grad_mode);
+  void enqueue(uint32_t idx, size_t stream);
+  void notify(size_t stream);
+  bool try_steal(size_t stream, uint32_t& idx);
+  void run_task(uint32_t idx, size_t stream);
+  void worker_loop(size_t stream);
+
+  Runner runner_;
+  std::unique_ptr<TaskSlot[]> slots_;
+  size_t num_slots_;
+  BoundedMPMCQueue<uint32_t> free_slots_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_stream_{0};
+  std::atomic<bool> stop_{false};
+
+  MultiStreamExecutor(const MultiStreamExecutor&) = delete;
+  MultiStreamExecutor(MultiStreamExecutor&&) = delete;
+  MultiStreamExecutor& operator=(const MultiStreamExecutor&) = delete;
+  MultiStreamExecutor& operator=(MultiStreamExecutor&&) = delete;
+};
+
+} // namespace runtime
+} // namespace torch_ipex
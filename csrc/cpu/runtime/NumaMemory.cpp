@@ -0,0 +1,230 @@
+#include "NumaMemory.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace torch_ipex {
+namespace runtime {
+
+namespace {
+constexpr int kMaxNumaNodes = 1024;
+constexpr int kBitsPerLong = 8 * sizeof(unsigned long);
+// From <linux/mempolicy.h>
+constexpr int kMpolDefault = 0;
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolBind = 2;
+constexpr int kMpolPreferredMany = 5;
+constexpr int kMpolMfMove = 1 << 1;
+
+#ifndef _WIN32
+long sys_set_mempolicy(int mode, const unsigned long* nodemask) {
+  // The kernel reads maxnode - 1 bits
+  return syscall(SYS_set_mempolicy, mode, nodemask, kMaxNumaNodes + 1);
+}
+
+void add_node(std::vector<int64_t>& per_node, int32_t node, int64_t bytes) {
+  if (node >= (int32_t)per_node.size()) {
+    per_node.resize(node + 1, 0);
+  }
+  per_node[node] += bytes;
+}
+
+// Pages of the tensor storage, for move_pages(2)
+std::vector<void*> storage_pages(const at::Tensor& tensor) {
+  std::vector<void*> pages;
+  if (!tensor.defined() || !tensor.has_storage() ||
+      tensor.storage().nbytes() == 0 || tensor.storage().data() == nullptr) {
+    return pages;
+  }
+  uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  auto start = (uintptr_t)tensor.storage().data();
+  auto end = start + tensor.storage().nbytes();
+  for (auto page = start & ~(page_size - 1); page < end; page += page_size) {
+    pages.push_back((void*)page);
+  }
+  return pages;
+}
+#endif
+} // namespace
+
+int32_t get_numa_node_count() {
+#ifdef _WIN32
+  return 1;
+#else
+  static int32_t count = []() {
+    int32_t nodes = 0;
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir == NULL) {
+      return 1;
+    }
+    while (auto entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+          name.find_first_not_of("0123456789", 4) == std::string::npos) {
+        nodes = std::max(nodes, std::stoi(name.substr(4)) + 1);
+      }
+    }
+    closedir(dir);
+    return std::max(nodes, 1);
+  }();
+  return count;
+#endif
+}
+
+bool set_thread_memory_policy(
+    MemoryPolicy policy,
+    const std::vector<int32_t>& nodes) {
+#ifdef _WIN32
+  return false;
+#else
+  if (policy == MEMORY_POLICY_NONE) {
+    return sys_set_mempolicy(kMpolDefault, NULL) == 0;
+  }
+  std::vector<unsigned long> nodemask(kMaxNumaNodes / kBitsPerLong, 0);
+  for (auto node : nodes) {
+    if (node < 0 || node >= kMaxNumaNodes) {
+      return false;
+    }
+    nodemask[node / kBitsPerLong] |= 1UL << (node % kBitsPerLong);
+  }
+  if (nodes.empty()) {
+    return false;
+  }
+  if (policy == MEMORY_POLICY_BIND) {
+    return sys_set_mempolicy(kMpolBind, nodemask.data()) == 0;
+  }
+  if (nodes.size() == 1 ||
+      sys_set_mempolicy(kMpolPreferredMany, nodemask.data()) != 0) {
+    // Before Linux 5.15, only one node can be preferred
+    std::fill(nodemask.begin(), nodemask.end(), 0);
+    nodemask[nodes[0] / kBitsPerLong] |= 1UL << (nodes[0] % kBitsPerLong);
+    return sys_set_mempolicy(kMpolPreferred, nodemask.data()) == 0;
+  }
+  return true;
+#endif
+}
+
+ThreadMemoryPolicy get_thread_memory_policy() {
+  ThreadMemoryPolicy policy;
+#ifndef _WIN32
+  policy.nodemask.assign(kMaxNumaNodes / kBitsPerLong, 0);
+  policy.valid = syscall(
+                     SYS_get_mempolicy,
+                     &policy.mode,
+                     policy.nodemask.data(),
+                     kMaxNumaNodes,
+                     NULL,
+                     0) == 0;
+#endif
+  return policy;
+}
+
+void restore_thread_memory_policy(const ThreadMemoryPolicy& policy) {
+#ifndef _WIN32
+  if (policy.valid) {
+    sys_set_mempolicy(policy.mode, policy.nodemask.data());
+  }
+#endif
+}
+
+std::vector<int64_t> get_process_numa_memory() {
+  std::vector<int64_t> per_node(get_numa_node_count(), 0);
+#ifndef _WIN32
+  // Each mapping lists its pages per node as N<node>=<pages>
+  std::ifstream numa_maps("/proc/self/numa_maps");
+  std::string line;
+  while (std::getline(numa_maps, line)) {
+    std::istringstream fields(line);
+    std::string field;
+    int64_t page_size = 4096;
+    std::vector<std::pair<int32_t, int64_t>> pages;
+    while (fields >> field) {
+      auto eq = field.find('=');
+      if (eq == std::string::npos) {
+        continue;
+      }
+      if (field.compare(0, eq, "kernelpagesize_kB") == 0) {
+        page_size = std::stoll(field.substr(eq + 1)) * 1024;
+      } else if (
+          field[0] == 'N' && eq > 1 &&
+          field.find_first_not_of("0123456789", 1) == eq) {
+        pages.emplace_back(
+            std::stoi(field.substr(1, eq - 1)),
+            std::stoll(field.substr(eq + 1)));
+      }
+    }
+    for (auto& node_pages : pages) {
+      add_node(per_node, node_pages.first, node_pages.second * page_size);
+    }
+  }
+#endif
+  return per_node;
+}
+
+std::vector<int64_t> get_tensor_numa_memory(const at::Tensor& tensor) {
+  std::vector<int64_t> per_node(get_numa_node_count(), 0);
+#ifndef _WIN32
+  auto pages = storage_pages(tensor);
+  if (pages.empty()) {
+    return per_node;
+  }
+  // With no target nodes, move_pages(2) only reports the node of each page
+  std::vector<int> status(pages.size(), 0);
+  if (syscall(
+          SYS_move_pages,
+          0,
+          pages.size(),
+          pages.data(),
+          NULL,
+          status.data(),
+          0) != 0) {
+    return per_node;
+  }
+  int64_t page_size = sysconf(_SC_PAGESIZE);
+  for (auto node : status) {
+    // Negative for the pages not mapped yet
+    if (node >= 0) {
+      add_node(per_node, node, page_size);
+    }
+  }
+#endif
+  return per_node;
+}
+
+bool move_tensor_to_numa_node(const at::Tensor& tensor, int32_t node) {
+#ifdef _WIN32
+  return false;
+#else
+  if (node < 0 || node >= get_numa_node_count()) {
+    throw std::runtime_error(
+        "Fail to move tensor to NUMA node " + std::to_string(node) +
+        ", the system has " + std::to_string(get_numa_node_count()) +
+        " nodes.");
+  }
+  auto pages = storage_pages(tensor);
+  if (pages.empty()) {
+    return true;
+  }
+  std::vector<int> nodes(pages.size(), node);
+  std::vector<int> status(pages.size(), 0);
+  return syscall(
+             SYS_move_pages,
+             0,
+             pages.size(),
+             pages.data(),
+             nodes.data(),
+             status.data(),
+             kMpolMfMove) == 0;
+#endif
+}
+
+} // namespace runtime
+} // namespace torch_ipex
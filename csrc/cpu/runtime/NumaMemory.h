@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <ATen/core/Tensor.h>
+#include <Macros.h>
+
+namespace torch_ipex {
+namespace runtime {
+
+// Where the memory allocated by the threads of a CPUPool goes
+enum MemoryPolicy : int64_t {
+  // First touch, the policy of the process
+  MEMORY_POLICY_NONE = 0,
+  // Prefer the NUMA nodes of the cores, other nodes when they are full
+  MEMORY_POLICY_PREFERRED = 1,
+  // Only the NUMA nodes of the cores
+  MEMORY_POLICY_BIND = 2,
+};
+
+// Memory policy of a thread as returned by get_mempolicy(2), used to restore
+// it
+struct ThreadMemoryPolicy {
+  bool valid{false};
+  int mode{0};
+  std::vector<unsigned long> nodemask;
+};
+
+// The NUMA APIs below use the raw syscalls so that IPEX does not depend on
+// libnuma. They do nothing on the systems without NUMA support.
+
+// Number of NUMA nodes of the system, 1 if unknown
+IPEX_API int32_t get_numa_node_count();
+// Applies the policy on nodes to the calling thread, false if not supported
+bool set_thread_memory_policy(
+    MemoryPolicy policy,
+    const std::vector<int32_t>& nodes);
+ThreadMemoryPolicy get_thread_memory_policy();
+void restore_thread_memory_policy(const ThreadMemoryPolicy& policy);
+
+// Bytes of the process memory resident on each NUMA node
+IPEX_API std::vector<int64_t> get_process_numa_memory();
+// Bytes of the tensor storage resident on each NUMA node, the pages not
+// touched yet are not counted
+IPEX_API std::vector<int64_t> get_tensor_numa_memory(const at::Tensor& tensor);
+// Migrates the pages of the tensor storage to the node. The first and last
+// pages may be shared with other allocations, which move as well.
+IPEX_API bool move_tensor_to_numa_node(const at::Tensor& tensor, int32_t node);
+
+} // namespace runtime
+} // namespace torch_ipex
@@ -1,5 +1,10 @@
 #include "sklearn.h"
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #ifdef _WIN32
 #include <ppl.h>
 #define IPEX_PARALLEL_SORT concurrency::parallel_sort
@@ -18,21 +23,22 @@ template <typename T>
 std::vector<double> roc_auc_score_(
     at::Tensor self,
     at::Tensor other,
-    int size,
+    int64_t size,
     bool only_score = true) {
   T* actual = self.data_ptr<T>();
   T* prediction = other.data_ptr<T>();
-  std::vector<T> predictedRank(size, 0.0);
-  int nPos = 0, nNeg = 0;
+  // the ranks go beyond the integers exactly represented by float
+  std::vector<double> predictedRank(size, 0.0);
+  int64_t nPos = 0, nNeg = 0;
 #pragma omp parallel for reduction(+ : nPos)
-  for (int i = 0; i < size; i++)
-    nPos += (int)actual[i];
+  for (int64_t i = 0; i < size; i++)
+    nPos += (int64_t)actual[i];
 
   nNeg = size - nPos;
 
-  std::vector<std::pair<T, int>> v_sort(size);
+  std::vector<std::pair<T, int64_t>> v_sort(size);
 #pragma omp parallel for
-  for (size_t i = 0; i < size; ++i) {
+  for (int64_t i = 0; i < size; ++i) {
     v_sort[i] = std::make_pair(prediction[i], i);
   }
 
@@ -40,18 +46,18 @@ std::vector<double> roc_auc_score_(
     return left.first < right.first;
   });
 
-  int r = 1;
-  int n = 1;
-  size_t i = 0;
+  int64_t r = 1;
+  int64_t n = 1;
+  int64_t i = 0;
   while (i < size) {
-    size_t j = i;
-    while ((j < (v_sort.size() - 1)) &&
+    int64_t j = i;
+    while ((j < size - 1) &&
            (v_sort[j].first == v_sort[j + 1].first)) {
       j++;
     }
     n = j - i + 1;
-    for (size_t j = 0; j < n; ++j) {
-      int idx = v_sort[i + j].second;
+    for (int64_t j = 0; j < n; ++j) {
+      int64_t idx = v_sort[i + j].second;
       predictedRank[idx] = r + ((n - 1) * 0.5);
     }
     r += n;
@@ -60,7 +66,7 @@ std::vector<double> roc_auc_score_(
 
   double filteredRankSum = 0;
 #pragma omp parallel for reduction(+ : filteredRankSum)
-  for (size_t i = 0; i < size; ++i) {
+  for (int64_t i = 0; i < size; ++i) {
     if (actual[i] == 1) {
       filteredRankSum += predictedRank[i];
     }
@@ -73,7 +79,7 @@ std::vector<double> roc_auc_score_(
     double acc = 0.0;
     double loss = 0.0;
 #pragma omp parallel for reduction(+ : acc, loss)
-    for (int i = 0; i < size; i++) {
+    for (int64_t i = 0; i < size; i++) {
       auto rpred = std::roundf(prediction[i]);
       if (actual[i] == rpred)
         acc += 1;
@@ -110,4 +116,280 @@ std::vector<double> roc_auc_score_all(at::Tensor self, at::Tensor other) {
       });
 }
 
+namespace {
+
+// Min number of samples of a chunk processed by a thread
+constexpr int64_t kMinChunkSize = 4096;
+// Predictions are clamped to [kEps, 1 - kEps] for the log loss
+constexpr double kEps = 1e-15;
+
+int64_t num_chunks_of(int64_t size) {
+  int64_t num_chunks = (size + kMinChunkSize - 1) / kMinChunkSize;
+  return std::max<int64_t>(
+      std::min<int64_t>(num_chunks, at::get_num_threads()), 1);
+}
+
+// Start of chunk c of the num_chunks chunks of [0, size)
+inline int64_t chunk_begin(int64_t size, int64_t num_chunks, int64_t c) {
+  return size / num_chunks * c + std::min(c, size % num_chunks);
+}
+
+// Maps a float to an uint32 key of the same order
+inline uint32_t float_key(float value) {
+  // -0.0 and 0.0 are the same prediction
+  if (value == 0.f) {
+    value = 0.f;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+// LSD radix sort with 8 bits digits. For each digit, every thread counts the
+// digits of its chunk and then scatters its chunk from its own offsets of
+// each bucket, so that each pass is parallel and stable.
+void parallel_radix_sort(std::vector<uint32_t>& keys) {
+  int64_t size = keys.size();
+  if (size <= 1) {
+    return;
+  }
+  constexpr int kBuckets = 256;
+  int64_t num_chunks = num_chunks_of(size);
+  std::vector<uint32_t> buffer(size);
+  std::vector<int64_t> offsets(num_chunks * kBuckets);
+  uint32_t* src = keys.data();
+  uint32_t* dst = buffer.data();
+  for (int shift = 0; shift < 32; shift += 8) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* count = &offsets[c * kBuckets];
+        int64_t chunk_end = chunk_begin(size, num_chunks, c + 1);
+        for (int64_t i = chunk_begin(size, num_chunks, c); i < chunk_end;
+             i++) {
+          count[(src[i] >> shift) & 0xFF]++;
+        }
+      }
+    });
+    // skip the digits shared by all the keys, e.g. the exponent bits of the
+    // predictions in [0, 1]
+    bool same_digit = false;
+    int64_t offset = 0;
+    for (int b = 0; b < kBuckets; b++) {
+      int64_t bucket_start = offset;
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * kBuckets + b];
+        offsets[c * kBuckets + b] = offset;
+        offset += count;
+      }
+      same_digit |= offset - bucket_start == size;
+    }
+    if (same_digit) {
+      continue;
+    }
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t* offset = &offsets[c * kBuckets];
+        int64_t chunk_end = chunk_begin(size, num_chunks, c + 1);
+        for (int64_t i = chunk_begin(size, num_chunks, c); i < chunk_end;
+             i++) {
+          dst[offset[(src[i] >> shift) & 0xFF]++] = src[i];
+        }
+      }
+    });
+    std::swap(src, dst);
+  }
+  if (src != keys.data()) {
+    std::memcpy(keys.data(), src, size * sizeof(uint32_t));
+  }
+}
+
+} // namespace
+
+RocAucAccumulator::RocAucAccumulator(int64_t num_bins) : num_bins_(num_bins) {
+  TORCH_CHECK(num_bins >= 0, "RocAucAccumulator: expect num_bins >= 0");
+  pos_hist_.resize(num_bins_, 0);
+  neg_hist_.resize(num_bins_, 0);
+}
+
+template <typename T>
+void RocAucAccumulator::update_(
+    const T* actual,
+    const T* prediction,
+    int64_t size) {
+  int64_t num_chunks = num_chunks_of(size);
+  std::vector<int64_t> chunk_pos(num_chunks, 0);
+  std::vector<int64_t> chunk_correct(num_chunks, 0);
+  std::vector<double> chunk_loss(num_chunks, 0);
+  // per thread histograms, merged after the pass
+  std::vector<int64_t> chunk_hist(num_chunks * 2 * num_bins_, 0);
+  bool exact = num_bins_ == 0;
+
+  // count the labels, the log loss and the accuracy, and the bins in
+  // histogram mode
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t* pos_hist = exact ? nullptr : &chunk_hist[c * 2 * num_bins_];
+      int64_t* neg_hist = exact ? nullptr : pos_hist + num_bins_;
+      int64_t pos = 0;
+      int64_t correct = 0;
+      double loss = 0;
+      int64_t chunk_end = chunk_begin(size, num_chunks, c + 1);
+      for (int64_t i = chunk_begin(size, num_chunks, c); i < chunk_end; i++) {
+        T label = actual[i];
+        double pred = prediction[i];
+        bool positive = label == T(1);
+        pos += positive;
+        correct += std::round(pred) == label;
+        double p = std::min(std::max(pred, kEps), 1 - kEps);
+        loss += label * std::log(p) + (1 - label) * std::log(1 - p);
+        if (!exact) {
+          double scaled = pred * num_bins_;
+          int64_t bin = !(scaled > 0) ? 0
+              : scaled >= num_bins_   ? num_bins_ - 1
+                                      : (int64_t)scaled;
+          (positive ? pos_hist : neg_hist)[bin]++;
+        }
+      }
+      chunk_pos[c] = pos;
+      chunk_correct[c] = correct;
+      chunk_loss[c] = loss;
+    }
+  });
+
+  int64_t num_pos = 0;
+  for (int64_t c = 0; c < num_chunks; c++) {
+    num_correct_ += chunk_correct[c];
+    loss_sum_ += chunk_loss[c];
+    num_pos += chunk_pos[c];
+  }
+
+  if (!exact) {
+    at::parallel_for(0, num_bins_, 1024, [&](int64_t begin, int64_t end) {
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t* pos_hist = &chunk_hist[c * 2 * num_bins_];
+        int64_t* neg_hist = pos_hist + num_bins_;
+        for (int64_t b = begin; b < end; b++) {
+          pos_hist_[b] += pos_hist[b];
+          neg_hist_[b] += neg_hist[b];
+        }
+      }
+    });
+  } else {
+    // append the keys of each chunk after the keys of the previous chunks
+    int64_t pos_offset = pos_keys_.size();
+    int64_t neg_offset = neg_keys_.size();
+    pos_keys_.resize(pos_offset + num_pos);
+    neg_keys_.resize(neg_offset + size - num_pos);
+    std::vector<int64_t> chunk_pos_offset(num_chunks);
+    std::vector<int64_t> chunk_neg_offset(num_chunks);
+    for (int64_t c = 0; c < num_chunks; c++) {
+      chunk_pos_offset[c] = pos_offset;
+      chunk_neg_offset[c] = neg_offset;
+      pos_offset += chunk_pos[c];
+      neg_offset += chunk_begin(size, num_chunks, c + 1) -
+          chunk_begin(size, num_chunks, c) - chunk_pos[c];
+    }
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        uint32_t* pos_keys = pos_keys_.data() + chunk_pos_offset[c];
+        uint32_t* neg_keys = neg_keys_.data() + chunk_neg_offset[c];
+        int64_t chunk_end = chunk_begin(size, num_chunks, c + 1);
+        for (int64_t i = chunk_begin(size, num_chunks, c); i < chunk_end;
+             i++) {
+          if (actual[i] == T(1)) {
+            *pos_keys++ = float_key(prediction[i]);
+          } else {
+            *neg_keys++ = float_key(prediction[i]);
+          }
+        }
+      }
+    });
+  }
+  num_pos_ += num_pos;
+  num_neg_ += size - num_pos;
+}
+
+void RocAucAccumulator::update(
+    const at::Tensor& actual,
+    const at::Tensor& predict) {
+  TORCH_CHECK(
+      actual.numel() == predict.numel(),
+      "RocAucAccumulator: expect actual and predict have the same numel, got ",
+      actual.numel(),
+      " and ",
+      predict.numel());
+  auto prediction = predict.contiguous();
+  auto label = actual.to(prediction.scalar_type()).contiguous();
+  AT_DISPATCH_FLOATING_TYPES(
+      prediction.scalar_type(), "RocAucAccumulator::update", [&]() {
+        update_<scalar_t>(
+            label.data_ptr<scalar_t>(),
+            prediction.data_ptr<scalar_t>(),
+            prediction.numel());
+      });
+}
+
+std::vector<double> RocAucAccumulator::compute() {
+  int64_t size = num_samples();
+  TORCH_CHECK(size > 0, "RocAucAccumulator: no sample to compute");
+  // sum of the number of negatives ranked below each positive, ties count as
+  // half
+  double rank_sum = 0;
+  if (num_bins_ == 0) {
+    parallel_radix_sort(pos_keys_);
+    parallel_radix_sort(neg_keys_);
+    const uint32_t* pos = pos_keys_.data();
+    const uint32_t* neg = neg_keys_.data();
+    int64_t num_neg = num_neg_;
+    rank_sum = at::parallel_reduce(
+        0,
+        num_pos_,
+        kMinChunkSize,
+        0.0,
+        [&](int64_t begin, int64_t end, double sum) {
+          // [lo, hi) are the negatives equal to pos[i]
+          int64_t lo = std::lower_bound(neg, neg + num_neg, pos[begin]) - neg;
+          int64_t hi = lo;
+          for (int64_t i = begin; i < end; i++) {
+            while (lo < num_neg && neg[lo] < pos[i]) {
+              lo++;
+            }
+            hi = std::max(hi, lo);
+            while (hi < num_neg && neg[hi] == pos[i]) {
+              hi++;
+            }
+            sum += lo + 0.5 * (hi - lo);
+          }
+          return sum;
+        },
+        std::plus<double>());
+  } else {
+    int64_t neg_below = 0;
+    for (int64_t b = 0; b < num_bins_; b++) {
+      rank_sum += pos_hist_[b] * (neg_below + 0.5 * neg_hist_[b]);
+      neg_below += neg_hist_[b];
+    }
+  }
+  double score = rank_sum / ((double)num_pos_ * num_neg_);
+  double log_loss = -loss_sum_ / size;
+  double accuracy = (double)num_correct_ / size;
+  return {score, log_loss, accuracy};
+}
+
+void RocAucAccumulator::reset() {
+  num_pos_ = 0;
+  num_neg_ = 0;
+  num_correct_ = 0;
+  loss_sum_ = 0;
+  std::vector<uint32_t>().swap(pos_keys_);
+  std::vector<uint32_t>().swap(neg_keys_);
+  std::fill(pos_hist_.begin(), pos_hist_.end(), 0);
+  std::fill(neg_hist_.begin(), neg_hist_.end(), 0);
+}
+
+int64_t RocAucAccumulator::num_samples() const {
+  return num_pos_ + num_neg_;
+}
+
 } // namespace toolkit
@@ -1,8 +1,45 @@
 #pragma once
 #include <ATen/Tensor.h>
+#include <cstdint>
 #include <vector>
 
 namespace toolkit {
 std::vector<double> roc_auc_score(at::Tensor actual, at::Tensor predict);
 std::vector<double> roc_auc_score_all(at::Tensor actual, at::Tensor predict);
+
+// Accumulates the predictions of a binary classifier batch by batch, e.g. over
+// the eval batches of DLRM, and computes {auc, log_loss, accuracy} of all of
+// them as roc_auc_score_all does for a single tensor.
+// - Exact mode (num_bins == 0) keeps each prediction as a 4 bytes float key,
+//   split by label, and sorts the keys with a parallel radix sort in compute().
+// - Histogram mode (num_bins > 0) only counts the predictions of each label in
+//   num_bins fixed bins of [0, 1], so it needs O(num_bins) memory and the
+//   predictions in the same bin count as ties.
+// log_loss and accuracy are accumulated in the same pass as the keys or bins.
+// An accumulator is not thread safe.
+class RocAucAccumulator {
+ public:
+  explicit RocAucAccumulator(int64_t num_bins = 0);
+
+  void update(const at::Tensor& actual, const at::Tensor& predict);
+  std::vector<double> compute();
+  void reset();
+  int64_t num_samples() const;
+
+ private:
+  template <typename T>
+  void update_(const T* actual, const T* prediction, int64_t size);
+
+  int64_t num_bins_;
+  int64_t num_pos_ = 0;
+  int64_t num_neg_ = 0;
+  int64_t num_correct_ = 0;
+  double loss_sum_ = 0;
+  // exact mode
+  std::vector<uint32_t> pos_keys_;
+  std::vector<uint32_t> neg_keys_;
+  // histogram mode
+  std::vector<int64_t> pos_hist_;
+  std::vector<int64_t> neg_hist_;
+};
 } // namespace toolkit
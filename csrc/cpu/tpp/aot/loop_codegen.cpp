@@ -0,0 +1,52 @@
+// Build time generator of the loop nests of BUILD_TPP_AOT_LOOP_SCHEMES.
+// Usage: loop_codegen <output header> <scheme>...
+// The header defines one function per scheme and IPEX_TPP_AOT_LOOP_ENTRIES,
+// which is expanded into pre_defined_loops in common_loops.cpp, so that these
+// schemes never go through the JIT compiler at runtime.
+#include <stdio.h>
+#include <fstream>
+#include <string>
+#include "par_loop_generator.h"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <output header> <scheme>...\n", argv[0]);
+    return 1;
+  }
+  const std::string signature = "extern \"C\" void par_nested_loops(";
+  const std::string omp_include = "#include <omp.h>\n";
+  std::string funcs, entries;
+  for (int i = 2; i < argc; i++) {
+    std::string code = torch_ipex::tpp::loop_generator(argv[i]);
+    auto pos = code.find(signature);
+    if (pos == std::string::npos) {
+      fprintf(stderr, "Unable to generate the loop nest for '%s'\n", argv[i]);
+      return 1;
+    }
+    auto func_name = "par_nested_loops_aot_" + std::to_string(i - 2);
+    code.replace(pos, signature.size(), "static void " + func_name + "(");
+    pos = code.find(omp_include);
+    if (pos != std::string::npos)
+      code.erase(pos, omp_include.size());
+    funcs += "// " + std::string(argv[i]) + "\n" + code + "\n";
+    entries += "  {\"" + std::string(argv[i]) + "\", aot::" + func_name + "},";
+    entries += i + 1 < argc ? " \\\n" : "\n";
+  }
+  std::ofstream ofs(argv[1], std::ofstream::out);
+  ofs << "// Generated by loop_codegen, do not edit.\n"
+      << "#pragma once\n\n"
+      << "#include <omp.h>\n"
+      << "#include <functional>\n"
+      << "#include \"threaded_loops.h\"\n\n"
+      << "namespace torch_ipex {\n"
+      << "namespace tpp {\n"
+      << "namespace aot {\n\n"
+      << "using loop_rt_spec_t = LoopSpecs;\n\n"
+      << funcs << "} // namespace aot\n"
+      << "} // namespace tpp\n"
+      << "} // namespace torch_ipex\n\n"
+      << "#define IPEX_TPP_AOT_LOOP_ENTRIES \\\n"
+      << entries;
+  ofs.close();
+  return ofs.good() ? 0 : 1;
+}
@@ -2,6 +2,9 @@
 #include <string>
 #include <unordered_map>
 #include "threaded_loops.h"
+#ifdef IPEX_TPP_AOT_LOOPS
+#include "tpp_aot_loops.h"
+#endif
 
 namespace torch_ipex {
 namespace tpp {
@@ -403,6 +406,9 @@ std::unordered_map<std::string, par_loop_kernel> pre_defined_loops = {
     {"CAB", par_nested_loops_CAB},
     {"ACb", par_nested_loops_ACb},
     {"ABCD", par_nested_loops_ABCD},
+#ifdef IPEX_TPP_AOT_LOOPS
+    IPEX_TPP_AOT_LOOP_ENTRIES
+#endif
 };
 } // namespace tpp
 } // namespace torch_ipex
\ No newline at end of file
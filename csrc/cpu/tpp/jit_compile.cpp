@@ -1,15 +1,183 @@
 #include "jit_compile.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #ifndef _WIN32
+#include <dirent.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #else
 #include <stdexcept>
 #endif
 namespace torch_ipex {
 namespace tpp {
+
+#define JIT_CXX "g++"
+
+#ifndef _WIN32
+// The JIT compiled libraries are cached on disk, so that a new process does
+// not invoke the compiler again for the loop nests it has already seen.
+// The cache is content addressed: the file name is <src>-<cxx>.so, where <src>
+// is the hash of the generated source and the flags and <cxx> is the hash of
+// the compiler version. IPEX_TPP_JIT_CACHE_DIR sets the cache directory
+// (default: $XDG_CACHE_HOME/intel_extension_for_pytorch/tpp_jit or
+// ~/.cache/intel_extension_for_pytorch/tpp_jit), IPEX_TPP_JIT_CACHE=0
+// disables the cache.
+
+// 64-bit FNV-1a, stable across runs and builds unlike std::hash
+static std::string jit_hash(const std::string& str) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+  return buf;
+}
+
+// Empty if the compiler is not available
+static const std::string& jit_compiler_version() {
+  static std::string version = []() {
+    std::string ret;
+    FILE* pipe =
+        popen(JIT_CXX " -dumpfullversion -dumpversion 2>/dev/null", "r");
+    if (pipe == NULL)
+      return ret;
+    char buf[128];
+    while (fgets(buf, sizeof(buf), pipe) != NULL)
+      ret += buf;
+    if (pclose(pipe) != 0)
+      ret.clear();
+    return ret.empty() ? ret : std::string(JIT_CXX " ") + ret;
+  }();
+  return version;
+}
+
+static bool make_dirs(const std::string& path) {
+  for (size_t pos = path.find('/', 1);; pos = path.find('/', pos + 1)) {
+    auto dir = path.substr(0, pos);
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST)
+      return false;
+    if (pos == std::string::npos)
+      return true;
+  }
+}
+
+// Empty if the cache is disabled or the directory can not be created
+static const std::string& jit_cache_dir() {
+  static std::string dir = []() {
+    std::string ret;
+    auto enable = getenv("IPEX_TPP_JIT_CACHE");
+    if (enable != NULL && std::string(enable) == "0")
+      return ret;
+    if (auto env = getenv("IPEX_TPP_JIT_CACHE_DIR")) {
+      ret = env;
+    } else if (auto env = getenv("XDG_CACHE_HOME")) {
+      ret = std::string(env) + "/intel_extension_for_pytorch/tpp_jit";
+    } else if (auto env = getenv("HOME")) {
+      ret = std::string(env) + "/.cache/intel_extension_for_pytorch/tpp_jit";
+    }
+    while (ret.size() > 1 && ret.back() == '/')
+      ret.pop_back();
+    if (!ret.empty() && !make_dirs(ret)) {
+      printf("Unable to create TPP JIT cache directory '%s'\n", ret.c_str());
+      ret.clear();
+    }
+    return ret;
+  }();
+  return dir;
+}
+
+// Path of the cached library, empty on miss. Without a compiler, a library
+// built by any compiler version is accepted as there is no other way to get
+// the kernel.
+static std::string jit_cache_lookup(const std::string& src_key) {
+  auto& dir = jit_cache_dir();
+  auto& cxx_version = jit_compiler_version();
+  if (!cxx_version.empty()) {
+    auto path = dir + "/" + src_key + "-" + jit_hash(cxx_version) + ".so";
+    return access(path.c_str(), R_OK) == 0 ? path : std::string();
+  }
+  std::string ret;
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL)
+    return ret;
+  auto prefix = src_key + "-";
+  while (auto entry = readdir(d)) {
+    std::string name = entry->d_name;
+    if (name.compare(0, prefix.size(), prefix) == 0 && name.size() > 3 &&
+        name.compare(name.size() - 3, 3, ".so") == 0) {
+      ret = dir + "/" + name;
+      break;
+    }
+  }
+  closedir(d);
+  return ret;
+}
+
+static bool jit_compile(
+    const std::string& filename,
+    const std::string& flags,
+    const std::string& output) {
+  auto cmd = std::string(JIT_CXX " -shared -fPIC -x c++ ") + flags;
+  cmd = cmd + " -o " + output + " " + filename;
+  printf("JIT COMPILE: %s\n", cmd.c_str());
+  return system(cmd.c_str()) == 0;
+}
+
+static void* jit_load(const char* libname) {
+  auto handle = dlopen(libname, RTLD_LAZY | RTLD_NODELETE);
+  if (!handle) {
+    fputs(dlerror(), stderr);
+    return NULL;
+  }
+  return handle;
+}
+
+void* jit_compile_and_load(
+    const std::string filename,
+    const std::string flags);
+
+// Compile into a temporary file in the cache directory and rename it, so
+// that concurrent processes never load a partially written library.
+static void* jit_compile_to_cache(
+    const std::string& filename,
+    const std::string& flags,
+    const std::string& src_key) {
+  auto& cxx_version = jit_compiler_version();
+  auto path =
+      jit_cache_dir() + "/" + src_key + "-" + jit_hash(cxx_version) + ".so";
+  auto tmp = path + ".XXXXXX";
+  int fd = mkstemp(&tmp[0]);
+  if (fd < 0) {
+    // e.g. a read-only cache directory, compile without caching
+    return jit_compile_and_load(filename, flags);
+  }
+  close(fd);
+  if (!jit_compile(filename, flags, tmp) ||
+      rename(tmp.c_str(), path.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return NULL;
+  }
+  return jit_load(path.c_str());
+}
+
+static void* jit_get_symbol(void* handle, const std::string func_name) {
+  if (handle == NULL)
+    return NULL;
+  void* func = dlsym(handle, func_name.c_str());
+  if (func == NULL) {
+    printf("Unable to find '%s' symbol in JIT COMPILE\n", func_name.c_str());
+  }
+  dlclose(handle);
+  return func;
+}
+#endif
+
 void* jit_compile_and_load(
     const std::string filename,
     const std::string flags) {
@@ -19,18 +187,9 @@ void* jit_compile_and_load(
   unlink(libname);
   char fdname[50];
   snprintf(fdname, sizeof(fdname), "/proc/self/fd/%d", fd);
-  auto cmd = std::string("g++ -shared -fPIC -x c++ ") + flags;
-  cmd = cmd + " -o " + fdname + " " + filename;
-  printf("JIT COMPILE: %s\n", cmd.c_str());
-  int ret = system(cmd.c_str());
-  if (ret != 0)
+  if (!jit_compile(filename, flags, fdname))
     return NULL;
-  auto handle = dlopen(fdname, RTLD_LAZY | RTLD_NODELETE);
-  if (!handle) {
-    fputs(dlerror(), stderr);
-    return NULL;
-  }
-  return handle;
+  return jit_load(fdname);
 #else
   throw std::runtime_error("not implemented.");
   return NULL;
@@ -42,15 +201,7 @@ void* jit_from_file(
     const std::string flags,
     const std::string func_name) {
 #ifndef _WIN32
-  void* handle = jit_compile_and_load(filename, flags);
-  if (handle == NULL)
-    return NULL;
-  void* func = dlsym(handle, func_name.c_str());
-  if (func == NULL) {
-    printf("Unable to find '%s' symbol in JIT COMPILE\n", func_name.c_str());
-  }
-  dlclose(handle);
-  return func;
+  return jit_get_symbol(jit_compile_and_load(filename, flags), func_name);
 #else
   throw std::runtime_error("not implemented.");
   return NULL;
@@ -62,12 +213,26 @@ void* jit_from_str(
     const std::string flags,
     const std::string func_name) {
 #ifndef _WIN32
+  std::string src_key;
+  if (!jit_cache_dir().empty()) {
+    src_key = jit_hash(flags + '\n' + src);
+    auto cached = jit_cache_lookup(src_key);
+    if (!cached.empty()) {
+      void* func = jit_get_symbol(jit_load(cached.c_str()), func_name);
+      if (func != NULL)
+        return func;
+    }
+  }
   char filename[] = "/tmp/ppx_XXXXXX";
   int fd = mkstemp(filename);
   unlink(filename);
   char fdname[50];
   snprintf(fdname, sizeof(fdname), "/proc/self/fd/%d", fd);
   write(fd, src.c_str(), src.length());
+  if (!src_key.empty() && !jit_compiler_version().empty()) {
+    return jit_get_symbol(
+        jit_compile_to_cache(fdname, flags, src_key), func_name);
+  }
   return jit_from_file(fdname, flags, func_name);
 #else
   throw std::runtime_error("not implemented.");
@@ -75,4 +240,4 @@ void* jit_from_str(
 #endif
 }
 } // namespace tpp
-} // namespace torch_ipex
\ No newline at end of file
+} // namespace torch_ipex
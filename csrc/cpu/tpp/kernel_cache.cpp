@@ -0,0 +1,69 @@
+#include "kernel_cache.h"
+#include <stdlib.h>
+
+namespace torch_ipex {
+namespace tpp {
+
+TPPKernelCache::TPPKernelCache() {
+  auto env = getenv("IPEX_TPP_KERNEL_CACHE_CAPACITY");
+  capacity_ = env ? atoll(env) : 0;
+}
+
+TPPKernelCache& TPPKernelCache::instance() {
+  // never destroyed, the kernels may be used until the process exits
+  static TPPKernelCache* cache = new TPPKernelCache();
+  return *cache;
+}
+
+bool TPPKernelCache::reserve() {
+  auto capacity = capacity_.load(std::memory_order_relaxed);
+  auto size = size_.load(std::memory_order_relaxed);
+  do {
+    if (capacity > 0 && size >= capacity)
+      return false;
+  } while (!size_.compare_exchange_weak(size, size + 1));
+  return true;
+}
+
+TPPKernelCacheStats TPPKernelCache::stats() const {
+  TPPKernelCacheStats stats{};
+  int64_t build_time_ns = 0;
+  for (auto& shard : shards_) {
+    stats.hits += shard.hits.load(std::memory_order_relaxed);
+    stats.misses += shard.misses.load(std::memory_order_relaxed);
+    build_time_ns += shard.build_time_ns.load(std::memory_order_relaxed);
+  }
+  stats.uncached = uncached_.load(std::memory_order_relaxed);
+  stats.size = size_.load(std::memory_order_relaxed);
+  stats.capacity = capacity_.load(std::memory_order_relaxed);
+  stats.build_time_ms = build_time_ns / 1e6;
+  return stats;
+}
+
+void TPPKernelCache::reset_stats() {
+  for (auto& shard : shards_) {
+    shard.hits = 0;
+    shard.misses = 0;
+    shard.build_time_ns = 0;
+  }
+  uncached_ = 0;
+}
+
+void TPPKernelCache::set_capacity(int64_t capacity) {
+  capacity_ = capacity;
+}
+
+TPPKernelCacheStats tpp_kernel_cache_stats() {
+  return TPPKernelCache::instance().stats();
+}
+
+void tpp_kernel_cache_reset_stats() {
+  TPPKernelCache::instance().reset_stats();
+}
+
+void tpp_kernel_cache_set_capacity(int64_t capacity) {
+  TPPKernelCache::instance().set_capacity(capacity);
+}
+
+} // namespace tpp
+} // namespace torch_ipex
@@ -0,0 +1,122 @@
+#ifndef _TPP_KERNEL_CACHE_H_
+#define _TPP_KERNEL_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace torch_ipex {
+namespace tpp {
+
+struct TPPKernelCacheStats {
+  int64_t hits;
+  int64_t misses;
+  // kernels built but not cached as the cache is full
+  int64_t uncached;
+  int64_t size;
+  // 0 means unlimited
+  int64_t capacity;
+  double build_time_ms;
+};
+
+// Cache of the JIT kernels of the TPPs, keyed by the hash of the kernel
+// parameters and shared by all the TPP classes.
+// The cache is split into shards of fixed size hash tables whose chains are
+// only appended, so lookups are lock-free and only the insertion of a new
+// kernel takes the lock of its shard. The kernels are built outside of the
+// lock, so that threads warming up different shapes do not wait on each
+// other. Entries are never evicted since the TPP objects keep the raw kernel
+// pointers. Once the capacity (IPEX_TPP_KERNEL_CACHE_CAPACITY, unlimited by
+// default) is reached, new kernels are still built but not cached and are
+// counted as uncached.
+class TPPKernelCache {
+ public:
+  static TPPKernelCache& instance();
+
+  template <typename BuildFunc>
+  void* get_or_build(uint64_t hash, BuildFunc build) {
+    auto& shard = shards_[shard_id(hash)];
+    auto& bucket = shard.buckets[bucket_id(hash)];
+    void* kernel = find(bucket.load(std::memory_order_acquire), hash);
+    if (kernel != nullptr) {
+      shard.hits.fetch_add(1, std::memory_order_relaxed);
+      return kernel;
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    kernel = build();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    shard.build_time_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    if (kernel == nullptr)
+      return kernel;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto head = bucket.load(std::memory_order_relaxed);
+    // another thread may have built the same kernel in the meantime
+    void* cached = find(head, hash);
+    if (cached != nullptr)
+      return cached;
+    if (!reserve()) {
+      uncached_.fetch_add(1, std::memory_order_relaxed);
+      return kernel;
+    }
+    bucket.store(new Node{hash, kernel, head}, std::memory_order_release);
+    return kernel;
+  }
+
+  TPPKernelCacheStats stats() const;
+  void reset_stats();
+  // Only limits the kernels cached from now on
+  void set_capacity(int64_t capacity);
+
+ private:
+  static constexpr int NUM_SHARDS = 64;
+  static constexpr int NUM_BUCKETS = 256;
+
+  struct Node {
+    uint64_t hash;
+    void* kernel;
+    Node* next;
+  };
+
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::atomic<int64_t> hits{0};
+    std::atomic<int64_t> misses{0};
+    std::atomic<int64_t> build_time_ns{0};
+    std::atomic<Node*> buckets[NUM_BUCKETS] = {};
+  };
+
+  TPPKernelCache();
+
+  static int shard_id(uint64_t hash) {
+    return (hash >> 56) % NUM_SHARDS;
+  }
+  static int bucket_id(uint64_t hash) {
+    return (hash ^ (hash >> 29)) % NUM_BUCKETS;
+  }
+  static void* find(const Node* node, uint64_t hash) {
+    for (; node != nullptr; node = node->next) {
+      if (node->hash == hash)
+        return node->kernel;
+    }
+    return nullptr;
+  }
+  bool reserve();
+
+  Shard shards_[NUM_SHARDS];
+  std::atomic<int64_t> size_{0};
+  std::atomic<int64_t> capacity_;
+  std::atomic<int64_t> uncached_{0};
+};
+
+TPPKernelCacheStats tpp_kernel_cache_stats();
+void tpp_kernel_cache_reset_stats();
+void tpp_kernel_cache_set_capacity(int64_t capacity);
+
+} // namespace tpp
+} // namespace torch_ipex
+
+#endif // _TPP_KERNEL_CACHE_H_
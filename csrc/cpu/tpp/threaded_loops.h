@@ -7,6 +7,7 @@
 #include <fstream>
 #include <initializer_list>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
@@ -235,7 +236,9 @@ class LoopingScheme {
 
 inline LoopingScheme* getLoopingScheme(std::string scheme) {
   static std::unordered_map<std::string, LoopingScheme*> kernel_cache;
+  static std::mutex kernel_cache_mutex;
 
+  std::lock_guard<std::mutex> lock(kernel_cache_mutex);
   LoopingScheme* kernel = NULL;
   auto search = kernel_cache.find(scheme);
   if (search != kernel_cache.end())
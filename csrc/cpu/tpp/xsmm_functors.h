@@ -10,6 +10,7 @@
 #include <string>
 #include <unordered_map>
 #include "csrc/cpu/aten/TPPGEMM.h"
+#include "kernel_cache.h"
 
 namespace torch_ipex {
 namespace tpp {
@@ -322,30 +323,18 @@ inline uint64_t string_to_hash_int(
 class BaseTPP {
  public:
   void* get_kernel() {
-    auto& kernel_cache = get_kernel_cache();
-    void* kernel = NULL;
     if (hash == 0)
       hash = hash_int();
-    auto search = kernel_cache.find(hash);
-    if (search != kernel_cache.end())
-      kernel = search->second;
+    void* kernel = TPPKernelCache::instance().get_or_build(
+        hash, [this]() { return build_kernel(); });
     if (kernel == NULL) {
-      kernel = build_kernel();
-      if (kernel == NULL) {
-        print_error();
-        exit(1);
-      }
-      // printf("TPP: %s @ %p\n", hash.c_str(), kernel);
-      kernel_cache[hash] = kernel;
+      print_error();
+      exit(1);
     }
     return kernel;
   }
 
  protected:
-  std::unordered_map<uint64_t, void*>& get_kernel_cache() {
-    static std::unordered_map<uint64_t, void*> kernel_cache;
-    return kernel_cache;
-  }
   virtual uint64_t hash_int() = 0;
   virtual void* build_kernel() = 0;
   virtual void print_error() = 0;
@@ -0,0 +1,339 @@
+#include "ScratchAllocator.h"
+#include "SysUtil.h"
+
+#include <ATen/ATen.h>
+#include <stdlib.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace torch_ipex {
+namespace utils {
+
+namespace {
+std::atomic<int64_t> stat_hits{0};
+std::atomic<int64_t> stat_misses{0};
+std::atomic<int64_t> stat_releases{0};
+std::atomic<int64_t> stat_allocated_bytes{0};
+std::atomic<int64_t> stat_cached_bytes{0};
+
+#ifndef _WIN32
+constexpr int NUM_CLASSES = 80;
+constexpr int MAX_NODES = 64;
+constexpr size_t MIN_CLASS_BYTES = 4096;
+constexpr size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;
+// Keeps the returned pointer 64 bytes aligned
+constexpr size_t HEADER_BYTES = 64;
+constexpr uint64_t BLOCK_MAGIC = 0x4950455853435254ULL;
+
+struct BlockHeader {
+  uint64_t magic;
+  // -1 for the blocks too large for a size class, never cached
+  int32_t size_class;
+  int32_t node;
+  void* map_base;
+  size_t map_bytes;
+};
+static_assert(sizeof(BlockHeader) <= HEADER_BYTES, "header too large");
+
+// 4, 5, 6, 7 times 2^k, from 4KB
+size_t class_bytes(int size_class) {
+  return (size_t)(4 + size_class % 4) << (10 + size_class / 4);
+}
+
+int size_class_of(size_t nbytes) {
+  if (nbytes <= MIN_CLASS_BYTES) {
+    return 0;
+  }
+  size_t n = nbytes - 1;
+  int shift = 63 - __builtin_clzll(n) - 2;
+  int size_class = (shift - 10) * 4 + (int)(n >> shift) - 4 + 1;
+  return size_class < NUM_CLASSES ? size_class : -1;
+}
+
+bool cache_enabled() {
+  static bool enabled = []() {
+    auto env = getenv("IPEX_SCRATCH_CACHE");
+    return env == NULL || std::string(env) != "0";
+  }();
+  return enabled;
+}
+
+int64_t node_cache_capacity() {
+  static int64_t capacity = []() {
+    auto env = getenv("IPEX_SCRATCH_CACHE_BYTES");
+    return env ? atoll(env) : (int64_t)1 << 30;
+  }();
+  return capacity;
+}
+
+// The thread cache only keeps the blocks of the thread's node, it is small
+// since the threads freeing scratch are usually the few calling the kernels
+int64_t thread_cache_capacity() {
+  return node_cache_capacity() / 4;
+}
+
+int current_node() {
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0 || node >= MAX_NODES) {
+    return 0;
+  }
+  return node;
+}
+
+void* map_block(int size_class, size_t nbytes) {
+  size_t bytes = size_class >= 0 ? class_bytes(size_class) : nbytes;
+  bool huge = bytes >= HUGE_PAGE_BYTES;
+  size_t map_bytes = huge ? bytes + HUGE_PAGE_BYTES : bytes;
+  void* map_base = mmap(
+      NULL,
+      map_bytes,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS,
+      -1,
+      0);
+  if (map_base == MAP_FAILED) {
+    return nullptr;
+  }
+  char* base = (char*)map_base;
+  if (huge) {
+    // Trim the mapping to 2MB boundaries
+    auto aligned = ((uintptr_t)base + HUGE_PAGE_BYTES - 1) &
+        ~(uintptr_t)(HUGE_PAGE_BYTES - 1);
+    size_t head = aligned - (uintptr_t)base;
+    if (head > 0) {
+      munmap(base, head);
+    }
+    size_t tail = map_bytes - head - bytes;
+    if (tail > 0) {
+      munmap((char*)aligned + bytes, tail);
+    }
+    base = (char*)aligned;
+    map_bytes = bytes;
+    madvise(base, bytes, MADV_HUGEPAGE);
+  }
+  auto header = (BlockHeader*)base;
+  header->magic = BLOCK_MAGIC;
+  header->size_class = size_class;
+  header->node = current_node();
+  header->map_base = base;
+  header->map_bytes = map_bytes;
+  return base + HEADER_BYTES;
+}
+
+void unmap_block(BlockHeader* header) {
+  munmap(header->map_base, header->map_bytes);
+}
+
+BlockHeader* header_of(void* ptr) {
+  auto header = (BlockHeader*)((char*)ptr - HEADER_BYTES);
+  TORCH_CHECK(
+      header->magic == BLOCK_MAGIC,
+      "scratch_free: the pointer was not allocated by scratch_alloc");
+  return header;
+}
+
+struct NodeCache {
+  std::mutex mutex;
+  std::vector<void*> blocks[NUM_CLASSES];
+  int64_t bytes{0};
+};
+
+NodeCache& node_cache(int node) {
+  // never destroyed, the blocks may be freed until the process exits
+  static NodeCache* caches = new NodeCache[MAX_NODES];
+  return caches[node];
+}
+
+// Returns false if the node cache is full
+bool push_node_cache(BlockHeader* header) {
+  auto& cache = node_cache(header->node);
+  auto bytes = (int64_t)class_bytes(header->size_class);
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  if (cache.bytes + bytes > node_cache_capacity()) {
+    return false;
+  }
+  cache.blocks[header->size_class].push_back((char*)header + HEADER_BYTES);
+  cache.bytes += bytes;
+  return true;
+}
+
+void* pop_node_cache(int node, int size_class) {
+  auto& cache = node_cache(node);
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  auto& blocks = cache.blocks[size_class];
+  if (blocks.empty()) {
+    return nullptr;
+  }
+  auto ptr = blocks.back();
+  blocks.pop_back();
+  cache.bytes -= class_bytes(size_class);
+  return ptr;
+}
+
+void release_block(BlockHeader* header) {
+  if (!push_node_cache(header)) {
+    stat_cached_bytes -= class_bytes(header->size_class);
+    stat_releases++;
+    unmap_block(header);
+  }
+}
+
+struct ThreadCache {
+  int node{current_node()};
+  std::vector<void*> blocks[NUM_CLASSES];
+  int64_t bytes{0};
+
+  void flush() {
+    for (auto& class_blocks : blocks) {
+      for (auto ptr : class_blocks) {
+        release_block(header_of(ptr));
+      }
+      class_blocks.clear();
+    }
+    bytes = 0;
+  }
+
+  ~ThreadCache() {
+    flush();
+  }
+};
+
+ThreadCache& thread_cache() {
+  static thread_local ThreadCache cache;
+  return cache;
+}
+#endif
+} // namespace
+
+void* scratch_alloc(size_t nbytes) {
+#ifdef _WIN32
+  stat_misses++;
+  return ipex_alloc_aligned(nbytes, 64);
+#else
+  nbytes += HEADER_BYTES;
+  int size_class = size_class_of(nbytes);
+  void* ptr = nullptr;
+  if (size_class >= 0 && cache_enabled()) {
+    auto& cache = thread_cache();
+    auto& blocks = cache.blocks[size_class];
+    if (!blocks.empty()) {
+      ptr = blocks.back();
+      blocks.pop_back();
+      cache.bytes -= class_bytes(size_class);
+    } else {
+      ptr = pop_node_cache(current_node(), size_class);
+    }
+  }
+  if (ptr != nullptr) {
+    stat_hits++;
+    stat_cached_bytes -= class_bytes(size_class);
+  } else {
+    stat_misses++;
+    ptr = map_block(size_class, nbytes);
+    TORCH_CHECK(
+        ptr != nullptr,
+        "scratch_alloc: fail to allocate ",
+        nbytes,
+        " bytes");
+  }
+  stat_allocated_bytes += header_of(ptr)->map_bytes;
+  return ptr;
+#endif
+}
+
+void scratch_free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+#ifdef _WIN32
+  ipex_free_aligned(ptr);
+#else
+  auto header = header_of(ptr);
+  stat_allocated_bytes -= header->map_bytes;
+  if (header->size_class < 0 || !cache_enabled()) {
+    stat_releases++;
+    unmap_block(header);
+    return;
+  }
+  auto bytes = (int64_t)class_bytes(header->size_class);
+  stat_cached_bytes += bytes;
+  auto& cache = thread_cache();
+  if (header->node == cache.node &&
+      cache.bytes + bytes <= thread_cache_capacity()) {
+    cache.blocks[header->size_class].push_back(ptr);
+    cache.bytes += bytes;
+    return;
+  }
+  release_block(header);
+#endif
+}
+
+at::Tensor empty_scratch(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options) {
+  TORCH_CHECK(
+      options.device().is_cpu(), "empty_scratch only supports CPU tensors");
+  int64_t numel = 1;
+  for (auto size : sizes) {
+    numel *= size;
+  }
+  auto nbytes = numel * options.dtype().itemsize();
+  void* ptr = scratch_alloc(nbytes > 0 ? nbytes : 1);
+  return at::from_blob(
+      ptr, sizes, [](void* data) { scratch_free(data); }, options);
+}
+
+ScratchAllocatorStats scratch_allocator_stats() {
+  ScratchAllocatorStats stats;
+  stats.hits = stat_hits.load();
+  stats.misses = stat_misses.load();
+  stats.releases = stat_releases.load();
+  stats.allocated_bytes = stat_allocated_bytes.load();
+  stats.cached_bytes = stat_cached_bytes.load();
+  return stats;
+}
+
+void scratch_allocator_reset_stats() {
+  stat_hits = 0;
+  stat_misses = 0;
+  stat_releases = 0;
+}
+
+void scratch_allocator_empty_cache() {
+#ifndef _WIN32
+  auto& cache = thread_cache();
+  for (auto& class_blocks : cache.blocks) {
+    for (auto ptr : class_blocks) {
+      auto header = header_of(ptr);
+      stat_cached_bytes -= class_bytes(header->size_class);
+      stat_releases++;
+      unmap_block(header);
+    }
+    class_blocks.clear();
+  }
+  cache.bytes = 0;
+  for (int node = 0; node < MAX_NODES; node++) {
+    auto& node_blocks = node_cache(node);
+    std::lock_guard<std::mutex> lock(node_blocks.mutex);
+    for (int size_class = 0; size_class < NUM_CLASSES; size_class++) {
+      for (auto ptr : node_blocks.blocks[size_class]) {
+        stat_cached_bytes -= class_bytes(size_class);
+        stat_releases++;
+        unmap_block(header_of(ptr));
+      }
+      node_blocks.blocks[size_class].clear();
+    }
+    node_blocks.bytes = 0;
+  }
+#endif
+}
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ATen/core/Tensor.h>
+#include <c10/core/TensorOptions.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace torch_ipex {
+namespace utils {
+
+struct ScratchAllocatorStats {
+  // allocations served from a cache
+  int64_t hits;
+  // allocations mapping new memory
+  int64_t misses;
+  // freed blocks unmapped as the caches were full
+  int64_t releases;
+  int64_t allocated_bytes;
+  int64_t cached_bytes;
+};
+
+// Caching allocator for the scratch buffers of the kernels, which are
+// allocated and freed with the same sizes on every call, e.g. every decode
+// step, and would otherwise go through mmap/munmap and page faults each time.
+// - The sizes are rounded up to size classes, 4 per power of 2 from 4KB.
+// - A freed block goes to a small cache of the freeing thread, or to the cache
+//   of the NUMA node it was allocated on, so that it is only reused on the
+//   node whose memory backs it.
+// - The blocks of 2MB or more are 2MB aligned and use transparent huge pages.
+// IPEX_SCRATCH_CACHE_BYTES limits the cache of each node (default 1GB),
+// IPEX_SCRATCH_CACHE=0 disables the caching.
+void* scratch_alloc(size_t nbytes);
+void scratch_free(void* ptr);
+// Uninitialized CPU tensor allocated with scratch_alloc
+at::Tensor empty_scratch(
+    at::IntArrayRef sizes,
+    const at::TensorOptions& options);
+
+ScratchAllocatorStats scratch_allocator_stats();
+void scratch_allocator_reset_stats();
+// Unmaps the blocks cached by the nodes and the calling thread, the caches of
+// the other threads are released when they exit
+void scratch_allocator_empty_cache();
+
+} // namespace utils
+} // namespace torch_ipex
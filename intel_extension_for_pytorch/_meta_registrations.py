@@ -611,6 +611,7 @@ def meta_masked_multihead_self_attention(
     head_mask,
     attention_mask,
     add_casual_mask=None,
+    tree_mask=None,
 ):
     attn_output = query.new_empty(
         (query.shape[0], query.shape[2], query.shape[1], query.shape[3])
@@ -12,3 +12,8 @@ if has_ccl():
     barrier = torch_ipex_cpp.barrier
     allreduce_add = torch.ops.torch_ipex.all_reduce_add
     allgather = torch.ops.torch_ipex.allgather
+    # Non-blocking all-reduce: with IPEX_COMM_THREAD_CORES set, the reduction
+    # runs on a dedicated communication thread and the tensor must not be
+    # accessed until allreduce_wait returns. Otherwise it runs synchronously.
+    allreduce_add_async = torch.ops.torch_ipex.all_reduce_add_async
+    allreduce_wait = torch.ops.torch_ipex.all_reduce_wait
@@ -1,4 +1,5 @@
 from .task import Task
+from .batch_task import DynamicBatchTask
 from .cpupool import pin, CPUPool, is_runtime_ext_enabled
 from .multi_stream import (
     MultiStreamModule,
@@ -6,4 +7,8 @@ from .multi_stream import (
     MultiStreamModuleHint,
     _MultiStreamBenchmarkModule,
 )
-from .runtime_utils import get_core_list_of_node_id
+from .runtime_utils import (
+    get_core_list_of_node_id,
+    get_numa_memory_stats,
+    replicate_module_to_numa_node,
+)
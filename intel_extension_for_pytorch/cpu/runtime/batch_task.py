@@ -0,0 +1,76 @@
+import torch
+import intel_extension_for_pytorch as ipex
+from .cpupool import CPUPool
+
+
+class DynamicBatchTask(object):
+    r"""
+    An abstraction of computation based on TorchScript module, which gathers
+    the inputs submitted one by one (e.g. by many client threads) into batches
+    and runs them asynchronously on several streams.
+
+    A free stream runs the pending inputs as one batch once they reach
+    ``max_batch_size`` rows or the oldest one has waited ``max_wait_us``
+    microseconds. The tensor inputs are concatenated along dim 0 and the other
+    inputs are taken from the first input of the batch. The tensors of the
+    output are split back along dim 0, the other outputs are returned as is.
+
+    Args:
+        module (torch.jit.ScriptModule): The input module.
+        cpu_pool (intel_extension_for_pytorch.cpu.runtime.CPUPool): An
+            intel_extension_for_pytorch.cpu.runtime.CPUPool object, contains
+            all CPU cores used to run the batches.
+        num_streams (int): Number of streams, the cores of ``cpu_pool`` are
+            split among them. The default value is 1.
+        max_batch_size (int): Max number of rows of a batch.
+        max_wait_us (int): Max time an input waits for its batch to fill.
+
+    Returns:
+        intel_extension_for_pytorch.cpu.runtime.DynamicBatchTask: Generated
+        intel_extension_for_pytorch.cpu.runtime.DynamicBatchTask object.
+    """
+
+    def __init__(
+        self,
+        module,
+        cpu_pool: CPUPool,
+        num_streams: int = 1,
+        max_batch_size: int = 32,
+        max_wait_us: int = 1000,
+    ):
+        assert type(cpu_pool) is CPUPool
+        # An nn.Module would need the GIL for each batch, which is what the
+        # batching in C++ avoids.
+        assert isinstance(
+            module, torch.jit.ScriptModule
+        ), "DynamicBatchTask only supports torch.jit.ScriptModule"
+        core_ids = cpu_pool.core_ids
+        assert (
+            0 < num_streams <= core_ids.__len__()
+        ), "num_streams must be in [1, number of cores of cpu_pool]"
+        self.cpu_pool = cpu_pool
+        cores_per_stream = core_ids.__len__() // num_streams
+        num_stream_allocated_extra_core = core_ids.__len__() % num_streams
+        stream_core_lists = []
+        start = 0
+        for j in range(num_streams):
+            end = start + cores_per_stream + (j < num_stream_allocated_extra_core)
+            stream_core_lists.append(core_ids[start:end])
+            start = end
+        self._task = ipex._C.BatchTaskModule(
+            module._c, stream_core_lists, max_batch_size, max_wait_us
+        )
+
+    def __call__(self, *args, **kwargs):
+        # async execution
+        return self._task.run_async(*args, **kwargs)
+
+    def run_sync(self, *args, **kwargs):
+        # sync execution
+        return self._task.run_sync(*args, **kwargs)
+
+    def num_batches(self):
+        return self._task.num_batches()
+
+    def num_requests(self):
+        return self._task.num_requests()
@@ -4,6 +4,10 @@ from .runtime_utils import get_core_list_of_node_id
 from ...utils._logger import logger, WarningType
 
 
+# Values of torch_ipex::runtime::MemoryPolicy
+_memory_policies = {"none": 0, "preferred": 1, "bind": 2}
+
+
 class CPUPool(object):
     r"""
     An abstraction of a pool of CPU cores used for intra-op parallelism.
@@ -12,13 +16,20 @@ class CPUPool(object):
         core_ids (list): A list of CPU cores' ids used for intra-op parallelism.
         node_id (int): A numa node id with all CPU cores on the numa node.
             ``node_id`` doesn't work if ``core_ids`` is set.
+        memory_policy (str): Where the memory allocated by the threads pinned
+            to the pool goes. ``"none"`` (default) keeps the first touch policy,
+            ``"preferred"`` prefers the numa nodes of the cores and falls back
+            to other nodes when they are full, ``"bind"`` only allocates on the
+            numa nodes of the cores.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.CPUPool: Generated
         intel_extension_for_pytorch.cpu.runtime.CPUPool object.
     """
 
-    def __init__(self, core_ids: list = None, node_id: int = None):
+    def __init__(
+        self, core_ids: list = None, node_id: int = None, memory_policy: str = "none"
+    ):
         if not ipex._C._has_cpu():
             return
         if core_ids is not None:
@@ -48,6 +59,20 @@ class CPUPool(object):
         # The actual core ids inside CPUPool may be updated in creation of ipex._C.CPUPool.
         # Since ipex._C.CPUPool will filter out core ids which not available for current process.
         self.core_ids = self.cpu_pool.get_core_list()
+        assert (
+            memory_policy in _memory_policies
+        ), "Input of memory_policy must be one of {}".format(
+            list(_memory_policies.keys())
+        )
+        self.memory_policy = memory_policy
+        self.cpu_pool.set_memory_policy(_memory_policies[memory_policy])
+
+    @property
+    def numa_nodes(self):
+        r"""
+        The numa nodes of the cores inside the pool.
+        """
+        return self.cpu_pool.get_numa_nodes()
 
 
 class pin(object):
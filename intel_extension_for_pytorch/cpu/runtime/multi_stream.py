@@ -4,6 +4,7 @@ from typing import Union
 import intel_extension_for_pytorch._C as core
 from .cpupool import CPUPool
 from .task import Task
+from .runtime_utils import replicate_module_to_numa_node
 import copy
 from ...utils._logger import logger, WarningType
 
@@ -38,6 +39,30 @@ default_multi_stream_module_split_hint = MultiStreamModuleHint(0)
 default_multi_stream_module_concat_hint = MultiStreamModuleHint(0)
 
 
+class _MultiStreamTaskResult(object):
+    # Same get() interface as the future returned by Task
+    def __init__(self, multi_stream_task, handle):
+        self.multi_stream_task = multi_stream_task
+        self.handle = handle
+
+    def get(self):
+        return self.multi_stream_task.get(self.handle)
+
+
+def _replicate_model_per_numa_node(model, stream_core_lists):
+    # One copy of the model for each numa node, used by the streams whose first core is on it.
+    stream_nodes = [
+        core.get_core_numa_node(core_list[0]) for core_list in stream_core_lists
+    ]
+    if len(set(stream_nodes)) <= 1 or min(stream_nodes) < 0:
+        return [model] * stream_core_lists.__len__()
+    replicas = {}
+    for node_id in stream_nodes:
+        if node_id not in replicas:
+            replicas[node_id] = replicate_module_to_numa_node(model, node_id)
+    return [replicas[node_id] for node_id in stream_nodes]
+
+
 def get_default_num_streams(cpu_pool):
     # One core per stream usually brings better overall throughput than other configurations.
     # Therefore, we heuristically make one core per stream the default here.
@@ -81,6 +106,10 @@ class MultiStreamModule(nn.Module):
             how to split the inputs.
         output_concat_hint (MultiStreamModuleHint): Hint to MultiStreamModule about
             how to concat the outputs.
+        replicate_weights (bool): A flag indicates whether each numa node used by
+            the streams gets its own copy of the model weights. The default value is
+            False. The memory of the streams follows the ``memory_policy`` of
+            ``cpu_pool``.
 
     Returns:
         intel_extension_for_pytorch.cpu.runtime.MultiStreamModule: Generated
@@ -97,6 +126,7 @@ class MultiStreamModule(nn.Module):
         concat_output: bool = True,
         input_split_hint: MultiStreamModuleHint = default_multi_stream_module_split_hint,
         output_concat_hint: MultiStreamModuleHint = default_multi_stream_module_concat_hint,
+        replicate_weights: bool = False,
     ):
         super(MultiStreamModule, self).__init__()
         assert (
@@ -141,7 +171,7 @@ class MultiStreamModule(nn.Module):
             num_stream_allocated_extra_core = (
                 self.core_list.__len__() % self.num_streams
             )
-            self.tasks = []
+            stream_core_lists = []
             start_core_list_idx = 0
             end_core_list_idx = 0
             for j in range(self.num_streams):
@@ -151,13 +181,35 @@ class MultiStreamModule(nn.Module):
                     end_core_list_idx += self.cores_per_instance + 1
                 else:
                     end_core_list_idx += self.cores_per_instance
-                self.tasks.append(
-                    Task(
-                        model,
-                        CPUPool(self.core_list[start_core_list_idx:end_core_list_idx]),
-                    )
+                stream_core_lists.append(
+                    self.core_list[start_core_list_idx:end_core_list_idx]
                 )
                 start_core_list_idx = end_core_list_idx
+            stream_models = (
+                _replicate_model_per_numa_node(model, stream_core_lists)
+                if replicate_weights
+                else [model] * self.num_streams
+            )
+            if isinstance(model, torch.jit.ScriptModule):
+                # Script modules run on a work stealing executor: all the streams' inputs
+                # are submitted at once and an idle stream can take the work of a busy one.
+                self.tasks = None
+                self.multi_stream_task = core.MultiStreamTaskModule(
+                    [stream_model._c for stream_model in stream_models],
+                    stream_core_lists,
+                    1024,
+                    cpu_pool.cpu_pool.get_memory_policy(),
+                )
+            else:
+                self.tasks = [
+                    Task(
+                        stream_model,
+                        CPUPool(stream_core_list, memory_policy=cpu_pool.memory_policy),
+                    )
+                    for stream_model, stream_core_list in zip(
+                        stream_models, stream_core_lists
+                    )
+                ]
         self.concat_output = concat_output
         self.input_split_hint = input_split_hint
         self.output_concat_hint = output_concat_hint
@@ -498,13 +550,28 @@ class MultiStreamModule(nn.Module):
 
         results_raw_future = []
         results_raw = []
-        for stream_id in range(self.used_num_streams):
-            results_raw_future.append(
-                self.tasks[stream_id](
-                    *(self.args_streams_input[stream_id]),
-                    **(self.kwargs_streams_input[stream_id]),
-                )
+        if self.tasks is None:
+            handles = self.multi_stream_task.submit_batch(
+                [
+                    (
+                        tuple(self.args_streams_input[stream_id]),
+                        self.kwargs_streams_input[stream_id],
+                    )
+                    for stream_id in range(self.used_num_streams)
+                ]
             )
+            results_raw_future = [
+                _MultiStreamTaskResult(self.multi_stream_task, handle)
+                for handle in handles
+            ]
+        else:
+            for stream_id in range(self.used_num_streams):
+                results_raw_future.append(
+                    self.tasks[stream_id](
+                        *(self.args_streams_input[stream_id]),
+                        **(self.kwargs_streams_input[stream_id]),
+                    )
+                )
 
         for stream_id in range(self.used_num_streams):
             # If we need to concat the output, for each position, we will push the result generated \
@@ -1,4 +1,7 @@
+import copy
 import subprocess
+import intel_extension_for_pytorch as ipex
+from ...utils._logger import logger, WarningType
 
 
 def get_num_nodes():
@@ -36,3 +39,52 @@ def get_core_list_of_node_id(node_id):
     )
     num_cores_per_node = get_num_cores_per_node()
     return list(range(num_cores_per_node * node_id, num_cores_per_node * (node_id + 1)))
+
+
+def get_numa_memory_stats(tensor=None):
+    r"""
+    Helper function to check the numa locality of the memory.
+
+    Args:
+        tensor (torch.Tensor): If set, only count the memory of the tensor.
+            Otherwise, count all the memory of the current process.
+
+    Returns:
+        dict: Bytes of resident memory on each numa node.
+    """
+
+    if tensor is None:
+        per_node = ipex._C.get_process_numa_memory()
+    else:
+        per_node = ipex._C.get_tensor_numa_memory(tensor)
+    return {node: nbytes for node, nbytes in enumerate(per_node)}
+
+
+def replicate_module_to_numa_node(module, node_id):
+    r"""
+    Helper function to copy a module with the memory of its parameters and
+    buffers on the input numa node, so that the streams on this node do not
+    read the weights from a remote node. The weights prepacked by
+    ``ipex.optimize`` are parameters and are replicated as well, while the
+    weights folded into the graph of a frozen TorchScript module are not.
+
+    Args:
+        module (torch.jit.ScriptModule or torch.nn.Module): The input module.
+        node_id (int): Input numa node id.
+
+    Returns:
+        torch.jit.ScriptModule or torch.nn.Module: The copy of the module.
+    """
+
+    replica = copy.deepcopy(module)
+    tensors = list(replica.parameters()) + list(replica.buffers())
+    if not tensors:
+        logger.warning(
+            "The module has no parameters or buffers to replicate on numa node {}.".format(
+                node_id
+            ),
+            _type=WarningType.NotSupported,
+        )
+    for tensor in tensors:
+        ipex._C.move_tensor_to_numa_node(tensor.detach(), node_id)
+    return replica
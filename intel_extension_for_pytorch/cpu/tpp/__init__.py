@@ -2,4 +2,5 @@ import pkg_resources
 from . import fused_bert
 from . import utils
 from . import optim
+from . import kernel_cache
 from .utils.blocked_layout import block_model_params as block
@@ -0,0 +1,52 @@
+import torch
+import intel_extension_for_pytorch._C as ipex_cpp
+
+
+def kernel_cache_stats():
+    r"""
+    Returns the statistics of the cache of the TPP JIT kernels as a dict:
+    ``hits``, ``misses``, ``uncached`` (kernels built while the cache was
+    full), ``size`` (number of cached kernels), ``capacity`` (0 means
+    unlimited) and ``build_time_ms`` (time spent building kernels).
+    """
+    return ipex_cpp.tpp_kernel_cache_stats()
+
+
+def reset_kernel_cache_stats():
+    r"""Resets the hit, miss, uncached and build time counters."""
+    ipex_cpp.tpp_kernel_cache_reset_stats()
+
+
+def set_kernel_cache_capacity(capacity):
+    r"""
+    Limits the number of cached TPP kernels, 0 means unlimited. The default
+    comes from ``IPEX_TPP_KERNEL_CACHE_CAPACITY``. Cached kernels are never
+    evicted, the kernels built once the cache is full are not cached.
+    """
+    ipex_cpp.tpp_kernel_cache_set_capacity(capacity)
+
+
+def prewarm(model, token_counts):
+    r"""
+    Builds the TPP kernels of the linear layers of a model optimized by
+    ``ipex.optimize`` for the given numbers of tokens, so that the first
+    requests with these shapes do not pay for the JIT compilation.
+
+    Args:
+        model (torch.nn.Module): the optimized model.
+        token_counts (list of int): the numbers of tokens (batch size times
+            sequence length) to build the kernels for.
+    """
+    from ...nn.utils._weight_prepack import _IPEXLinear
+
+    with torch.no_grad():
+        for module in model.modules():
+            if not isinstance(module, _IPEXLinear):
+                continue
+            if not getattr(module, "use_tpp", False) or module.tpp_fallback:
+                continue
+            for tokens in token_counts:
+                x = torch.zeros(
+                    1, tokens, module.in_features, dtype=module.weight.dtype
+                )
+                module(x)
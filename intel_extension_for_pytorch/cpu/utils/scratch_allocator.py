@@ -0,0 +1,27 @@
+import intel_extension_for_pytorch._C as ipex_cpp
+
+
+def scratch_allocator_stats():
+    r"""
+    Returns the statistics of the allocator of the scratch buffers used by
+    the attention and weight-only quantization kernels as a dict: ``hits``
+    (allocations served from a cache), ``misses`` (allocations mapping new
+    memory), ``releases`` (freed blocks unmapped as the caches were full),
+    ``allocated_bytes`` and ``cached_bytes``.
+    """
+    return ipex_cpp.scratch_allocator_stats()
+
+
+def reset_scratch_allocator_stats():
+    r"""Resets the hit, miss and release counters."""
+    ipex_cpp.scratch_allocator_reset_stats()
+
+
+def empty_scratch_cache():
+    r"""
+    Releases the cached scratch buffers of the NUMA nodes and of the calling
+    thread. The size of the cache of each node is limited by
+    ``IPEX_SCRATCH_CACHE_BYTES`` (1GB by default), ``IPEX_SCRATCH_CACHE=0``
+    disables the caching.
+    """
+    ipex_cpp.scratch_allocator_empty_cache()
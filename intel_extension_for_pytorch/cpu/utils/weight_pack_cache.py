@@ -0,0 +1,30 @@
+import intel_extension_for_pytorch._C as ipex_cpp
+
+
+def weight_pack_cache_stats():
+    r"""
+    Returns the statistics of the cache of the packed LSTM weights as a dict:
+    ``entries``, ``bytes`` (size of the packed weights), ``capacity`` (0
+    means unlimited), ``hits``, ``misses`` and ``evictions``.
+    """
+    return ipex_cpp.weight_pack_cache_stats()
+
+
+def reset_weight_pack_cache_stats():
+    r"""Resets the hit, miss and eviction counters."""
+    ipex_cpp.weight_pack_cache_reset_stats()
+
+
+def set_weight_pack_cache_capacity(capacity):
+    r"""
+    Limits the size in bytes of the cached packed weights, 0 means unlimited.
+    The default comes from ``IPEX_WEIGHT_PACK_CACHE_BYTES``. Once the limit is
+    exceeded the least recently used packed weights are evicted, they are
+    packed again on their next use.
+    """
+    ipex_cpp.weight_pack_cache_set_capacity(capacity)
+
+
+def clear_weight_pack_cache():
+    r"""Drops all the cached packed weights, e.g. after swapping a model."""
+    ipex_cpp.weight_pack_cache_clear()
@@ -26,6 +26,7 @@
 #include "utils/fpmath_mode.h"
 #include "utils/isa_utils.h"
 #include "utils/module_version.h"
+#include "utils/ScratchAllocator.h"
 #include "utils/onednn_utils.h"
 
 #include <c10/core/DeviceType.h>
@@ -36,11 +37,14 @@
 
 #include "TaskModule.h"
 #include "aten/EmbeddingBag.h"
+#include "aten/MmapEmbeddingCache.h"
 #include "aten/TPPShmAllReduceAdd.h"
+#include "aten/WeightPack.h"
 #include "comm/comm.h"
 #include "runtime/CPUPool.h"
 #include "runtime/TaskExecutor.h"
 #include "toolkit/sklearn.h"
+#include "tpp/kernel_cache.h"
 #include "tpp/optim.h"
 #include "tpp/utils.h"
 
@@ -198,8 +202,24 @@ void InitIpexModuleBindings(py::module m) {
         return std::make_shared<torch_ipex::runtime::CPUPool>(
             py::cast<std::vector<int32_t>>(core_list));
       }))
-      .def("get_core_list", [](torch_ipex::runtime::CPUPool& self) {
-        return self.get_cpu_core_list();
+      .def(
+          "get_core_list",
+          [](torch_ipex::runtime::CPUPool& self) {
+            return self.get_cpu_core_list();
+          })
+      .def(
+          "set_memory_policy",
+          [](torch_ipex::runtime::CPUPool& self, int64_t memory_policy) {
+            self.set_memory_policy(
+                (torch_ipex::runtime::MemoryPolicy)memory_policy);
+          })
+      .def(
+          "get_memory_policy",
+          [](torch_ipex::runtime::CPUPool& self) {
+            return (int64_t)self.get_memory_policy();
+          })
+      .def("get_numa_nodes", [](torch_ipex::runtime::CPUPool& self) {
+        return self.get_numa_nodes();
       });
 
   py::class_<
@@ -235,6 +255,75 @@ void InitIpexModuleBindings(py::module m) {
             return self.run_async(std::move(args), std::move(kwargs));
           });
 
+  py::class_<
+      torch_ipex::runtime::MultiStreamTaskModule,
+      std::shared_ptr<torch_ipex::runtime::MultiStreamTaskModule>>(
+      m, "MultiStreamTaskModule")
+      .def(py::init([](const torch::jit::Module& module,
+                       const std::vector<std::vector<int32_t>>& stream_cores,
+                       int64_t max_pending) {
+        return std::make_shared<torch_ipex::runtime::MultiStreamTaskModule>(
+            std::vector<torch::jit::Module>(stream_cores.size(), module),
+            stream_cores,
+            max_pending,
+            torch_ipex::runtime::MEMORY_POLICY_NONE);
+      }))
+      .def(py::init(
+          [](const std::vector<torch::jit::Module>& stream_modules,
+             const std::vector<std::vector<int32_t>>& stream_cores,
+             int64_t max_pending,
+             int64_t memory_policy) {
+            return std::make_shared<
+                torch_ipex::runtime::MultiStreamTaskModule>(
+                stream_modules,
+                stream_cores,
+                max_pending,
+                (torch_ipex::runtime::MemoryPolicy)memory_policy);
+          }))
+      .def(
+          "submit",
+          [](torch_ipex::runtime::MultiStreamTaskModule& self,
+             py::args& args,
+             py::kwargs& kwargs) {
+            return self.submit(std::move(args), std::move(kwargs));
+          })
+      .def(
+          "submit_batch",
+          &torch_ipex::runtime::MultiStreamTaskModule::submit_batch)
+      .def("get", &torch_ipex::runtime::MultiStreamTaskModule::get)
+      .def(
+          "stolen_counts",
+          &torch_ipex::runtime::MultiStreamTaskModule::stolen_counts);
+
+  py::class_<
+      torch_ipex::runtime::BatchTaskModule,
+      std::shared_ptr<torch_ipex::runtime::BatchTaskModule>>(
+      m, "BatchTaskModule")
+      .def(py::init([](const torch::jit::Module& module,
+                       const std::vector<std::vector<int32_t>>& stream_cores,
+                       int64_t max_batch_size,
+                       int64_t max_wait_us) {
+        return std::make_shared<torch_ipex::runtime::BatchTaskModule>(
+            module, stream_cores, max_batch_size, max_wait_us);
+      }))
+      .def(
+          "run_sync",
+          [](torch_ipex::runtime::BatchTaskModule& self,
+             py::args& args,
+             py::kwargs& kwargs) {
+            return self.run_sync(std::move(args), std::move(kwargs));
+          })
+      .def(
+          "run_async",
+          [](torch_ipex::runtime::BatchTaskModule& self,
+             py::args& args,
+             py::kwargs& kwargs) {
+            return self.run_async(std::move(args), std::move(kwargs));
+          })
+      .def("num_batches", &torch_ipex::runtime::BatchTaskModule::num_batches)
+      .def(
+          "num_requests", &torch_ipex::runtime::BatchTaskModule::num_requests);
+
   m.def(
       "get_process_available_cores",
       &torch_ipex::runtime::get_process_available_cores);
@@ -256,6 +345,16 @@ void InitIpexModuleBindings(py::module m) {
     return std::make_shared<torch_ipex::runtime::CPUPool>(
         torch_ipex::runtime::get_cpu_pool_from_mask_affinity());
   });
+  m.def("get_core_numa_node", &torch_ipex::runtime::get_core_numa_node);
+  m.def("get_numa_node_count", &torch_ipex::runtime::get_numa_node_count);
+  m.def(
+      "get_process_numa_memory",
+      &torch_ipex::runtime::get_process_numa_memory);
+  m.def(
+      "get_tensor_numa_memory", &torch_ipex::runtime::get_tensor_numa_memory);
+  m.def(
+      "move_tensor_to_numa_node",
+      &torch_ipex::runtime::move_tensor_to_numa_node);
   m.def(
       "set_cpu_pool",
       [](std::shared_ptr<torch_ipex::runtime::CPUPool> cpu_pool) {
@@ -265,10 +364,123 @@ void InitIpexModuleBindings(py::module m) {
 
   m.def("roc_auc_score", &toolkit::roc_auc_score);
   m.def("roc_auc_score_all", &toolkit::roc_auc_score_all);
+  py::class_<
+      toolkit::RocAucAccumulator,
+      std::shared_ptr<toolkit::RocAucAccumulator>>(m, "RocAucAccumulator")
+      .def(py::init<int64_t>(), py::arg("num_bins") = 0)
+      .def(
+          "update",
+          &toolkit::RocAucAccumulator::update,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "compute",
+          &toolkit::RocAucAccumulator::compute,
+          py::call_guard<py::gil_scoped_release>())
+      .def("reset", &toolkit::RocAucAccumulator::reset)
+      .def("num_samples", &toolkit::RocAucAccumulator::num_samples);
 
   // libxsmm
   m.def("xsmm_manual_seed", &torch_ipex::tpp::xsmm_manual_seed);
   m.def("init_libxsmm", &torch_ipex::tpp::init_libxsmm);
+  m.def("tpp_kernel_cache_stats", []() {
+    auto stats = torch_ipex::tpp::tpp_kernel_cache_stats();
+    py::dict ret;
+    ret["hits"] = stats.hits;
+    ret["misses"] = stats.misses;
+    ret["uncached"] = stats.uncached;
+    ret["size"] = stats.size;
+    ret["capacity"] = stats.capacity;
+    ret["build_time_ms"] = stats.build_time_ms;
+    return ret;
+  });
+  m.def(
+      "tpp_kernel_cache_reset_stats",
+      &torch_ipex::tpp::tpp_kernel_cache_reset_stats);
+  m.def(
+      "tpp_kernel_cache_set_capacity",
+      &torch_ipex::tpp::tpp_kernel_cache_set_capacity);
+
+  // cache of the packed LSTM weights
+  m.def("weight_pack_cache_stats", []() {
+    auto stats = torch_ipex::cpu::weight_pack_cache_stats();
+    py::dict ret;
+    ret["entries"] = stats.entries;
+    ret["bytes"] = stats.bytes;
+    ret["capacity"] = stats.capacity;
+    ret["hits"] = stats.hits;
+    ret["misses"] = stats.misses;
+    ret["evictions"] = stats.evictions;
+    return ret;
+  });
+  m.def(
+      "weight_pack_cache_reset_stats",
+      &torch_ipex::cpu::weight_pack_cache_reset_stats);
+  m.def(
+      "weight_pack_cache_set_capacity",
+      &torch_ipex::cpu::weight_pack_cache_set_capacity);
+  m.def("weight_pack_cache_clear", &torch_ipex::cpu::weight_pack_cache_clear);
+
+  // scratch allocator of the kernels
+  m.def("scratch_allocator_stats", []() {
+    auto stats = torch_ipex::utils::scratch_allocator_stats();
+    py::dict ret;
+    ret["hits"] = stats.hits;
+    ret["misses"] = stats.misses;
+    ret["releases"] = stats.releases;
+    ret["allocated_bytes"] = stats.allocated_bytes;
+    ret["cached_bytes"] = stats.cached_bytes;
+    return ret;
+  });
+  m.def(
+      "scratch_allocator_reset_stats",
+      &torch_ipex::utils::scratch_allocator_reset_stats);
+  m.def(
+      "scratch_allocator_empty_cache",
+      &torch_ipex::utils::scratch_allocator_empty_cache);
+
+  // out-of-core embedding tables
+  py::class_<
+      torch_ipex::cpu::MmapEmbeddingCache,
+      std::shared_ptr<torch_ipex::cpu::MmapEmbeddingCache>>(
+      m, "MmapEmbeddingCache")
+      .def(
+          py::init<const std::string&, int64_t, int64_t, int64_t, int64_t>(),
+          py::arg("path"),
+          py::arg("num_rows"),
+          py::arg("emb_dim"),
+          py::arg("num_states"),
+          py::arg("cache_rows"))
+      .def(
+          "lookup",
+          &torch_ipex::cpu::MmapEmbeddingCache::lookup,
+          py::call_guard<py::gil_scoped_release>())
+      .def("prefetch", &torch_ipex::cpu::MmapEmbeddingCache::prefetch)
+      .def("cached_rows", &torch_ipex::cpu::MmapEmbeddingCache::cached_rows)
+      .def("weight", &torch_ipex::cpu::MmapEmbeddingCache::weight)
+      .def("state", &torch_ipex::cpu::MmapEmbeddingCache::state)
+      // the view of the file is valid as long as the cache
+      .def(
+          "table",
+          &torch_ipex::cpu::MmapEmbeddingCache::table,
+          py::keep_alive<0, 1>())
+      .def(
+          "flush",
+          &torch_ipex::cpu::MmapEmbeddingCache::flush,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "clear",
+          &torch_ipex::cpu::MmapEmbeddingCache::clear,
+          py::call_guard<py::gil_scoped_release>())
+      .def("stats", [](const torch_ipex::cpu::MmapEmbeddingCache& self) {
+        auto stats = self.stats();
+        py::dict ret;
+        ret["hits"] = stats.hits;
+        ret["misses"] = stats.misses;
+        ret["prefetched"] = stats.prefetched;
+        ret["evictions"] = stats.evictions;
+        ret["write_backs"] = stats.write_backs;
+        return ret;
+      });
 
   // tpp-for-optimizer
   m.def("tpp_dense_sparse_add_", &torch_ipex::tpp::dense_sparse_add_);
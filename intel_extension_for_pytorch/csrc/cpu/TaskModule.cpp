@@ -138,5 +138,139 @@ py::object TaskModule::run_sync(py::args&& args, py::kwargs&& kwargs) {
   return future_tensor_result->get();
 }
 
+MultiStreamTaskModule::MultiStreamTaskModule(
+    const std::vector<torch::jit::Module>& stream_modules,
+    const std::vector<std::vector<int32_t>>& stream_cores,
+    int64_t max_pending,
+    MemoryPolicy memory_policy)
+    : stream_modules_(stream_modules) {
+  if (stream_modules_.size() != stream_cores.size()) {
+    throw std::runtime_error(
+        "MultiStreamTaskModule needs one module for each stream.");
+  }
+  std::vector<torch::jit::Function*> functions;
+  std::vector<c10::IValue> selves;
+  for (auto& module : stream_modules_) {
+    functions.push_back(&module.get_method("forward").function());
+    selves.push_back(module._ivalue());
+  }
+  this->executor_ = std::make_unique<MultiStreamExecutor>(
+      [functions, selves](std::vector<at::IValue>& stack, size_t stream) {
+        // The stack is created for the first module, a task may run on any
+        // stream
+        stack[0] = selves[stream];
+        // run() leaves the output on the stack and keeps its storage
+        functions[stream]->run(stack);
+        return torch::jit::pop(stack);
+      },
+      stream_cores,
+      max_pending,
+      memory_policy);
+}
+
+MultiStreamTaskModule::~MultiStreamTaskModule() {
+  pybind11::gil_scoped_release no_gil_guard;
+  this->executor_->stop();
+}
+
+std::vector<at::IValue> MultiStreamTaskModule::create_stack(
+    py::args&& args,
+    py::kwargs&& kwargs) {
+  auto& function = stream_modules_[0].get_method("forward").function();
+  return torch::jit::createStackForSchema(
+      function.getSchema(),
+      std::move(args),
+      // NOLINTNEXTLINE(performance-move-const-arg)
+      std::move(kwargs),
+      stream_modules_[0]._ivalue());
+}
+
+int64_t MultiStreamTaskModule::submit(py::args&& args, py::kwargs&& kwargs) {
+  auto stack = this->create_stack(std::move(args), std::move(kwargs));
+  pybind11::gil_scoped_release no_gil_guard;
+  return this->executor_->submit(std::move(stack));
+}
+
+std::vector<int64_t> MultiStreamTaskModule::submit_batch(
+    const py::list& inputs) {
+  std::vector<std::vector<at::IValue>> stacks;
+  stacks.reserve(inputs.size());
+  for (auto& input : inputs) {
+    auto pair = py::reinterpret_borrow<py::tuple>(input);
+    stacks.push_back(this->create_stack(
+        py::reinterpret_borrow<py::args>(pair[0]),
+        py::reinterpret_borrow<py::kwargs>(pair[1])));
+  }
+  pybind11::gil_scoped_release no_gil_guard;
+  return this->executor_->submit_batch(std::move(stacks));
+}
+
+py::object MultiStreamTaskModule::get(int64_t handle) {
+  c10::IValue res;
+  {
+    pybind11::gil_scoped_release no_gil_guard;
+    res = this->executor_->get(handle);
+  }
+  return torch::jit::toPyObject(std::move(res));
+}
+
+std::vector<int64_t> MultiStreamTaskModule::stolen_counts() const {
+  return this->executor_->stolen_counts();
+}
+
+BatchTaskModule::BatchTaskModule(
+    const torch::jit::Module& script_module,
+    const std::vector<std::vector<int32_t>>& stream_cores,
+    int64_t max_batch_size,
+    int64_t max_wait_us)
+    : script_module_(script_module) {
+  auto* function = &script_module_.get_method("forward").function();
+  this->scheduler_ = std::make_unique<BatchScheduler>(
+      [function](std::vector<at::IValue>& stack) -> c10::IValue {
+        return (*function)(std::move(stack));
+      },
+      stream_cores,
+      max_batch_size,
+      max_wait_us);
+}
+
+BatchTaskModule::~BatchTaskModule() {
+  pybind11::gil_scoped_release no_gil_guard;
+  this->scheduler_->stop();
+}
+
+std::unique_ptr<FutureTensor> BatchTaskModule::run_async(
+    py::args&& args,
+    py::kwargs&& kwargs) {
+  auto& function = script_module_.get_method("forward").function();
+  std::vector<at::IValue> stack = torch::jit::createStackForSchema(
+      function.getSchema(),
+      std::move(args),
+      // NOLINTNEXTLINE(performance-move-const-arg)
+      std::move(kwargs),
+      script_module_._ivalue());
+  std::unique_ptr<FutureTensor> future_tensor_result =
+      std::make_unique<FutureTensor>();
+  {
+    pybind11::gil_scoped_release no_gil_guard;
+    future_tensor_result->future_script_tensor =
+        this->scheduler_->submit(std::move(stack));
+  }
+  future_tensor_result->script_module_initialized_ = true;
+  return future_tensor_result;
+}
+
+py::object BatchTaskModule::run_sync(py::args&& args, py::kwargs&& kwargs) {
+  return this->run_async(std::move(args), std::move(kwargs))->get();
+}
+
+int64_t BatchTaskModule::num_batches() const {
+  return this->scheduler_->num_batches();
+}
+
+int64_t BatchTaskModule::num_requests() const {
+  return this->scheduler_->num_requests();
+}
+
 } // namespace runtime
 } // namespace torch_ipex
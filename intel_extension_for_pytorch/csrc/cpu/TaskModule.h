@@ -13,6 +13,8 @@
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
 #include <torch/csrc/utils/pybind.h>
+#include "BatchScheduler.h"
+#include "MultiStreamExecutor.h"
 #include "TaskExecutor.h"
 
 namespace torch_ipex {
@@ -61,5 +63,62 @@ class TaskModule {
   py::kwargs kwargs;
 };
 
+/*MultiStreamTaskModule runs a script module on several streams, the inputs
+ * are converted with the GIL held and the streams run without it. Each stream
+ * can have its own copy of the module, e.g. with the weights on its NUMA node*/
+class MultiStreamTaskModule {
+ public:
+  explicit MultiStreamTaskModule(
+      const std::vector<torch::jit::Module>& stream_modules,
+      const std::vector<std::vector<int32_t>>& stream_cores,
+      int64_t max_pending,
+      MemoryPolicy memory_policy);
+  MultiStreamTaskModule(const MultiStreamTaskModule& task_module) = delete;
+  MultiStreamTaskModule(MultiStreamTaskModule&& task_module) = delete;
+  MultiStreamTaskModule& operator=(const MultiStreamTaskModule& task_module) =
+      delete;
+  MultiStreamTaskModule& operator=(MultiStreamTaskModule&& task_module) =
+      delete;
+  ~MultiStreamTaskModule();
+  // Returns the handle to get the output with, runs on the next stream
+  int64_t submit(py::args&& args, py::kwargs&& kwargs);
+  // inputs is a list of (args, kwargs), the i-th one runs on the i-th stream
+  std::vector<int64_t> submit_batch(const py::list& inputs);
+  py::object get(int64_t handle);
+  std::vector<int64_t> stolen_counts() const;
+
+ private:
+  std::vector<at::IValue> create_stack(py::args&& args, py::kwargs&& kwargs);
+
+  std::vector<torch::jit::Module> stream_modules_;
+  std::unique_ptr<MultiStreamExecutor> executor_;
+};
+
+/*BatchTaskModule batches the inputs of a script module submitted one by one
+ * with BatchScheduler*/
+class BatchTaskModule {
+ public:
+  explicit BatchTaskModule(
+      const torch::jit::Module& module,
+      const std::vector<std::vector<int32_t>>& stream_cores,
+      int64_t max_batch_size,
+      int64_t max_wait_us);
+  BatchTaskModule(const BatchTaskModule& task_module) = delete;
+  BatchTaskModule(BatchTaskModule&& task_module) = delete;
+  BatchTaskModule& operator=(const BatchTaskModule& task_module) = delete;
+  BatchTaskModule& operator=(BatchTaskModule&& task_module) = delete;
+  ~BatchTaskModule();
+  py::object run_sync(py::args&& args, py::kwargs&& kwargs); /*sync execution*/
+  std::unique_ptr<FutureTensor> run_async(
+      py::args&& args,
+      py::kwargs&& kwargs); /*async execution in a batch*/
+  int64_t num_batches() const;
+  int64_t num_requests() const;
+
+ private:
+  torch::jit::Module script_module_;
+  std::unique_ptr<BatchScheduler> scheduler_;
+};
+
 } // namespace runtime
 } // namespace torch_ipex
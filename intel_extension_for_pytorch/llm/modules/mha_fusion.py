@@ -1,6 +1,6 @@
 import torch
 import torch.nn as nn
-from typing import Optional, Tuple
+from typing import List, Optional, Tuple
 from .utils import IPEXRuntimeCustomOps, IPEXCustomOpType
 
 
@@ -439,8 +439,14 @@ class PagedAttention:
     The block is basic allocation unit of paged attention and the token intra-block are stored one-by-one.
     The block tables are used to map the logical block of sequence into the physical block.
 
+    The key/value cache can also be allocated as int8, ``torch.float8_e5m2`` or ``torch.float8_e4m3fn``
+    to halve the cache memory and bandwidth. Then every head of every token is quantized symmetrically when it
+    is stored, and its scale is saved in ``k_scale``/``v_scale``, float tensors with the shape of
+    [num_blocks, num_heads, block_size] which should be passed to all the class methods below.
+
     [class method]: reshape_and_cache
-    ipex.llm.modules.PagedAttention.reshape_and_cache(key, value, key_cache, value_cache, slot_mapping)
+    ipex.llm.modules.PagedAttention.reshape_and_cache(key, value, key_cache, value_cache, slot_mapping,
+                                                      k_scale=None, v_scale=None)
     This operator is used to store the key/value token states into the pre-allcated kv_cache buffers of paged attention.
 
     Args:
@@ -453,6 +459,8 @@ class PagedAttention:
         slot_mapping (torch.Tensor):  It stores the position to store the key/value in the pre-allocated buffers.
             The shape should be the number of sequences. For sequence ``i``, the ``slot_mapping[i] // block_number``
             can get the block index, and the ``slot_mapping % block_size`` can get the offset of this block.
+        k_scale (torch.Tensor, optional): The scales of the int8/fp8 key cache.
+        v_scale (torch.Tensor, optional): The scales of the int8/fp8 value cache.
 
     [class method]: single_query_cached_kv_attention
 
@@ -470,7 +478,10 @@ class PagedAttention:
                                                             context_lens,
                                                             block_size,
                                                             max_context_len,
-                                                            alibi_slopes
+                                                            alibi_slopes,
+                                                            k_scale=None,
+                                                            v_scale=None,
+                                                            window_size=-1
                                                             )
 
     This operator is used to be calculated the scale-dot-product based on the paged attention.
@@ -494,6 +505,85 @@ class PagedAttention:
         block_size (int): The block size which means the number of token in every block.
         max_context_len (int): The max sequence length.
         alibi_slopes (torch.Tensor, optinal): which is the alibi slope with the shape of (num_heads).
+        k_scale (torch.Tensor, optional): The scales of the int8/fp8 key cache.
+        v_scale (torch.Tensor, optional): The scales of the int8/fp8 value cache.
+        window_size (int, optional): The sliding window size, the query only attends the last
+            ``window_size`` tokens of its context if it is positive. The blocks before the window
+            are never read, so they can be recycled by the cache manager. Default is -1 (disabled).
+
+    [class method]: multi_query_cached_kv_attention
+
+    .. highlight:: python
+    .. code-block:: python
+
+        ipex.llm.modules.PagedAttention.multi_query_cached_kv_attention(
+                                                            out,
+                                                            query,
+                                                            key_cache,
+                                                            value_cache,
+                                                            scale,
+                                                            block_tables,
+                                                            context_lens,
+                                                            query_start_loc,
+                                                            block_size,
+                                                            max_query_len,
+                                                            alibi_slopes,
+                                                            k_scale=None,
+                                                            v_scale=None,
+                                                            window_size=-1
+                                                            )
+
+    This operator is used to calculate the causal scale-dot-product for several query tokens per sequence
+    directly against the paged key/value cache, so prefill chunks and decode tokens can be mixed in one batch.
+    The key/value of the query tokens should be stored by reshape_and_cache before calling it.
+
+    Args:
+        out (torch.Tensor): The output tensor with shape of [num_tokens, num_heads, head_size],
+            where the num_tokens is the total number of query tokens in this batch.
+        query (torch.Tensor): The query tensor. The shape should be [num_tokens, num_heads, head_size].
+        key_cache (torch.Tensor): The pre-allocated buffer to store the key cache.
+            The shape should be [num_blocks, num_kv_heads, block_size, head_size].
+        value_cache(torch.Tensor): The pre-allocated buffer to store the value cache.
+            The shape should be [num_blocks, num_kv_heads, block_size, head_size].
+        scale (float): The scale used by the scale-dot-product.
+            In general, it is: ``float(1.0 / (head_size ** 0.5))``.
+        block_tables:(torch.Tensor): The mapping table used to mapping the logical sequence
+            to the physical sequence. The shape should be [num_seqs, max_num_blocks_per_seq].
+        context_lens (torch.Tensor): The sequence length for every sequence including the query tokens
+            of this step. The size is [num_seqs].
+        query_start_loc (torch.Tensor): The cumulative query lengths with the size of [num_seqs + 1].
+            The query tokens of sequence ``i`` are ``query[query_start_loc[i]:query_start_loc[i + 1]]``
+            and they are the last tokens of its context.
+        block_size (int): The block size which means the number of token in every block.
+        max_query_len (int): The max number of query tokens of one sequence.
+        alibi_slopes (torch.Tensor, optinal): which is the alibi slope with the shape of (num_heads).
+        k_scale (torch.Tensor, optional): The scales of the int8/fp8 key cache.
+        v_scale (torch.Tensor, optional): The scales of the int8/fp8 value cache.
+        window_size (int, optional): The sliding window size, the query token at position ``p``
+            only attends the keys in ``(p - window_size, p]`` if it is positive. Default is -1 (disabled).
+
+    [class method]: copy_blocks
+    ipex.llm.modules.PagedAttention.copy_blocks(key_caches, value_caches, block_mapping)
+    This operator is used to copy blocks inside the kv cache of every layer, e.g. for the copy-on-write of
+    the shared prefix and the fork of beams.
+
+    Args:
+        key_caches (List[torch.Tensor]): The key caches of all layers.
+        value_caches (List[torch.Tensor]): The value caches of all layers. The scales of the int8/fp8 kv cache
+            can be passed in these two lists as well since their first dimension is also the block index.
+        block_mapping (torch.Tensor): The pairs of the source and destination block index with the shape
+            of [num_pairs, 2].
+
+    [class method]: swap_blocks
+    ipex.llm.modules.PagedAttention.swap_blocks(src, dst, block_mapping)
+    This operator is used to move blocks between two caches with the same block layout, e.g. between
+    the active kv cache and an overflow pool.
+
+    Args:
+        src (torch.Tensor): The source cache.
+        dst (torch.Tensor): The destination cache.
+        block_mapping (torch.Tensor): The pairs of the source block index in ``src`` and the destination
+            block index in ``dst`` with the shape of [num_pairs, 2].
 
     """
 
@@ -507,10 +597,14 @@ class PagedAttention:
         key_cache: torch.Tensor,
         value_cache: torch.Tensor,
         slot_mapping: torch.Tensor,
+        k_scale: Optional[torch.Tensor] = None,
+        v_scale: Optional[torch.Tensor] = None,
     ):
         return cls.runtime_ops.get_module_from_device(
             key.device.type, IPEXCustomOpType.PAGED_ATTENTION, False
-        ).reshape_and_cache(key, value, key_cache, value_cache, slot_mapping)
+        ).reshape_and_cache(
+            key, value, key_cache, value_cache, slot_mapping, k_scale, v_scale
+        )
 
     @classmethod
     def single_query_cached_kv_attention(
@@ -526,6 +620,9 @@ class PagedAttention:
         block_size: int,
         max_context_len: int,
         alibi_slopes: torch.Tensor,
+        k_scale: Optional[torch.Tensor] = None,
+        v_scale: Optional[torch.Tensor] = None,
+        window_size: int = -1,
     ):
         return cls.runtime_ops.get_module_from_device(
             output.device.type, IPEXCustomOpType.PAGED_ATTENTION, False
@@ -541,8 +638,70 @@ class PagedAttention:
             block_size,
             max_context_len,
             alibi_slopes,
+            k_scale,
+            v_scale,
+            window_size,
+        )
+
+    @classmethod
+    def multi_query_cached_kv_attention(
+        cls,
+        output: torch.Tensor,
+        query: torch.Tensor,
+        key_cache: torch.Tensor,
+        value_cache: torch.Tensor,
+        scale: float,
+        block_tables: torch.Tensor,
+        context_lens: torch.Tensor,
+        query_start_loc: torch.Tensor,
+        block_size: int,
+        max_query_len: int,
+        alibi_slopes: torch.Tensor,
+        k_scale: Optional[torch.Tensor] = None,
+        v_scale: Optional[torch.Tensor] = None,
+        window_size: int = -1,
+    ):
+        return cls.runtime_ops.get_module_from_device(
+            output.device.type, IPEXCustomOpType.PAGED_ATTENTION, False
+        ).multi_query_cached_kv_attention(
+            output,
+            query,
+            key_cache,
+            value_cache,
+            scale,
+            block_tables,
+            context_lens,
+            query_start_loc,
+            block_size,
+            max_query_len,
+            alibi_slopes,
+            k_scale,
+            v_scale,
+            window_size,
         )
 
+    @classmethod
+    def copy_blocks(
+        cls,
+        key_caches: List[torch.Tensor],
+        value_caches: List[torch.Tensor],
+        block_mapping: torch.Tensor,
+    ):
+        return cls.runtime_ops.get_module_from_device(
+            block_mapping.device.type, IPEXCustomOpType.PAGED_ATTENTION, False
+        ).copy_blocks(key_caches, value_caches, block_mapping)
+
+    @classmethod
+    def swap_blocks(
+        cls,
+        src: torch.Tensor,
+        dst: torch.Tensor,
+        block_mapping: torch.Tensor,
+    ):
+        return cls.runtime_ops.get_module_from_device(
+            src.device.type, IPEXCustomOpType.PAGED_ATTENTION, False
+        ).swap_blocks(src, dst, block_mapping)
+
 
 class IndirectAccessKVCacheAttention(nn.Module):
     r"""
@@ -586,6 +745,16 @@ class IndirectAccessKVCacheAttention(nn.Module):
 
         head_mask (torch.Tensor): Head mask tensor which is not supported by kernel yet.
         attention_mask(torch.Tensor): Attention mask information.
+        seq_info (torch.Tensor): The first element is the offset, i.e. the number of past tokens
+            in the cache. Defaults to the length recorded in layer_past.
+        tree_mask (torch.Tensor): Ancestry of the draft tokens when verifying seq_len > 1 draft
+            tokens of speculative decoding, shape: (seq_len, seq_len) or (batch, seq_len, seq_len).
+            Draft token i attends to draft token j only if tree_mask[i][j] is nonzero, the draft
+            tokens are causal if it is None. Not supported with beam search. The key/value of the
+            draft tokens are written to the cache at [offset, offset + seq_len), the rejected
+            ones are rolled back by passing the accepted length as seq_info of the next step.
+            For a tree, gather the accepted path to the front first, e.g.
+            ``key_cache[offset : offset + n] = key_cache[offset + accepted_idx]``.
 
     Return:
         attn_output: Weighted value which is the output of scale dot product.
@@ -640,6 +809,7 @@ class IndirectAccessKVCacheAttention(nn.Module):
         add_casual_mask: Optional[bool] = True,
         seq_info: Optional[torch.Tensor] = None,
         text_max_length: Optional[int] = 0,
+        tree_mask: Optional[torch.Tensor] = None,
     ):
         return cls.runtime_ops.get_module_from_device(
             query.device.type, IPEXCustomOpType.INDIRECTACCESS_KVCACHE_ATTENTION, False
@@ -655,6 +825,7 @@ class IndirectAccessKVCacheAttention(nn.Module):
             add_casual_mask,
             seq_info,
             text_max_length,
+            tree_mask=tree_mask,
         )
 
     def forward(
@@ -669,6 +840,7 @@ class IndirectAccessKVCacheAttention(nn.Module):
         alibi: Optional[torch.Tensor] = None,
         add_casual_mask: Optional[bool] = True,
         seq_info: Optional[torch.Tensor] = None,
+        tree_mask: Optional[torch.Tensor] = None,
     ):
         # query: Tensor [batch, seq_len, num_head, head_dim]
         # key: Tensor [batch, seq_len, num_kv_head, head_dim]
@@ -703,4 +875,5 @@ class IndirectAccessKVCacheAttention(nn.Module):
             alibi,
             add_casual_mask,
             seq_info,
+            tree_mask=tree_mask,
         )
@@ -4,6 +4,8 @@ from .merged_embeddingbag import MergedEmbeddingBagWithSGD
 from .merged_embeddingbag import MergedEmbeddingBag
 from .merged_embeddingbag import MergedEmbeddingBagWithCat
 from .merged_embeddingbag import MergedEmbeddingBagWithAdaGrad
+from .merged_embeddingbag import MergedEmbeddingBagWithMmapCache
+from .merged_embeddingbag import MergedEmbeddingBagRowwiseQuantized
 from .merged_embeddingbag import DistMergeEmbeddingBagWithAdaGrad
 from ...cpu.nn.linear_fuse_eltwise import IPEXLinearEltwise
 from .weight_only_quantization import WeightOnlyQuantizedLinear
@@ -1,3 +1,4 @@
+import os
 import torch
 from torch import nn
 from torch.autograd import Function
@@ -605,6 +606,199 @@ class MergedEmbeddingBagWithAdaGrad(MergedEmbeddingBag):
         return cls(embedding_specs, lr, eps)
 
 
+class MergedEmbeddingBagWithMmapCache(nn.Module):
+    r"""
+    `MergedEmbeddingBagWithSGD` or `MergedEmbeddingBagWithAdaGrad` for tables larger than the memory.
+
+    Each table, followed by its AdaGrad state, lives in the file `table{i}.bin` under `path`, e.g. on a local NVMe,
+    which is memory mapped. A DRAM cache of `cache_rows` rows per table holds the hot rows, the rows of a batch are
+    loaded into the cache before the forward, and the forward and the fused backward/update run on the cache. The
+    updated rows are written back to the file when they are evicted or by `flush`. The rows of the next batch can be
+    prefetched while the current batch runs:
+
+        >>> merged_emb = MergedEmbeddingBagWithMmapCache.from_embeddingbag_list(
+        >>>     EmbLists, path="/nvme/emb", cache_rows=1 << 20, optimizer="adagrad", lr=lr)
+        >>> for i in range(len(batches)):
+        >>>     indices, offsets = batches[i]
+        >>>     outputs = merged_emb(indices, offsets)
+        >>>     if i + 1 < len(batches):
+        >>>         merged_emb.prefetch(batches[i + 1][0])
+        >>>     loss = ...
+        >>>     loss.backward()
+        >>> merged_emb.flush()
+
+    Only float tables are supported. An existing file of the same shape is reused, e.g. to resume the training, the
+    weights of `embedding_specs` are only copied into the new files. The unique indices of a batch must fit in the
+    cache of their table.
+    """
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        path: str,
+        cache_rows: int,
+        optimizer: str = "sgd",
+        lr: float = 0.01,
+        weight_decay: float = 0,
+        eps: float = 1e-10,
+    ):
+        super(MergedEmbeddingBagWithMmapCache, self).__init__()
+        import intel_extension_for_pytorch._C as core
+
+        self.n_tables = len(embedding_specs)
+        assert self.n_tables > 0, "MergedEmbeddingBag at least have 1 table"
+        self.embedding_dim = embedding_specs[0].embedding_dim
+        assert all(
+            specs.embedding_dim == self.embedding_dim for specs in embedding_specs
+        ), "expect all tables have same embedding_dim"
+        assert all(
+            specs.dtype == torch.float for specs in embedding_specs
+        ), "MergedEmbeddingBagWithMmapCache only support float tables"
+        assert all(
+            specs.pooling_mode == embedding_specs[0].pooling_mode
+            for specs in embedding_specs
+        ), "expect all tables have same pooling_mode"
+        assert embedding_specs[0].pooling_mode in (
+            "sum",
+            "mean",
+        ), "MergedEmbeddingBag only support EmbeddingBag with model sum or mean"
+        if embedding_specs[0].pooling_mode == "sum":
+            self.pooling_mode = PoolingMode.SUM
+        else:
+            self.pooling_mode = PoolingMode.MEAN
+        self.include_last_offset = embedding_specs[0].include_last_offset
+        assert all(
+            specs.include_last_offset == self.include_last_offset
+            for specs in embedding_specs
+        ), "expect all tables have same include_last_offset"
+        assert optimizer in (
+            "sgd",
+            "adagrad",
+        ), "MergedEmbeddingBagWithMmapCache only support sgd and adagrad"
+        self.optimizer = optimizer
+
+        os.makedirs(path, exist_ok=True)
+        self.caches = []
+        for i, spec in enumerate(embedding_specs):
+            file = os.path.join(path, "table{}.bin".format(i))
+            exists = os.path.exists(file)
+            cache = core.MmapEmbeddingCache(
+                file,
+                spec.num_embeddings,
+                spec.embedding_dim,
+                1 if optimizer == "adagrad" else 0,
+                cache_rows,
+            )
+            if not exists and spec.weight is not None:
+                cache.table(0).copy_(spec.weight)
+            self.caches.append(cache)
+        # The fused backward only runs for the inputs requiring grad, it updates
+        # the cached rows in place and returns no grad
+        self.weights = [cache.weight().requires_grad_() for cache in self.caches]
+        bf16_trail = [torch.empty(0, dtype=torch.bfloat16) for _ in self.caches]
+        if optimizer == "sgd":
+            if lr < 0.0:
+                raise ValueError("Invalid learning rate: {}".format(lr))
+            if weight_decay < 0.0:
+                raise ValueError("Invalid weight_decay value: {}".format(weight_decay))
+            self.sgd_args = SGDArgs(
+                weight_decay=weight_decay, lr=lr, bf16_trail=bf16_trail
+            )
+        else:
+            if lr < 0.0:
+                raise ValueError("Invalid learning rate: {}".format(lr))
+            if eps < 0.0:
+                raise ValueError("Invalid eps value: {}".format(eps))
+            self.adagrad_args = AdaGradArgs(
+                eps=eps,
+                lr=lr,
+                bf16_trail=bf16_trail,
+                hessian=[cache.state(0) for cache in self.caches],
+            )
+
+    def forward(self, indices, offsets):
+        r"""
+        Args:
+            indices (List[Tensor]):
+                See https://pytorch.org/docs/stable/generated/torch.nn.EmbeddingBag.html#torch.nn.EmbeddingBag.forward
+            offsets (List[Tensor]):
+                See https://pytorch.org/docs/stable/generated/torch.nn.EmbeddingBag.html#torch.nn.EmbeddingBag.forward
+        Returns:
+            List[Tensor] output shape of `(batch_size, embedding_dim)` which length = num of tables.
+        """
+        update = torch.is_grad_enabled()
+        # the cache slots of the indices, valid until the next forward
+        slots = [
+            cache.lookup(index, update) for cache, index in zip(self.caches, indices)
+        ]
+        if self.optimizer == "sgd":
+            return merged_embeddingbag_sgd(
+                self.weights,
+                slots,
+                offsets,
+                self.pooling_mode,
+                self.include_last_offset,
+                self.sgd_args,
+            )
+        return merged_embeddingbag_adagrad(
+            self.weights,
+            slots,
+            offsets,
+            self.pooling_mode,
+            self.include_last_offset,
+            self.adagrad_args,
+        )
+
+    def prefetch(self, indices):
+        r"""
+        Reads the rows of the next batch not in the caches in the background.
+        """
+        for cache, index in zip(self.caches, indices):
+            cache.prefetch(index)
+
+    def flush(self):
+        r"""
+        Writes the updated rows back to the files.
+        """
+        for cache in self.caches:
+            cache.flush()
+
+    def table(self, i):
+        r"""
+        Returns the flushed table i, a view of its file.
+        """
+        self.caches[i].flush()
+        return self.caches[i].table(0)
+
+    def cache_stats(self):
+        return [cache.stats() for cache in self.caches]
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        path: str,
+        cache_rows: int,
+        optimizer: str = "sgd",
+        **optimizer_args,
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_embeddings=emb_shape[0],
+                    embedding_dim=emb_shape[1],
+                    pooling_mode=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse,
+                    include_last_offset=emb.include_last_offset,
+                )
+            )
+        return cls(embedding_specs, path, cache_rows, optimizer, **optimizer_args)
+
+
 class MergedEmbeddingBagWithCat(MergedEmbeddingBag):
     r"""
     To support `MergedEmbeddingBag` with cat all outputs with an given input.
@@ -653,6 +847,154 @@ class MergedEmbeddingBagWithCat(MergedEmbeddingBag):
         )
 
 
+class MergedEmbeddingBagRowwiseQuantized(nn.Module):
+    r"""
+    `MergedEmbeddingBag` for inference with row-wise quantized tables, to hold more tables in the memory.
+
+    Each row is stored in `qtype` with its own fp32 scale and bias following the data, and is dequantized while it is
+    pooled, the outputs are float:
+
+        "int8": asymmetric uint8, 1 byte per element
+        "int4": asymmetric uint4, 2 elements per byte
+        "fp8": fp8 e4m3 scaled by the absolute max of the row
+
+    A table of dim 128 takes 136 bytes per row in int8 and fp8, 72 bytes in int4, against 512 bytes in float. With
+    `dense_feature`, the dense feature and the outputs are concatenated as `MergedEmbeddingBagWithCat`:
+
+        >>> merged_emb = MergedEmbeddingBagRowwiseQuantized.from_embeddingbag_list(EmbLists, qtype="int4")
+        >>> outputs = merged_emb(indices, offsets)
+        >>> cat_out = merged_emb(indices, offsets, dense_feature)
+    """
+
+    qtypes = {
+        "int8": torch.uint8,
+        "int4": torch.quint4x2,
+        "fp8": torch.float8_e4m3fn,
+    }
+
+    def __init__(
+        self,
+        embedding_specs: List[EmbeddingSpec],
+        qtype: str = "int8",
+    ):
+        super(MergedEmbeddingBagRowwiseQuantized, self).__init__()
+        self.n_tables = len(embedding_specs)
+        assert self.n_tables > 0, "MergedEmbeddingBag at least have 1 table"
+        self.embedding_dim = embedding_specs[0].embedding_dim
+        assert all(
+            specs.embedding_dim == self.embedding_dim for specs in embedding_specs
+        ), "expect all tables have same embedding_dim"
+        assert all(
+            specs.pooling_mode == embedding_specs[0].pooling_mode
+            for specs in embedding_specs
+        ), "expect all tables have same pooling_mode"
+        assert embedding_specs[0].pooling_mode in (
+            "sum",
+            "mean",
+        ), "MergedEmbeddingBag only support EmbeddingBag with model sum or mean"
+        if embedding_specs[0].pooling_mode == "sum":
+            self.pooling_mode = PoolingMode.SUM
+        else:
+            self.pooling_mode = PoolingMode.MEAN
+        self.include_last_offset = embedding_specs[0].include_last_offset
+        assert all(
+            specs.include_last_offset == self.include_last_offset
+            for specs in embedding_specs
+        ), "expect all tables have same include_last_offset"
+        assert (
+            qtype in self.qtypes
+        ), "MergedEmbeddingBagRowwiseQuantized only support int8, int4 and fp8"
+        self.qtype = qtype
+
+        for i, spec in enumerate(embedding_specs):
+            weight = spec.weight
+            if weight is None:
+                weight = torch.randn((spec.num_embeddings, spec.embedding_dim))
+            self.register_buffer(
+                "qweight{}".format(i),
+                torch.ops.torch_ipex.merged_embeddingbag_rowwise_quantize(
+                    weight.detach(), self.qtypes[qtype]
+                ),
+            )
+
+    @property
+    def qweights(self):
+        return [getattr(self, "qweight{}".format(i)) for i in range(self.n_tables)]
+
+    def extra_repr(self) -> str:
+        return "number of tables={}, embedding_dim={}, qtype={}, {}".format(
+            self.n_tables, self.embedding_dim, self.qtype, self.pooling_mode
+        )
+
+    def dequantize(self, i):
+        r"""
+        Returns the float table i.
+        """
+        qweight = self.qweights[i]
+        data_bytes = qweight.shape[1] - 8
+        data = qweight[:, :data_bytes]
+        if self.qtype == "int4":
+            data = torch.stack([data & 0xF, data >> 4], dim=-1).flatten(1)
+            data = data[:, : self.embedding_dim].float()
+        elif self.qtype == "fp8":
+            data = data.view(torch.float8_e4m3fn).float()
+        else:
+            data = data.float()
+        scale = qweight[:, data_bytes : data_bytes + 4].contiguous().view(torch.float)
+        bias = qweight[:, data_bytes + 4 :].contiguous().view(torch.float)
+        return data * scale + bias
+
+    def forward(self, indices, offsets, dense_feature=None):
+        r"""
+        Args:
+            indices (List[Tensor]):
+                See https://pytorch.org/docs/stable/generated/torch.nn.EmbeddingBag.html#torch.nn.EmbeddingBag.forward
+            offsets (List[Tensor]):
+                See https://pytorch.org/docs/stable/generated/torch.nn.EmbeddingBag.html#torch.nn.EmbeddingBag.forward
+            dense_feature (Tensor, optional): float dense feature to be cat, requires sum pooling
+        Returns:
+            List[Tensor] output shape of `(batch_size, embedding_dim)` which length = num of tables, or with
+            `dense_feature`, output shape of `(batch_size, feature_size)` which feature_size = emb_dim * (num of
+            tables + 1).
+        """
+        if dense_feature is not None:
+            assert self.pooling_mode == PoolingMode.SUM
+            return torch.ops.torch_ipex.merged_embeddingbag_rowwise_cat_forward(
+                self.qweights, indices, offsets, dense_feature, self.qtypes[self.qtype]
+            )
+        return torch.ops.torch_ipex.merged_embeddingbag_rowwise_forward(
+            self.qweights,
+            indices,
+            offsets,
+            self.pooling_mode,
+            self.include_last_offset,
+            self.qtypes[self.qtype],
+            self.embedding_dim,
+        )
+
+    @classmethod
+    def from_embeddingbag_list(
+        cls,
+        tables: List[torch.nn.EmbeddingBag],
+        qtype: str = "int8",
+    ):
+        embedding_specs = []
+        for emb in tables:
+            emb_shape = emb.weight.shape
+            embedding_specs.append(
+                EmbeddingSpec(
+                    num_embeddings=emb_shape[0],
+                    embedding_dim=emb_shape[1],
+                    pooling_mode=emb.mode,
+                    dtype=emb.weight.dtype,
+                    weight=emb.weight.detach(),
+                    sparse=emb.sparse,
+                    include_last_offset=emb.include_last_offset,
+                )
+            )
+        return cls(embedding_specs, qtype)
+
+
 import torch.distributed as dist
 
 
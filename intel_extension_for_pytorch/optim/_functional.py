@@ -106,7 +106,6 @@ def _single_tensor_adagrad(
                 state_sum = torch.view_as_complex(state_sum)
 
 
-# keep this function here if enable fused_foreach_adagrad_later
 def _multi_tensor_adagrad(
     params: List[Tensor],
     params2: List[Tensor],
@@ -126,24 +125,37 @@ def _multi_tensor_adagrad(
     if len(params) == 0:
         return
 
+    # the multi tensor kernel is CPU only
+    if (
+        has_sparse_grad
+        or params[0].device.type != "cpu"
+        or any(torch.is_complex(p) for p in params)
+    ):
+        _single_tensor_adagrad(
+            params,
+            params2,
+            grads,
+            state_sums,
+            state_steps,
+            lr=lr,
+            weight_decay=weight_decay,
+            lr_decay=lr_decay,
+            eps=eps,
+            has_sparse_grad=has_sparse_grad,
+            maximize=maximize,
+            fused=fused,
+        )
+        return
+
     if maximize:
-        grads = torch._foreach_neg(grads)
+        grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
 
-    _single_tensor_adagrad(
-        params,
-        params2,
-        grads,
-        state_sums,
-        state_steps,
-        lr=lr,
-        weight_decay=weight_decay,
-        lr_decay=lr_decay,
-        eps=eps,
-        has_sparse_grad=has_sparse_grad,
-        maximize=False,
-        fused=fused,
+    # update steps
+    torch._foreach_add_(state_steps, 1)
+    steps = [step_t.item() for step_t in state_steps]
+    torch.ops.torch_ipex.adagrad_fused_step_multi_tensor(
+        params, grads, state_sums, params2, steps, lr, weight_decay, lr_decay, eps
     )
-    return
 
 
 def adagrad(
@@ -383,7 +395,6 @@ def _single_tensor_lars(
         # continue
 
 
-# keep this function here if enable fused_foreach_sgd_later
 def _multi_tensor_sgd(
     params: List[Tensor],
     params2: List[Tensor],
@@ -402,20 +413,42 @@ def _multi_tensor_sgd(
     if len(params) == 0:
         return
 
-    _single_tensor_sgd(
+    # the multi tensor kernel is CPU only
+    if has_sparse_grad or params[0].device.type != "cpu":
+        _single_tensor_sgd(
+            params,
+            params2,
+            grads,
+            momentum_buffer_list,
+            weight_decay=weight_decay,
+            momentum=momentum,
+            lr=lr,
+            dampening=dampening,
+            nesterov=nesterov,
+            maximize=maximize,
+            has_sparse_grad=has_sparse_grad,
+            fused=fused,
+        )
+        return
+
+    if maximize:
+        grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
+
+    momentum_buffers = torch.ops.torch_ipex.sgd_fused_step_multi_tensor(
         params,
-        params2,
         grads,
         momentum_buffer_list,
-        weight_decay=weight_decay,
-        momentum=momentum,
-        lr=lr,
-        dampening=dampening,
-        nesterov=nesterov,
-        maximize=maximize,
-        has_sparse_grad=has_sparse_grad,
-        fused=fused,
+        params2,
+        momentum,
+        lr,
+        weight_decay,
+        dampening,
+        nesterov,
     )
+    # the buffers allocated for the params without one are returned
+    if momentum != 0:
+        for i, buf in enumerate(momentum_buffers):
+            momentum_buffer_list[i] = buf
 
 
 def sgd(
@@ -687,25 +720,41 @@ def _lamb_fused_impl(
     See :class:`~torch.optim.Lamb` for details.
     """
 
-    for i, param in enumerate(params):
-        grad = grads[i]
-        exp_avg = exp_avgs[i]
-        exp_avg_sq = exp_avg_sqs[i]
-        step = state_steps[i]
-        param2 = get_param2(param, attr)
-        torch.ops.torch_ipex.lamb_fused_step(
-            param,
-            exp_avg,
-            exp_avg_sq,
-            grad,
-            param2,
-            step,
-            beta1,
-            beta2,
-            lr,
-            weight_decay,
-            eps,
-        )
+    if len(params) == 0:
+        return
+
+    if params[0].device.type != "cpu":
+        for i, param in enumerate(params):
+            torch.ops.torch_ipex.lamb_fused_step(
+                param,
+                exp_avgs[i],
+                exp_avg_sqs[i],
+                grads[i],
+                get_param2(param, attr),
+                state_steps[i],
+                beta1,
+                beta2,
+                lr,
+                weight_decay,
+                eps,
+            )
+        return
+
+    # all the params of the group are updated by a single op
+    params2 = [get_param2(param, attr) for param in params]
+    torch.ops.torch_ipex.lamb_fused_step_multi_tensor(
+        params,
+        exp_avgs,
+        exp_avg_sqs,
+        grads,
+        params2,
+        state_steps,
+        beta1,
+        beta2,
+        lr,
+        weight_decay,
+        eps,
+    )
 
 
 def _lamb_impl(
@@ -1035,24 +1084,46 @@ def _multi_tensor_adam(
     if len(params) == 0:
         return
 
+    # the multi tensor kernel is CPU only
+    if params[0].device.type != "cpu":
+        _single_tensor_adam(
+            params,
+            params2,
+            grads,
+            exp_avgs,
+            exp_avg_sqs,
+            max_exp_avg_sqs,
+            state_steps,
+            amsgrad=amsgrad,
+            beta1=beta1,
+            beta2=beta2,
+            lr=lr,
+            weight_decay=weight_decay,
+            eps=eps,
+            maximize=maximize,
+        )
+        return
+
     if maximize:
         grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
 
-    _single_tensor_adam(
+    # update steps
+    torch._foreach_add_(state_steps, 1)
+    steps = [step_t.item() for step_t in state_steps]
+    torch.ops.torch_ipex.adam_fused_step_multi_tensor(
         params,
-        params2,
-        grads,
         exp_avgs,
         exp_avg_sqs,
-        max_exp_avg_sqs,
-        state_steps,
-        amsgrad=amsgrad,
-        beta1=beta1,
-        beta2=beta2,
-        lr=lr,
-        weight_decay=weight_decay,
-        eps=eps,
-        maximize=False,
+        max_exp_avg_sqs if amsgrad else [],
+        grads,
+        params2,
+        amsgrad,
+        steps,
+        beta1,
+        beta2,
+        lr,
+        weight_decay,
+        eps,
     )
 
 
@@ -1184,24 +1255,46 @@ def _multi_tensor_adamw(
     if len(params) == 0:
         return
 
+    # the multi tensor kernel is CPU only
+    if params[0].device.type != "cpu":
+        _single_tensor_adamw(
+            params,
+            params2,
+            grads,
+            exp_avgs,
+            exp_avg_sqs,
+            max_exp_avg_sqs,
+            state_steps,
+            amsgrad=amsgrad,
+            beta1=beta1,
+            beta2=beta2,
+            lr=lr,
+            weight_decay=weight_decay,
+            eps=eps,
+            maximize=maximize,
+        )
+        return
+
     if maximize:
         grads = torch._foreach_neg(tuple(grads))  # type: ignore[assignment]
 
-    _single_tensor_adamw(
+    # update steps
+    torch._foreach_add_(state_steps, 1)
+    steps = [step_t.item() for step_t in state_steps]
+    torch.ops.torch_ipex.adamw_fused_step_multi_tensor(
         params,
-        params2,
-        grads,
         exp_avgs,
         exp_avg_sqs,
-        max_exp_avg_sqs,
-        state_steps,
-        amsgrad=amsgrad,
-        beta1=beta1,
-        beta2=beta2,
-        lr=lr,
-        weight_decay=weight_decay,
-        eps=eps,
-        maximize=False,
+        max_exp_avg_sqs if amsgrad else [],
+        grads,
+        params2,
+        amsgrad,
+        steps,
+        beta1,
+        beta2,
+        lr,
+        weight_decay,
+        eps,
     )
 
 
@@ -1248,8 +1341,12 @@ def adamw_step(self, closure=None):
                 state = self.state[p]
                 # Lazy state initialization
                 if len(state) == 0:
-                    buffer_dtype = p.dtype
-                    if p.dtype is not torch.float:
+                    buffer_dtype = torch.float
+                    # a bf16 parameter on CPU is the top half of a split master
+                    # weight, its states are still FP32
+                    if p.dtype is not torch.float and not (
+                        p.dtype is torch.bfloat16 and p.device.type == "cpu"
+                    ):
                         raise RuntimeError(
                             "parameter in optimizer(Adamw) is not FP32, need check"
                         )
@@ -11,6 +11,7 @@ from transformers.generation.logits_process import LogitsProcessorList
 from transformers.generation.streamers import BaseStreamer
 from transformers.utils import ModelOutput
 import time
+from .utils import _get_fused_sampling_args
 
 
 class SampleEncoderDecoderOutput(ModelOutput):
@@ -72,6 +73,7 @@ def _sample(
     logits_warper = (
         logits_warper if logits_warper is not None else LogitsProcessorList()
     )
+    fused_sampling_args = _get_fused_sampling_args(logits_processor, logits_warper)
     pad_token_id = (
         pad_token_id
         if pad_token_id is not None
@@ -377,9 +379,18 @@ def _sample(
         else:
             next_token_logits = outputs[0][:, -1, :]
 
-        # pre-process distribution
-        next_token_scores = logits_processor(input_ids, next_token_logits)
-        next_token_scores = logits_warper(input_ids, next_token_scores)
+        next_tokens = None
+        if fused_sampling_args is not None and not (
+            return_dict_in_generate and output_scores
+        ):
+            # penalty, temperature, top-k/top-p and sampling in one pass
+            next_tokens = torch.ops.torch_ipex.fused_sampling(
+                next_token_logits, input_ids, **fused_sampling_args
+            )
+        else:
+            # pre-process distribution
+            next_token_scores = logits_processor(input_ids, next_token_logits)
+            next_token_scores = logits_warper(input_ids, next_token_scores)
 
         # Store scores, attentions and hidden_states when required
         if return_dict_in_generate:
@@ -402,8 +413,9 @@ def _sample(
                 )
 
         # sample
-        probs = nn.functional.softmax(next_token_scores, dim=-1)
-        next_tokens = torch.multinomial(probs, num_samples=1).squeeze(1)
+        if next_tokens is None:
+            probs = nn.functional.softmax(next_token_scores, dim=-1)
+            next_tokens = torch.multinomial(probs, num_samples=1).squeeze(1)
 
         # finished sentences should have their next token be a padding token
         if eos_token_id is not None:
@@ -22,3 +22,43 @@ def _extract_past_from_model_output(
             past_key_values, batch_size=batch_size
         )
     return past_key_values
+
+
+def _get_fused_sampling_args(logits_processor, logits_warper):
+    """
+    Map the logits processors of the sampling to the arguments of
+    torch.ops.torch_ipex.fused_sampling. Returns None if any of them can not be
+    fused, and the caller should fall back to the processor chain.
+    """
+    from transformers.generation.logits_process import (
+        RepetitionPenaltyLogitsProcessor,
+        TemperatureLogitsWarper,
+        TopKLogitsWarper,
+        TopPLogitsWarper,
+    )
+
+    args = {}
+    for processor in logits_processor:
+        if (
+            not isinstance(processor, RepetitionPenaltyLogitsProcessor)
+            or "repetition_penalty" in args
+        ):
+            return None
+        args["repetition_penalty"] = float(processor.penalty)
+    # the warpers are applied as temperature -> top-k -> top-p
+    order = [TemperatureLogitsWarper, TopKLogitsWarper, TopPLogitsWarper]
+    last = -1
+    for warper in logits_warper:
+        kind = next((i for i, c in enumerate(order) if type(warper) is c), None)
+        if kind is None or kind <= last:
+            return None
+        last = kind
+        if kind == 0:
+            args["temperature"] = float(warper.temperature)
+        elif kind == 1:
+            args["top_k"] = int(warper.top_k)
+        else:
+            if warper.min_tokens_to_keep != 1:
+                return None
+            args["top_p"] = float(warper.top_p)
+    return args
@@ -163,6 +163,7 @@ class _IPEXScaleDotProductCPU(nn.Module):
         text_max_length: Optional[int] = 0,
         cutoff: Optional[torch.Tensor] = None,
         vision: Optional[torch.Tensor] = False,
+        tree_mask: Optional[torch.Tensor] = None,
     ):
         if cutoff is not None:
             if layer_past is None:
@@ -253,6 +254,7 @@ class _IPEXScaleDotProductCPU(nn.Module):
             head_mask,
             attention_mask,
             add_casual_mask,
+            tree_mask,
         )
 
         present = (
@@ -283,6 +285,7 @@ class _IPEXScaleDotProductCPU(nn.Module):
         seq_info: Optional[torch.Tensor] = None,
         cutoff: Optional[torch.Tensor] = None,
         vision: Optional[torch.Tensor] = False,
+        tree_mask: Optional[torch.Tensor] = None,
     ):
         return self.apply_function(
             query,
@@ -298,6 +301,7 @@ class _IPEXScaleDotProductCPU(nn.Module):
             self.text_max_length,
             cutoff,
             vision,
+            tree_mask,
         )
 
 
@@ -341,13 +345,24 @@ class _IPEXFastLayerNormCPU(nn.Module):
 
 class _IPEXPagedAttentionCPU:
     @classmethod
-    def reshape_and_cache(cls, key, value, key_cache, value_cache, slot_mapping):
+    def reshape_and_cache(
+        cls,
+        key,
+        value,
+        key_cache,
+        value_cache,
+        slot_mapping,
+        k_scale=None,
+        v_scale=None,
+    ):
         torch.ops.torch_ipex.reshape_and_cache(
             key,
             value,
             key_cache,
             value_cache,
             slot_mapping.int() if slot_mapping.dtype is torch.long else slot_mapping,
+            k_scale,
+            v_scale,
         )
 
     @classmethod
@@ -364,6 +379,9 @@ class _IPEXPagedAttentionCPU:
         block_size,
         max_context_len,
         alibi_slopes,
+        k_scale=None,
+        v_scale=None,
+        window_size=-1,
     ):
         torch.ops.torch_ipex.single_query_cached_kv_attention(
             output,
@@ -377,8 +395,56 @@ class _IPEXPagedAttentionCPU:
             block_size,
             max_context_len,
             alibi_slopes,
+            k_scale,
+            v_scale,
+            window_size,
         )
 
+    @classmethod
+    def multi_query_cached_kv_attention(
+        cls,
+        output,
+        query,
+        key_cache,
+        value_cache,
+        scale,
+        block_tables,
+        context_lens,
+        query_start_loc,
+        block_size,
+        max_query_len,
+        alibi_slopes,
+        k_scale=None,
+        v_scale=None,
+        window_size=-1,
+    ):
+        torch.ops.torch_ipex.multi_query_cached_kv_attention(
+            output,
+            query,
+            key_cache,
+            value_cache,
+            scale,
+            block_tables,
+            context_lens,
+            query_start_loc.int()
+            if query_start_loc.dtype is torch.long
+            else query_start_loc,
+            block_size,
+            max_query_len,
+            alibi_slopes,
+            k_scale,
+            v_scale,
+            window_size,
+        )
+
+    @classmethod
+    def copy_blocks(cls, key_caches, value_caches, block_mapping):
+        torch.ops.torch_ipex.copy_blocks(key_caches, value_caches, block_mapping)
+
+    @classmethod
+    def swap_blocks(cls, src, dst, block_mapping):
+        torch.ops.torch_ipex.swap_blocks(src, dst, block_mapping)
+
 
 class _IPEXVarlenScaledDotProductCPU(nn.Module):
     def __init__(self):
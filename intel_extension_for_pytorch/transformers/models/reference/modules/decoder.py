@@ -777,67 +777,45 @@ def MixtralDecoderLayer_forward(
     # we cast back to the input dtype
     routing_weights = routing_weights.to(hidden_states.dtype)
 
-    final_hidden_states = torch.zeros(
-        (batch_size * sequence_length, hidden_dim),
-        dtype=hidden_states.dtype,
-        device=hidden_states.device,
-    )
-
-    # One hot encode the selected experts to create an expert mask
-    # this will be used to easily index which expert is going to be sollicitated
-    expert_mask = torch.nn.functional.one_hot(
-        selected_experts, num_classes=self.block_sparse_moe.num_experts
-    ).permute(2, 1, 0)
-
-    # Loop over all available experts in the model and perform the computation on each expert
-    for expert_idx in range(self.block_sparse_moe.num_experts):
-        expert_layer = self.block_sparse_moe.experts[expert_idx]
-        idx, top_x = torch.where(expert_mask[expert_idx])
-        if expert_layer.w1.weight.dtype in [torch.qint8, torch.int8, torch.uint8]:
-            final_hidden_states = torch.ops.torch_ipex.mixtral_moe_woq(
-                hidden_states,
-                top_x,
-                idx,
-                expert_layer.w1._op_context.get_data_handle(),
-                expert_layer.w3._op_context.get_data_handle(),
-                expert_layer.w2._op_context.get_data_handle(),
-                routing_weights,
-                final_hidden_states,
-                self.distributed,
-            )
-        elif hasattr(expert_layer.w1, "use_dnnl") and expert_layer.w1.use_dnnl:
-            final_hidden_states = torch.ops.torch_ipex.mixtral_moe(
-                hidden_states,
-                top_x,
-                idx,
-                expert_layer.w1._get_forward_weight(),
-                expert_layer.w1.ctx.get_data_handle(),
-                expert_layer.w3._get_forward_weight(),
-                expert_layer.w3.ctx.get_data_handle(),
-                expert_layer.w2._get_forward_weight(),
-                expert_layer.w2.ctx.get_data_handle(),
-                hasattr(expert_layer.w1, "use_dnnl") and expert_layer.w1.use_dnnl,
-                routing_weights,
-                final_hidden_states,
-                self.distributed,
-            )
-        else:
-            final_hidden_states = torch.ops.torch_ipex.mixtral_moe_tpp(
-                hidden_states,
-                top_x,
-                idx,
-                expert_layer.w1.weight,
-                expert_layer.w3.weight,
-                expert_layer.w2.weight,
-                (
-                    expert_layer.w1.tpp_fallback
-                    if hasattr(expert_layer.w1, "tpp_fallback")
-                    else True
-                ),
-                routing_weights,
-                final_hidden_states,
-                self.distributed,
-            )
+    # All experts run in one grouped op: tokens are bucketed by expert inside
+    # the kernel and the tensor parallel all-reduce is issued once per layer.
+    experts = self.block_sparse_moe.experts
+    first_w1 = experts[0].w1
+    if first_w1.weight.dtype in [torch.qint8, torch.int8, torch.uint8]:
+        final_hidden_states = torch.ops.torch_ipex.mixtral_moe_woq_grouped(
+            hidden_states,
+            selected_experts,
+            routing_weights,
+            [e.w1._op_context.get_data_handle() for e in experts],
+            [e.w3._op_context.get_data_handle() for e in experts],
+            [e.w2._op_context.get_data_handle() for e in experts],
+            self.distributed,
+        )
+    elif hasattr(first_w1, "use_dnnl") and first_w1.use_dnnl:
+        final_hidden_states = torch.ops.torch_ipex.mixtral_moe_grouped(
+            hidden_states,
+            selected_experts,
+            routing_weights,
+            [e.w1._get_forward_weight() for e in experts],
+            [e.w1.ctx.get_data_handle() for e in experts],
+            [e.w3._get_forward_weight() for e in experts],
+            [e.w3.ctx.get_data_handle() for e in experts],
+            [e.w2._get_forward_weight() for e in experts],
+            [e.w2.ctx.get_data_handle() for e in experts],
+            True,
+            self.distributed,
+        )
+    else:
+        final_hidden_states = torch.ops.torch_ipex.mixtral_moe_tpp_grouped(
+            hidden_states,
+            selected_experts,
+            routing_weights,
+            [e.w1.weight for e in experts],
+            [e.w3.weight for e in experts],
+            [e.w2.weight for e in experts],
+            (first_w1.tpp_fallback if hasattr(first_w1, "tpp_fallback") else True),
+            self.distributed,
+        )
     final_hidden_states = final_hidden_states.reshape(
         batch_size, sequence_length, hidden_dim
     )
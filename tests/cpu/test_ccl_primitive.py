@@ -1,5 +1,9 @@
 import unittest
 import os
+import subprocess
+import sys
+import time
+import uuid
 import torch
 import intel_extension_for_pytorch as ipex
 
@@ -139,6 +143,38 @@ class CCLTester(unittest.TestCase):
         self.assertEqual(mpi_world_size, ipex.cpu.comm.get_world_size())
         self.assertEqual(mpi_rank, ipex.cpu.comm.get_rank())
 
+    @unittest.skipIf(not (has_ccl and world_size > 1), "oneccl is not built")
+    def test_all_reduce_add_async(self):
+        mpi_world_size = int(os.environ.get("PMI_SIZE", -1))
+        mpi_rank = int(os.environ.get("PMI_RANK", -1))
+        for dtype in [torch.float32, torch.bfloat16]:
+            inputs = [
+                torch.tensor([mpi_rank + 1.0 + i]).to(dtype).repeat(4096 * 32)
+                for i in range(3)
+            ]
+            handles = [ipex.cpu.comm.allreduce_add_async(t) for t in inputs]
+            # blocking collectives are ordered after the pending ones
+            blocking = torch.tensor([mpi_rank + 1.0]).to(dtype).repeat(4096)
+            ipex.cpu.comm.allreduce_add(blocking)
+            for i, (t, handle) in enumerate(zip(inputs, handles)):
+                ipex.cpu.comm.allreduce_wait(t, handle)
+                expected = float(
+                    mpi_world_size * (mpi_world_size + 1) / 2 + i * mpi_world_size
+                )
+                target = torch.tensor([expected]).to(dtype).repeat(t.numel())
+                self.assertTrue(torch.allclose(t, target))
+            self.assertTrue(
+                torch.allclose(
+                    blocking,
+                    torch.tensor([float(mpi_world_size * (mpi_world_size + 1) / 2)])
+                    .to(dtype)
+                    .repeat(4096),
+                )
+            )
+            with self.assertRaises(RuntimeError):
+                ipex.cpu.comm.allreduce_wait(inputs[0], handles[0])
+        ipex.cpu.comm.barrier()
+
     @unittest.skipIf(not (has_ccl and world_size > 1), "oneccl is not built")
     def test_allgather(self):
         mpi_world_size = int(os.environ.get("PMI_SIZE", -1))
@@ -159,6 +195,143 @@ class CCLTester(unittest.TestCase):
                 output = ipex.cpu.comm.allgather(input, col_per_rank, mpi_world_size)
                 torch.allclose(expected_output, output)
 
+    def _run_local_ranks(self, script, world_size, timeout=300, **env):
+        # Runs script in world_size processes rendezvousing on
+        # IPEX_COMM_JOB_ID. The ranks left are killed as soon as one fails or
+        # on timeout, instead of blocking on the collectives of a dead peer.
+        env = dict(
+            os.environ,
+            IPEX_COMM_JOB_ID=uuid.uuid4().hex,
+            WORLD_SIZE=str(world_size),
+            **env,
+        )
+        procs = [
+            subprocess.Popen(
+                [sys.executable, "-c", script], env=dict(env, RANK=str(rank))
+            )
+            for rank in range(world_size)
+        ]
+        deadline = time.monotonic() + timeout
+        try:
+            pending = set(range(world_size))
+            while pending:
+                for rank in list(pending):
+                    ret = procs[rank].poll()
+                    if ret is not None:
+                        pending.remove(rank)
+                        self.assertEqual(ret, 0, "rank {} failed".format(rank))
+                if pending and time.monotonic() > deadline:
+                    self.fail("the ranks timed out after {}s".format(timeout))
+                time.sleep(0.1)
+        finally:
+            for proc in procs:
+                if proc.poll() is None:
+                    proc.kill()
+                proc.wait()
+
+    @unittest.skipIf(not has_ccl, "oneccl is not built")
+    def test_local_rendezvous(self):
+        # Ranks spawned without MPI rendezvous on IPEX_COMM_JOB_ID
+        script = """
+import os, torch
+import intel_extension_for_pytorch as ipex
+comm = ipex.cpu.comm
+rank, world_size = int(os.environ["RANK"]), int(os.environ["WORLD_SIZE"])
+assert comm.get_rank() == rank and comm.get_world_size() == world_size
+for dtype in [torch.float32, torch.bfloat16]:
+    t = torch.tensor([rank + 1.0]).to(dtype).repeat(4096 * 32)
+    comm.allreduce_add(t)
+    target = torch.tensor([world_size * (world_size + 1) / 2]).to(dtype)
+    assert torch.allclose(t, target.repeat(t.numel()))
+    out = comm.allgather(torch.tensor([rank]).to(dtype), [0, 1, 2], world_size)
+    assert torch.equal(out, torch.arange(world_size).to(dtype))
+comm.barrier()
+"""
+        for precision in ["native", "fp32", "int8"]:
+            self._run_local_ranks(script, 2, IPEX_SHM_ALLREDUCE_PRECISION=precision)
+
+    @unittest.skipIf(not has_ccl, "oneccl is not built")
+    def test_all_reduce_add_comm_thread(self):
+        # The collectives run on the communication thread once one is async
+        script = """
+import os, torch
+import intel_extension_for_pytorch as ipex
+comm = ipex.cpu.comm
+rank, world_size = int(os.environ["RANK"]), int(os.environ["WORLD_SIZE"])
+inputs = [torch.tensor([rank + 1.0 + i]).repeat(4096 * 32) for i in range(3)]
+handles = [comm.allreduce_add_async(t) for t in inputs]
+blocking = torch.tensor([rank + 1.0]).repeat(4096)
+comm.allreduce_add(blocking)
+total = world_size * (world_size + 1) / 2
+for i, (t, handle) in enumerate(zip(inputs, handles)):
+    comm.allreduce_wait(t, handle)
+    assert torch.equal(t, torch.tensor([total + i * world_size]).repeat(t.numel()))
+assert torch.equal(blocking, torch.tensor([total]).repeat(4096))
+comm.barrier()
+"""
+        self._run_local_ranks(script, 2, IPEX_COMM_THREAD_CORES="0")
+
+    @unittest.skipIf(not has_ccl, "oneccl is not built")
+    def test_all_reduce_add_chunked(self):
+        # Messages of several chunks of 4096 * 5120 elements are streamed
+        # through the channels of the shared memory buffer
+        script = """
+import os, torch
+import intel_extension_for_pytorch as ipex
+comm = ipex.cpu.comm
+rank, world_size = int(os.environ["RANK"]), int(os.environ["WORLD_SIZE"])
+numel = 2 * 4096 * 5120 + 4097
+for dtype, period in [(torch.float32, 1024), (torch.bfloat16, 64)]:
+    # distinct values per chunk to catch a misplaced chunk
+    base = torch.arange(numel) % period
+    t = (base + rank).to(dtype)
+    comm.allreduce_add(t)
+    target = base * world_size + world_size * (world_size - 1) // 2
+    assert torch.equal(t, target.to(dtype))
+comm.barrier()
+"""
+        self._run_local_ranks(script, 2, timeout=600)
+
+    @unittest.skipIf(not has_ccl, "oneccl is not built")
+    def test_all_reduce_add_reduce_scatter_all_gather(self):
+        # 3 or more ranks reduce the messages fitting in a slot with a
+        # reduce-scatter + all-gather, the others with the serial chain
+        script = """
+import os, torch
+import intel_extension_for_pytorch as ipex
+comm = ipex.cpu.comm
+rank, world_size = int(os.environ["RANK"]), int(os.environ["WORLD_SIZE"])
+numel = int(os.environ["TEST_NUMEL"])
+for dtype, period in [(torch.float32, 1024), (torch.bfloat16, 32)]:
+    # distinct values per slice to catch a misplaced slice
+    base = torch.arange(numel) % period
+    target = base * world_size + world_size * (world_size - 1) // 2
+    # the states are reset between the calls
+    for _ in range(3):
+        t = (base + rank).to(dtype)
+        comm.allreduce_add(t)
+        assert torch.equal(t, target.to(dtype))
+comm.barrier()
+"""
+        for world_size in [3, 4]:
+            # the slices are not aligned to the cache lines
+            self._run_local_ranks(
+                script,
+                world_size,
+                TEST_NUMEL=str(4096 * 32 + 17),
+                IPEX_SHM_ALLREDUCE_PRECISION="native",
+            )
+        # The largest chunk of the serial chain, 4096 * 5120 elements, is
+        # larger than the fp32 slots of 9 ranks and falls back to the chain
+        self._run_local_ranks(
+            script,
+            9,
+            timeout=600,
+            TEST_NUMEL=str(4096 * 5120),
+            IPEX_SHM_ALLREDUCE_PRECISION="native",
+            IPEX_SHM_ALLREDUCE_CHUNK=str(4096 * 5120),
+        )
+
 
 if __name__ == "__main__":
     test = unittest.main()
@@ -1618,6 +1618,35 @@ class CPUOPsTester(TestCase):
         math_ref = torch._scaled_dot_product_attention_math(q2, k2, v2)[0]
         torch.testing.assert_close(actual, math_ref, atol=1e-5, rtol=5e-6)
 
+    def test_flash_attention_sliding_window(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            atol = 1e-5 if dtype is torch.float else 2e-2
+            rtol = 5e-6 if dtype is torch.float else 2e-2
+            for seq_len, window_size in itertools.product(
+                [1, 129, 533, 1030], [1, 64, 300]
+            ):
+                q, k, v = torch.randn(3, 2, 4, seq_len, 16, dtype=dtype).unbind(0)
+                pos = torch.arange(seq_len)
+                # causal sliding window: query i attends keys in (i - window, i]
+                visible = (pos.view(1, -1) <= pos.view(-1, 1)) & (
+                    pos.view(1, -1) > pos.view(-1, 1) - window_size
+                )
+                mask = torch.zeros(seq_len, seq_len).masked_fill(
+                    ~visible, float("-inf")
+                )
+                actual = torch.ops.torch_ipex.flash_attention(
+                    q,
+                    k,
+                    v,
+                    dropout_p=0.0,
+                    is_causal=True,
+                    window_size=window_size,
+                )[0]
+                math_ref = torch._scaled_dot_product_attention_math(
+                    q.float(), k.float(), v.float(), attn_mask=mask
+                )[0].to(dtype)
+                torch.testing.assert_close(actual, math_ref, atol=atol, rtol=rtol)
+
     def test_prepare_4d_causal_attention_mask(self):
         for dtype in [torch.float32, torch.bfloat16]:
             for sliding_window in [10, 40]:
@@ -1653,6 +1682,46 @@ class CPUOPsTester(TestCase):
                     except ImportError:
                         pass
 
+    def test_fused_sampling(self):
+        batch, vocab_size = 4, 1000
+        for dtype in [torch.float32, torch.bfloat16]:
+            logits = torch.randn(batch, vocab_size).to(dtype)
+            input_ids = torch.randint(0, vocab_size, (batch, 16))
+            # greedy and top_k=1 pick the argmax
+            greedy = torch.ops.torch_ipex.fused_sampling(logits, temperature=0.0)
+            self.assertEqual(greedy, logits.float().argmax(-1))
+            top1 = torch.ops.torch_ipex.fused_sampling(logits, top_k=1, seed=0)
+            self.assertEqual(top1, greedy)
+            # the repetition penalty is applied before the selection
+            penalty = 1.3
+            penalized = logits.float().clone()
+            for b in range(batch):
+                ids = input_ids[b].unique()
+                s = penalized[b, ids]
+                penalized[b, ids] = torch.where(s < 0, s * penalty, s / penalty)
+            greedy = torch.ops.torch_ipex.fused_sampling(
+                logits, input_ids, repetition_penalty=penalty, temperature=0.0
+            )
+            self.assertEqual(greedy, penalized.argmax(-1))
+            for top_k, top_p in [(50, 1.0), (0, 0.8), (50, 0.5), (0, 1.0)]:
+                args = dict(temperature=0.7, top_k=top_k, top_p=top_p)
+                out = torch.ops.torch_ipex.fused_sampling(logits, seed=1234, **args)
+                # same seed, same tokens
+                self.assertEqual(
+                    out, torch.ops.torch_ipex.fused_sampling(logits, seed=1234, **args)
+                )
+                # the token is within the top-k and the nucleus
+                probs = torch.softmax(logits.float() / 0.7, dim=-1)
+                sorted_probs, sorted_ids = probs.sort(dim=-1, descending=True)
+                if top_k > 0:
+                    sorted_probs = sorted_probs[:, :top_k]
+                    sorted_ids = sorted_ids[:, :top_k]
+                cum = sorted_probs.cumsum(-1) / sorted_probs.sum(-1, keepdim=True)
+                for b in range(batch):
+                    # one more token for the rounding at the boundary
+                    num_keep = int((cum[b] < top_p).sum()) + 2
+                    self.assertTrue(out[b] in sorted_ids[b, :num_keep])
+
 
 if __name__ == "__main__":
     test = unittest.main()
@@ -785,6 +785,107 @@ class MaskedMHATest(TestCase):
         self._test_mha(torchcompile=False)
         self._test_mha_fp16(torchcompile=False)
 
+    def test_mha_speculative_decoding(self):
+        batch_size, head_num, head_num_kv, head_size = 2, 8, 2, 64
+        prompt_len, max_seq_len = 8, 32
+        scale = head_size**0.5
+
+        def _ref(q, k, v, mask):
+            n_rep = head_num // head_num_kv
+            k = k.repeat_interleave(n_rep, 2).transpose(1, 2).float()
+            v = v.repeat_interleave(n_rep, 2).transpose(1, 2).float()
+            attn = q.transpose(1, 2).float().matmul(k.transpose(-1, -2)) / scale
+            return (attn + mask).softmax(-1).matmul(v)
+
+        def _inputs(seq_len, dtype):
+            q = torch.randn(batch_size, seq_len, head_num, head_size).to(dtype)
+            k = torch.randn(batch_size, seq_len, head_num_kv, head_size).to(dtype)
+            v = torch.randn(batch_size, seq_len, head_num_kv, head_size).to(dtype)
+            return q, k, v
+
+        # the draft tokens 1 and 2 are two candidates after 0, 3 follows 1
+        tree = torch.tensor(
+            [[1, 0, 0, 0], [1, 1, 0, 0], [1, 0, 1, 0], [1, 1, 0, 1]], dtype=torch.bool
+        )
+        accepted = torch.tensor([0, 1, 3])
+        for dtype in [torch.float32, torch.bfloat16]:
+            prec = 1e-5 if dtype == torch.float32 else 2e-2
+            q, k, v = _inputs(prompt_len, dtype)
+            mask = torch.full((prompt_len, prompt_len), -1e6).triu(1)
+            mask = mask.expand(batch_size, 1, -1, -1).to(dtype)
+            with torch.inference_mode():
+                _, _, key_cache, value_cache, beam_idx = (
+                    torch.ops.torch_ipex.masked_multihead_self_attention(
+                        q,
+                        k,
+                        v,
+                        torch.zeros(1),
+                        torch.zeros(1),
+                        torch.zeros(max_seq_len, batch_size, dtype=torch.long),
+                        torch.tensor(0),
+                        scale,
+                        max_seq_len,
+                        None,
+                        mask,
+                    )
+                )
+                past_k, past_v = k, v
+                # verify the tree of draft tokens
+                q, k, v = _inputs(tree.size(0), dtype)
+                offset = prompt_len
+                mask = torch.zeros(batch_size, 1, tree.size(0), offset + tree.size(0))
+                out = torch.ops.torch_ipex.masked_multihead_self_attention(
+                    q,
+                    k,
+                    v,
+                    key_cache,
+                    value_cache,
+                    beam_idx,
+                    torch.tensor(offset),
+                    scale,
+                    max_seq_len,
+                    None,
+                    mask.to(dtype),
+                    tree_mask=tree,
+                )
+                key_cache, value_cache, beam_idx = out[2:]
+                ref_mask = mask.clone()
+                ref_mask[..., offset:].masked_fill_(~tree, float("-inf"))
+                ref = _ref(
+                    q, torch.cat([past_k, k], 1), torch.cat([past_v, v], 1), ref_mask
+                )
+                self.assertEqual(out[0].float(), ref, prec=prec)
+                # roll back to the accepted path and verify causal draft tokens
+                key_cache[offset : offset + 3] = key_cache[offset + accepted].clone()
+                value_cache[offset : offset + 3] = value_cache[
+                    offset + accepted
+                ].clone()
+                past_k = torch.cat([past_k, k[:, accepted]], 1)
+                past_v = torch.cat([past_v, v[:, accepted]], 1)
+                offset += accepted.numel()
+                q, k, v = _inputs(2, dtype)
+                mask = torch.zeros(batch_size, 1, 2, offset + 2)
+                out = torch.ops.torch_ipex.masked_multihead_self_attention(
+                    q,
+                    k,
+                    v,
+                    key_cache,
+                    value_cache,
+                    beam_idx,
+                    torch.tensor(offset),
+                    scale,
+                    max_seq_len,
+                    None,
+                    mask.to(dtype),
+                )
+                ref_mask = mask.clone()
+                ref_mask[..., offset:] = torch.full((2, 2), float("-inf")).triu(1)
+                ref = _ref(
+                    q, torch.cat([past_k, k], 1), torch.cat([past_v, v], 1), ref_mask
+                )
+                self.assertEqual(out[0].float(), ref, prec=prec)
+                self.assertEqual(out[2][offset : offset + 2].transpose(0, 1), k)
+
 
 if __name__ == "__main__":
     test = unittest.main()
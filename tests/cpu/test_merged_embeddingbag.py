@@ -10,7 +10,13 @@ from bench.custom_op_bench.merged_embeddingbag import (
     MergedEmbAdaGrad,
 )
 import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.nn.modules import (
+    MergedEmbeddingBagWithMmapCache,
+    MergedEmbeddingBagRowwiseQuantized,
+)
 import copy
+import os
+import tempfile
 
 
 class TestMergedEmbedding(TestCase):
@@ -230,6 +236,108 @@ class TestMergedEmbedding(TestCase):
                                 )
                             self._test_training(m, ref_m, (indices, offsets), opt=opt)
 
+    def test_mmap_cache_training(self):
+        B = 64
+        NUM_TABLE = 3
+        NUM_STEPS = 4
+        batches = []
+        for _ in range(NUM_STEPS):
+            indices = [torch.randint(1000, (B * 3,)) for _ in range(NUM_TABLE)]
+            offsets = [torch.arange(0, B * 3, 3) for _ in range(NUM_TABLE)]
+            batches.append((indices, offsets))
+        with tempfile.TemporaryDirectory() as path:
+            cache = ipex._C.MmapEmbeddingCache(
+                os.path.join(path, "table.bin"), 1000, 128, 0, 256
+            )
+            for indices, _ in batches:
+                slots = cache.lookup(indices[0], False)
+                # every index is mapped to the slot caching its row
+                self.assertEqual(cache.cached_rows(slots), indices[0])
+        for optimizer in ["sgd", "adagrad"]:
+            for NUM_DIM in [128, 129]:
+                emb_list = EmbeddingBagList(NUM_TABLE, NUM_DIM, torch.float32)
+                if optimizer == "sgd":
+                    lr = 0.1
+                    ref_m = MergedEmbSGD(copy.deepcopy(emb_list), lr=lr)
+                else:
+                    lr = 0.01
+                    ref_m = MergedEmbAdaGrad(copy.deepcopy(emb_list), lr=lr)
+                ref_m = ref_m.merged_emb
+                with tempfile.TemporaryDirectory() as path:
+                    # smaller than the rows used by all the batches, to evict
+                    m = MergedEmbeddingBagWithMmapCache.from_embeddingbag_list(
+                        emb_list.list,
+                        path=path,
+                        cache_rows=256,
+                        optimizer=optimizer,
+                        lr=lr,
+                    )
+                    for step, (indices, offsets) in enumerate(batches):
+                        out = m(indices, offsets)
+                        if step + 1 < NUM_STEPS:
+                            m.prefetch(batches[step + 1][0])
+                        ref_out = ref_m(indices, offsets)
+                        self.assertEqual(out, ref_out)
+                        sum(out).sum().backward()
+                        sum(ref_out).sum().backward()
+                    stats = m.cache_stats()
+                    self.assertTrue(all(s["evictions"] > 0 for s in stats))
+                    self.assertTrue(all(s["write_backs"] > 0 for s in stats))
+                    self.assertTrue(all(s["prefetched"] > 0 for s in stats))
+                    for i in range(NUM_TABLE):
+                        self.assertEqual(m.table(i), ref_m.weights[i])
+                    with torch.no_grad():
+                        self.assertEqual(m(*batches[0]), ref_m(*batches[0]))
+
+    def test_rowwise_quantized_inference(self):
+        B = 64
+        NUM_TABLE = 3
+        indices = [torch.randint(1000, (B * 3,)) for _ in range(NUM_TABLE)]
+        for mode in ["mean", "sum"]:
+            for include_last_offset in [True, False]:
+                n_offset = B + 1 if include_last_offset else B
+                offsets = [torch.arange(0, n_offset * 3, 3) for _ in range(NUM_TABLE)]
+                # an empty bag
+                offsets[0][1] = 0
+                for qtype in ["int8", "int4", "fp8"]:
+                    for NUM_DIM in [128, 129]:
+                        # 129 for the scalar tail and the odd int4 row
+                        emb_list = EmbeddingBagList(
+                            NUM_TABLE,
+                            NUM_DIM,
+                            torch.float32,
+                            include_last_offset=include_last_offset,
+                            mode=mode,
+                        )
+                        m = MergedEmbeddingBagRowwiseQuantized.from_embeddingbag_list(
+                            emb_list.list, qtype
+                        )
+                        ref_m = copy.deepcopy(emb_list)
+                        for i in range(NUM_TABLE):
+                            w = emb_list.list[i].weight.detach()
+                            dq_w = m.dequantize(i)
+                            err = (dq_w - w).abs()
+                            if qtype == "fp8":
+                                # half an ulp of the 3 bits mantissa
+                                amax = w.abs().amax(dim=1, keepdim=True)
+                                tol = w.abs() / 16 + amax * 1e-5
+                            else:
+                                # half a step of the row
+                                qmax = 255 if qtype == "int8" else 15
+                                w_range = w.amax(dim=1, keepdim=True) - w.amin(
+                                    dim=1, keepdim=True
+                                )
+                                tol = w_range / qmax / 2 + 1e-5
+                            self.assertTrue((err <= tol).all())
+                            ref_m.list[i].weight.data.copy_(dq_w)
+                        self._test_inference(m, ref_m, (indices, offsets))
+
+                        if mode == "mean":
+                            continue
+                        ref_m = EmbeddingBagListCatDense(ref_m)
+                        dense = torch.randn(B, NUM_DIM)
+                        self._test_inference(m, ref_m, (indices, offsets, dense))
+
 
 if __name__ == "__main__":
     test = unittest.main()
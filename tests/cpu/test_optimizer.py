@@ -313,6 +313,37 @@ class TestOptimizers(TestCase):
                 M, adam, dtype, split_master_weight_for_bf16, set_to_none, fused
             )
 
+    def test_adamw(self):
+        M = TestModule()
+        options = itertools.product(
+            [True, False],
+            [True, False],
+            [True, False],
+            [torch.float, torch.bfloat16],
+            [0, 0.1],
+            [True, False],
+            [True, False],
+        )
+        for (
+            set_to_none,
+            split_master_weight_for_bf16,
+            amsgrad,
+            dtype,
+            weight_decay,
+            foreach,
+            fused,
+        ) in options:
+            adamw = torch.optim.AdamW(
+                M.parameters(),
+                lr=0.001,
+                weight_decay=weight_decay,
+                amsgrad=amsgrad,
+                foreach=foreach,
+            )
+            self._test_update(
+                M, adamw, dtype, split_master_weight_for_bf16, set_to_none, fused
+            )
+
     def test_grad_scaling_unscale(self):
         inv_scale = torch.full((1,), 0.25, dtype=torch.float)
         found_inf = torch.full((1,), 0.0, dtype=torch.float)
@@ -1229,6 +1260,117 @@ class TestFusedSteps(TestCase):
         grad2 = base_grad.bfloat16()[10:20, 10:20]
         self._test_packed_add(param, grad, param2, trail, grad2)
 
+    def _multi_tensor_args(self):
+        # params of different sizes, the last one is non-contiguous
+        sizes = [(31, 33), (7,), (1000,), (1,), (33, 31)]
+        params = [torch.randn(size) for size in sizes]
+        params[-1] = params[-1].t().contiguous().t()
+        grads = [torch.randn(size) for size in sizes]
+        states = [torch.randn(size).abs() for size in sizes]
+        # bf16 params (master weight split)
+        params2, trails2 = zip(
+            *[torch.ops.torch_ipex.split_float_bfloat16(p) for p in params]
+        )
+        grads2 = [g.bfloat16() for g in grads]
+        return params, grads, states, list(params2), list(trails2), grads2
+
+    def _clone(self, tensors):
+        return [t.clone() for t in tensors]
+
+    def test_multi_tensor_steps(self):
+        params, grads, states, params2, trails2, grads2 = self._multi_tensor_args()
+        empty = [torch.Tensor() for _ in params]
+
+        # adam, fp32 and bf16 split params
+        for p, t, g in [(params, empty, grads), (params2, trails2, grads2)]:
+            p1, t1, m1, v1 = map(self._clone, (p, t, states, states))
+            p2, t2, m2, v2 = map(self._clone, (p, t, states, states))
+            steps = [float(i + 1) for i in range(len(p))]
+            for i in range(len(p)):
+                torch.ops.torch_ipex.adam_fused_step(
+                    p1[i],
+                    m1[i],
+                    v1[i],
+                    torch.Tensor(),
+                    g[i],
+                    t1[i],
+                    False,
+                    steps[i],
+                    0.8,
+                    0.9,
+                    0.1,
+                    0.01,
+                    1e-5,
+                )
+            torch.ops.torch_ipex.adam_fused_step_multi_tensor(
+                p2, m2, v2, [], g, t2, False, steps, 0.8, 0.9, 0.1, 0.01, 1e-5
+            )
+            self.assertEqual(p1, p2)
+            self.assertEqual(t1, t2)
+            self.assertEqual(m1, m2)
+            self.assertEqual(v1, v2)
+
+        # lamb, fp32 and bf16 split params, the fp32 grads are overwritten
+        for p, t, g in [(params, empty, grads), (params2, trails2, grads2)]:
+            p1, t1, m1, v1 = map(self._clone, (p, t, states, states))
+            p2, t2, m2, v2 = map(self._clone, (p, t, states, states))
+            g1, g2 = self._clone(g), self._clone(g)
+            steps = [i + 1 for i in range(len(p))]
+            for i in range(len(p)):
+                torch.ops.torch_ipex.lamb_fused_step(
+                    p1[i],
+                    m1[i],
+                    v1[i],
+                    g1[i],
+                    t1[i],
+                    steps[i],
+                    0.8,
+                    0.9,
+                    0.1,
+                    0.01,
+                    1e-5,
+                )
+            torch.ops.torch_ipex.lamb_fused_step_multi_tensor(
+                p2, m2, v2, g2, t2, steps, 0.8, 0.9, 0.1, 0.01, 1e-5
+            )
+            self.assertEqual(p1, p2)
+            self.assertEqual(t1, t2)
+            self.assertEqual(m1, m2)
+            self.assertEqual(v1, v2)
+
+        # adagrad, fp32 and bf16 split params
+        for p, t, g in [(params, empty, grads), (params2, trails2, grads2)]:
+            p1, t1, s1 = map(self._clone, (p, t, states))
+            p2, t2, s2 = map(self._clone, (p, t, states))
+            steps = [float(i + 1) for i in range(len(p))]
+            for i in range(len(p)):
+                torch.ops.torch_ipex.adagrad_fused_step(
+                    p1[i], g[i], s1[i], t1[i], steps[i], 0.1, 0.01, 0.1, 1e-5
+                )
+            torch.ops.torch_ipex.adagrad_fused_step_multi_tensor(
+                p2, g, s2, t2, steps, 0.1, 0.01, 0.1, 1e-5
+            )
+            self.assertEqual(p1, p2)
+            self.assertEqual(t1, t2)
+            self.assertEqual(s1, s2)
+
+        # sgd, with and without momentum bufs
+        for p, t, g in [(params, empty, grads), (params2, trails2, grads2)]:
+            p1, t1 = map(self._clone, (p, t))
+            p2, t2 = map(self._clone, (p, t))
+            bufs1 = [None, None] + self._clone(states[2:])
+            bufs2 = [None, None] + self._clone(states[2:])
+            for i in range(len(p)):
+                bufs1[i] = torch.ops.torch_ipex.sgd_fused_step(
+                    p1[i], g[i], bufs1[i], t1[i], 0.9, 0.1, 0.01, 0.0, True
+                )
+            bufs2 = torch.ops.torch_ipex.sgd_fused_step_multi_tensor(
+                p2, g, bufs2, t2, 0.9, 0.1, 0.01, 0.0, True
+            )
+            self.assertEqual(p1, p2)
+            self.assertEqual(t1, t2)
+            self.assertEqual(bufs1, bufs2)
+
 
 class TestPatchedMethod(TestCase):
     def test_zero_grad(self):
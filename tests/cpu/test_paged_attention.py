@@ -3,7 +3,7 @@ from common_utils import TestCase
 import unittest
 import random
 from typing import List, Optional, Tuple
-from itertools import product
+from itertools import product, accumulate
 import intel_extension_for_pytorch._C as core
 
 
@@ -63,6 +63,7 @@ class PagedAttentionTest(TestCase):
         context_lens: torch.Tensor,
         scale: float,
         alibi_slopes: Optional[torch.Tensor],
+        window_size: int = -1,
     ) -> None:
         num_query_heads = query.shape[1]
         num_kv_head = value_cache.shape[1]
@@ -77,9 +78,12 @@ class PagedAttentionTest(TestCase):
             block_table = block_tables[i]
             context_len = int(context_lens[i])
 
+            # only the last window_size tokens are visible
+            key_start = max(0, context_len - window_size) if window_size > 0 else 0
+
             keys = []
             values = []
-            for j in range(context_len):
+            for j in range(key_start, context_len):
                 key = torch.empty(
                     num_kv_head, head_size, dtype=query.dtype, device="cpu"
                 )
@@ -102,7 +106,7 @@ class PagedAttentionTest(TestCase):
             alibi_bias = None
             if alibi_slopes is not None:
                 # Create the ALiBi bias used in the paged attention kernel.
-                position_ids = torch.arange(context_len, device="cpu").int()
+                position_ids = torch.arange(key_start, context_len, device="cpu").int()
                 alibi_bias = (position_ids - context_len + 1).float()
                 alibi_bias = alibi_slopes.view(-1, 1, 1) * alibi_bias.view(1, 1, -1)
 
@@ -120,6 +124,7 @@ class PagedAttentionTest(TestCase):
         block_size: int,
         dtype: torch.dtype,
         seed: int,
+        window_size: int = -1,
     ) -> None:
         random.seed(seed)
         torch.random.manual_seed(seed)
@@ -167,7 +172,7 @@ class PagedAttentionTest(TestCase):
         block_tables = []
         for _ in range(num_seqs):
             block_table = [
-                random.randint(0, num_blocks - 1) for _ in range(max_num_blocks_per_seq)
+                random.randint(1, num_blocks - 1) for _ in range(max_num_blocks_per_seq)
             ]
             block_tables.append(block_table)
         block_tables = torch.tensor(block_tables, dtype=torch.int, device="cpu")
@@ -177,6 +182,10 @@ class PagedAttentionTest(TestCase):
             num_blocks, block_size, 1, num_kv_head, head_size, dtype, seed
         )
         key_cache, value_cache = key_caches[0], value_caches[0]
+        if window_size > 0:
+            self._recycle_out_of_window_blocks(
+                key_cache, value_cache, block_tables, context_lens, window_size
+            )
         # Call the paged attention kernel.
         output = torch.empty_like(query)
         torch.ops.torch_ipex.single_query_cached_kv_attention(
@@ -191,6 +200,7 @@ class PagedAttentionTest(TestCase):
             block_size,
             max_context_len,
             alibi_slopes,
+            window_size=window_size,
         )
 
         # Run the reference implementation.
@@ -205,6 +215,7 @@ class PagedAttentionTest(TestCase):
             context_lens,
             scale,
             alibi_slopes,
+            window_size,
         )
         assert torch.allclose(output, ref_output, atol=5e-3, rtol=1e-3)
 
@@ -247,6 +258,256 @@ class PagedAttentionTest(TestCase):
                 seed,
             )
 
+    def test_paged_attention_scratch_cache(self):
+        from intel_extension_for_pytorch.cpu.utils import scratch_allocator
+
+        scratch_allocator.empty_scratch_cache()
+        scratch_allocator.reset_scratch_allocator_stats()
+        # The scratch buffers of the first call are reused by the second one
+        for _ in range(2):
+            self._test_paged_attention_func(
+                7, (64, 16), 128, False, 128, 16, torch.float, 0
+            )
+        stats = scratch_allocator.scratch_allocator_stats()
+        self.assertGreater(stats["misses"], 0)
+        self.assertGreater(stats["hits"], 0)
+        self.assertGreater(stats["cached_bytes"], 0)
+        scratch_allocator.empty_scratch_cache()
+        stats = scratch_allocator.scratch_allocator_stats()
+        self.assertEqual(stats["cached_bytes"], 0)
+
+    def ref_multi_query_cached_kv_attention(
+        self,
+        output: torch.Tensor,
+        query: torch.Tensor,
+        num_queries_per_kv: int,
+        key_cache: torch.Tensor,
+        value_cache: torch.Tensor,
+        block_tables: torch.Tensor,
+        context_lens: torch.Tensor,
+        query_start_loc: torch.Tensor,
+        scale: float,
+        alibi_slopes: Optional[torch.Tensor],
+        window_size: int = -1,
+    ) -> None:
+        num_kv_head = value_cache.shape[1]
+        head_size = value_cache.shape[3]
+        block_size = value_cache.shape[2]
+        num_seqs = context_lens.shape[0]
+
+        block_tables = block_tables.cpu().tolist()
+        context_lens = context_lens.cpu().tolist()
+        query_start_loc = query_start_loc.cpu().tolist()
+        for i in range(num_seqs):
+            q = query[query_start_loc[i] : query_start_loc[i + 1]]
+            query_len = q.shape[0]
+            block_table = block_tables[i]
+            context_len = int(context_lens[i])
+            # the keys before the window of the first query token are not visible
+            key_start = 0
+            if window_size > 0:
+                key_start = max(0, context_len - query_len - window_size + 1)
+
+            keys = []
+            values = []
+            for j in range(key_start, context_len):
+                block_number = int(block_table[j // block_size])
+                block_offset = j % block_size
+                keys.append(key_cache[block_number, :, block_offset, :])
+                values.append(value_cache[block_number, :, block_offset, :])
+            keys = torch.stack(keys, dim=0)
+            values = torch.stack(values, dim=0)
+            if num_queries_per_kv > 1:
+                # Handle MQA and GQA
+                keys = torch.repeat_interleave(keys, num_queries_per_kv, dim=1)
+                values = torch.repeat_interleave(values, num_queries_per_kv, dim=1)
+            # The query tokens are the last query_len tokens of the context.
+            query_pos = torch.arange(context_len - query_len, context_len).view(-1, 1)
+            key_pos = torch.arange(key_start, context_len).view(1, -1)
+            attn_mask = torch.zeros(query_len, context_len - key_start)
+            attn_mask.masked_fill_(key_pos > query_pos, float("-inf"))
+            if window_size > 0:
+                window_mask = key_pos <= query_pos - window_size
+                attn_mask.masked_fill_(window_mask, float("-inf"))
+            attn_mask = attn_mask.view(1, query_len, context_len - key_start)
+            if alibi_slopes is not None:
+                alibi_bias = (key_pos - query_pos).float()
+                attn_mask = attn_mask + alibi_slopes.view(-1, 1, 1) * alibi_bias
+            out = self.ref_masked_attention(q, keys, values, scale, attn_mask)
+            output[query_start_loc[i] : query_start_loc[i + 1]].copy_(out)
+
+    def _test_multi_query_paged_attention_func(
+        self,
+        query_lens: List[int],
+        num_head: Tuple[int, int],
+        head_size: int,
+        use_alibi: bool,
+        num_blocks: int,
+        block_size: int,
+        dtype: torch.dtype,
+        seed: int,
+        window_size: int = -1,
+    ) -> None:
+        random.seed(seed)
+        torch.random.manual_seed(seed)
+        torch.manual_seed(seed)
+        max_seq_len = 256
+        scale = float(1.0 / (head_size**0.5))
+        num_query_heads, num_kv_head = num_head
+        num_seqs = len(query_lens)
+        num_tokens = sum(query_lens)
+        query = torch.empty(num_tokens, num_query_heads, head_size, dtype=dtype)
+        query.uniform_(-scale, scale)
+        num_queries_per_kv = num_query_heads // num_kv_head
+        alibi_slopes = None
+        if use_alibi:
+            alibi_slopes = torch.randn(num_query_heads, dtype=torch.float)
+
+        # Every sequence has some cached tokens followed by its query tokens.
+        context_lens = [
+            query_len + random.randint(0, max_seq_len) for query_len in query_lens
+        ]
+        max_context_len = max(context_lens)
+        context_lens = torch.tensor(context_lens, dtype=torch.int)
+        query_start_loc = [0]
+        for query_len in query_lens:
+            query_start_loc.append(query_start_loc[-1] + query_len)
+        query_start_loc = torch.tensor(query_start_loc, dtype=torch.int)
+
+        max_num_blocks_per_seq = (max_context_len + block_size - 1) // block_size
+        block_tables = []
+        for _ in range(num_seqs):
+            block_table = [
+                random.randint(1, num_blocks - 1) for _ in range(max_num_blocks_per_seq)
+            ]
+            block_tables.append(block_table)
+        block_tables = torch.tensor(block_tables, dtype=torch.int)
+
+        key_caches, value_caches = self.create_kv_caches(
+            num_blocks, block_size, 1, num_kv_head, head_size, dtype, seed
+        )
+        key_cache, value_cache = key_caches[0], value_caches[0]
+        if window_size > 0:
+            # the window of the first query token decides the recyclable blocks
+            self._recycle_out_of_window_blocks(
+                key_cache,
+                value_cache,
+                block_tables,
+                context_lens - torch.tensor(query_lens, dtype=torch.int) + 1,
+                window_size,
+            )
+        output = torch.empty_like(query)
+        torch.ops.torch_ipex.multi_query_cached_kv_attention(
+            output,
+            query,
+            key_cache,
+            value_cache,
+            scale,
+            block_tables,
+            context_lens,
+            query_start_loc,
+            block_size,
+            max(query_lens),
+            alibi_slopes,
+            window_size=window_size,
+        )
+
+        ref_output = torch.empty_like(query)
+        self.ref_multi_query_cached_kv_attention(
+            ref_output,
+            query,
+            num_queries_per_kv,
+            key_cache,
+            value_cache,
+            block_tables,
+            context_lens,
+            query_start_loc,
+            scale,
+            alibi_slopes,
+            window_size,
+        )
+        assert torch.allclose(output, ref_output, atol=5e-3, rtol=1e-3)
+
+    def test_multi_query_paged_attention(self):
+        num_blocks = 128
+        dtypes = [torch.bfloat16, torch.float]
+        if core.onednn_has_fp16_support():
+            dtypes.append(torch.float16)
+        # mix prefill chunks and decode tokens in one batch
+        query_lens = [[1, 1, 1], [17, 1, 70, 1], [100]]
+        num_heads = [(40, 40), (64, 16)]
+        head_sizes = [64, 80, 128]
+        block_sizes = [16, 32]
+        use_alibis = [True, False]
+        seeds = [0]
+        for (
+            query_len,
+            num_head,
+            head_size,
+            use_alibi,
+            block_size,
+            dtype,
+            seed,
+        ) in product(
+            query_lens,
+            num_heads,
+            head_sizes,
+            use_alibis,
+            block_sizes,
+            dtypes,
+            seeds,
+        ):
+            self._test_multi_query_paged_attention_func(
+                query_len,
+                num_head,
+                head_size,
+                use_alibi,
+                num_blocks,
+                block_size,
+                dtype,
+                seed,
+            )
+
+    def _recycle_out_of_window_blocks(
+        self, key_cache, value_cache, block_tables, context_lens, window_size
+    ):
+        # Point the blocks that are entirely before the sliding window to block 0
+        # and poison it, the kernel should never read them.
+        key_cache[0].fill_(float("nan"))
+        value_cache[0].fill_(float("nan"))
+        block_size = key_cache.shape[2]
+        for i, context_len in enumerate(context_lens.tolist()):
+            num_out_of_window = max(0, context_len - window_size) // block_size
+            block_tables[i, :num_out_of_window] = 0
+
+    def test_paged_attention_sliding_window(self):
+        num_blocks = 128
+        for window_size, use_alibi, block_size, dtype in product(
+            [1, 100, 300], [True, False], [16, 32], [torch.bfloat16, torch.float]
+        ):
+            self._test_paged_attention_func(
+                7,
+                (64, 16),
+                128,
+                use_alibi,
+                num_blocks,
+                block_size,
+                dtype,
+                0,
+                window_size,
+            )
+            self._test_multi_query_paged_attention_func(
+                [17, 1, 70, 1],
+                (64, 16),
+                128,
+                use_alibi,
+                num_blocks,
+                block_size,
+                dtype,
+                0,
+                window_size,
+            )
+
     def _test_reshape_and_cache_func(
         self,
         num_token: int,
@@ -326,6 +587,235 @@ class PagedAttentionTest(TestCase):
                 num_token, num_kv_head, head_size, block_size, num_blocks, dtype, seed
             )
 
+    def _quantize_kv_cache(self, kv_cache: torch.Tensor, cache_dtype: torch.dtype):
+        # per token per head symmetric quantization as reshape_and_cache does
+        quant_max = 127.0 if cache_dtype is torch.int8 else torch.finfo(cache_dtype).max
+        amax = kv_cache.float().abs().amax(dim=-1)
+        kv_scale = torch.where(amax == 0, torch.ones_like(amax), amax / quant_max)
+        quantized = (kv_cache.float() / kv_scale.unsqueeze(-1)).clamp(
+            -quant_max, quant_max
+        )
+        if cache_dtype is torch.int8:
+            quantized = quantized.round()
+        return quantized.to(cache_dtype), kv_scale
+
+    def _dequantize_kv_cache(self, kv_cache: torch.Tensor, kv_scale: torch.Tensor):
+        return kv_cache.float() * kv_scale.unsqueeze(-1)
+
+    def test_reshape_and_cache_quantized(self):
+        num_blocks = 128
+        num_head = 8
+        block_size = 16
+        cache_dtypes = [torch.int8, torch.float8_e5m2, torch.float8_e4m3fn]
+        for num_token, head_size, dtype, cache_dtype in product(
+            [1, 83], [64, 80, 128], [torch.bfloat16, torch.float], cache_dtypes
+        ):
+            slot_mapping = random.sample(range(block_size * num_blocks), num_token)
+            slot_mapping = torch.tensor(slot_mapping, dtype=torch.int)
+            key = torch.randn(num_token, num_head, head_size, dtype=dtype)
+            value = torch.randn(num_token, num_head, head_size, dtype=dtype)
+            cache_shape = (num_blocks, num_head, block_size, head_size)
+            key_cache = torch.zeros(cache_shape, dtype=cache_dtype)
+            value_cache = torch.zeros(cache_shape, dtype=cache_dtype)
+            k_scale = torch.ones(num_blocks, num_head, block_size)
+            v_scale = torch.ones(num_blocks, num_head, block_size)
+            torch.ops.torch_ipex.reshape_and_cache(
+                key, value, key_cache, value_cache, slot_mapping, k_scale, v_scale
+            )
+            block_indicies = torch.div(slot_mapping, block_size, rounding_mode="floor")
+            block_offsets = slot_mapping % block_size
+            ref_key, ref_k_scale = self._quantize_kv_cache(key, cache_dtype)
+            ref_value, ref_v_scale = self._quantize_kv_cache(value, cache_dtype)
+            for i in range(num_token):
+                block_idx = block_indicies[i]
+                block_offset = block_offsets[i]
+                torch.testing.assert_close(
+                    k_scale[block_idx, :, block_offset], ref_k_scale[i]
+                )
+                torch.testing.assert_close(
+                    v_scale[block_idx, :, block_offset], ref_v_scale[i]
+                )
+                torch.testing.assert_close(
+                    key_cache[block_idx, :, block_offset].float(),
+                    ref_key[i].float(),
+                    atol=1,
+                    rtol=0.25,
+                )
+                torch.testing.assert_close(
+                    value_cache[block_idx, :, block_offset].float(),
+                    ref_value[i].float(),
+                    atol=1,
+                    rtol=0.25,
+                )
+
+    def test_paged_attention_quantized_kv_cache(self):
+        num_blocks = 128
+        block_size = 16
+        num_query_heads, num_kv_head = 64, 16
+        head_size = 128
+        cache_dtypes = [torch.int8, torch.float8_e5m2, torch.float8_e4m3fn]
+        for dtype, cache_dtype in product([torch.bfloat16, torch.float], cache_dtypes):
+            random.seed(0)
+            torch.manual_seed(0)
+            scale = float(1.0 / (head_size**0.5))
+            key_caches, value_caches = self.create_kv_caches(
+                num_blocks, block_size, 1, num_kv_head, head_size, dtype, 0
+            )
+            key_cache, k_scale = self._quantize_kv_cache(key_caches[0], cache_dtype)
+            value_cache, v_scale = self._quantize_kv_cache(
+                value_caches[0], cache_dtype
+            )
+            # the reference runs on the dequantized cache
+            ref_key_cache = self._dequantize_kv_cache(key_cache, k_scale).to(dtype)
+            ref_value_cache = self._dequantize_kv_cache(value_cache, v_scale).to(dtype)
+            num_seqs = 5
+            query_lens = [1, 1, 9, 1, 33]
+            context_lens = [q + random.randint(1, 300) for q in query_lens]
+            max_context_len = max(context_lens)
+            max_num_blocks_per_seq = (max_context_len + block_size - 1) // block_size
+            block_tables = torch.tensor(
+                [
+                    [
+                        random.randint(0, num_blocks - 1)
+                        for _ in range(max_num_blocks_per_seq)
+                    ]
+                    for _ in range(num_seqs)
+                ],
+                dtype=torch.int,
+            )
+            context_lens = torch.tensor(context_lens, dtype=torch.int)
+            num_queries_per_kv = num_query_heads // num_kv_head
+
+            # single query decode
+            query = torch.empty(num_seqs, num_query_heads, head_size, dtype=dtype)
+            query.uniform_(-scale, scale)
+            head_mapping = torch.repeat_interleave(
+                torch.arange(num_kv_head, dtype=torch.int32), num_queries_per_kv
+            )
+            output = torch.empty_like(query)
+            torch.ops.torch_ipex.single_query_cached_kv_attention(
+                output,
+                query,
+                key_cache,
+                value_cache,
+                head_mapping,
+                scale,
+                block_tables,
+                context_lens,
+                block_size,
+                max_context_len,
+                None,
+                k_scale,
+                v_scale,
+            )
+            ref_output = torch.empty_like(query)
+            self.ref_single_query_cached_kv_attention(
+                ref_output,
+                query,
+                num_queries_per_kv,
+                ref_key_cache,
+                ref_value_cache,
+                block_tables,
+                context_lens,
+                scale,
+                None,
+            )
+            assert torch.allclose(output, ref_output, atol=5e-3, rtol=1e-3)
+
+            # multi query prefill and decode
+            query_start_loc = torch.tensor(
+                [0] + list(accumulate(query_lens)), dtype=torch.int
+            )
+            query = torch.empty(
+                sum(query_lens), num_query_heads, head_size, dtype=dtype
+            )
+            query.uniform_(-scale, scale)
+            output = torch.empty_like(query)
+            torch.ops.torch_ipex.multi_query_cached_kv_attention(
+                output,
+                query,
+                key_cache,
+                value_cache,
+                scale,
+                block_tables,
+                context_lens,
+                query_start_loc,
+                block_size,
+                max(query_lens),
+                None,
+                k_scale,
+                v_scale,
+            )
+            ref_output = torch.empty_like(query)
+            self.ref_multi_query_cached_kv_attention(
+                ref_output,
+                query,
+                num_queries_per_kv,
+                ref_key_cache,
+                ref_value_cache,
+                block_tables,
+                context_lens,
+                query_start_loc,
+                scale,
+                None,
+            )
+            assert torch.allclose(output, ref_output, atol=5e-3, rtol=1e-3)
+
+    def test_copy_blocks(self):
+        num_blocks = 64
+        num_layers = 3
+        num_head = 8
+        head_size = 64
+        block_size = 16
+        for dtype in [torch.bfloat16, torch.float, torch.int8]:
+            random.seed(0)
+            key_caches, value_caches = [], []
+            for _ in range(num_layers):
+                key_caches.append(
+                    torch.randn(num_blocks, num_head, block_size, head_size).to(dtype)
+                )
+                value_caches.append(
+                    torch.randn(num_blocks, num_head, block_size, head_size).to(dtype)
+                )
+            src_blocks = random.sample(range(num_blocks), 10)
+            remaining_blocks = list(set(range(num_blocks)) - set(src_blocks))
+            dst_blocks = random.sample(remaining_blocks, 10)
+            block_mapping = torch.tensor(
+                list(zip(src_blocks, dst_blocks)), dtype=torch.long
+            )
+            ref_key_caches = [cache.clone() for cache in key_caches]
+            ref_value_caches = [cache.clone() for cache in value_caches]
+            for src, dst in zip(src_blocks, dst_blocks):
+                for ref_key_cache, ref_value_cache in zip(
+                    ref_key_caches, ref_value_caches
+                ):
+                    ref_key_cache[dst].copy_(ref_key_cache[src])
+                    ref_value_cache[dst].copy_(ref_value_cache[src])
+            torch.ops.torch_ipex.copy_blocks(key_caches, value_caches, block_mapping)
+            for key_cache, ref_key_cache in zip(key_caches, ref_key_caches):
+                self.assertEqual(key_cache, ref_key_cache)
+            for value_cache, ref_value_cache in zip(value_caches, ref_value_caches):
+                self.assertEqual(value_cache, ref_value_cache)
+
+    def test_swap_blocks(self):
+        num_head = 8
+        head_size = 128
+        block_size = 16
+        for dtype in [torch.bfloat16, torch.float]:
+            random.seed(0)
+            src = torch.randn(64, num_head, block_size, head_size).to(dtype)
+            dst = torch.randn(32, num_head, block_size, head_size).to(dtype)
+            src_blocks = random.sample(range(64), 7)
+            dst_blocks = random.sample(range(32), 7)
+            block_mapping = torch.tensor(
+                list(zip(src_blocks, dst_blocks)), dtype=torch.long
+            )
+            ref_dst = dst.clone()
+            for src_block, dst_block in zip(src_blocks, dst_blocks):
+                ref_dst[dst_block].copy_(src[src_block])
+            torch.ops.torch_ipex.swap_blocks(src, dst, block_mapping)
+            self.assertEqual(dst, ref_dst)
+
 
 if __name__ == "__main__":
     test = unittest.main()
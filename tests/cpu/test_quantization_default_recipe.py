@@ -26,6 +26,7 @@ from intel_extension_for_pytorch.quantization import (
     quantize_per_block,
     WoqWeightDtype,
     WoqLowpMode,
+    WoqActQuantMode,
 )
 
 
@@ -1937,6 +1938,89 @@ class WeightOnlyQuantizationTester(TestCase):
         for has_bias, quant_mode, M, group_size in cases:
             test(has_bias, quant_mode, M, group_size)
 
+    def test_weight_only_quantization_small_batch(self):
+        # M <= 32 runs the GEMM dequantizing the weight in registers on CPUs
+        # without AVX512-FP16
+        class Mod(nn.Module):
+            def __init__(self, has_bias):
+                super(Mod, self).__init__()
+                self.linear = torch.nn.Linear(K, N, has_bias)
+
+            def forward(self, x):
+                return self.linear(x)
+
+        def test(has_bias, w_dtype, lowp_mode, act_quant_mode, M, group_size):
+            m = Mod(has_bias).eval()
+            data = torch.randn(M, K)
+            qconfig_mapping = ipex.quantization.get_weight_only_quant_qconfig_mapping(
+                weight_dtype=w_dtype,
+                lowp_mode=lowp_mode,
+                act_quant_mode=act_quant_mode,
+                group_size=group_size,
+            )
+            prepared_model = prepare(copy.deepcopy(m), qconfig_mapping, inplace=True)
+            with torch.no_grad():
+                woq_model = convert(prepared_model)
+                w = m.linear.weight.data
+                if group_size > 0:
+                    qw, w_scales, w_zero_points = quantize_per_block(
+                        w, w_dtype, group_size, None, None
+                    )
+                    fake_quant_w = dequantize_per_block(
+                        qw,
+                        w_scales,
+                        w_zero_points,
+                        w_dtype,
+                        group_size,
+                        weight_shape=w.shape,
+                    )
+                else:
+                    qw, w_scales, w_zero_points = quantize_per_channel(
+                        w, w_dtype, None, None
+                    )
+                    fake_quant_w = dequantize_per_channel(
+                        qw, w_scales, w_zero_points, w_dtype, w.shape
+                    )
+                y_ref = torch.nn.functional.linear(data, fake_quant_w, m.linear.bias)
+                y = woq_model(data)
+                if lowp_mode == WoqLowpMode.NONE:
+                    torch.testing.assert_close(y, y_ref, atol=1e-3, rtol=1e-3)
+                else:
+                    # fp16/bf16 compute on CPUs with AVX512-FP16, and the
+                    # activation quantized to 7 or 8 bits for INT8
+                    err = (y - y_ref).norm() / y_ref.norm()
+                    self.assertLess(err.item(), 0.05)
+
+        N, K = 100, 256
+        has_bias_list = [False, True]
+        weight_dtype_list = [
+            WoqWeightDtype.INT8,
+            WoqWeightDtype.INT4,
+            WoqWeightDtype.NF4,
+        ]
+        lowp_mode_list = [
+            WoqLowpMode.NONE,
+            WoqLowpMode.FP16,
+            WoqLowpMode.BF16,
+            WoqLowpMode.INT8,
+        ]
+        batch_size_list = [1, 5, 32]
+        group_size_list = [-1, 64]
+        cases = itertools.product(
+            has_bias_list,
+            weight_dtype_list,
+            lowp_mode_list,
+            batch_size_list,
+            group_size_list,
+        )
+        for has_bias, w_dtype, lowp_mode, M, group_size in cases:
+            # act_quant_mode only takes effect for INT8
+            act_quant_mode_list = (
+                range(8) if lowp_mode == WoqLowpMode.INT8 else [WoqActQuantMode.NONE]
+            )
+            for act_quant_mode in act_quant_mode_list:
+                test(has_bias, w_dtype, lowp_mode, act_quant_mode, M, group_size)
+
 
 class QuantizedOpsTester(TestCase):
     def test_matmul_i8i8i32(self):
@@ -97,6 +97,40 @@ class TestCPUPool(TestCase):
         cpu_pool = ipex.cpu.runtime.CPUPool(core_list)
         self.assertEqual(cpu_pool.cpu_pool.get_core_list(), core_list)
 
+    @unittest.skipIf(
+        not ipex.cpu.runtime.is_runtime_ext_enabled(),
+        "Skip when IPEX Runtime extension is not enabled",
+    )
+    @runtime_thread_affinity_test_env
+    def test_cpupool_memory_policy(self):
+        for memory_policy in ["none", "preferred", "bind"]:
+            cpu_pool = ipex.cpu.runtime.CPUPool([0, 1], memory_policy=memory_policy)
+            self.assertEqual(cpu_pool.memory_policy, memory_policy)
+            node_id = ipex._C.get_core_numa_node(0)
+            if node_id >= 0:
+                self.assertTrue(node_id in cpu_pool.numa_nodes)
+            with ipex.cpu.runtime.pin(cpu_pool):
+                x = torch.ones(1024, 1024)
+            stats = ipex.cpu.runtime.get_numa_memory_stats(x)
+            self.assertTrue(sum(stats.values()) >= x.numel() * x.element_size())
+            if memory_policy == "bind" and node_id >= 0:
+                self.assertEqual(
+                    stats[node_id], sum(stats.values()), "allocated off node"
+                )
+        with self.assertRaises(AssertionError):
+            ipex.cpu.runtime.CPUPool([0, 1], memory_policy="interleave")
+
+    def test_replicate_module_to_numa_node(self):
+        model = SimpleNet()
+        replica = ipex.cpu.runtime.replicate_module_to_numa_node(model, 0)
+        self.assertNotEqual(
+            replica.conv.weight.data_ptr(), model.conv.weight.data_ptr()
+        )
+        self.assertEqual(replica.conv.weight, model.conv.weight)
+        stats = ipex.cpu.runtime.get_numa_memory_stats(replica.conv.weight)
+        self.assertEqual(stats[0], sum(stats.values()))
+        self.assertTrue(sum(ipex.cpu.runtime.get_numa_memory_stats().values()) > 0)
+
 
 class TestCoreBinding(TestCase):
     @unittest.skipIf(
@@ -1,3 +1,4 @@
+import threading
 import unittest
 import torch
 import intel_extension_for_pytorch as ipex
@@ -475,6 +476,104 @@ class TestJITMultiStreamModule(JitTestCase):
             multi_stream_model.get_stream_number(), cpu_pool.core_ids.__len__()
         )
 
+    @unittest.skipIf(
+        not ipex.cpu.runtime.is_runtime_ext_enabled(),
+        "Skip when IPEX Runtime extension is not enabled",
+    )
+    @runtime_thread_affinity_test_env
+    def test_multi_stream_task_module_submit(self):
+        model = SimpleNet()
+        model.eval()
+        cpu_pool = ipex.cpu.runtime.CPUPool()
+        core_ids = cpu_pool.core_ids
+        x = torch.rand(2, 64, 3, 3)
+        with torch.no_grad():
+            trace_model = torch.jit.trace(model, x)
+        y = trace_model(x)
+
+        # Just enough task slots for one round, so that they are reused
+        multi_stream_task = ipex._C.MultiStreamTaskModule(
+            trace_model._c,
+            [[core_id] for core_id in core_ids],
+            core_ids.__len__() + 1,
+        )
+        for _ in range(16):
+            handles = multi_stream_task.submit_batch(
+                [((x,), {}) for _ in range(core_ids.__len__())]
+            )
+            handles.append(multi_stream_task.submit(x))
+            for handle in handles:
+                self.assertEqual(y, multi_stream_task.get(handle))
+        # A handle can only be consumed once
+        handle = multi_stream_task.submit(x)
+        multi_stream_task.get(handle)
+        with self.assertRaises(RuntimeError):
+            multi_stream_task.get(handle)
+        self.assertEqual(
+            multi_stream_task.stolen_counts().__len__(), core_ids.__len__()
+        )
+
+
+class TestJITDynamicBatchTask(JitTestCase):
+    @unittest.skipIf(
+        not ipex.cpu.runtime.is_runtime_ext_enabled(),
+        "Skip when IPEX Runtime extension is not enabled",
+    )
+    @runtime_thread_affinity_test_env
+    def test_dynamic_batch_task(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(16, 64, 3, 3)
+        with torch.no_grad():
+            trace_model = torch.jit.trace(model, x)
+        y = trace_model(x)
+
+        cpu_pool = ipex.cpu.runtime.CPUPool()
+        # Long enough wait for the batches to be full
+        task = ipex.cpu.runtime.DynamicBatchTask(
+            trace_model, cpu_pool, max_batch_size=4, max_wait_us=1000000
+        )
+        futures = [task(x[i : i + 1]) for i in range(16)]
+        for i in range(16):
+            self.assertEqual(y[i : i + 1], futures[i].get())
+        self.assertEqual(task.num_requests(), 16)
+        self.assertEqual(task.num_batches(), 4)
+
+    @unittest.skipIf(
+        not ipex.cpu.runtime.is_runtime_ext_enabled(),
+        "Skip when IPEX Runtime extension is not enabled",
+    )
+    @runtime_thread_affinity_test_env
+    def test_dynamic_batch_task_multi_thread(self):
+        model = SimpleNet()
+        model.eval()
+        x = torch.rand(32, 64, 3, 3)
+        with torch.no_grad():
+            trace_model = torch.jit.trace(model, x)
+        y = trace_model(x)
+
+        cpu_pool = ipex.cpu.runtime.CPUPool()
+        task = ipex.cpu.runtime.DynamicBatchTask(
+            trace_model,
+            cpu_pool,
+            num_streams=min(2, cpu_pool.core_ids.__len__()),
+            max_batch_size=8,
+            max_wait_us=100,
+        )
+        y_runtime = [None] * 16
+
+        def client(i):
+            # Requests of 2 rows, from several threads
+            y_runtime[i] = task.run_sync(x[2 * i : 2 * i + 2])
+
+        threads = [threading.Thread(target=client, args=(i,)) for i in range(16)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(y, torch.cat(y_runtime))
+        self.assertEqual(task.num_requests(), 16)
+
 
 class TestLLGARuntimeAPI(JitLlgaTestCase):
     @unittest.skipIf(
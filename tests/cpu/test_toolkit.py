@@ -21,3 +21,31 @@ class ToolkitTester(TestCase):
         self.assertEqual(roc_auc_st, roc_auc_mt)
         self.assertEqual(roc_auc_st, roc_auc_mt_2)
         self.assertEqual(accuracy_st, accuracy_mt)
+
+    def test_roc_auc_accumulator(self):
+        targets = np.random.randint(0, 2, size=100000)
+        # ties and a few predictions out of [0, 1], but none at 0.5, which
+        # np.round and std::round don't round the same way
+        scores = (torch.randint(0, 1000, (100000,)) * 2 + 1) / 2000.0
+        scores[:10] = -0.0
+        scores[10:20] = 1.25
+        roc_auc_st = sklearn.metrics.roc_auc_score(targets, scores.numpy())
+        accuracy_st = sklearn.metrics.accuracy_score(
+            y_true=targets, y_pred=np.round(scores.numpy())
+        )
+        p = np.clip(scores.numpy().astype(np.float64), 1e-15, 1 - 1e-15)
+        log_loss_ref = -np.mean(targets * np.log(p) + (1 - targets) * np.log(1 - p))
+        for num_bins in [0, 1 << 16]:
+            acc = ipex._C.RocAucAccumulator(num_bins)
+            for target, score in zip(
+                torch.tensor(targets).split(30000), scores.split(30000)
+            ):
+                acc.update(target, score)
+            self.assertEqual(acc.num_samples(), 100000)
+            roc_auc, log_loss, accuracy = acc.compute()
+            tol = 1e-9 if num_bins == 0 else 1e-3
+            self.assertEqual(roc_auc, roc_auc_st, atol=tol, rtol=0)
+            self.assertEqual(log_loss, log_loss_ref, atol=1e-5, rtol=1e-5)
+            self.assertEqual(accuracy, accuracy_st)
+            acc.reset()
+            self.assertEqual(acc.num_samples(), 0)
@@ -415,6 +415,88 @@ class TestTPPlinear(TestCase):
                 self.assertEqual(out, ref_out)
                 _disable_tpp()
 
+    def test_mixtral_moe_tpp_grouped(self):
+        from intel_extension_for_pytorch.nn.utils import Apply_TPPLinear_weight_prepack
+
+        num_tokens, hidden, inter, num_experts, top_k = 13, 128, 64, 8, 2
+        # (out_features, in_features) of gate, up and down, blockable for TPP
+        shapes = [(inter, hidden), (inter, hidden), (hidden, inter)]
+        with torch.no_grad():
+            for dtype in [torch.float, torch.bfloat16]:
+                x = torch.randn(num_tokens, hidden).to(dtype)
+                experts = [
+                    [
+                        torch.nn.Linear(in_f, out_f, bias=False).to(dtype)
+                        for _ in range(num_experts)
+                    ]
+                    for out_f, in_f in shapes
+                ]
+                gate, up, down = [
+                    [m.weight.detach().clone() for m in linears] for linears in experts
+                ]
+                # route to the first 4 experts only so that some stay inactive
+                routing_weights, selected_experts = torch.topk(
+                    torch.softmax(torch.randn(num_tokens, 4), dim=-1), top_k, dim=-1
+                )
+                routing_weights = routing_weights.to(dtype)
+                ref_out = torch.zeros_like(x)
+                expert_mask = torch.nn.functional.one_hot(
+                    selected_experts, num_classes=num_experts
+                ).permute(2, 1, 0)
+                for e in range(num_experts):
+                    idx, top_x = torch.where(expert_mask[e])
+                    ref_out = torch.ops.torch_ipex.mixtral_moe_tpp(
+                        x,
+                        top_x,
+                        idx,
+                        gate[e],
+                        up[e],
+                        down[e],
+                        True,
+                        routing_weights,
+                        ref_out,
+                        False,
+                    )
+                # the grouped TPP GEMMs take the weights blocked for TPP
+                for linears in experts:
+                    for m in linears:
+                        Apply_TPPLinear_weight_prepack(m, dtype)
+                        self.assertFalse(m.tpp_fallback)
+                blocked_gate, blocked_up, blocked_down = [
+                    [m.weight for m in linears] for linears in experts
+                ]
+                for tpp_fallback in [True, False]:
+                    if tpp_fallback:
+                        weights = [gate, up, down]
+                    else:
+                        weights = [blocked_gate, blocked_up, blocked_down]
+                    out = torch.ops.torch_ipex.mixtral_moe_tpp_grouped(
+                        x,
+                        selected_experts,
+                        routing_weights,
+                        *weights,
+                        tpp_fallback,
+                        False,
+                    )
+                    self.assertEqual(out, ref_out, atol=2e-2, rtol=2e-2)
+
+    def test_tpp_kernel_cache(self):
+        kernel_cache = ipex.cpu.tpp.kernel_cache
+        with torch.no_grad():
+            for dtype in [torch.float, torch.bfloat16]:
+                model = Linear_without_bias().eval().to(dtype)
+                _enable_tpp()
+                model = ipex.optimize(model, dtype=dtype)
+                kernel_cache.prewarm(model, [3, 70])
+                kernel_cache.reset_kernel_cache_stats()
+                for tokens in [3, 70]:
+                    model(torch.rand(1, tokens, 4096).to(dtype))
+                stats = kernel_cache.kernel_cache_stats()
+                self.assertEqual(stats["misses"], 0)
+                self.assertGreater(stats["hits"], 0)
+                self.assertGreater(stats["size"], 0)
+                _disable_tpp()
+
 
 if __name__ == "__main__":
     test = unittest.main()
@@ -2204,6 +2204,39 @@ class TestPrepackCases(TestCase):
                 y_ref = origin_model(x_var)
                 self.assertEqual(y_var, y_ref)
 
+    def test_lstm_weight_pack_cache(self):
+        from intel_extension_for_pytorch.cpu.utils import weight_pack_cache
+
+        m = torch.nn.LSTM(input_size=16, hidden_size=32, num_layers=1).eval()
+        x = torch.randn(4, 2, 16)
+        ipex_model = ipex.optimize(copy.deepcopy(m), dtype=torch.float)
+        weight_pack_cache.clear_weight_pack_cache()
+        weight_pack_cache.reset_weight_pack_cache_stats()
+        with torch.no_grad():
+            y_ref, _ = m(x)
+            y, _ = ipex_model(x)
+            self.assertEqual(y, y_ref)
+            stats = weight_pack_cache.weight_pack_cache_stats()
+            self.assertGreater(stats["entries"], 0)
+            # The weights packed by the first call are reused
+            ipex_model(x)
+            self.assertGreater(weight_pack_cache.weight_pack_cache_stats()["hits"], 0)
+            # A capacity smaller than a packed weight keeps at most one entry,
+            # the evicted weights are packed again
+            weight_pack_cache.set_weight_pack_cache_capacity(1)
+            try:
+                for _ in range(2):
+                    y, _ = ipex_model(x)
+                    self.assertEqual(y, y_ref)
+                    stats = weight_pack_cache.weight_pack_cache_stats()
+                    self.assertLessEqual(stats["entries"], 1)
+            finally:
+                weight_pack_cache.set_weight_pack_cache_capacity(0)
+        weight_pack_cache.clear_weight_pack_cache()
+        stats = weight_pack_cache.weight_pack_cache_stats()
+        self.assertEqual(stats["entries"], 0)
+        self.assertEqual(stats["bytes"], 0)
+
 
 if __name__ == "__main__":
     torch.manual_seed(2020)